@@ -0,0 +1,145 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "app_config.h"
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <algorithm>
+#include <cwctype>
+#include <utility>
+// 4. Project classes
+
+/* public */ bool shortcut_config::operator==(const shortcut_config& other) const
+{
+    return displayName == other.displayName &&
+           startExePath == other.startExePath &&
+           startParams == other.startParams &&
+           startWorkingDir == other.startWorkingDir &&
+           checkExeName == other.checkExeName &&
+           checkTitleName == other.checkTitleName &&
+           above == other.above &&
+           snippet == other.snippet;
+}
+
+// --- add_shortcut(): Normalizes the shortcut and appends it to the above or below list.
+// Display names are made UPPERCASE and / in paths is replaced with the native \. Snippets are kept as they are.
+// ----- shortcut: The shortcut as it was read from the config file.
+// --------------------------------------------------------------------------------------------/
+/* public */ void app_config::add_shortcut(shortcut_config shortcut)
+{
+    for (size_t i = 0; i < shortcut.displayName.size(); i++)
+    {
+        shortcut.displayName[i] = static_cast<wchar_t>(std::towupper(static_cast<std::wint_t>(shortcut.displayName[i])));
+    }
+    for (size_t i = 0; i < shortcut.startExePath.size(); i++)
+    {
+        if (shortcut.startExePath[i] == L'/')
+        {
+            shortcut.startExePath[i] = L'\\';
+        }
+    }
+    for (size_t i = 0; i < shortcut.startWorkingDir.size(); i++)
+    {
+        if (shortcut.startWorkingDir[i] == L'/')
+        {
+            shortcut.startWorkingDir[i] = L'\\';
+        }
+    }
+    if (shortcut.above)
+    {
+        m_above.push_back(std::move(shortcut));
+    }
+    else
+    {
+        m_below.push_back(std::move(shortcut));
+    }
+}
+
+// --- diff(): Works out the fewest edits that turn one shortcut list into another.
+// Shortcuts are matched by display name along the longest common subsequence, so entries that stay keep
+// their place (and a combo box keeps its selection) however many others were added, removed or reordered.
+// ----- before: The list currently loaded.
+// ----- after: The list from the newer config.
+// ------- returns: The edits in the order they must be applied, see shortcut_edit. Empty if nothing changed.
+// --------------------------------------------------------------------------------------------/
+/* public */ std::vector<shortcut_edit> app_config::diff(const std::vector<shortcut_config>& before, const std::vector<shortcut_config>& after)
+{
+    // lengths[i * width + j] is the longest common run of names in before[i..] and after[j..].
+    // Configs hold tens of shortcuts, the quadratic table is a few KB at most.
+    size_t width = after.size() + 1;
+    std::vector<uint32_t> lengths((before.size() + 1) * width, 0);
+    for (size_t i = before.size(); i-- > 0;)
+    {
+        for (size_t j = after.size(); j-- > 0;)
+        {
+            if (before[i].displayName == after[j].displayName)
+            {
+                lengths[i * width + j] = lengths[(i + 1) * width + j + 1] + 1;
+            }
+            else
+            {
+                lengths[i * width + j] = std::max(lengths[(i + 1) * width + j], lengths[i * width + j + 1]);
+            }
+        }
+    }
+
+    std::vector<bool> keptBefore(before.size(), false);
+    std::vector<bool> keptAfter(after.size(), false);
+    std::vector<shortcut_edit> updates;
+    size_t i = 0;
+    size_t j = 0;
+    while (i < before.size() && j < after.size())
+    {
+        if (before[i].displayName == after[j].displayName)
+        {
+            keptBefore[i] = true;
+            keptAfter[j] = true;
+            if (before[i] != after[j])
+            {
+                updates.push_back({ shortcut_edit::opUpdate, static_cast<uint32_t>(j) });
+            }
+            i++;
+            j++;
+        }
+        else if (lengths[(i + 1) * width + j] >= lengths[i * width + j + 1])
+        {
+            i++;
+        }
+        else
+        {
+            j++;
+        }
+    }
+
+    std::vector<shortcut_edit> edits;
+    for (size_t k = before.size(); k-- > 0;)
+    {
+        if (!keptBefore[k])
+        {
+            edits.push_back({ shortcut_edit::opRemove, static_cast<uint32_t>(k) });
+        }
+    }
+    for (size_t k = 0; k < after.size(); k++)
+    {
+        if (!keptAfter[k])
+        {
+            edits.push_back({ shortcut_edit::opInsert, static_cast<uint32_t>(k) });
+        }
+    }
+    edits.insert(edits.end(), updates.begin(), updates.end());
+    return edits;
+}
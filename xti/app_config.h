@@ -0,0 +1,83 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef APP_CONFIG_H
+#define APP_CONFIG_H
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <cstdint>
+#include <string>
+#include <vector>
+// 4. Project classes
+#include "text_injector.h"
+// 5. Forward decl
+
+// One app shortcut from ~/xti.json, see README.md for what each field does.
+struct shortcut_config
+{
+    std::wstring displayName; // UPPERCASE
+    std::wstring startExePath; // native \ separators
+    std::wstring startParams;
+    std::wstring startWorkingDir; // native \ separators
+    std::wstring checkExeName;
+    std::wstring checkTitleName;
+    bool above;
+    std::wstring snippet; // typed into the focused app instead of starting one when not empty, used as is
+
+    bool operator==(const shortcut_config& other) const;
+    bool operator!=(const shortcut_config& other) const { return !(*this == other); }
+};
+
+// One step of bringing a shortcut list (and the combo box showing it) in line with a newer config.
+// diff() returns every opRemove first (descending), then every opInsert (ascending), then every opUpdate,
+// applying them in that order keeps all indexes valid.
+struct shortcut_edit
+{
+    static constexpr uint8_t opRemove = 0; // index is into the old list
+    static constexpr uint8_t opInsert = 1; // index is into the new list
+    static constexpr uint8_t opUpdate = 2; // index is into the new list, same display name but other fields changed
+
+    uint8_t op;
+    uint32_t index;
+};
+
+// The loaded shortcuts, split into the two lists the main window shows, and the typing settings.
+// Has no Qt or OS dependencies, reading the JSON is left to the caller.
+class app_config
+{
+public:
+    // public add_shortcut(): Normalizes the shortcut and appends it to the above or below list.
+    // see cpp file for more info.
+    void add_shortcut(shortcut_config shortcut);
+
+    const std::vector<shortcut_config>& get_shortcuts(bool above) const { return above ? m_above : m_below; }
+
+    // public set_typing(): Sets how snippets and the clipboard are typed.
+    void set_typing(const text_injection_settings& typing) { m_typing = typing; }
+    const text_injection_settings& get_typing() const { return m_typing; }
+
+    // public diff(): Works out the fewest edits that turn one shortcut list into another.
+    // see cpp file for more info.
+    static std::vector<shortcut_edit> diff(const std::vector<shortcut_config>& before, const std::vector<shortcut_config>& after);
+
+private:
+    std::vector<shortcut_config> m_above;
+    std::vector<shortcut_config> m_below;
+    text_injection_settings m_typing;
+};
+
+#endif // APP_CONFIG_H
@@ -0,0 +1,176 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "app_config_loader.h"
+
+// 1. Qt framework headers
+#include <QByteArray>
+#include <QDir>
+#include <QFile>
+#include <QIODevice>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonParseError>
+#include <QJsonValue>
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <utility>
+// 4. Project classes
+
+/* public */ QString app_config_loader::get_path()
+{
+    return QDir::homePath() + "/xti.json";
+}
+
+// --- load(): Reads and validates a config file. Assumes UTF-8 encoding.
+// The top level is either the list of shortcuts or an object holding that list as "shortcuts" and, optionally, the
+// "typing" settings. Every shortcut must be an object with "displayName", the bool "above" and either "snippet" or
+// all of the app fields, see README.md.
+// ----- path: The config file to read.
+// ----- configOut: Receives the shortcuts, only written to when the whole file is valid.
+// ----- errorOut: Receives a short reason when the file is not valid.
+// ------- returns: True if the file was read and is valid.
+// --------------------------------------------------------------------------------------------/
+/* public */ bool app_config_loader::load(const QString& path, app_config& configOut, QString& errorOut)
+{
+    QFile configFile(path);
+    if (!configFile.open(QIODevice::ReadOnly))
+    {
+        errorOut = "cannot open " + path;
+        return false;
+    }
+    QByteArray configData = configFile.readAll();
+    configFile.close();
+    QJsonParseError parseError;
+    QJsonDocument document = QJsonDocument::fromJson(configData, &parseError);
+    if (document.isNull())
+    {
+        errorOut = parseError.errorString() + " at offset " + QString::number(parseError.offset);
+        return false;
+    }
+
+    app_config config;
+    QJsonArray entries;
+    if (document.isArray())
+    {
+        entries = document.array();
+    }
+    else
+    {
+        QJsonObject root = document.object();
+        QJsonValue shortcuts = root.value("shortcuts");
+        if (!shortcuts.isArray())
+        {
+            errorOut = "top level is neither an array nor an object with a \"shortcuts\" array";
+            return false;
+        }
+        entries = shortcuts.toArray();
+        QJsonValue typing = root.value("typing");
+        if (!typing.isUndefined())
+        {
+            text_injection_settings settings;
+            if (!read_typing(typing, settings))
+            {
+                errorOut = "\"typing\" has a missing or mistyped field";
+                return false;
+            }
+            config.set_typing(settings);
+        }
+    }
+
+    for (qsizetype i = 0; i < entries.size(); i++)
+    {
+        QJsonValue entry = entries[i];
+        if (!entry.isObject())
+        {
+            errorOut = "entry " + QString::number(i) + " is not an object";
+            return false;
+        }
+        QJsonObject obj = entry.toObject();
+        QJsonValue displayName = obj.value("displayName");
+        QJsonValue above = obj.value("above");
+        QJsonValue snippet = obj.value("snippet");
+        if (snippet.isString())
+        {
+            if (!displayName.isString() || !above.isBool())
+            {
+                errorOut = "entry " + QString::number(i) + " has a missing or mistyped field";
+                return false;
+            }
+            config.add_shortcut({ displayName.toString().toStdWString(), L"", L"", L"", L"", L"", above.toBool(),
+                                  snippet.toString().toStdWString() });
+            continue;
+        }
+        QJsonValue startExePath = obj.value("startExePath");
+        QJsonValue startParams = obj.value("startParams");
+        QJsonValue startWorkingDir = obj.value("startWorkingDir");
+        QJsonValue checkExeName = obj.value("checkExeName");
+        QJsonValue checkTitleName = obj.value("checkTitleName");
+        // A missing field comes back as Undefined, which fails these checks too.
+        if (!displayName.isString() ||
+            !startExePath.isString() ||
+            !startParams.isString() ||
+            !startWorkingDir.isString() ||
+            !checkExeName.isString() ||
+            !checkTitleName.isString() ||
+            !above.isBool() ||
+            !snippet.isUndefined())
+        {
+            errorOut = "entry " + QString::number(i) + " has a missing or mistyped field";
+            return false;
+        }
+        config.add_shortcut({ displayName.toString().toStdWString(),
+                              startExePath.toString().toStdWString(),
+                              startParams.toString().toStdWString(),
+                              startWorkingDir.toString().toStdWString(),
+                              checkExeName.toString().toStdWString(),
+                              checkTitleName.toString().toStdWString(),
+                              above.toBool(),
+                              L"" });
+    }
+    configOut = std::move(config);
+    return true;
+}
+
+// --- read_typing(): Reads the "typing" settings, both fields are optional and keep their default when left out.
+// ----- value: The "typing" value from the config file.
+// ----- settingsOut: Receives the settings.
+// ------- returns: False if it is not an object or a field is not a non-negative number.
+// --------------------------------------------------------------------------------------------/
+/* private */ bool app_config_loader::read_typing(const QJsonValue& value, text_injection_settings& settingsOut)
+{
+    if (!value.isObject())
+    {
+        return false;
+    }
+    QJsonObject obj = value.toObject();
+    QJsonValue charsPerBatch = obj.value("charsPerBatch");
+    QJsonValue batchPauseMs = obj.value("batchPauseMs");
+    if ((!charsPerBatch.isUndefined() && (!charsPerBatch.isDouble() || charsPerBatch.toDouble() < 0.0)) ||
+        (!batchPauseMs.isUndefined() && (!batchPauseMs.isDouble() || batchPauseMs.toDouble() < 0.0)))
+    {
+        return false;
+    }
+    if (!charsPerBatch.isUndefined())
+    {
+        settingsOut.charsPerBatch = static_cast<uint32_t>(charsPerBatch.toInteger());
+    }
+    if (!batchPauseMs.isUndefined())
+    {
+        settingsOut.batchPauseNs = static_cast<int64_t>(batchPauseMs.toDouble() * 1e6);
+    }
+    return true;
+}
@@ -0,0 +1,45 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef APP_CONFIG_LOADER_H
+#define APP_CONFIG_LOADER_H
+
+// 1. Qt framework headers
+#include <QString>
+// 2. System/OS headers
+// 3. C++ standard library headers
+// 4. Project classes
+#include "app_config.h"
+// 5. Forward decl
+class QJsonValue;
+
+// Reads ~/xti.json into an app_config. Only touches its arguments, so it can run on any thread.
+class app_config_loader // static members only
+{
+public:
+    // public get_path(): Gets the full path of the config file.
+    static QString get_path();
+
+    // public load(): Reads and validates a config file.
+    // see cpp file for more info.
+    static bool load(const QString& path, app_config& configOut, QString& errorOut);
+
+private:
+    // private read_typing(): Reads the "typing" settings.
+    // see cpp file for more info.
+    static bool read_typing(const QJsonValue& value, text_injection_settings& settingsOut);
+};
+
+#endif // APP_CONFIG_LOADER_H
@@ -0,0 +1,208 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "app_launcher.h"
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+// 4. Project classes
+#include "windows_subsystem.h"
+#include "error_reporter.h"
+
+/* public */ app_launcher::app_launcher(const window_registry* registry)
+    : m_registry(registry)
+{
+    activeLauncher = this;
+}
+
+/* public */ app_launcher::~app_launcher()
+{
+    if (m_timer != 0)
+    {
+        ::KillTimer(nullptr, m_timer);
+    }
+    for (size_t i = 0; i < m_pending.size(); i++)
+    {
+        if (m_pending[i].process != nullptr)
+        {
+            ::CloseHandle(m_pending[i].process);
+        }
+    }
+    activeLauncher = nullptr;
+}
+
+/* public */ void app_launcher::set_callback(launch_callback callback, void* context)
+{
+    m_callback = callback;
+    m_callbackContext = context;
+}
+
+/* public */ void app_launcher::set_placer(place_function placer, void* context)
+{
+    m_placer = placer;
+    m_placerContext = context;
+}
+
+// --- track(): Starts waiting for the window of a process that was just launched.
+// ----- process: Handle to the launched process, owned by app_launcher from here on. nullptr if there is none.
+// ----- exeNameUpper: The running exe name the window should belong to, UPPERCASE.
+// ----- titleContains: Text the window title should contain, empty for any.
+// ----- above: True to place it above the xti keyboard, false for below.
+// ----- dimensions: Where windows should be placed in the desktop.
+// --------------------------------------------------------------------------------------------/
+/* public */ void app_launcher::track(::HANDLE process, const std::wstring& exeNameUpper, const std::wstring& titleContains,
+                                      bool above, const app_dimensions& dimensions)
+{
+    m_pending.push_back({ process, exeNameUpper, titleContains, above, dimensions, ::GetTickCount64() });
+    if (m_timer == 0)
+    {
+        m_timer = ::SetTimer(nullptr, 0, retryIntervalMs, timer_proc);
+        if (m_timer == 0)
+        {
+            error_reporter::stop(__FILE__, __LINE__, "Win32::SetTimer() failure.");
+        }
+    }
+    // The window may already be there, e.g. the launch was handed to a running instance.
+    try_place_all();
+}
+
+/* public */ void app_launcher::on_window_created([[maybe_unused]] const window_info& info)
+{
+    try_place_all();
+}
+
+/* public */ void app_launcher::on_window_destroyed([[maybe_unused]] window_id id)
+{
+}
+
+/* public */ void app_launcher::on_window_renamed([[maybe_unused]] window_id id, [[maybe_unused]] const std::wstring& title)
+{
+    try_place_all();
+}
+
+/* public */ void app_launcher::on_window_visibility([[maybe_unused]] window_id id, bool visible)
+{
+    if (visible)
+    {
+        try_place_all();
+    }
+}
+
+/* public */ void app_launcher::on_foreground_changed([[maybe_unused]] window_id id)
+{
+}
+
+/* private */ app_launcher* app_launcher::activeLauncher = nullptr;
+
+/* private */ void app_launcher::try_place_all()
+{
+    if (m_pending.empty())
+    {
+        return;
+    }
+    uint64_t nowMs = ::GetTickCount64();
+    for (size_t i = 0; i < m_pending.size();)
+    {
+        if (try_place(m_pending[i], nowMs))
+        {
+            finish(m_pending[i], true, nowMs);
+            m_pending.erase(m_pending.begin() + i);
+        }
+        else if (nowMs - m_pending[i].startedMs >= timeoutMs)
+        {
+            finish(m_pending[i], false, nowMs);
+            m_pending.erase(m_pending.begin() + i);
+        }
+        else
+        {
+            i++;
+        }
+    }
+    if (m_pending.empty() && m_timer != 0)
+    {
+        ::KillTimer(nullptr, m_timer);
+        m_timer = 0;
+    }
+}
+
+/* private */ bool app_launcher::try_place(const pending_launch& launch, uint64_t nowMs)
+{
+    window_id found = 0;
+    if (!launch.titleContains.empty())
+    {
+        found = m_registry->find(launch.exeNameUpper, launch.titleContains);
+    }
+    // Without a title match, settle for any window of the exe only on the last attempt,
+    // otherwise a splash screen or an unrelated window of the same app would be taken.
+    if (found == 0 && (launch.titleContains.empty() || nowMs - launch.startedMs >= timeoutMs))
+    {
+        found = m_registry->find(launch.exeNameUpper, L"");
+    }
+    if (found == 0)
+    {
+        return false;
+    }
+    ::HWND window = reinterpret_cast<::HWND>(found);
+    // Apps that are still initializing often move their own window afterwards, so wait until the process
+    // that owns the window is ready for input. Only possible when it's the process that was launched.
+    if (launch.process != nullptr && m_registry->get(found)->processId == ::GetProcessId(launch.process))
+    {
+        uint32_t r = ::WaitForInputIdle(launch.process, 0);
+        if (r == WAIT_TIMEOUT && nowMs - launch.startedMs < timeoutMs)
+        {
+            return false;
+        }
+        // WAIT_FAILED here means the process has no message queue (e.g. a console app), nothing to wait for.
+    }
+    if (m_placer != nullptr)
+    {
+        m_placer(m_placerContext, window, launch.above, launch.dimensions);
+    }
+    else
+    {
+        windows_subsystem::move_window(window, launch.above, launch.dimensions);
+    }
+    return true;
+}
+
+/* private */ void app_launcher::finish(const pending_launch& launch, bool placed, uint64_t nowMs)
+{
+    if (launch.process != nullptr)
+    {
+        int32_t r = ::CloseHandle(launch.process);
+        if (r == 0)
+        {
+            error_reporter::stop(__FILE__, __LINE__, "Win32::CloseHandle() failure.");
+        }
+    }
+    if (m_callback != nullptr)
+    {
+        launch_result result;
+        result.exeNameUpper = launch.exeNameUpper;
+        result.placed = placed;
+        result.latencyMs = nowMs - launch.startedMs;
+        m_callback(m_callbackContext, result);
+    }
+}
+
+/* private */ void __stdcall app_launcher::timer_proc([[maybe_unused]] ::HWND window, [[maybe_unused]] ::UINT message,
+                                                     [[maybe_unused]] ::UINT_PTR timerId, [[maybe_unused]] ::DWORD time)
+{
+    if (activeLauncher != nullptr)
+    {
+        activeLauncher->try_place_all();
+    }
+}
@@ -0,0 +1,98 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef APP_LAUNCHER_H
+#define APP_LAUNCHER_H
+
+// 1. Qt framework headers
+// 2. System/OS headers
+#include <Windows.h>
+// 3. C++ standard library headers
+#include <cstdint>
+#include <string>
+#include <vector>
+// 4. Project classes
+#include "app_dimensions.h"
+#include "window_registry.h"
+// 5. Forward decl
+
+struct launch_result
+{
+    std::wstring exeNameUpper;
+    bool placed; // false if no window turned up before the timeout
+    uint64_t latencyMs; // launch to placed (or to giving up)
+};
+
+// Places the windows of launched apps as soon as they appear, without blocking the UI thread.
+// Watches the window_registry (as its observer) for a matching window, and retries on a short Win32 timer while
+// the app is still starting up (not input-idle) or while nothing has turned up yet. Gives up after timeoutMs.
+// UI thread only.
+class app_launcher : public window_event_sink
+{
+public:
+    static constexpr uint32_t timeoutMs = 10000;
+    static constexpr uint32_t retryIntervalMs = 100;
+    typedef void (*launch_callback)(void* context, const launch_result& result);
+    typedef void (*place_function)(void* context, ::HWND window, bool above, const app_dimensions& dimensions);
+
+    explicit app_launcher(const window_registry* registry);
+    virtual ~app_launcher();
+    app_launcher(const app_launcher&) = delete;
+    app_launcher& operator=(const app_launcher&) = delete;
+
+    // public set_callback(): Called once per launch when it's placed or has timed out.
+    void set_callback(launch_callback callback, void* context);
+
+    // public set_placer(): Replaces the direct windows_subsystem::move_window() call, nullptr to go back to it.
+    void set_placer(place_function placer, void* context);
+
+    // public track(): Starts waiting for the window of a process that was just launched.
+    // see cpp file for more info.
+    void track(::HANDLE process, const std::wstring& exeNameUpper, const std::wstring& titleContains,
+               bool above, const app_dimensions& dimensions);
+
+    virtual void on_window_created(const window_info& info) override;
+    virtual void on_window_destroyed(window_id id) override;
+    virtual void on_window_renamed(window_id id, const std::wstring& title) override;
+    virtual void on_window_visibility(window_id id, bool visible) override;
+    virtual void on_foreground_changed(window_id id) override;
+
+private:
+    struct pending_launch
+    {
+        ::HANDLE process; // can be nullptr, e.g. when the shell handed the launch to an already running instance
+        std::wstring exeNameUpper;
+        std::wstring titleContains;
+        bool above;
+        app_dimensions dimensions;
+        uint64_t startedMs;
+    };
+
+    static app_launcher* activeLauncher;
+    const window_registry* m_registry;
+    std::vector<pending_launch> m_pending;
+    ::UINT_PTR m_timer = 0;
+    launch_callback m_callback = nullptr;
+    void* m_callbackContext = nullptr;
+    place_function m_placer = nullptr;
+    void* m_placerContext = nullptr;
+
+    void try_place_all();
+    bool try_place(const pending_launch& launch, uint64_t nowMs);
+    void finish(const pending_launch& launch, bool placed, uint64_t nowMs);
+    static void __stdcall timer_proc(::HWND window, ::UINT message, ::UINT_PTR timerId, ::DWORD time);
+};
+
+#endif // APP_LAUNCHER_H
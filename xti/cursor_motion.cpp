@@ -0,0 +1,74 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "cursor_motion.h"
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <cmath>
+#include <cstdio>
+// 4. Project classes
+
+// --- add_sample(): Adds the motion of one touch sample.
+// ----- dx: Horizontal motion in cursor pixels, may be fractional.
+// ----- dy: Vertical motion in cursor pixels, may be fractional.
+// --------------------------------------------------------------------------------------------/
+/* public */ void cursor_motion::add_sample(double dx, double dy)
+{
+    m_pendingX += dx;
+    m_pendingY += dy;
+    m_stats.samplesIn++;
+}
+
+// --- take_move(): Takes the whole pixels collected since the last move, the fractional part stays pending.
+// ----- dx: Receives the horizontal move.
+// ----- dy: Receives the vertical move.
+// ------- returns: true if there is anything to move, false if both are 0 (nothing needs to be injected).
+// --------------------------------------------------------------------------------------------/
+/* public */ bool cursor_motion::take_move(int32_t& dx, int32_t& dy)
+{
+    // Truncate towards zero so the remainder keeps the sign of the motion it came from.
+    double wholeX = std::trunc(m_pendingX);
+    double wholeY = std::trunc(m_pendingY);
+    dx = static_cast<int32_t>(wholeX);
+    dy = static_cast<int32_t>(wholeY);
+    if (dx == 0 && dy == 0)
+    {
+        return false;
+    }
+    m_pendingX -= wholeX;
+    m_pendingY -= wholeY;
+    m_stats.movesOut++;
+    return true;
+}
+
+/* public */ void cursor_motion::reset()
+{
+    m_pendingX = 0.0;
+    m_pendingY = 0.0;
+    m_stats.strokes++;
+}
+
+/* public */ std::string cursor_motion::dump() const
+{
+    // Samples per move shows how much coalescing to the display refresh saves the injection path.
+    double perMove = m_stats.movesOut == 0 ? 0.0 : static_cast<double>(m_stats.samplesIn) / static_cast<double>(m_stats.movesOut);
+    char line[160];
+    std::snprintf(line, sizeof(line), "touchpad motion: %llu strokes, %llu samples in, %llu moves out, %.1f samples per move\n",
+        static_cast<unsigned long long>(m_stats.strokes), static_cast<unsigned long long>(m_stats.samplesIn),
+        static_cast<unsigned long long>(m_stats.movesOut), perMove);
+    return line;
+}
@@ -0,0 +1,61 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef CURSOR_MOTION_H
+#define CURSOR_MOTION_H
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <cstdint>
+#include <string>
+// 4. Project classes
+// 5. Forward decl
+
+struct cursor_motion_stats
+{
+    uint64_t strokes; // touchpad strokes started, see reset()
+    uint64_t samplesIn; // touch samples added
+    uint64_t movesOut; // relative moves handed out for injection
+};
+
+// Collects touchpad motion between display refreshes.
+// Touch samples can arrive far faster than the screen can show a cursor move, so they are summed here
+// and handed out as a single relative move per refresh. Fractions of a pixel are kept for the next move.
+class cursor_motion
+{
+public:
+    // public add_sample(): Adds the motion of one touch sample, in cursor pixels.
+    void add_sample(double dx, double dy);
+
+    // public take_move(): Takes the whole pixels collected since the last move.
+    // see cpp file for more info.
+    bool take_move(int32_t& dx, int32_t& dy);
+
+    // public reset(): Drops any pending motion when a new touchpad stroke starts.
+    void reset();
+
+    cursor_motion_stats get_stats() const { return m_stats; }
+
+    // public dump(): Formats the stats as one line of text.
+    std::string dump() const;
+
+private:
+    double m_pendingX = 0.0;
+    double m_pendingY = 0.0;
+    cursor_motion_stats m_stats = {};
+};
+
+#endif // CURSOR_MOTION_H
@@ -0,0 +1,193 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "hit_index.h"
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <algorithm>
+#include <limits>
+// 4. Project classes
+
+// --- rebuild(): Replaces the indexed rectangles.
+// ----- rects: Rectangles to index. Their position in this array is the index hit_test() returns.
+// ----- count: Number of entries in rects.
+// --------------------------------------------------------------------------------------------/
+/* public */ void hit_index::rebuild(const hit_rect* rects, uint32_t count)
+{
+    m_left.resize(count);
+    m_top.resize(count);
+    m_right.resize(count);
+    m_bottom.resize(count);
+    m_cellStart.clear();
+    m_cellItems.clear();
+    m_columns = 0;
+    m_rows = 0;
+    if (count == 0)
+    {
+        return;
+    }
+
+    int32_t minX = std::numeric_limits<int32_t>::max();
+    int32_t minY = std::numeric_limits<int32_t>::max();
+    int32_t maxX = std::numeric_limits<int32_t>::min();
+    int32_t maxY = std::numeric_limits<int32_t>::min();
+    for (uint32_t i = 0; i < count; i++)
+    {
+        m_left[i] = rects[i].left;
+        m_top[i] = rects[i].top;
+        m_right[i] = rects[i].right;
+        m_bottom[i] = rects[i].bottom;
+        minX = std::min(minX, rects[i].left);
+        minY = std::min(minY, rects[i].top);
+        maxX = std::max(maxX, rects[i].right);
+        maxY = std::max(maxY, rects[i].bottom);
+    }
+    m_originX = minX;
+    m_originY = minY;
+    m_columns = (maxX - minX + cellSize - 1) / cellSize;
+    m_rows = (maxY - minY + cellSize - 1) / cellSize;
+    if (m_columns <= 0 || m_rows <= 0)
+    {
+        m_columns = 0;
+        m_rows = 0;
+        return;
+    }
+
+    // Two passes (count then fill) so every cell's items end up contiguous in one array.
+    m_cellStart.assign(static_cast<size_t>(m_columns) * m_rows + 1, 0);
+    for (int32_t pass = 0; pass < 2; pass++)
+    {
+        std::vector<uint32_t> cursor;
+        if (pass == 1)
+        {
+            for (size_t c = 1; c < m_cellStart.size(); c++)
+            {
+                m_cellStart[c] += m_cellStart[c - 1];
+            }
+            m_cellItems.resize(m_cellStart.back());
+            cursor.assign(m_cellStart.begin(), m_cellStart.end() - 1);
+        }
+        for (uint32_t i = 0; i < count; i++)
+        {
+            if (m_right[i] <= m_left[i] || m_bottom[i] <= m_top[i])
+            {
+                continue; // hidden or collapsed widget
+            }
+            int32_t firstColumn = (m_left[i] - m_originX) / cellSize;
+            int32_t lastColumn = (m_right[i] - 1 - m_originX) / cellSize;
+            int32_t firstRow = (m_top[i] - m_originY) / cellSize;
+            int32_t lastRow = (m_bottom[i] - 1 - m_originY) / cellSize;
+            for (int32_t row = firstRow; row <= lastRow; row++)
+            {
+                for (int32_t column = firstColumn; column <= lastColumn; column++)
+                {
+                    int32_t cell = cell_of(column, row);
+                    if (pass == 0)
+                    {
+                        m_cellStart[cell + 1]++;
+                    }
+                    else
+                    {
+                        m_cellItems[cursor[cell]++] = static_cast<uint16_t>(i);
+                    }
+                }
+            }
+        }
+    }
+}
+
+// --- hit_test(): Finds the rectangle under a point.
+// ----- x, y: The point, in the same coordinate space as the indexed rectangles.
+// ----- snapToNearest: When the point lands in a gap between rectangles, resolve it to the rectangle
+// ------------------- with the nearest centre (within a few pixels) instead of returning nothing.
+// ------- returns: Index of the rectangle as passed to rebuild(), or -1 if none.
+// --------------------------------------------------------------------------------------------/
+/* public */ int32_t hit_index::hit_test(int32_t x, int32_t y, bool snapToNearest) const
+{
+    if (m_columns == 0)
+    {
+        return -1;
+    }
+    int32_t localX = x - m_originX;
+    int32_t localY = y - m_originY;
+    int32_t column = localX >= 0 ? localX / cellSize : -1;
+    int32_t row = localY >= 0 ? localY / cellSize : -1;
+    if (column >= 0 && column < m_columns && row >= 0 && row < m_rows)
+    {
+        int32_t cell = cell_of(column, row);
+        for (uint32_t j = m_cellStart[cell]; j < m_cellStart[cell + 1]; j++)
+        {
+            uint16_t i = m_cellItems[j];
+            if (m_left[i] <= x && m_top[i] <= y && m_right[i] > x && m_bottom[i] > y)
+            {
+                return i;
+            }
+        }
+    }
+    if (!snapToNearest)
+    {
+        return -1;
+    }
+
+    // The snap radius is smaller than a cell, so only the surrounding 3x3 cells can hold a candidate.
+    int32_t best = -1;
+    int64_t bestDistance = std::numeric_limits<int64_t>::max();
+    for (int32_t r = row - 1; r <= row + 1; r++)
+    {
+        if (r < 0 || r >= m_rows)
+        {
+            continue;
+        }
+        for (int32_t c = column - 1; c <= column + 1; c++)
+        {
+            if (c < 0 || c >= m_columns)
+            {
+                continue;
+            }
+            int32_t cell = cell_of(c, r);
+            for (uint32_t j = m_cellStart[cell]; j < m_cellStart[cell + 1]; j++)
+            {
+                uint16_t i = m_cellItems[j];
+                int32_t outsideX = std::max({ m_left[i] - x, 0, x - (m_right[i] - 1) });
+                int32_t outsideY = std::max({ m_top[i] - y, 0, y - (m_bottom[i] - 1) });
+                if (outsideX > snapRadius || outsideY > snapRadius)
+                {
+                    continue;
+                }
+                // Compare doubled centres to stay in integers.
+                int64_t dx = static_cast<int64_t>(m_left[i]) + m_right[i] - 2 * static_cast<int64_t>(x);
+                int64_t dy = static_cast<int64_t>(m_top[i]) + m_bottom[i] - 2 * static_cast<int64_t>(y);
+                int64_t distance = dx * dx + dy * dy;
+                if (distance < bestDistance)
+                {
+                    bestDistance = distance;
+                    best = i;
+                }
+            }
+        }
+    }
+    return best;
+}
+
+/* public */ bool hit_index::contains(int32_t index, int32_t x, int32_t y) const
+{
+    if (index < 0 || static_cast<uint32_t>(index) >= m_left.size())
+    {
+        return false;
+    }
+    return m_left[index] <= x && m_top[index] <= y && m_right[index] > x && m_bottom[index] > y;
+}
@@ -0,0 +1,82 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef HIT_INDEX_H
+#define HIT_INDEX_H
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <cstdint>
+#include <vector>
+// 4. Project classes
+// 5. Forward decl
+
+// Axis aligned rectangle, right and bottom are exclusive.
+struct hit_rect
+{
+    int32_t left;
+    int32_t top;
+    int32_t right;
+    int32_t bottom;
+
+    bool contains(int32_t x, int32_t y) const
+    {
+        return left <= x && top <= y && right > x && bottom > y;
+    }
+};
+
+// Frozen copy of the push button geometry, bucketed into a uniform grid so a touch point
+// only has to be tested against the few rectangles sharing its grid cell.
+// Rebuild whenever the widget geometry changes, lookups never touch the widgets themselves.
+class hit_index
+{
+public:
+    // public rebuild(): Replaces the indexed rectangles.
+    // see cpp file for more info.
+    void rebuild(const hit_rect* rects, uint32_t count);
+
+    // public hit_test(): Finds the rectangle under a point.
+    // see cpp file for more info.
+    int32_t hit_test(int32_t x, int32_t y, bool snapToNearest) const;
+
+    // public contains(): Tests a point against one indexed rectangle.
+    bool contains(int32_t index, int32_t x, int32_t y) const;
+
+    uint32_t size() const { return static_cast<uint32_t>(m_left.size()); }
+
+private:
+    static constexpr int32_t cellSize = 32;
+    // How far outside a rectangle a touch can land and still snap to it, about the widest gap between keys.
+    static constexpr int32_t snapRadius = 12;
+
+    // Structure of arrays, one entry per rectangle.
+    std::vector<int32_t> m_left;
+    std::vector<int32_t> m_top;
+    std::vector<int32_t> m_right;
+    std::vector<int32_t> m_bottom;
+
+    int32_t m_originX = 0;
+    int32_t m_originY = 0;
+    int32_t m_columns = 0;
+    int32_t m_rows = 0;
+    // Cell c owns m_cellItems[m_cellStart[c] .. m_cellStart[c + 1]).
+    std::vector<uint32_t> m_cellStart;
+    std::vector<uint16_t> m_cellItems;
+
+    int32_t cell_of(int32_t column, int32_t row) const { return row * m_columns + column; }
+};
+
+#endif // HIT_INDEX_H
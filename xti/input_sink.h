@@ -0,0 +1,58 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef INPUT_SINK_H
+#define INPUT_SINK_H
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <cstdint>
+// 4. Project classes
+#include "key_chord.h"
+// 5. Forward decl
+
+// A single mouse button change, relative move and/or wheel turn to be injected.
+struct mouse_stroke
+{
+    static constexpr uint16_t flagLeftDown = 0x0001;
+    static constexpr uint16_t flagLeftUp = 0x0002;
+    static constexpr uint16_t flagRightDown = 0x0004;
+    static constexpr uint16_t flagRightUp = 0x0008;
+    static constexpr uint16_t flagMove = 0x0010; // dx and dy are valid
+    static constexpr uint16_t flagWheel = 0x0020; // wheel is valid
+
+    uint16_t flags;
+    int32_t dx; // relative pixels, only with flagMove
+    int32_t dy;
+    int32_t wheel; // vertical wheel in 1/120ths of a notch (WHEEL_DELTA), positive away from the user, only with flagWheel
+};
+
+// Destination for all synthesized input. The Win32 implementation lives in windows_input_sink,
+// other implementations can record or count what would have been injected.
+class input_sink
+{
+public:
+    virtual ~input_sink() = default;
+
+    // public send_keys(): Injects the strokes in order as a single batch.
+    // returns the number of strokes actually injected, callers must treat anything less than count as a failure.
+    virtual uint32_t send_keys(const key_stroke* strokes, uint32_t count) = 0;
+
+    // public send_mouse(): Same as send_keys() but for mouse events.
+    virtual uint32_t send_mouse(const mouse_stroke* strokes, uint32_t count) = 0;
+};
+
+#endif // INPUT_SINK_H
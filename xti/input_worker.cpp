@@ -0,0 +1,153 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "input_worker.h"
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+// 4. Project classes
+
+input_worker::input_worker(input_sink* sink, latency_recorder* latency)
+    : m_sink(sink)
+    , m_latency(latency)
+{
+    m_thread = std::thread(&input_worker::run, this);
+}
+
+input_worker::~input_worker()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_stopping = true;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+}
+
+// --- post_mouse(): Queues a mouse event for injection.
+// A full queue means the worker is behind, so the UI thread waits for room (back-pressure) rather than dropping
+// a click or a move. Only a queue that stays full for maxStallNs is treated as the worker having hung.
+// ----- stroke: The mouse event to inject.
+// ----- kind: Which latency histograms the event is recorded into once injected.
+// ----- mark: Checkpoints taken on the UI thread so far, the worker adds the injection itself.
+// ------- returns: false if the worker has stalled and the event was not queued.
+// --------------------------------------------------------------------------------------------/
+/* public */ bool input_worker::post_mouse(const mouse_stroke& stroke, latency_kind kind, const latency_mark& mark)
+{
+    queued_mouse item = { stroke, now_ns(), kind, mark };
+    if (!m_queue.try_push(item))
+    {
+        // The worker cannot be asleep on a non-empty queue, it is injecting and will make room.
+        m_backPressureWaits.fetch_add(1, std::memory_order_relaxed);
+        while (!m_queue.try_push(item))
+        {
+            if (now_ns() - item.enqueuedAtNs > maxStallNs)
+            {
+                return false;
+            }
+            std::this_thread::yield();
+        }
+    }
+    uint32_t depth = m_queue.size();
+    if (depth > m_maxQueueDepth.load(std::memory_order_relaxed))
+    {
+        m_maxQueueDepth.store(depth, std::memory_order_relaxed);
+    }
+    // Pairs with the fence in run(): either the worker sees this push before it sleeps, or this sees it sleeping.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_sleeping.load(std::memory_order_relaxed))
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_wake.notify_one();
+    }
+    return true;
+}
+
+/* public */ bool input_worker::has_failed() const
+{
+    return m_failed.load(std::memory_order_acquire);
+}
+
+/* public */ input_worker_stats input_worker::get_stats() const
+{
+    input_worker_stats stats;
+    stats.queueDepth = m_queue.size();
+    stats.maxQueueDepth = m_maxQueueDepth.load(std::memory_order_relaxed);
+    stats.drainedEvents = m_drainedEvents.load(std::memory_order_relaxed);
+    stats.drainedBatches = m_drainedBatches.load(std::memory_order_relaxed);
+    stats.lastDrainLatencyUs = m_lastDrainLatencyUs.load(std::memory_order_relaxed);
+    stats.maxDrainLatencyUs = m_maxDrainLatencyUs.load(std::memory_order_relaxed);
+    stats.backPressureWaits = m_backPressureWaits.load(std::memory_order_relaxed);
+    return stats;
+}
+
+/* private */ void input_worker::run()
+{
+    queued_mouse batch[queueCapacity];
+    mouse_stroke strokes[queueCapacity];
+    while (true)
+    {
+        // Everything queued so far goes to the OS in one call, oldest first.
+        uint32_t count = m_queue.pop_batch(batch, queueCapacity);
+        if (count == 0)
+        {
+            // The mutex is held from announcing the sleep until the wait releases it, so a post that sees
+            // m_sleeping cannot notify before the worker is waiting.
+            std::unique_lock<std::mutex> lock(m_wakeMutex);
+            m_sleeping.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            m_wake.wait(lock, [this]() { return m_stopping || !m_queue.empty(); });
+            m_sleeping.store(false, std::memory_order_relaxed);
+            if (m_stopping && m_queue.empty())
+            {
+                return;
+            }
+            continue;
+        }
+        for (uint32_t i = 0; i < count; i++)
+        {
+            strokes[i] = batch[i].stroke;
+        }
+        int64_t injectStartNs = now_ns();
+        uint32_t sent = m_sink->send_mouse(strokes, count);
+        int64_t injectEndNs = now_ns();
+        if (sent != count)
+        {
+            m_failed.store(true, std::memory_order_release);
+        }
+        else if (m_latency != nullptr)
+        {
+            for (uint32_t i = 0; i < count; i++)
+            {
+                m_latency->record(batch[i].kind, batch[i].mark, injectStartNs, injectEndNs);
+            }
+        }
+        uint64_t latencyUs = static_cast<uint64_t>((injectEndNs - batch[0].enqueuedAtNs) / 1000);
+        m_lastDrainLatencyUs.store(latencyUs, std::memory_order_relaxed);
+        if (latencyUs > m_maxDrainLatencyUs.load(std::memory_order_relaxed))
+        {
+            m_maxDrainLatencyUs.store(latencyUs, std::memory_order_relaxed);
+        }
+        m_drainedEvents.fetch_add(count, std::memory_order_relaxed);
+        m_drainedBatches.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+/* private */ int64_t input_worker::now_ns()
+{
+    // Same clock as latency_recorder, so checkpoints taken on the UI thread line up with the ones taken here.
+    return latency_recorder::now_ns();
+}
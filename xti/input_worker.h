@@ -0,0 +1,98 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef INPUT_WORKER_H
+#define INPUT_WORKER_H
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+// 4. Project classes
+#include "input_sink.h"
+#include "latency_recorder.h"
+#include "spsc_ring.h"
+// 5. Forward decl
+
+struct input_worker_stats
+{
+    uint32_t queueDepth; // events waiting right now
+    uint32_t maxQueueDepth; // most events ever waiting at once
+    uint64_t drainedEvents;
+    uint64_t drainedBatches;
+    uint64_t lastDrainLatencyUs; // time the oldest event of the last batch spent queued until injected
+    uint64_t maxDrainLatencyUs;
+    uint64_t backPressureWaits; // posts that found the queue full and waited for the worker to make room
+};
+
+// Long lived thread that injects mouse events on behalf of the UI thread, in the order they were posted.
+// Only one thread (the UI thread) may post. Posting is lock-free while the worker is awake, the wake mutex is
+// only taken to wake a worker that has gone to sleep on an empty queue.
+class input_worker
+{
+public:
+    // latency may be nullptr, otherwise every posted event is recorded into it from the worker thread.
+    input_worker(input_sink* sink, latency_recorder* latency);
+    ~input_worker();
+    input_worker(const input_worker&) = delete;
+    input_worker& operator=(const input_worker&) = delete;
+
+    // public post_mouse(): Queues a mouse event for injection.
+    // see cpp file for more info.
+    bool post_mouse(const mouse_stroke& stroke, latency_kind kind, const latency_mark& mark);
+
+    // public has_failed(): True once the sink has rejected an event. The worker never throws or reports errors itself,
+    // so callers on the UI thread are expected to poll this and report it.
+    bool has_failed() const;
+
+    // public get_stats(): Gets a snapshot of the queue-depth and drain-latency counters.
+    input_worker_stats get_stats() const;
+
+private:
+    static constexpr uint32_t queueCapacity = 256;
+    static constexpr int64_t maxStallNs = 500000000; // a full queue that does not move for this long is a hung sink
+    struct queued_mouse
+    {
+        mouse_stroke stroke;
+        int64_t enqueuedAtNs;
+        latency_kind kind;
+        latency_mark mark;
+    };
+
+    input_sink* m_sink;
+    latency_recorder* m_latency;
+    spsc_ring<queued_mouse, queueCapacity> m_queue;
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;
+    bool m_stopping = false; // guarded by m_wakeMutex
+    std::atomic<bool> m_sleeping { false }; // worker is (about to be) waiting on m_wake, see post_mouse()
+    std::atomic<bool> m_failed { false };
+    std::atomic<uint32_t> m_maxQueueDepth { 0 };
+    std::atomic<uint64_t> m_drainedEvents { 0 };
+    std::atomic<uint64_t> m_drainedBatches { 0 };
+    std::atomic<uint64_t> m_lastDrainLatencyUs { 0 };
+    std::atomic<uint64_t> m_maxDrainLatencyUs { 0 };
+    std::atomic<uint64_t> m_backPressureWaits { 0 };
+    std::thread m_thread;
+
+    void run();
+    static int64_t now_ns();
+};
+
+#endif // INPUT_WORKER_H
@@ -0,0 +1,96 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "key_chord.h"
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+// 4. Project classes
+
+// --- build_press(): Builds a full press and release of a key, wrapped in the requested modifiers.
+// Control and alt together are how AltGr characters are typed, Windows treats them the same as AltGr.
+// ----- virtualKeyCode: The key to press and release.
+// ----- scanCode: The key's scan code on the active layout, 0 if unknown.
+// ----- shift: True to hold LSHIFT around the key.
+// ----- control: True to hold LCONTROL around the key.
+// ----- alt: True to hold LMENU around the key.
+// ----- extended: True if the key is in the extended set, see is_extended_key().
+// ------- returns: The ordered strokes, between 2 and 8 of them.
+// --------------------------------------------------------------------------------------------/
+/* public */ key_chord key_chord_builder::build_press(uint16_t virtualKeyCode, uint16_t scanCode, bool shift, bool control, bool alt, bool extended)
+{
+    key_chord chord = {};
+    uint16_t keyFlags = extended ? key_stroke::flagExtended : 0;
+    if (control)
+    {
+        chord.strokes[chord.count++] = { VK_LCONTROL, 0, scanLeftControl };
+    }
+    if (alt)
+    {
+        chord.strokes[chord.count++] = { VK_LMENU, 0, scanLeftAlt };
+    }
+    if (shift)
+    {
+        chord.strokes[chord.count++] = { VK_LSHIFT, 0, scanLeftShift };
+    }
+    chord.strokes[chord.count++] = { virtualKeyCode, keyFlags, scanCode };
+    chord.strokes[chord.count++] = { virtualKeyCode, static_cast<uint16_t>(key_stroke::flagKeyUp | keyFlags), scanCode };
+    if (shift)
+    {
+        chord.strokes[chord.count++] = { VK_LSHIFT, key_stroke::flagKeyUp, scanLeftShift };
+    }
+    if (alt)
+    {
+        chord.strokes[chord.count++] = { VK_LMENU, key_stroke::flagKeyUp, scanLeftAlt };
+    }
+    if (control)
+    {
+        chord.strokes[chord.count++] = { VK_LCONTROL, key_stroke::flagKeyUp, scanLeftControl };
+    }
+    return chord;
+}
+
+// --- build_toggle(): Builds a single down or up stroke for modifiers that stay held between presses.
+// ----- virtualKeyCode: The modifier key to change.
+// ----- scanCode: The key's scan code on the active layout, 0 if unknown.
+// ----- keyUp: True to release the modifier, false to push it down.
+// ----- extended: True if the key is in the extended set, see is_extended_key().
+// ------- returns: A chord containing exactly one stroke.
+// --------------------------------------------------------------------------------------------/
+/* public */ key_chord key_chord_builder::build_toggle(uint16_t virtualKeyCode, uint16_t scanCode, bool keyUp, bool extended)
+{
+    key_chord chord = {};
+    uint16_t flags = extended ? key_stroke::flagExtended : 0;
+    if (keyUp)
+    {
+        flags |= key_stroke::flagKeyUp;
+    }
+    chord.strokes[chord.count++] = { virtualKeyCode, flags, scanCode };
+    return chord;
+}
+
+// --- build_unicode(): Builds a press and release that types one UTF-16 unit whatever the keyboard layout.
+// Held modifiers do not apply to it, so it is for typing only and never for shortcuts.
+// ----- unit: The UTF-16 unit, a surrogate pair takes two chords back to back.
+// ------- returns: A chord containing exactly two strokes.
+// --------------------------------------------------------------------------------------------/
+/* public */ key_chord key_chord_builder::build_unicode(char16_t unit)
+{
+    key_chord chord = {};
+    chord.strokes[chord.count++] = { static_cast<uint16_t>(unit), key_stroke::flagUnicode, 0 };
+    chord.strokes[chord.count++] = { static_cast<uint16_t>(unit), static_cast<uint16_t>(key_stroke::flagUnicode | key_stroke::flagKeyUp), 0 };
+    return chord;
+}
@@ -0,0 +1,108 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef KEY_CHORD_H
+#define KEY_CHORD_H
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <cstdint>
+// 4. Project classes
+#include "virtual_keys.h"
+// 5. Forward decl
+
+// A single key down or key up to be injected.
+struct key_stroke
+{
+    static constexpr uint16_t flagKeyUp = 0x0001;
+    static constexpr uint16_t flagExtended = 0x0002;
+    static constexpr uint16_t flagUnicode = 0x0004; // virtualKeyCode holds a UTF-16 unit to type, not a key
+
+    uint16_t virtualKeyCode;
+    uint16_t flags;
+    uint16_t scanCode; // set 1 make code without the E0 prefix (see flagExtended), 0 when unknown
+};
+
+// The full, ordered sequence of strokes for one virtual keyboard key press.
+// Submitted to an input_sink as one batch so other input cannot interleave mid-chord.
+struct key_chord
+{
+    // LCONTROL down, LMENU down, LSHIFT down, key down, key up, LSHIFT up, LMENU up, LCONTROL up.
+    static constexpr uint32_t maxStrokes = 8;
+
+    key_stroke strokes[maxStrokes];
+    uint32_t count;
+};
+
+class key_chord_builder // static members only
+{
+public:
+    // Scan codes of the modifiers wrapped around a press, the same on every layout.
+    static constexpr uint16_t scanLeftShift = 0x2A;
+    static constexpr uint16_t scanLeftControl = 0x1D;
+    static constexpr uint16_t scanLeftAlt = 0x38;
+
+    // public build_press(): Builds a full press and release of a key, wrapped in the requested modifiers.
+    // see cpp file for more info.
+    static key_chord build_press(uint16_t virtualKeyCode, uint16_t scanCode, bool shift, bool control, bool alt, bool extended);
+
+    // public build_toggle(): Builds a single down or up stroke for modifiers that stay held between presses.
+    // see cpp file for more info.
+    static key_chord build_toggle(uint16_t virtualKeyCode, uint16_t scanCode, bool keyUp, bool extended);
+
+    // public build_unicode(): Builds a press and release that types one UTF-16 unit whatever the keyboard layout.
+    // see cpp file for more info.
+    static key_chord build_unicode(char16_t unit);
+
+    // public is_extended_key(): Determines if the key needs the extended-key flag when injected.
+    // Evaluated at compile time when building the key_mapping action table.
+    static constexpr bool is_extended_key(uint16_t virtualKeyCode)
+    {
+        // https://learn.microsoft.com/en-us/windows/win32/inputdev/about-keyboard-input go to Extended-key flag
+        // Both the down and the up stroke need the flag, otherwise the OS can see a different key
+        // released to the one that was pressed and leave it stuck down.
+        switch (virtualKeyCode)
+        {
+        case VK_RMENU:
+        case VK_RCONTROL:
+        case VK_RWIN:
+        case VK_APPS:
+        case VK_INSERT:
+        case VK_DELETE:
+        case VK_HOME:
+        case VK_END:
+        case VK_PRIOR:
+        case VK_NEXT:
+        case VK_UP:
+        case VK_DOWN:
+        case VK_LEFT:
+        case VK_RIGHT:
+        case VK_SNAPSHOT:
+        case VK_NUMLOCK:
+        case VK_VOLUME_MUTE:
+        case VK_VOLUME_DOWN:
+        case VK_VOLUME_UP:
+        case VK_MEDIA_NEXT_TRACK:
+        case VK_MEDIA_PREV_TRACK:
+        case VK_MEDIA_PLAY_PAUSE:
+            return true;
+        default:
+            return false;
+        }
+    }
+};
+
+#endif // KEY_CHORD_H
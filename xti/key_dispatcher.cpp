@@ -0,0 +1,108 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "key_dispatcher.h"
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+// 4. Project classes
+#include "latency_recorder.h"
+
+static key_press_outcome send(const key_chord& chord, input_sink& sink)
+{
+    key_press_outcome outcome = {};
+    outcome.chord = chord;
+    outcome.injectStartNs = latency_recorder::now_ns();
+    outcome.sent = sink.send_keys(chord.strokes, chord.count) == chord.count;
+    outcome.injectEndNs = latency_recorder::now_ns();
+    return outcome;
+}
+
+// --- press(): Injects the press of one key.
+// Letter keys are looked up as shortcuts while control, alt or windows is held. Modifiers (control, shift, alt and
+// windows) are toggled using the right-side virtual key codes and stay down between presses, so the rest of the
+// virtual keyboard cannot mess with them. Locks flip. Everything else is one full press in a single batch, so other
+// input cannot land between the modifiers and the key.
+// ----- layout: The active keyboard layout.
+// ----- id: The key pressed.
+// ----- modifiers: xti's modifier state, updated with what was injected.
+// ----- sink: Where the chord is injected.
+// ------- returns: What was injected and whether it changed a modifier or lock.
+// --------------------------------------------------------------------------------------------/
+/* public */ key_press_outcome key_dispatcher::press(const key_layout& layout, key_id id, modifier_state& modifiers, input_sink& sink)
+{
+    const key_modifiers& held = modifiers.get();
+    bool shortcut = held.control || held.alt || held.windows;
+    const key_action& action = layout.get_action(id, shortcut);
+    bool extended = (action.flags & key_action::flagExtended) != 0;
+    if ((action.flags & key_action::flagModifier) != 0)
+    {
+        bool currentlyDown = false;
+        switch (action.virtualKeyCode)
+        {
+        case VK_RCONTROL:
+            currentlyDown = held.control;
+            break;
+        case VK_RSHIFT:
+            currentlyDown = held.shift;
+            break;
+        case VK_RMENU:
+            currentlyDown = held.alt;
+            break;
+        case VK_RWIN:
+            currentlyDown = held.windows;
+            break;
+        }
+        key_press_outcome outcome = send(key_chord_builder::build_toggle(action.virtualKeyCode, action.scanCode, currentlyDown, extended), sink);
+        modifiers.apply_strokes(outcome.chord.strokes, outcome.chord.count);
+        outcome.modChanged = true;
+        outcome.modOn = !currentlyDown;
+        return outcome;
+    }
+    if ((action.flags & key_action::flagUnicode) != 0)
+    {
+        // The layout has no key for this character.
+        return send(key_chord_builder::build_unicode(static_cast<char16_t>(action.virtualKeyCode)), sink);
+    }
+    bool lock = (action.flags & key_action::flagLock) != 0;
+    bool lockOn = false;
+    if (lock)
+    {
+        switch (action.virtualKeyCode)
+        {
+        case VK_CAPITAL:
+            lockOn = !held.capsLock;
+            break;
+        case VK_SCROLL:
+            lockOn = !held.scrollLock;
+            break;
+        case VK_NUMLOCK:
+            lockOn = !held.numLock;
+            break;
+        }
+    }
+    bool shift = (action.flags & key_action::flagShift) != 0;
+    bool control = (action.flags & key_action::flagControl) != 0;
+    bool alt = (action.flags & key_action::flagAlt) != 0;
+    key_press_outcome outcome = send(key_chord_builder::build_press(action.virtualKeyCode, action.scanCode, shift, control, alt, extended), sink);
+    if (lock)
+    {
+        modifiers.apply_strokes(outcome.chord.strokes, outcome.chord.count);
+        outcome.modChanged = true;
+        outcome.modOn = lockOn;
+    }
+    return outcome;
+}
@@ -0,0 +1,51 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef KEY_DISPATCHER_H
+#define KEY_DISPATCHER_H
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <cstdint>
+// 4. Project classes
+#include "input_sink.h"
+#include "key_chord.h"
+#include "key_layout.h"
+#include "modifier_state.h"
+// 5. Forward decl
+
+// What one key press did, for the caller's visual feedback and bookkeeping.
+struct key_press_outcome
+{
+    key_chord chord; // as injected
+    bool sent; // false if the sink took fewer strokes than the chord has
+    bool modChanged; // a modifier or lock key, its state flipped
+    bool modOn; // with modChanged: the modifier is now held or the lock is on
+    int64_t injectStartNs; // latency_recorder::now_ns() around the send_keys() call
+    int64_t injectEndNs;
+};
+
+// The UI thread's part of a key press: looks the key up on the active layout, builds its chord, injects it and
+// keeps the modifier state up to date. Makes no heap allocations, see key_press_tests.
+class key_dispatcher // static members only
+{
+public:
+    // public press(): Injects the press of one key.
+    // see cpp file for more info.
+    static key_press_outcome press(const key_layout& layout, key_id id, modifier_state& modifiers, input_sink& sink);
+};
+
+#endif // KEY_DISPATCHER_H
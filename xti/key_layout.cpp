@@ -0,0 +1,94 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "key_layout.h"
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+// 4. Project classes
+#include "key_chord.h"
+
+key_layout::key_layout()
+    : m_layoutId(0)
+    , m_unicodeCount(0)
+{
+    for (uint32_t i = 0; i < key_count; i++)
+    {
+        m_actions[0][i] = key_mapping::get_action(static_cast<key_id>(i));
+        m_actions[1][i] = m_actions[0][i];
+    }
+}
+
+// --- build(): Translates every key for a layout.
+// Keys that type a character are looked up by that character, so the button for @ types @ even where @ is
+// AltGr+Q. Characters the layout has no key for (or only a dead key) are typed as unicode instead, which apps
+// that read scan codes will not see, but every text field will. All other keys keep their virtual key and gain
+// the layout's scan code.
+// ----- source: The layout to translate for.
+// ----- layoutId: Identifies the layout, e.g. the HKL, see get_layout_id().
+// --------------------------------------------------------------------------------------------/
+/* public */ void key_layout::build(const key_layout_source& source, uint64_t layoutId)
+{
+    static constexpr uint8_t layoutFlags = key_action::flagShift | key_action::flagControl | key_action::flagAlt |
+                                           key_action::flagExtended | key_action::flagUnicode;
+    m_unicodeCount = 0;
+    for (uint32_t i = 0; i < key_count; i++)
+    {
+        key_id id = static_cast<key_id>(i);
+        key_action shortcut = key_mapping::get_action(id);
+        set_scan_code(source, shortcut);
+        key_action typing = shortcut;
+        char16_t character = key_mapping::get_character(id);
+        uint16_t virtualKeyCode = 0;
+        uint8_t modifiers = 0;
+        if (character != 0 && source.find_character(character, virtualKeyCode, modifiers))
+        {
+            typing.virtualKeyCode = virtualKeyCode;
+            typing.flags = static_cast<uint8_t>((typing.flags & ~layoutFlags) | modifiers);
+            if (key_chord_builder::is_extended_key(virtualKeyCode))
+            {
+                typing.flags |= key_action::flagExtended;
+            }
+            set_scan_code(source, typing);
+        }
+        else if (character != 0)
+        {
+            typing.virtualKeyCode = character;
+            typing.flags = static_cast<uint8_t>((typing.flags & ~layoutFlags) | key_action::flagUnicode);
+            typing.scanCode = 0;
+            m_unicodeCount++;
+        }
+        m_actions[0][i] = typing;
+        m_actions[1][i] = shortcut;
+    }
+    m_layoutId = layoutId;
+}
+
+// --- set_scan_code(): Fills in a key's scan code and extended flag from the layout.
+// Pause is the one key with an E1 prefix, a sequence no single stroke can carry, so it keeps scan code 0.
+// ----- source: The layout to ask.
+// ----- action: The key, its virtualKeyCode must already be the layout's.
+// --------------------------------------------------------------------------------------------/
+/* private */ void key_layout::set_scan_code(const key_layout_source& source, key_action& action)
+{
+    uint16_t scanCode = source.get_scan_code(action.virtualKeyCode);
+    uint16_t prefix = scanCode & 0xFF00;
+    if (prefix == 0xE000)
+    {
+        action.flags |= key_action::flagExtended;
+    }
+    action.scanCode = prefix == 0 || prefix == 0xE000 ? scanCode & 0x00FF : 0;
+}
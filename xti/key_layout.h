@@ -0,0 +1,74 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef KEY_LAYOUT_H
+#define KEY_LAYOUT_H
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <cstdint>
+// 4. Project classes
+#include "key_mapping.h"
+// 5. Forward decl
+
+// What a keyboard layout does with its keys, asked while a key_layout is built.
+// The Win32 implementation is windows_layout_source, which reads the tables of one installed layout.
+class key_layout_source
+{
+public:
+    virtual ~key_layout_source() = default;
+
+    // public find_character(): Finds the key and the modifiers (key_action::flagShift, flagControl, flagAlt) that type
+    // character. False if no key types it, or only as a dead key that waits for the next key.
+    virtual bool find_character(char16_t character, uint16_t& virtualKeyCodeOut, uint8_t& modifiersOut) const = 0;
+
+    // public get_scan_code(): Gets the scan code of a key, 0xE0 in the high byte for extended keys, 0 if it has none.
+    virtual uint16_t get_scan_code(uint16_t virtualKeyCode) const = 0;
+};
+
+// The key_action of every key for one keyboard layout, so typing a key is one table index whatever layout is active.
+// Two tables are kept: typing looks keys up by the character on the button (falling back to unicode when the layout
+// has no key for it), shortcuts keep the virtual key apps match Ctrl+C and friends against.
+// Built again only when the layout changes, starts out as the US defaults from key_mapping.
+class key_layout
+{
+public:
+    key_layout();
+
+    // public build(): Translates every key for a layout.
+    // see cpp file for more info.
+    void build(const key_layout_source& source, uint64_t layoutId);
+
+    // public get_action(): Gets what a key does, shortcut is true while control, alt or windows is held.
+    const key_action& get_action(key_id id, bool shortcut) const { return m_actions[shortcut ? 1 : 0][id]; }
+
+    // public get_layout_id(): Gets the id passed to the last build(), 0 for the US defaults.
+    uint64_t get_layout_id() const { return m_layoutId; }
+
+    // public get_unicode_count(): Gets how many keys the layout has no key for and are typed as unicode.
+    uint32_t get_unicode_count() const { return m_unicodeCount; }
+
+private:
+    key_action m_actions[2][key_count]; // [0] typing, [1] shortcuts
+    uint64_t m_layoutId;
+    uint32_t m_unicodeCount;
+
+    // private set_scan_code(): Fills in a key's scan code and extended flag from the layout.
+    // see cpp file for more info.
+    static void set_scan_code(const key_layout_source& source, key_action& action);
+};
+
+#endif // KEY_LAYOUT_H
@@ -17,157 +17,231 @@
 
 // 1. Qt framework headers
 // 2. System/OS headers
-#include <Windows.h>
 // 3. C++ standard library headers
 // 4. Project classes
+#include "virtual_keys.h"
+#include "key_chord.h"
 
-std::unordered_map<std::wstring, int32_t> key_mapping::translateSet;
+static constexpr key_action make_action(uint16_t virtualKeyCode, uint8_t flags)
+{
+    if (key_chord_builder::is_extended_key(virtualKeyCode))
+    {
+        flags |= key_action::flagExtended;
+    }
+    return { virtualKeyCode, flags, 0 };
+}
+
+// Indexed by key_id. Shifted symbols and custom key combinations are expressed as the
+// underlying US layout key plus the modifiers to hold, so dispatch never has to inspect the button.
+// Editing and navigation keys repeat, holding a letter stays a single press. Keys inside the touchpad zone never
+// repeat, holding a finger there moves the cursor instead.
+static constexpr key_action actionTable[] = {
+    /* key_escape */ make_action(VK_ESCAPE, 0),
+    /* key_f1 */ make_action(VK_F1, 0),
+    /* key_f2 */ make_action(VK_F2, 0),
+    /* key_f3 */ make_action(VK_F3, 0),
+    /* key_f4 */ make_action(VK_F4, 0),
+    /* key_f5 */ make_action(VK_F5, 0),
+    /* key_f6 */ make_action(VK_F6, 0),
+    /* key_f7 */ make_action(VK_F7, 0),
+    /* key_f8 */ make_action(VK_F8, 0),
+    /* key_f9 */ make_action(VK_F9, 0),
+    /* key_f10 */ make_action(VK_F10, 0),
+    /* key_f11 */ make_action(VK_F11, 0),
+    /* key_f12 */ make_action(VK_F12, 0),
+    /* key_backspace */ make_action(VK_BACK, key_action::flagRepeat),
+    /* key_tilde */ make_action(VK_OEM_3, key_action::flagShift),
+    /* key_exclamationMark */ make_action(0x31, key_action::flagShift),
+    /* key_at */ make_action(0x32, key_action::flagShift),
+    /* key_hash */ make_action(0x33, key_action::flagShift),
+    /* key_dollar */ make_action(0x34, key_action::flagShift),
+    /* key_percent */ make_action(0x35, key_action::flagShift),
+    /* key_next */ make_action(VK_MEDIA_NEXT_TRACK, 0),
+    /* key_previous */ make_action(VK_MEDIA_PREV_TRACK, 0),
+    /* key_circumflex */ make_action(0x36, key_action::flagShift),
+    /* key_ampersand */ make_action(0x37, key_action::flagShift),
+    /* key_asterisk */ make_action(0x38, key_action::flagShift),
+    /* key_leftRoundBracket */ make_action(0x39, key_action::flagShift),
+    /* key_rightRoundBracket */ make_action(0x30, key_action::flagShift),
+    /* key_minus */ make_action(VK_OEM_MINUS, 0),
+    /* key_graveAccent */ make_action(VK_OEM_3, 0),
+    /* key_num1 */ make_action(0x31, 0),
+    /* key_num2 */ make_action(0x32, 0),
+    /* key_num3 */ make_action(0x33, 0),
+    /* key_num4 */ make_action(0x34, 0),
+    /* key_num5 */ make_action(0x35, 0),
+    /* key_mute */ make_action(VK_VOLUME_MUTE, 0),
+    /* key_pause */ make_action(VK_MEDIA_PLAY_PAUSE, 0),
+    /* key_num6 */ make_action(0x36, 0),
+    /* key_num7 */ make_action(0x37, 0),
+    /* key_num8 */ make_action(0x38, 0),
+    /* key_num9 */ make_action(0x39, 0),
+    /* key_num0 */ make_action(0x30, 0),
+    /* key_underscore */ make_action(VK_OEM_MINUS, key_action::flagShift),
+    /* key_singleQuote */ make_action(VK_OEM_7, 0),
+    /* key_Q */ make_action(0x51, key_action::flagShift),
+    /* key_W */ make_action(0x57, key_action::flagShift),
+    /* key_E */ make_action(0x45, key_action::flagShift),
+    /* key_R */ make_action(0x52, key_action::flagShift),
+    /* key_T */ make_action(0x54, key_action::flagShift),
+    /* key_pageUp */ make_action(VK_PRIOR, 0),
+    /* key_pageDown */ make_action(VK_NEXT, key_action::flagRepeat),
+    /* key_Y */ make_action(0x59, key_action::flagShift),
+    /* key_U */ make_action(0x55, key_action::flagShift),
+    /* key_I */ make_action(0x49, key_action::flagShift),
+    /* key_O */ make_action(0x4F, key_action::flagShift),
+    /* key_P */ make_action(0x50, key_action::flagShift),
+    /* key_equals */ make_action(VK_OEM_PLUS, 0),
+    /* key_doubleQuote */ make_action(VK_OEM_7, key_action::flagShift),
+    /* key_A */ make_action(0x41, key_action::flagShift),
+    /* key_S */ make_action(0x53, key_action::flagShift),
+    /* key_D */ make_action(0x44, key_action::flagShift),
+    /* key_F */ make_action(0x46, key_action::flagShift),
+    /* key_G */ make_action(0x47, key_action::flagShift),
+    /* key_home */ make_action(VK_HOME, 0),
+    /* key_end */ make_action(VK_END, 0),
+    /* key_H */ make_action(0x48, key_action::flagShift),
+    /* key_J */ make_action(0x4A, key_action::flagShift),
+    /* key_K */ make_action(0x4B, key_action::flagShift),
+    /* key_L */ make_action(0x4C, key_action::flagShift),
+    /* key_leftSquareBracket */ make_action(VK_OEM_4, 0),
+    /* key_plus */ make_action(VK_OEM_PLUS, key_action::flagShift),
+    /* key_semicolon */ make_action(VK_OEM_1, 0),
+    /* key_Z */ make_action(0x5A, key_action::flagShift),
+    /* key_X */ make_action(0x58, key_action::flagShift),
+    /* key_C */ make_action(0x43, key_action::flagShift),
+    /* key_V */ make_action(0x56, key_action::flagShift),
+    /* key_B */ make_action(0x42, key_action::flagShift),
+    /* key_tab */ make_action(VK_TAB, 0),
+    /* key_break */ make_action(VK_PAUSE, 0),
+    /* key_N */ make_action(0x4E, key_action::flagShift),
+    /* key_M */ make_action(0x4D, key_action::flagShift),
+    /* key_lessThan */ make_action(VK_OEM_COMMA, key_action::flagShift),
+    /* key_greaterThan */ make_action(VK_OEM_PERIOD, key_action::flagShift),
+    /* key_rightSquareBracket */ make_action(VK_OEM_6, 0),
+    /* key_backslash */ make_action(VK_OEM_5, 0),
+    /* key_colon */ make_action(VK_OEM_1, key_action::flagShift),
+    /* key_q */ make_action(0x51, 0),
+    /* key_w */ make_action(0x57, 0),
+    /* key_e */ make_action(0x45, 0),
+    /* key_r */ make_action(0x52, 0),
+    /* key_t_ */ make_action(0x54, 0),
+    /* key_volumeUp */ make_action(VK_VOLUME_UP, 0),
+    /* key_volumeDown */ make_action(VK_VOLUME_DOWN, key_action::flagRepeat),
+    /* key_y */ make_action(0x59, 0),
+    /* key_u */ make_action(0x55, 0),
+    /* key_i */ make_action(0x49, 0),
+    /* key_o */ make_action(0x4F, 0),
+    /* key_p */ make_action(0x50, 0),
+    /* key_leftBraces */ make_action(VK_OEM_4, key_action::flagShift),
+    /* key_comma */ make_action(VK_OEM_COMMA, 0),
+    /* key_a */ make_action(0x41, 0),
+    /* key_s */ make_action(0x53, 0),
+    /* key_d */ make_action(0x44, 0),
+    /* key_f */ make_action(0x46, 0),
+    /* key_g */ make_action(0x47, 0),
+    /* key_printScreen */ make_action(VK_SNAPSHOT, 0),
+    /* key_numLock */ make_action(VK_NUMLOCK, key_action::flagLock),
+    /* key_h */ make_action(0x48, 0),
+    /* key_j */ make_action(0x4A, 0),
+    /* key_k */ make_action(0x4B, 0),
+    /* key_l */ make_action(0x4C, 0),
+    /* key_verticalSlash */ make_action(VK_OEM_5, key_action::flagShift),
+    /* key_rightBraces */ make_action(VK_OEM_6, key_action::flagShift),
+    /* key_fullstop */ make_action(VK_OEM_PERIOD, 0),
+    /* key_z */ make_action(0x5A, 0),
+    /* key_x */ make_action(0x58, 0),
+    /* key_c */ make_action(0x43, 0),
+    /* key_v */ make_action(0x56, 0),
+    /* key_b */ make_action(0x42, 0),
+    /* key_shift */ make_action(VK_RSHIFT, key_action::flagModifier),
+    /* key_scrollLock */ make_action(VK_SCROLL, key_action::flagLock),
+    /* key_n */ make_action(0x4E, 0),
+    /* key_m */ make_action(0x4D, 0),
+    /* key_slash */ make_action(VK_OEM_2, 0),
+    /* key_questionMark */ make_action(VK_OEM_2, key_action::flagShift),
+    /* key_menu */ make_action(VK_APPS, 0),
+    /* key_capsLock */ make_action(VK_CAPITAL, key_action::flagLock),
+    /* key_space */ make_action(VK_SPACE, 0),
+    /* key_undo */ make_action(0x5A, key_action::flagControl),
+    /* key_redo */ make_action(0x59, key_action::flagControl | key_action::flagRepeat),
+    /* key_up */ make_action(VK_UP, key_action::flagRepeat),
+    /* key_down */ make_action(VK_DOWN, key_action::flagRepeat),
+    /* key_left */ make_action(VK_LEFT, key_action::flagRepeat),
+    /* key_right */ make_action(VK_RIGHT, key_action::flagRepeat),
+    /* key_control */ make_action(VK_RCONTROL, key_action::flagModifier),
+    /* key_windows */ make_action(VK_RWIN, key_action::flagModifier),
+    /* key_alt */ make_action(VK_RMENU, key_action::flagModifier),
+    /* key_copy */ make_action(0x43, key_action::flagControl),
+    /* key_cut */ make_action(0x58, key_action::flagControl),
+    /* key_paste */ make_action(0x56, key_action::flagControl),
+    /* key_fileFind */ make_action(0x4E, key_action::flagShift | key_action::flagControl),
+    /* key_find */ make_action(0x46, key_action::flagControl),
+    /* key_findAll */ make_action(0x46, key_action::flagShift | key_action::flagControl),
+    /* key_insert */ make_action(VK_INSERT, 0),
+    /* key_delete */ make_action(VK_DELETE, key_action::flagRepeat),
+    /* key_enter */ make_action(VK_RETURN, 0),
+};
+static_assert(sizeof(actionTable) / sizeof(actionTable[0]) == key_count, "actionTable must have one entry per key_id.");
+
+// --- get_action(): Gets the precomputed action for a key.
+// ----- id: The key to look up.
+// ------- returns: The action to perform for the key.
+// --------------------------------------------------------------------------------------------/
+/* public */ const key_action& key_mapping::get_action(key_id id)
+{
+    return actionTable[id];
+}
 
-void key_mapping::initialize()
+// --- get_character(): Gets the character a key types on the US layout.
+// Only keys whose character moves between layouts have one, Space, Enter, Tab and the keys wrapped in control
+// (copy, undo, ...) do not. Shortcuts name a virtual key, not a character, and stay the same on every layout.
+// ----- id: The key to look up.
+// ------- returns: The character, 0 if the key does not type a layout dependent one.
+// --------------------------------------------------------------------------------------------/
+/* public */ char16_t key_mapping::get_character(key_id id)
 {
-    /*HANDLED*/ translateSet[L"pushButton_escape"] = VK_ESCAPE;
-    /*HANDLED*/ translateSet[L"pushButton_f1"] = VK_F1;
-    /*HANDLED*/ translateSet[L"pushButton_f2"] = VK_F2;
-    /*HANDLED*/ translateSet[L"pushButton_f3"] = VK_F3;
-    /*HANDLED*/ translateSet[L"pushButton_f4"] = VK_F4;
-    /*HANDLED*/ translateSet[L"pushButton_f5"] = VK_F5;
-    /*HANDLED*/ translateSet[L"pushButton_f6"] = VK_F6;
-    /*HANDLED*/ translateSet[L"pushButton_f7"] = VK_F7;
-    /*HANDLED*/ translateSet[L"pushButton_f8"] = VK_F8;
-    /*HANDLED*/ translateSet[L"pushButton_f9"] = VK_F9;
-    /*HANDLED*/ translateSet[L"pushButton_f10"] = VK_F10;
-    /*HANDLED*/ translateSet[L"pushButton_f11"] = VK_F11;
-    /*HANDLED*/ translateSet[L"pushButton_f12"] = VK_F12;
-    /*HANDLED*/ translateSet[L"pushButton_backspace"] = VK_BACK;
-    /*HANDLED*/ translateSet[L"pushButton_tilde"] = VK_OEM_3;
-    /*HANDLED*/ translateSet[L"pushButton_exclamationMark"] = VK_XTI_CUSTOM_EXCLAMATION_MARK;
-    /*HANDLED*/ translateSet[L"pushButton_at"] = VK_XTI_CUSTOM_AT;
-    /*HANDLED*/ translateSet[L"pushButton_hash"] = VK_XTI_CUSTOM_HASH;
-    /*HANDLED*/ translateSet[L"pushButton_dollar"] = VK_XTI_CUSTOM_DOLLAR;
-    /*HANDLED*/ translateSet[L"pushButton_percent"] = VK_XTI_CUSTOM_PERCENT;
-    /*HANDLED*/ translateSet[L"pushButton_next"] = VK_MEDIA_NEXT_TRACK;
-    /*HANDLED*/ translateSet[L"pushButton_previous"] = VK_MEDIA_PREV_TRACK;
-    /*HANDLED*/ translateSet[L"pushButton_circumflex"] = VK_XTI_CUSTOM_CIRCUMFLEX;
-    /*HANDLED*/ translateSet[L"pushButton_ampersand"] = VK_XTI_CUSTOM_AMPERSAND;
-    /*HANDLED*/ translateSet[L"pushButton_asterisk"] = VK_XTI_CUSTOM_ASTERISK;
-    /*HANDLED*/ translateSet[L"pushButton_leftRoundBracket"] = VK_XTI_CUSTOM_LEFT_ROUND_BRACKET;
-    /*HANDLED*/ translateSet[L"pushButton_rightRoundBracket"] = VK_XTI_CUSTOM_RIGHT_ROUND_BRACKET;
-    /*HANDLED*/ translateSet[L"pushButton_minus"] = VK_OEM_MINUS;
-    /*HANDLED*/ translateSet[L"pushButton_graveAccent"] = VK_OEM_3;
-    /*HANDLED*/ translateSet[L"pushButton_num1"] = 0x31;
-    /*HANDLED*/ translateSet[L"pushButton_num2"] = 0x32;
-    /*HANDLED*/ translateSet[L"pushButton_num3"] = 0x33;
-    /*HANDLED*/ translateSet[L"pushButton_num4"] = 0x34;
-    /*HANDLED*/ translateSet[L"pushButton_num5"] = 0x35;
-    /*HANDLED*/ translateSet[L"pushButton_mute"] = VK_VOLUME_MUTE;
-    /*HANDLED*/ translateSet[L"pushButton_pause"] = VK_MEDIA_PLAY_PAUSE;
-    /*HANDLED*/ translateSet[L"pushButton_num6"] = 0x36;
-    /*HANDLED*/ translateSet[L"pushButton_num7"] = 0x37;
-    /*HANDLED*/ translateSet[L"pushButton_num8"] = 0x38;
-    /*HANDLED*/ translateSet[L"pushButton_num9"] = 0x39;
-    /*HANDLED*/ translateSet[L"pushButton_num0"] = 0x30;
-    /*HANDLED*/ translateSet[L"pushButton_underscore"] = VK_OEM_MINUS;
-    /*HANDLED*/ translateSet[L"pushButton_singleQuote"] = VK_OEM_7;
-    /*HANDLED*/ translateSet[L"pushButton_Q"] = 0x51;
-    /*HANDLED*/ translateSet[L"pushButton_W"] = 0x57;
-    /*HANDLED*/ translateSet[L"pushButton_E"] = 0x45;
-    /*HANDLED*/ translateSet[L"pushButton_R"] = 0x52;
-    /*HANDLED*/ translateSet[L"pushButton_T"] = 0x54;
-    /*HANDLED*/ translateSet[L"pushButton_pageUp"] = VK_PRIOR;
-    /*HANDLED*/ translateSet[L"pushButton_pageDown"] = VK_NEXT;
-    /*HANDLED*/ translateSet[L"pushButton_Y"] = 0x59;
-    /*HANDLED*/ translateSet[L"pushButton_U"] = 0x55;
-    /*HANDLED*/ translateSet[L"pushButton_I"] = 0x49;
-    /*HANDLED*/ translateSet[L"pushButton_O"] = 0x4F;
-    /*HANDLED*/ translateSet[L"pushButton_P"] = 0x50;
-    /*HANDLED*/ translateSet[L"pushButton_equals"] = VK_OEM_PLUS;
-    /*HANDLED*/ translateSet[L"pushButton_doubleQuote"] = VK_OEM_7;
-    /*HANDLED*/ translateSet[L"pushButton_A"] = 0x41;
-    /*HANDLED*/ translateSet[L"pushButton_S"] = 0x53;
-    /*HANDLED*/ translateSet[L"pushButton_D"] = 0x44;
-    /*HANDLED*/ translateSet[L"pushButton_F"] = 0x46;
-    /*HANDLED*/ translateSet[L"pushButton_G"] = 0x47;
-    /*HANDLED*/ translateSet[L"pushButton_home"] = VK_HOME;
-    /*HANDLED*/ translateSet[L"pushButton_end"] = VK_END;
-    /*HANDLED*/ translateSet[L"pushButton_H"] = 0x48;
-    /*HANDLED*/ translateSet[L"pushButton_J"] = 0x4A;
-    /*HANDLED*/ translateSet[L"pushButton_K"] = 0x4B;
-    /*HANDLED*/ translateSet[L"pushButton_L"] = 0x4C;
-    /*HANDLED*/ translateSet[L"pushButton_leftSquareBracket"] = VK_OEM_4;
-    /*HANDLED*/ translateSet[L"pushButton_plus"] = VK_OEM_PLUS;
-    /*HANDLED*/ translateSet[L"pushButton_semicolon"] = VK_OEM_1;
-    /*HANDLED*/ translateSet[L"pushButton_Z"] = 0x5A;
-    /*HANDLED*/ translateSet[L"pushButton_X"] = 0x58;
-    /*HANDLED*/ translateSet[L"pushButton_C"] = 0x43;
-    /*HANDLED*/ translateSet[L"pushButton_V"] = 0x56;
-    /*HANDLED*/ translateSet[L"pushButton_B"] = 0x42;
-    /*HANDLED*/ translateSet[L"pushButton_tab"] = VK_TAB;
-    /*HANDLED*/ translateSet[L"pushButton_break"] = VK_PAUSE;
-    /*HANDLED*/ translateSet[L"pushButton_N"] = 0x4E;
-    /*HANDLED*/ translateSet[L"pushButton_M"] = 0x4D;
-    /*HANDLED*/ translateSet[L"pushButton_lessThan"] = VK_OEM_COMMA;
-    /*HANDLED*/ translateSet[L"pushButton_greaterThan"] = VK_OEM_PERIOD;
-    /*HANDLED*/ translateSet[L"pushButton_rightSquareBracket"] = VK_OEM_6;
-    /*HANDLED*/ translateSet[L"pushButton_backslash"] = VK_OEM_5;
-    /*HANDLED*/ translateSet[L"pushButton_colon"] = VK_OEM_1;
-    /*HANDLED*/ translateSet[L"pushButton_q"] = 0x51;
-    /*HANDLED*/ translateSet[L"pushButton_w"] = 0x57;
-    /*HANDLED*/ translateSet[L"pushButton_e"] = 0x45;
-    /*HANDLED*/ translateSet[L"pushButton_r"] = 0x52;
-    /*HANDLED*/ translateSet[L"pushButton_t"] = 0x54;
-    /*HANDLED*/ translateSet[L"pushButton_volumeUp"] = VK_VOLUME_UP;
-    /*HANDLED*/ translateSet[L"pushButton_volumeDown"] = VK_VOLUME_DOWN;
-    /*HANDLED*/ translateSet[L"pushButton_y"] = 0x59;
-    /*HANDLED*/ translateSet[L"pushButton_u"] = 0x55;
-    /*HANDLED*/ translateSet[L"pushButton_i"] = 0x49;
-    /*HANDLED*/ translateSet[L"pushButton_o"] = 0x4F;
-    /*HANDLED*/ translateSet[L"pushButton_p"] = 0x50;
-    /*HANDLED*/ translateSet[L"pushButton_leftBraces"] = VK_OEM_4;
-    /*HANDLED*/ translateSet[L"pushButton_comma"] = VK_OEM_COMMA;
-    /*HANDLED*/ translateSet[L"pushButton_a"] = 0x41;
-    /*HANDLED*/ translateSet[L"pushButton_s"] = 0x53;
-    /*HANDLED*/ translateSet[L"pushButton_d"] = 0x44;
-    /*HANDLED*/ translateSet[L"pushButton_f"] = 0x46;
-    /*HANDLED*/ translateSet[L"pushButton_g"] = 0x47;
-    /*HANDLED*/ translateSet[L"pushButton_printScreen"] = VK_SNAPSHOT;
-    /*HANDLED*/ translateSet[L"pushButton_numLock"] = VK_NUMLOCK;
-    /*HANDLED*/ translateSet[L"pushButton_h"] = 0x48;
-    /*HANDLED*/ translateSet[L"pushButton_j"] = 0x4A;
-    /*HANDLED*/ translateSet[L"pushButton_k"] = 0x4B;
-    /*HANDLED*/ translateSet[L"pushButton_l"] = 0x4C;
-    /*HANDLED*/ translateSet[L"pushButton_verticalSlash"] = VK_OEM_5;
-    /*HANDLED*/ translateSet[L"pushButton_rightBraces"] = VK_OEM_6;
-    /*HANDLED*/ translateSet[L"pushButton_fullstop"] = VK_OEM_PERIOD;
-    /*HANDLED*/ translateSet[L"pushButton_z"] = 0x5A;
-    /*HANDLED*/ translateSet[L"pushButton_x"] = 0x58;
-    /*HANDLED*/ translateSet[L"pushButton_c"] = 0x43;
-    /*HANDLED*/ translateSet[L"pushButton_v"] = 0x56;
-    /*HANDLED*/ translateSet[L"pushButton_b"] = 0x42;
-    /*HANDLED*/ translateSet[L"pushButton_shift"] = VK_RSHIFT;
-    /*HANDLED*/ translateSet[L"pushButton_scrollLock"] = VK_SCROLL;
-    /*HANDLED*/ translateSet[L"pushButton_n"] = 0x4E;
-    /*HANDLED*/ translateSet[L"pushButton_m"] = 0x4D;
-    /*HANDLED*/ translateSet[L"pushButton_slash"] = VK_OEM_2;
-    /*HANDLED*/ translateSet[L"pushButton_questionMark"] = VK_OEM_2;
-    /*HANDLED*/ translateSet[L"pushButton_menu"] = VK_APPS;
-    /*HANDLED*/ translateSet[L"pushButton_capsLock"] = VK_CAPITAL;
-    /*HANDLED*/ translateSet[L"pushButton_space"] = VK_SPACE;
-    /*HANDLED*/ translateSet[L"pushButton_undo"] = VK_XTI_CUSTOM_UNDO;
-    /*HANDLED*/ translateSet[L"pushButton_redo"] = VK_XTI_CUSTOM_REDO;
-    /*HANDLED*/ translateSet[L"pushButton_up"] = VK_UP;
-    /*HANDLED*/ translateSet[L"pushButton_down"] = VK_DOWN;
-    /*HANDLED*/ translateSet[L"pushButton_left"] = VK_LEFT;
-    /*HANDLED*/ translateSet[L"pushButton_right"] = VK_RIGHT;
-    /*HANDLED*/ translateSet[L"pushButton_control"] = VK_RCONTROL;
-    /*HANDLED*/ translateSet[L"pushButton_windows"] = VK_RWIN;
-    /*HANDLED*/ translateSet[L"pushButton_alt"] = VK_RMENU;
-    /*HANDLED*/ translateSet[L"pushButton_copy"] = VK_XTI_CUSTOM_COPY;
-    /*HANDLED*/ translateSet[L"pushButton_cut"] = VK_XTI_CUSTOM_CUT;
-    /*HANDLED*/ translateSet[L"pushButton_paste"] = VK_XTI_CUSTOM_PASTE;
-    /*HANDLED*/ translateSet[L"pushButton_fileFind"] = VK_XTI_CUSTOM_FIND_FILE;
-    /*HANDLED*/ translateSet[L"pushButton_find"] = VK_XTI_CUSTOM_FIND;
-    /*HANDLED*/ translateSet[L"pushButton_findAll"] = VK_XTI_CUSTOM_FIND_ALL;
-    /*HANDLED*/ translateSet[L"pushButton_insert"] = VK_INSERT;
-    /*HANDLED*/ translateSet[L"pushButton_delete"] = VK_DELETE;
-    /*HANDLED*/ translateSet[L"pushButton_enter"] = VK_RETURN;
+    const key_action& action = actionTable[id];
+    if ((action.flags & (key_action::flagControl | key_action::flagModifier | key_action::flagLock)) != 0)
+    {
+        return 0;
+    }
+    bool shift = (action.flags & key_action::flagShift) != 0;
+    uint16_t virtualKeyCode = action.virtualKeyCode;
+    if (virtualKeyCode >= 0x41 && virtualKeyCode <= 0x5A)
+    {
+        return static_cast<char16_t>(shift ? virtualKeyCode : virtualKeyCode + 0x20);
+    }
+    if (virtualKeyCode >= 0x30 && virtualKeyCode <= 0x39)
+    {
+        static constexpr char16_t shiftedDigits[] = u")!@#$%^&*(";
+        return shift ? shiftedDigits[virtualKeyCode - 0x30] : static_cast<char16_t>(virtualKeyCode);
+    }
+    switch (virtualKeyCode)
+    {
+    case VK_OEM_1:
+        return shift ? u':' : u';';
+    case VK_OEM_PLUS:
+        return shift ? u'+' : u'=';
+    case VK_OEM_COMMA:
+        return shift ? u'<' : u',';
+    case VK_OEM_MINUS:
+        return shift ? u'_' : u'-';
+    case VK_OEM_PERIOD:
+        return shift ? u'>' : u'.';
+    case VK_OEM_2:
+        return shift ? u'?' : u'/';
+    case VK_OEM_3:
+        return shift ? u'~' : u'`';
+    case VK_OEM_4:
+        return shift ? u'{' : u'[';
+    case VK_OEM_5:
+        return shift ? u'|' : u'\\';
+    case VK_OEM_6:
+        return shift ? u'}' : u']';
+    case VK_OEM_7:
+        return shift ? u'"' : u'\'';
+    default:
+        return 0;
+    }
 }
@@ -20,37 +20,190 @@
 // 2. System/OS headers
 // 3. C++ standard library headers
 #include <cstdint>
-#include <string>
-#include <unordered_map>
 // 4. Project classes
 // 5. Forward decl
 
-#define VK_XTI_CUSTOM_EXCLAMATION_MARK -1002
-#define VK_XTI_CUSTOM_AT -1003
-#define VK_XTI_CUSTOM_HASH -1004
-#define VK_XTI_CUSTOM_DOLLAR -1005
-#define VK_XTI_CUSTOM_PERCENT -1006
-#define VK_XTI_CUSTOM_CIRCUMFLEX -1007
-#define VK_XTI_CUSTOM_AMPERSAND -1008
-#define VK_XTI_CUSTOM_ASTERISK -1009
-#define VK_XTI_CUSTOM_LEFT_ROUND_BRACKET -1010
-#define VK_XTI_CUSTOM_RIGHT_ROUND_BRACKET -1011
-
-#define VK_XTI_CUSTOM_COPY -2002
-#define VK_XTI_CUSTOM_PASTE -2003
-#define VK_XTI_CUSTOM_FIND_FILE -2004
-#define VK_XTI_CUSTOM_FIND -2005
-#define VK_XTI_CUSTOM_FIND_ALL -2006
-#define VK_XTI_CUSTOM_CUT -2007
-#define VK_XTI_CUSTOM_UNDO -2008
-#define VK_XTI_CUSTOM_REDO -2009
+// Dense identifier for every key push button on the main_window.ui.
+// Order matches main_window::m_keyButtonList so either can be indexed with the other.
+enum key_id : uint8_t
+{
+    key_escape,
+    key_f1,
+    key_f2,
+    key_f3,
+    key_f4,
+    key_f5,
+    key_f6,
+    key_f7,
+    key_f8,
+    key_f9,
+    key_f10,
+    key_f11,
+    key_f12,
+    key_backspace,
+    key_tilde,
+    key_exclamationMark,
+    key_at,
+    key_hash,
+    key_dollar,
+    key_percent,
+    key_next,
+    key_previous,
+    key_circumflex,
+    key_ampersand,
+    key_asterisk,
+    key_leftRoundBracket,
+    key_rightRoundBracket,
+    key_minus,
+    key_graveAccent,
+    key_num1,
+    key_num2,
+    key_num3,
+    key_num4,
+    key_num5,
+    key_mute,
+    key_pause,
+    key_num6,
+    key_num7,
+    key_num8,
+    key_num9,
+    key_num0,
+    key_underscore,
+    key_singleQuote,
+    key_Q,
+    key_W,
+    key_E,
+    key_R,
+    key_T,
+    key_pageUp,
+    key_pageDown,
+    key_Y,
+    key_U,
+    key_I,
+    key_O,
+    key_P,
+    key_equals,
+    key_doubleQuote,
+    key_A,
+    key_S,
+    key_D,
+    key_F,
+    key_G,
+    key_home,
+    key_end,
+    key_H,
+    key_J,
+    key_K,
+    key_L,
+    key_leftSquareBracket,
+    key_plus,
+    key_semicolon,
+    key_Z,
+    key_X,
+    key_C,
+    key_V,
+    key_B,
+    key_tab,
+    key_break,
+    key_N,
+    key_M,
+    key_lessThan,
+    key_greaterThan,
+    key_rightSquareBracket,
+    key_backslash,
+    key_colon,
+    key_q,
+    key_w,
+    key_e,
+    key_r,
+    key_t_, // key_t is taken by a POSIX typedef
+    key_volumeUp,
+    key_volumeDown,
+    key_y,
+    key_u,
+    key_i,
+    key_o,
+    key_p,
+    key_leftBraces,
+    key_comma,
+    key_a,
+    key_s,
+    key_d,
+    key_f,
+    key_g,
+    key_printScreen,
+    key_numLock,
+    key_h,
+    key_j,
+    key_k,
+    key_l,
+    key_verticalSlash,
+    key_rightBraces,
+    key_fullstop,
+    key_z,
+    key_x,
+    key_c,
+    key_v,
+    key_b,
+    key_shift,
+    key_scrollLock,
+    key_n,
+    key_m,
+    key_slash,
+    key_questionMark,
+    key_menu,
+    key_capsLock,
+    key_space,
+    key_undo,
+    key_redo,
+    key_up,
+    key_down,
+    key_left,
+    key_right,
+    key_control,
+    key_windows,
+    key_alt,
+    key_copy,
+    key_cut,
+    key_paste,
+    key_fileFind,
+    key_find,
+    key_findAll,
+    key_insert,
+    key_delete,
+    key_enter,
+    key_count
+};
+
+// What a key push button does when pressed. The US layout defaults are precomputed at compile time,
+// key_layout translates them for the layout actually in use.
+struct key_action
+{
+    static constexpr uint8_t flagShift = 0x01; // hold LSHIFT around the key
+    static constexpr uint8_t flagControl = 0x02; // hold LCONTROL around the key
+    static constexpr uint8_t flagExtended = 0x04; // inject with the extended-key flag
+    static constexpr uint8_t flagLock = 0x08; // caps, num or scroll lock
+    static constexpr uint8_t flagModifier = 0x10; // stays held down between presses until pressed again
+    static constexpr uint8_t flagRepeat = 0x20; // presses again and again while held, see key_repeater
+    static constexpr uint8_t flagAlt = 0x40; // hold LMENU around the key, with flagControl it is AltGr
+    static constexpr uint8_t flagUnicode = 0x80; // the layout has no key for it, virtualKeyCode is the character to type
+
+    uint16_t virtualKeyCode;
+    uint8_t flags;
+    uint16_t scanCode; // 0 in the US defaults, key_layout fills it in
+};
 
 // Maps push buttons on the main_window.ui to virtual key codes: https://learn.microsoft.com/en-us/windows/win32/inputdev/virtual-key-codes
 class key_mapping  // static members only
 {
 public:
-    static std::unordered_map<std::wstring, int32_t> translateSet;
-    static void initialize();
+    // public get_action(): Gets the precomputed action for a key.
+    // see cpp file for more info.
+    static const key_action& get_action(key_id id);
+
+    // public get_character(): Gets the character a key types on the US layout.
+    // see cpp file for more info.
+    static char16_t get_character(key_id id);
 };
 
 #endif // KEY_MAPPING_H
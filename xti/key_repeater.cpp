@@ -0,0 +1,99 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "key_repeater.h"
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <cstdio>
+// 4. Project classes
+
+static double to_us(uint64_t valueNs)
+{
+    return static_cast<double>(valueNs) / 1000.0;
+}
+
+key_repeater::key_repeater()
+    : m_delayNs(500000000) // the Windows defaults, until set_timing() is given the user's own
+    , m_intervalNs(33333333)
+    , m_key(-1)
+    , m_deadlineNs(0)
+    , m_heldRepeats(0)
+    , m_repeats(0)
+    , m_skipped(0)
+{
+}
+
+/* public */ void key_repeater::set_timing(int64_t delayNs, int64_t intervalNs)
+{
+    m_delayNs = delayNs;
+    m_intervalNs = intervalNs > 0 ? intervalNs : 1;
+}
+
+/* public */ void key_repeater::start(int32_t key, int64_t nowNs)
+{
+    m_key = key;
+    m_deadlineNs = nowNs + m_delayNs;
+    m_heldRepeats = 0;
+}
+
+/* public */ void key_repeater::stop()
+{
+    m_key = -1;
+    m_heldRepeats = 0;
+}
+
+// --- poll(): Determines if a repeat is due and moves on to the next deadline if so.
+// At most one repeat is due per poll. Deadlines the caller has already missed entirely are skipped rather than
+// sent in a burst, a stalled UI thread must not come back and type a run of characters at once.
+// ----- nowNs: The steady clock time now, same clock as start().
+// ------- returns: True if the held key should be pressed once now.
+// --------------------------------------------------------------------------------------------/
+/* public */ bool key_repeater::poll(int64_t nowNs)
+{
+    if (m_key == -1 || nowNs < m_deadlineNs)
+    {
+        return false;
+    }
+    m_jitter.record(nowNs - m_deadlineNs);
+    m_deadlineNs += m_intervalNs;
+    if (m_deadlineNs <= nowNs)
+    {
+        int64_t missed = (nowNs - m_deadlineNs) / m_intervalNs + 1;
+        m_deadlineNs += missed * m_intervalNs;
+        m_skipped += static_cast<uint64_t>(missed);
+    }
+    m_heldRepeats++;
+    m_repeats++;
+    return true;
+}
+
+/* public */ key_repeat_stats key_repeater::get_stats() const
+{
+    key_repeat_stats stats;
+    stats.repeats = m_repeats;
+    stats.skipped = m_skipped;
+    return stats;
+}
+
+/* public */ std::string key_repeater::dump() const
+{
+    char line[192];
+    std::snprintf(line, sizeof(line), "key repeat: %llu repeats, %llu skipped, lateness (us) p50 %.1f p99 %.1f max %.1f\n",
+        static_cast<unsigned long long>(m_repeats), static_cast<unsigned long long>(m_skipped),
+        to_us(m_jitter.get_percentile(50.0)), to_us(m_jitter.get_percentile(99.0)), to_us(m_jitter.get_max()));
+    return line;
+}
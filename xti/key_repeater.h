@@ -0,0 +1,83 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef KEY_REPEATER_H
+#define KEY_REPEATER_H
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <cstdint>
+#include <string>
+// 4. Project classes
+#include "latency_histogram.h"
+// 5. Forward decl
+
+struct key_repeat_stats
+{
+    uint64_t repeats;
+    uint64_t skipped; // deadlines passed over because the caller polled more than a whole interval late
+};
+
+// Auto-repeat for one held key. Deadlines are absolute on the steady clock (held + delay + n * interval), so a
+// late poll delays that one repeat but never the ones after it. How late each repeat was polled is the jitter.
+// Has no timer of its own, the caller polls it at get_deadline_ns(). Used from one thread only.
+class key_repeater
+{
+public:
+    key_repeater();
+
+    // public set_timing(): Sets the initial delay and the interval between repeats, used from the next start().
+    void set_timing(int64_t delayNs, int64_t intervalNs);
+
+    // public start(): Starts counting towards the first repeat of a key held since nowNs.
+    void start(int32_t key, int64_t nowNs);
+
+    // public stop(): Stops repeating, e.g. when the key is let go or the touch moves off it.
+    void stop();
+
+    // public get_key(): Gets the key being held, -1 when none.
+    int32_t get_key() const { return m_key; }
+
+    // public has_repeated(): Determines if the held key has repeated at least once since start().
+    bool has_repeated() const { return m_heldRepeats > 0; }
+
+    // public get_deadline_ns(): Gets when the next repeat is due, only meaningful while a key is held.
+    int64_t get_deadline_ns() const { return m_deadlineNs; }
+
+    // public poll(): Determines if a repeat is due and moves on to the next deadline if so.
+    // see cpp file for more info.
+    bool poll(int64_t nowNs);
+
+    key_repeat_stats get_stats() const;
+
+    // public get_jitter(): Gets how late each repeat was polled relative to its deadline.
+    const latency_histogram& get_jitter() const { return m_jitter; }
+
+    // public dump(): Formats the stats and jitter percentiles as one line of text.
+    std::string dump() const;
+
+private:
+    int64_t m_delayNs;
+    int64_t m_intervalNs;
+    int32_t m_key;
+    int64_t m_deadlineNs;
+    uint64_t m_heldRepeats;
+    uint64_t m_repeats;
+    uint64_t m_skipped;
+    latency_histogram m_jitter;
+};
+
+#endif // KEY_REPEATER_H
@@ -0,0 +1,126 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "latency_histogram.h"
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <cmath>
+// 4. Project classes
+
+latency_histogram::latency_histogram()
+    : m_max(0)
+{
+    for (uint32_t i = 0; i < bucketCount; i++)
+    {
+        m_counts[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+// --- record(): Adds one duration.
+// There is only ever one writer, so a relaxed load and store is enough and no locked instruction is needed.
+// Readers on other threads may see the bucket and the max updated in either order, which only matters
+// for the value being recorded right at that moment.
+// ----- valueNs: The duration in nanoseconds.
+// --------------------------------------------------------------------------------------------/
+/* public */ void latency_histogram::record(int64_t valueNs)
+{
+    uint64_t value = valueNs < 0 ? 0 : static_cast<uint64_t>(valueNs);
+    if (value > maxValue)
+    {
+        value = maxValue;
+    }
+    std::atomic<uint32_t>& count = m_counts[to_index(value)];
+    count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    if (value > m_max.load(std::memory_order_relaxed))
+    {
+        m_max.store(value, std::memory_order_relaxed);
+    }
+}
+
+/* public */ uint64_t latency_histogram::get_count() const
+{
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < bucketCount; i++)
+    {
+        total += m_counts[i].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+/* public */ uint64_t latency_histogram::get_max() const
+{
+    return m_max.load(std::memory_order_relaxed);
+}
+
+// --- get_percentile(): Gets the value below which the given percentage of recorded values fall.
+// Like HdrHistogram this reports the highest value that shares a bucket with the percentile, so the result
+// is never optimistic. It is capped at get_max().
+// ----- percentile: 0 to 100, e.g. 99.9.
+// ------- returns: The value in nanoseconds, 0 if nothing was recorded.
+// --------------------------------------------------------------------------------------------/
+/* public */ uint64_t latency_histogram::get_percentile(double percentile) const
+{
+    uint64_t total = get_count();
+    if (total == 0)
+    {
+        return 0;
+    }
+    uint64_t target = static_cast<uint64_t>(std::ceil(percentile / 100.0 * static_cast<double>(total)));
+    if (target == 0)
+    {
+        target = 1;
+    }
+    uint64_t seen = 0;
+    uint64_t max = get_max();
+    for (uint32_t i = 0; i < bucketCount; i++)
+    {
+        seen += m_counts[i].load(std::memory_order_relaxed);
+        if (seen >= target)
+        {
+            uint64_t value = to_highest_value(i);
+            return value < max ? value : max;
+        }
+    }
+    return max;
+}
+
+// --- to_index(): Maps a value to its bucket.
+// Values below 2 * subBucketCount get a bucket each. Above that the value is shifted right until it fits in
+// [subBucketCount, 2 * subBucketCount), the shift picks the power of two and the remaining bits the sub-bucket.
+// ----- value: The value, at most maxValue.
+// ------- returns: The bucket index, below bucketCount.
+// --------------------------------------------------------------------------------------------/
+/* private */ uint32_t latency_histogram::to_index(uint64_t value)
+{
+    uint32_t shift = 0;
+    while ((value >> shift) >= 2 * subBucketCount)
+    {
+        shift++;
+    }
+    return shift * subBucketCount + static_cast<uint32_t>(value >> shift);
+}
+
+/* private */ uint64_t latency_histogram::to_highest_value(uint32_t index)
+{
+    if (index < 2 * subBucketCount)
+    {
+        return index;
+    }
+    uint32_t shift = index / subBucketCount - 1;
+    uint64_t subBucket = index - shift * subBucketCount;
+    return ((subBucket + 1) << shift) - 1;
+}
@@ -0,0 +1,66 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <atomic>
+#include <cstdint>
+// 4. Project classes
+// 5. Forward decl
+
+// HDR-style histogram of nanosecond durations: every power of two is split into 32 linear sub-buckets,
+// so any recorded value is reported within about 3% while the whole range up to ~18 minutes fits in a
+// fixed 4.5 KiB array. Recording is a couple of shifts and one relaxed store, cheap enough to leave on.
+// Each histogram must only be recorded into from one thread, any thread may read it at the same time.
+class latency_histogram
+{
+public:
+    static constexpr uint32_t subBucketBits = 5;
+    static constexpr uint32_t subBucketCount = 1u << subBucketBits;
+    static constexpr uint32_t maxValueBits = 40;
+    static constexpr uint64_t maxValue = (1ull << maxValueBits) - 1; // larger values are clamped to this
+    static constexpr uint32_t bucketCount = (maxValueBits - subBucketBits + 1) * subBucketCount;
+
+    latency_histogram();
+    latency_histogram(const latency_histogram&) = delete;
+    latency_histogram& operator=(const latency_histogram&) = delete;
+
+    // public record(): Adds one duration, negative durations count as 0.
+    // see cpp file for more info.
+    void record(int64_t valueNs);
+
+    // public get_count(): Number of values recorded so far.
+    uint64_t get_count() const;
+
+    // public get_max(): Largest value recorded so far, exact rather than bucketed.
+    uint64_t get_max() const;
+
+    // public get_percentile(): Gets the value below which the given percentage of recorded values fall.
+    // see cpp file for more info.
+    uint64_t get_percentile(double percentile) const;
+
+private:
+    std::atomic<uint32_t> m_counts[bucketCount];
+    std::atomic<uint64_t> m_max;
+
+    static uint32_t to_index(uint64_t value);
+    static uint64_t to_highest_value(uint32_t index);
+};
+
+#endif // LATENCY_HISTOGRAM_H
@@ -0,0 +1,92 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "latency_recorder.h"
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <chrono>
+#include <cstdio>
+// 4. Project classes
+
+static double to_us(uint64_t valueNs)
+{
+    return static_cast<double>(valueNs) / 1000.0;
+}
+
+/* public */ int64_t latency_recorder::now_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// --- record(): Records every stage of one injected event.
+// Stages whose starting checkpoint was not taken are skipped, the total then starts at the first one that was.
+// ----- kind: Which set of histograms to record into. Must always be recorded from the same thread.
+// ----- mark: Checkpoints taken while the touch was handled.
+// ----- injectStartNs: now_ns() right before the injection call.
+// ----- injectEndNs: now_ns() right after the injection call returned.
+// --------------------------------------------------------------------------------------------/
+/* public */ void latency_recorder::record(latency_kind kind, const latency_mark& mark, int64_t injectStartNs, int64_t injectEndNs)
+{
+    latency_histogram* stages = m_histograms[kind];
+    if (mark.touchNs != 0 && mark.entryNs != 0)
+    {
+        stages[stage_queue].record(mark.entryNs - mark.touchNs);
+    }
+    if (mark.entryNs != 0 && mark.hitNs != 0)
+    {
+        stages[stage_hitTest].record(mark.hitNs - mark.entryNs);
+    }
+    if (mark.hitNs != 0)
+    {
+        stages[stage_dispatch].record(injectStartNs - mark.hitNs);
+    }
+    stages[stage_inject].record(injectEndNs - injectStartNs);
+    int64_t originNs = mark.touchNs != 0 ? mark.touchNs : (mark.entryNs != 0 ? mark.entryNs : mark.hitNs);
+    if (originNs != 0)
+    {
+        stages[stage_total].record(injectEndNs - originNs);
+    }
+}
+
+/* public */ const latency_histogram& latency_recorder::get_histogram(latency_kind kind, latency_stage stage) const
+{
+    return m_histograms[kind][stage];
+}
+
+// --- dump(): Formats every stage as a text table, one line per kind and stage, times in microseconds.
+// Safe to call while events are still being recorded, a line may then be off by the event in flight.
+// ------- returns: The table, ending in a newline.
+// --------------------------------------------------------------------------------------------/
+/* public */ std::string latency_recorder::dump() const
+{
+    static constexpr const char* kindNames[kind_count] = { "key", "click", "move" };
+    static constexpr const char* stageNames[stage_count] = { "queue", "hit-test", "dispatch", "inject", "total" };
+    std::string text = "latency (us)           count        p50        p99      p99.9        max\n";
+    char line[128];
+    for (uint32_t kind = 0; kind < kind_count; kind++)
+    {
+        for (uint32_t stage = 0; stage < stage_count; stage++)
+        {
+            const latency_histogram& histogram = m_histograms[kind][stage];
+            std::snprintf(line, sizeof(line), "%-6s%-10s %10llu %10.1f %10.1f %10.1f %10.1f\n", kindNames[kind], stageNames[stage],
+                static_cast<unsigned long long>(histogram.get_count()), to_us(histogram.get_percentile(50.0)),
+                to_us(histogram.get_percentile(99.0)), to_us(histogram.get_percentile(99.9)), to_us(histogram.get_max()));
+            text.append(line);
+        }
+    }
+    return text;
+}
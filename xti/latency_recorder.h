@@ -0,0 +1,79 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef LATENCY_RECORDER_H
+#define LATENCY_RECORDER_H
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <cstdint>
+#include <string>
+// 4. Project classes
+#include "latency_histogram.h"
+// 5. Forward decl
+
+enum latency_kind : uint8_t
+{
+    kind_key,
+    kind_click,
+    kind_move,
+    kind_count
+};
+
+// Each stage is the time between two consecutive checkpoints of latency_mark, then the injection call.
+enum latency_stage : uint8_t
+{
+    stage_queue, // touch timestamp from the OS -> main_window::event() picked it up
+    stage_hitTest, // event() picked it up -> key or zone resolved
+    stage_dispatch, // resolved -> injection call made (includes the input_worker queue and move coalescing)
+    stage_inject, // injection call -> injection call returned
+    stage_total, // touch timestamp (or event() if unknown) -> injection call returned
+    stage_count
+};
+
+// Steady clock checkpoints (latency_recorder::now_ns()) of one touch on its way to the OS, 0 when not taken.
+struct latency_mark
+{
+    int64_t touchNs;
+    int64_t entryNs;
+    int64_t hitNs;
+};
+
+// Per-stage latency_histograms for keys, clicks and cursor moves.
+// Keys are recorded on the UI thread, clicks and moves on the input_worker thread. Each histogram therefore
+// has a single writer, and dump() can be called from anywhere at any time.
+class latency_recorder
+{
+public:
+    // public now_ns(): Steady clock time used for every checkpoint.
+    static int64_t now_ns();
+
+    // public record(): Records every stage of one injected event.
+    // see cpp file for more info.
+    void record(latency_kind kind, const latency_mark& mark, int64_t injectStartNs, int64_t injectEndNs);
+
+    // public get_histogram(): Gets the histogram of one stage, for callers that want more than dump().
+    const latency_histogram& get_histogram(latency_kind kind, latency_stage stage) const;
+
+    // public dump(): Formats count, p50, p99, p99.9 and max of every stage as a text table.
+    // see cpp file for more info.
+    std::string dump() const;
+
+private:
+    latency_histogram m_histograms[kind_count][stage_count];
+};
+
+#endif // LATENCY_RECORDER_H
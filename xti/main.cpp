@@ -15,15 +15,60 @@
 
 // 1. Qt framework headers
 #include <QApplication>
+#include <QByteArray>
+#include <QFile>
+#include <QIODevice>
+#include <QString>
 // 2. System/OS headers
 #include <combaseapi.h>
 // 3. C++ standard library headers
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 // 4. Project classes
 #include "error_reporter.h"
 #include "main_window.h"
+#include "startup_profiler.h"
+#include "touch_replay.h"
+#include "touch_trace.h"
 
 int main(int argc, char *argv[])
 {
+    startup_profiler profiler;
+    // --record <file>: writes every touch xti handles, and the keys it injected, to a trace file on exit.
+    // --replay <file> [--fast]: replays a trace through an offscreen window instead of running, see touch_replay.
+    // --handover <server> <window>: takes over from the instance that restarted into this one, see main_window::ui_on_restart().
+    const char* recordPath = nullptr;
+    const char* replayPath = nullptr;
+    bool replayFast = false;
+    const char* handoverServer = nullptr;
+    uint64_t handoverWindow = 0;
+    for (int32_t i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+        {
+            recordPath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+        {
+            replayPath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--fast") == 0)
+        {
+            replayFast = true;
+        }
+        else if (std::strcmp(argv[i], "--handover") == 0 && i + 2 < argc)
+        {
+            handoverServer = argv[++i];
+            handoverWindow = std::strtoull(argv[++i], nullptr, 10);
+        }
+    }
+    if (replayPath != nullptr)
+    {
+        // Has to be set before the QApplication picks its platform plugin.
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
     // Used by ShellExecuteW in windows_subsystem.cpp
     int32_t r = ::CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED | COINIT_DISABLE_OLE1DDE);
     if (r != S_OK)
@@ -42,7 +87,32 @@ int main(int argc, char *argv[])
     }
     QApplication a(argc, argv);
     a.setStyle("fusion");
-    main_window w(nullptr);
+    profiler.mark(phase_qtInit);
+    if (replayPath != nullptr)
+    {
+        return touch_replay::run(QString::fromLocal8Bit(replayPath), replayFast);
+    }
+    touch_trace_writer recorder;
+    main_window w(nullptr, nullptr, false, &profiler);
+    if (recordPath != nullptr)
+    {
+        w.set_touch_recorder(&recorder);
+    }
+    if (handoverServer != nullptr)
+    {
+        w.set_handover(QString::fromLocal8Bit(handoverServer), handoverWindow);
+    }
     w.show();
-    return a.exec();
+    r = a.exec();
+    if (recordPath != nullptr)
+    {
+        const std::vector<uint8_t>& trace = recorder.finish();
+        QFile traceFile(QString::fromLocal8Bit(recordPath));
+        if (!traceFile.open(QIODevice::WriteOnly) ||
+            traceFile.write(reinterpret_cast<const char*>(trace.data()), static_cast<qint64>(trace.size())) != static_cast<qint64>(trace.size()))
+        {
+            error_reporter::stop(__FILE__, __LINE__, "Cannot write the --record trace file.");
+        }
+    }
+    return r;
 }
@@ -24,124 +24,93 @@
 #include <QPalette>
 #include <QBrush>
 #include <QColor>
+#include <QStandardPaths>
 #include <QFile>
 #include <QIODevice>
-#include <QStandardPaths>
-#include <QByteArray>
 #include <QDir>
-#include <QJsonArray>
-#include <QJsonObject>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QSignalBlocker>
 #include <QTimer>
-#include <QVariant>
 #include <QEvent>
 #include <QList>
 #include <QTouchEvent>
 #include <QEventPoint>
+#include <QRect>
+#include <QScreen>
+#include <QDebug>
+#include <QDateTime>
+#include <QMetaObject>
+#include <QCoreApplication>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QStringList>
+#include <QClipboard>
+#include <QGuiApplication>
 // 2. System/OS headers
 // 3. C++ standard library headers
 #include <string>
 #include <cctype>
 #include <algorithm>
-#include <thread>
+#include <cmath>
+#include <memory>
+#include <functional>
+#include <utility>
+#include <cstddef>
 // 4. Project classes
 #include "windows_subsystem.h"
 #include "touchpad_cursor.h"
 #include "key_mapping.h"
+#include "key_chord.h"
+#include "key_dispatcher.h"
+#include "windows_input_sink.h"
+#include "windows_layout_source.h"
+#include "input_worker.h"
+#include "app_config_loader.h"
 #include "error_reporter.h"
 
-const char configError[] = "Invalid XTI config at ~/xti.json. Read the README.md.";
+const char configInvalidError[] = "Invalid XTI config at ~/xti.json. Read the README.md.";
+// Touches landing in the small gaps between keys go to the key with the nearest centre rather than nowhere.
+const bool snapTouchesToNearestKey = true;
 
-main_window::main_window(QWidget *parent)
+main_window::main_window(QWidget *parent, input_sink* sink, bool headless, startup_profiler* profiler)
     : QMainWindow(parent)
+    , m_headless(headless)
     , ui(new Ui::main_window)
+    , m_startupProfiler(profiler)
 {
     ui->setupUi(this);
+    mark_startup(phase_uiSetup);
+    m_inputSink = sink != nullptr ? sink : new windows_input_sink();
+    m_inputWorker = new input_worker(m_inputSink, &m_latency);
+    if (!m_headless)
+    {
+        // A sink of its own, send_keys() is not safe to call from the UI thread and the typing thread at once.
+        m_textSink = new windows_input_sink();
+        m_textInjector = new text_injector(m_textSink);
+    }
+    // Window management never runs on the UI thread, results come back as queued calls on this window.
+    m_windowExecutor = new window_executor(
+        [this](std::function<void()> function) { QMetaObject::invokeMethod(this, std::move(function), Qt::QueuedConnection); },
+        &windows_subsystem::initialize_worker_thread, &windows_subsystem::cleanup_worker_thread);
 
     // STEP 1: Make window top-most with no border + make background translucent.
     setWindowFlags(Qt::FramelessWindowHint | Qt::WindowStaysOnTopHint);
     setAttribute(Qt::WA_TranslucentBackground);
     setAttribute(Qt::WA_AcceptTouchEvents);
 
-    // STEP 2: Load app config. Assumes UTF-8 encoding.
-    QFile configFile(QDir::homePath() + "/xti.json");
-    if (!configFile.open(QIODevice::ReadOnly))
-    {
-        error_reporter::stop(__FILE__, __LINE__, configError);
-    }
-    QByteArray configData = configFile.readAll();
-    configFile.close();
-    m_appConfig = QJsonDocument::fromJson(configData);
-
-    // STEP 3: Validate config so we can trust it later.
-    if (!m_appConfig.isArray())
-    {
-        error_reporter::stop(__FILE__, __LINE__, configError);
-    }
-    QJsonArray configEntries = m_appConfig.array();
-    for (qsizetype i = 0; i < configEntries.size(); i++)
+    // STEP 2: Load and validate app config so we can trust it later. Later edits are picked up by reload_config().
+    QString configError;
+    // Replays (e.g. under ctest) run fine without shortcuts, a machine with no ~/xti.json still replays.
+    bool replayWithoutConfig = m_headless && !QFile::exists(app_config_loader::get_path());
+    if (!replayWithoutConfig && !app_config_loader::load(app_config_loader::get_path(), m_config, configError))
     {
-        QJsonValueRef entry = configEntries[i];
-        if (!entry.isObject())
-        {
-            error_reporter::stop(__FILE__, __LINE__, configError);
-        }
-        QJsonObject obj = entry.toObject();
-        QJsonObject::iterator displayName = obj.find("displayName");
-        QJsonObject::iterator startExePath = obj.find("startExePath");
-        QJsonObject::iterator startParams = obj.find("startParams");
-        QJsonObject::iterator startWorkingDir = obj.find("startWorkingDir");
-        QJsonObject::iterator checkExeName = obj.find("checkExeName");
-        QJsonObject::iterator checkTitleName = obj.find("checkTitleName");
-        QJsonObject::iterator above = obj.find("above");
-        if (displayName == obj.end() ||
-            startExePath == obj.end() ||
-            startParams == obj.end() ||
-            startWorkingDir == obj.end() ||
-            checkExeName == obj.end() ||
-            checkTitleName == obj.end() ||
-            above == obj.end())
-        {
-            error_reporter::stop(__FILE__, __LINE__, configError);
-        }
-        if (!displayName->isString() ||
-            !startExePath->isString() ||
-            !startParams->isString() ||
-            !startWorkingDir->isString() ||
-            !checkExeName->isString() ||
-            !checkTitleName->isString() ||
-            !above->isBool())
-        {
-            error_reporter::stop(__FILE__, __LINE__, configError);
-        }
-
-        // Replace / with native \ in windows paths.
-        std::wstring startExePathVal = startExePath->toString().toStdWString();
-        for (size_t j = 0; j < startExePathVal.size(); j++)
-        {
-            if (startExePathVal[j] == '/')
-            {
-                startExePathVal[j] = '\\';
-            }
-        }
-        *startExePath = QJsonValue(QString(startExePathVal));
-        std::wstring startWorkingDirVal = startWorkingDir->toString().toStdWString();
-        for (size_t j = 0; j < startWorkingDirVal.size(); j++)
-        {
-            if (startWorkingDirVal[j] == '/')
-            {
-                startWorkingDirVal[j] = '\\';
-            }
-        }
-        *startWorkingDir = QJsonValue(QString(startWorkingDirVal));
-
-        // Make display names uppercase.
-        std::wstring displayNameVal = displayName->toString().toStdWString();
-        std::transform(displayNameVal.begin(), displayNameVal.end(), displayNameVal.begin(), ::toupper);
-        *displayName = QJsonValue(QString(displayNameVal));
-        configEntries[i] = obj;
+        QByteArray message = (QString(configInvalidError) + " " + configError).toUtf8();
+        error_reporter::stop(__FILE__, __LINE__, message.constData());
     }
+    mark_startup(phase_config);
 
-    // STEP 4: Collecting all keyboard push buttons.
+    // STEP 3: Collecting all keyboard push buttons.
     m_keyButtonList.push_back(ui->pushButton_escape);
     m_keyButtonList.push_back(ui->pushButton_f1);
     m_keyButtonList.push_back(ui->pushButton_f2);
@@ -287,13 +256,22 @@ main_window::main_window(QWidget *parent)
     m_keyButtonList.push_back(ui->pushButton_insert);
     m_keyButtonList.push_back(ui->pushButton_delete);
     m_keyButtonList.push_back(ui->pushButton_enter);
+    if (m_keyButtonList.size() != key_count)
+    {
+        error_reporter::stop(__FILE__, __LINE__, "Push button list does not match key_mapping key_id list.");
+    }
     for (size_t i = 0; i < m_keyButtonList.size(); i++)
     {
         // Prevent button corners being able to be pushed-through to desktop.
         m_keyButtonList[i]->setAutoFillBackground(true);
+        // Label texts shown for modifier and lock presses, built here rather than on every press.
+        m_keyTextOn.push_back(m_keyButtonList[i]->text() + QString(L" ON"));
+        m_keyTextOff.push_back(m_keyButtonList[i]->text() + QString(L" OFF"));
     }
 
-    // STEP 5: Collecting all keyboard push buttons (left side).
+    mark_startup(phase_keyLists);
+
+    // STEP 4: Collecting all keyboard push buttons (left side).
     m_keyButtonLeftList.push_back(ui->pushButton_escape);
     m_keyButtonLeftList.push_back(ui->pushButton_f1);
     m_keyButtonLeftList.push_back(ui->pushButton_f2);
@@ -366,7 +344,7 @@ main_window::main_window(QWidget *parent)
     m_keyButtonLeftList.push_back(ui->pushButton_cut);
     m_keyButtonLeftList.push_back(ui->pushButton_paste);
 
-    // STEP 6: Collecting all keyboard push buttons (right side).
+    // STEP 5: Collecting all keyboard push buttons (right side).
     m_keyButtonRightTopList.push_back(ui->pushButton_f7);
     m_keyButtonRightTopList.push_back(ui->pushButton_f8);
     m_keyButtonRightTopList.push_back(ui->pushButton_f9);
@@ -442,24 +420,12 @@ main_window::main_window(QWidget *parent)
     m_keyButtonRightBottomList.push_back(ui->pushButton_delete);
     m_keyButtonRightBottomList.push_back(ui->pushButton_enter);
 
-    // STEP 7: Inserting configured shortcuts.
-    for (QJsonArray::iterator entry = configEntries.begin(); entry != configEntries.end(); ++entry)
-    {
-        QJsonObject obj = entry->toObject();
-        if (obj.find("above")->toBool())
-        {
-            ui->comboBox_shortcutsAbove->addItem(obj.find("displayName")->toString(), obj);
-        }
-        else
-        {
-            ui->comboBox_shortcutsBelow->addItem(obj.find("displayName")->toString(), obj);
-        }
-    }
-
-    // STEP 8: Hook QT buttons and controls.
+    // STEP 6: Hook QT buttons and controls.
     for (size_t i = 0; i < m_keyButtonList.size(); i++)
     {
-        connect(m_keyButtonList[i], &QPushButton::clicked, this, &main_window::ui_on_key_press);
+        // Each button carries its key_id in the connection, so a press never has to look at the button name.
+        key_id id = static_cast<key_id>(i);
+        connect(m_keyButtonList[i], &QPushButton::clicked, this, [this, id]() { ui_on_key_press(id); });
         m_allButtonsList.push_back(m_keyButtonList[i]);
     }
     connect(ui->pushButton_reopenAbove, &QPushButton::clicked, this, &main_window::ui_on_shortcuts_above_reopen);
@@ -478,546 +444,403 @@ main_window::main_window(QWidget *parent)
     m_allButtonsList.push_back(ui->pushButton_panic);
     connect(ui->pushButton_restart, &QPushButton::clicked, this, &main_window::ui_on_restart);
     m_allButtonsList.push_back(ui->pushButton_restart);
+    connect(ui->pushButton_typeClipboard, &QPushButton::clicked, this, &main_window::ui_on_type_clipboard);
+    m_allButtonsList.push_back(ui->pushButton_typeClipboard);
+    m_suggestionButtons = { ui->pushButton_suggestion0, ui->pushButton_suggestion1, ui->pushButton_suggestion2 };
+    for (uint32_t i = 0; i < suggestionCount; i++)
+    {
+        connect(m_suggestionButtons[i], &QPushButton::clicked, this, [this, i]() { ui_on_suggestion(i); });
+        m_allButtonsList.push_back(m_suggestionButtons[i]);
+    }
     for (size_t i = 0; i < m_allButtonsList.size(); i++)
     {
         m_allButtonsList[i]->setAttribute(Qt::WA_TransparentForMouseEvents);
     }
+    mark_startup(phase_signals);
 
-    // STEP 9. Initialize some timers.
+    // STEP 7. Initialize some timers and shared palettes.
     m_cursorMoveTimerDelay = new QTimer(this);
     m_cursorMoveTimerDelay->setSingleShot(true);
     connect(m_cursorMoveTimerDelay, &QTimer::timeout, this, &main_window::ui_on_cursor_move_ready);
+    m_keyRepeatTimer = new QTimer(this);
+    m_keyRepeatTimer->setSingleShot(true);
+    m_keyRepeatTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_keyRepeatTimer, &QTimer::timeout, this, &main_window::ui_on_key_repeat);
+    m_cursorFlushTimer = new QTimer(this);
+    m_cursorFlushTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_cursorFlushTimer, &QTimer::timeout, this, &main_window::ui_on_cursor_motion_flush);
     ui->line->setAutoFillBackground(true);
     ui->line_2->setAutoFillBackground(true);
+    m_paletteDefault = QApplication::palette();
+    m_palettePressed = m_paletteDefault;
+    m_palettePressed.setColor(QPalette::Button, Qt::blue);
+    m_paletteModifier = m_paletteDefault;
+    m_paletteModifier.setColor(QPalette::Button, Qt::darkCyan);
+    m_paletteMouse = m_paletteDefault;
+    m_paletteMouse.setColor(QPalette::Button, Qt::red);
+    m_keyVisuals.assign(key_count, 0);
+    m_keyLeftIds = to_key_ids(m_keyButtonLeftList);
+    m_keyRightTopIds = to_key_ids(m_keyButtonRightTopList);
+    m_keyRightBottomIds = to_key_ids(m_keyButtonRightBottomList);
+    m_paletteActiveKey = ui->label_activeKey->palette();
+    m_paletteActiveKey.setColor(QPalette::WindowText, Qt::cyan);
+    // Editors often save several times in a row, or replace the file, so changes settle before a reload.
+    m_configWatcher = new QFileSystemWatcher(this); // watching starts once the combo boxes are filled
+    connect(m_configWatcher, &QFileSystemWatcher::fileChanged, this, &main_window::ui_on_config_changed);
+    connect(m_configWatcher, &QFileSystemWatcher::directoryChanged, this, &main_window::ui_on_config_changed);
+    m_configSettleTimer = new QTimer(this);
+    m_configSettleTimer->setSingleShot(true);
+    connect(m_configSettleTimer, &QTimer::timeout, this, &main_window::reload_config);
+    m_keyLayoutTimer = new QTimer(this);
+    m_keyLayoutTimer->setSingleShot(true);
+    m_keyLayoutTimer->setInterval(100);
+    connect(m_keyLayoutTimer, &QTimer::timeout, this, &main_window::refresh_key_layout);
+    m_handoverTimeout = new QTimer(this);
+    m_handoverTimeout->setSingleShot(true);
+    connect(m_handoverTimeout, &QTimer::timeout, this, [this]() { abort_handover("timed out"); });
+    mark_startup(phase_timers);
 
-    // STEP 10: Final system setup.
-    windows_subsystem::initialize_apply_keyboard_window_style(reinterpret_cast<HWND>(winId()));
-    windows_subsystem::initialize_disable_touch_input();
-    key_mapping::initialize();
+    // STEP 8: Final system setup.
+    if (!m_headless)
+    {
+        windows_subsystem::initialize_apply_keyboard_window_style(reinterpret_cast<HWND>(winId()));
+        windows_subsystem::initialize_disable_touch_input();
+    }
+    mark_startup(phase_windowStyle);
     // continue at post_ctor after win32 message pump has had the opportunity to process above changes.
     QTimer::singleShot(0, this, &main_window::ui_on_post_ctor);
 }
 
 main_window::~main_window()
 {
-    windows_subsystem::cleanup_disable_touch_input();
+    dump_latency();
+    delete m_windowExecutor; // joins, must go before what its requests use
+    if (!m_headless)
+    {
+        windows_subsystem::cleanup_window_registry();
+        windows_subsystem::cleanup_keyboard_hook();
+        windows_subsystem::cleanup_disable_touch_input();
+    }
     delete m_cursor;
+    delete m_textInjector; // cancels and joins, must go before the sink it types into
+    delete m_textSink;
+    delete m_inputWorker; // joins the worker, must go before the sink it injects into
+    delete m_inputSink;
     delete ui;
 }
 
-void main_window::ui_on_post_ctor() {
-    // Needs to be after the window has been constructed, otherwise certain resize values get ignored.
-    m_appDimensions = windows_subsystem::initialize_orientate_main_window(reinterpret_cast<HWND>(winId()));
-    setFixedSize(size());
-    m_keyModifiers = windows_subsystem::get_key_modifiers();
-    update_modifier_colors();
-
-    m_cursor = new touchpad_cursor(nullptr);
-    m_cursor->show();
-
-    QTimer* timer = new QTimer(this);
-    connect(timer, &QTimer::timeout, this, &main_window::ui_on_state_refresher_loop);
-    timer->start(3000);
+void main_window::set_touch_recorder(touch_trace_writer* recorder)
+{
+    m_touchRecorder = recorder;
 }
 
-void main_window::ui_on_state_refresher_loop()
+void main_window::set_handover(const QString& serverName, uint64_t previousWindow)
 {
-    std::wstring text = windows_subsystem::get_focus_window_name();
-    if (text.length() > 38)
+    m_handoverServerName = serverName;
+    m_handoverPreviousWindow = previousWindow;
+    // The instance being replaced keeps taking touches until the state has been handed over.
+    m_inputReleased = true;
+}
+
+void main_window::ui_on_post_ctor() {
+    mark_startup(phase_shown);
+    if (m_headless)
     {
-        text = text.substr(0, 38);
-        text.append(L"...");
+        setFixedSize(size());
+        m_hitIndexDirty = true;
+        update_modifier_colors();
+        QTimer::singleShot(0, this, &main_window::ui_on_deferred_init);
+        return;
     }
-    ui->label_activeWindow->setText(QString::fromStdWString(text));
-    m_keyModifiers = windows_subsystem::get_key_modifiers();
-    if (!m_cursorIsMoving)
+    if (!m_handoverServerName.isEmpty())
     {
-        update_modifier_colors();
+        // Warm up out of sight behind the instance being replaced, it stays on top until the handover is done.
+        windows_subsystem::place_window_below(reinterpret_cast<HWND>(winId()), reinterpret_cast<HWND>(m_handoverPreviousWindow));
     }
+    // Needs to be after the window has been constructed, otherwise certain resize values get ignored.
+    m_appDimensions = windows_subsystem::initialize_orientate_main_window(reinterpret_cast<HWND>(winId()));
+    setFixedSize(size());
+    m_hitIndexDirty = true;
+    mark_startup(phase_orientate);
+    // From here on the modifier state is kept up to date by the keyboard hook, the OS is never asked again.
+    m_modifierState.adopt(windows_subsystem::get_key_modifiers());
+    windows_subsystem::initialize_keyboard_hook(&main_window::on_hooked_key_event, this);
+    refresh_key_layout();
+    update_modifier_colors();
+    mark_startup(phase_keyboardHook);
+    // Keys work from here. Everything a key press does not need waits until the events queued so far are handled.
+    QTimer::singleShot(0, this, &main_window::ui_on_deferred_init);
 }
 
-void main_window::open_or_show_app(const QVariant& shortcutConfig)
+// Startup work the first key press does not depend on: the shortcut combo boxes, window tracking (which looks up
+// the process of every open window) and the touchpad cursor overlay.
+void main_window::ui_on_deferred_init()
 {
-    QJsonObject jsonObj = shortcutConfig.toJsonObject();
-    std::wstring checkExeName = jsonObj.find("checkExeName")->toString().toStdWString();
-    std::wstring checkTitleName = jsonObj.find("checkTitleName")->toString().toStdWString();
-    bool isAbove = jsonObj.find("above")->toBool();
-    if (windows_subsystem::is_process_running(checkExeName))
+    // Each combo box lists m_config's shortcuts in the same order.
+    for (bool above : { true, false })
     {
-        HWND window = windows_subsystem::get_window(checkExeName, checkTitleName);
-        if (window != nullptr)
+        QComboBox* comboBox = above ? ui->comboBox_shortcutsAbove : ui->comboBox_shortcutsBelow;
+        const std::vector<shortcut_config>& shortcuts = m_config.get_shortcuts(above);
+        QSignalBlocker blocker(comboBox);
+        for (size_t i = 0; i < shortcuts.size(); i++)
         {
-            windows_subsystem::move_window(window, isAbove, m_appDimensions);
-            return;
+            comboBox->addItem(QString::fromStdWString(shortcuts[i].displayName));
         }
     }
-
-    // Not found, start it.
-    std::wstring startExePath = jsonObj.find("startExePath")->toString().toStdWString();
-    std::wstring startParams = jsonObj.find("startParams")->toString().toStdWString();
-    std::wstring startWorkingDir = jsonObj.find("startWorkingDir")->toString().toStdWString();
-    windows_subsystem::start_process(startExePath, startParams, startWorkingDir, checkExeName, checkTitleName, isAbove, m_appDimensions);
-}
-
-void main_window::ui_on_key_press()
-{
-    if (m_cursorIsHooked)
+    m_configWatcher->addPath(app_config_loader::get_path());
+    mark_startup(phase_shortcuts);
+    if (m_headless)
     {
+        log_startup();
         return;
     }
-    QPushButton* srcButton = qobject_cast<QPushButton*>(sender());
-    bool modChanged = false;
-    bool modOn = false;
-    // Key press back color changes -> Key modifiers and locks.
-    if (srcButton == ui->pushButton_shift ||
-        srcButton == ui->pushButton_control ||
-        srcButton == ui->pushButton_windows ||
-        srcButton == ui->pushButton_alt ||
-        srcButton == ui->pushButton_scrollLock ||
-        srcButton == ui->pushButton_numLock ||
-        srcButton == ui->pushButton_capsLock)
-    {
-        modChanged = true;
-    }
-    // Everything else
-    else
-    {
-        QPalette palette = srcButton->palette();
-        palette.setColor(QPalette::Button, Qt::blue);
-        srcButton->setPalette(palette);
 
-        QPalette defaultPalette = QApplication::palette();
-        for (size_t i = 0; i < m_keyButtonList.size(); i++)
-        {
-            QPushButton* dstButton = m_keyButtonList[i];
-            if (dstButton == ui->pushButton_shift ||
-                dstButton == ui->pushButton_control ||
-                dstButton == ui->pushButton_windows ||
-                dstButton == ui->pushButton_alt ||
-                dstButton == ui->pushButton_scrollLock ||
-                dstButton == ui->pushButton_numLock ||
-                dstButton == ui->pushButton_capsLock)
-            {
-                continue;
-            }
-            if (srcButton != dstButton) {
-                dstButton->setPalette(defaultPalette);
-            }
-        }
-    }
+    windows_subsystem::initialize_window_registry();
+    windows_subsystem::set_launch_callback(&main_window::on_launch_finished, this);
+    windows_subsystem::set_window_placer(&main_window::on_place_window, this);
+    windows_subsystem::set_foreground_listener(&main_window::on_foreground_changed, this);
+    mark_startup(phase_windowRegistry);
 
-    // Send off the key press.
-    std::wstring buttonName = srcButton->objectName().toStdWString();
-    auto keyCode = key_mapping::translateSet.find(buttonName);
-    if (keyCode == key_mapping::translateSet.end())
-    {
-        error_reporter::stop(__FILE__, __LINE__, "Missing key_mapping entry for pushButton.");
-    }
-    int32_t virtualKeyCode = keyCode->second;
-    ::INPUT input = {};
-    input.type = INPUT_KEYBOARD;
-    int32_t r;
-
-    // Long if else chain for handling all QPushButton keyboard keys on the UI.
-    bool toggleControl = false;
-    bool toggleShift = false;
-    // CHAIN 1: PASS THROUGH PIPE
-    if ((virtualKeyCode == VK_ESCAPE) ||
-        (virtualKeyCode >= VK_F1 && virtualKeyCode <= VK_F12) ||
-        (virtualKeyCode == VK_BACK) ||
-        (virtualKeyCode >= 0x30 && virtualKeyCode <= 0x39) || // 0-9 numbers.
-        (virtualKeyCode == VK_MEDIA_PLAY_PAUSE) ||
-        (virtualKeyCode == VK_VOLUME_MUTE) ||
-        (virtualKeyCode == VK_MEDIA_NEXT_TRACK) ||
-        (virtualKeyCode == VK_MEDIA_PREV_TRACK) ||
-        (virtualKeyCode == VK_VOLUME_UP) ||
-        (virtualKeyCode == VK_VOLUME_DOWN) ||
-        (virtualKeyCode == VK_SPACE) ||
-        (virtualKeyCode == VK_UP) ||
-        (virtualKeyCode == VK_DOWN) ||
-        (virtualKeyCode == VK_LEFT) ||
-        (virtualKeyCode == VK_RIGHT) ||
-        (virtualKeyCode == VK_DELETE) ||
-        (virtualKeyCode == VK_RETURN) ||
-        (virtualKeyCode == VK_SNAPSHOT) ||
-        (virtualKeyCode == VK_PRIOR) ||
-        (virtualKeyCode == VK_NEXT) ||
-        (virtualKeyCode == VK_HOME) ||
-        (virtualKeyCode == VK_END) ||
-        (virtualKeyCode == VK_TAB) ||
-        (virtualKeyCode == VK_APPS) ||
-        (virtualKeyCode == VK_INSERT) ||
-        (virtualKeyCode == VK_PAUSE))
-    {
-        input.ki.wVk = virtualKeyCode;
-    }
-    // CHAIN 2: ALPHABET
-    else if (virtualKeyCode >= 0x41 && virtualKeyCode <= 0x5A)
-    {
-        input.ki.wVk = virtualKeyCode;
-        if (buttonName[11] == ::toupper(buttonName[11]))
-        {
-            toggleShift = true;
-        }
-    }
-    // CHAIN 3: VK_OEM_1 EXTENSIONS
-    else if (virtualKeyCode == VK_OEM_1)
+    m_cursor = new touchpad_cursor(nullptr);
+    m_cursor->show();
+    mark_startup(phase_cursorOverlay);
+    log_startup();
+    load_dictionary();
+    if (!m_handoverServerName.isEmpty())
     {
-        input.ki.wVk = VK_OEM_1;
-        if (buttonName == L"pushButton_colon")
-        {
-            toggleShift = true;
-        }
+        // Everything is up and the hooks are in, only now ask the old instance to let go.
+        start_handover_client();
     }
-    // CHAIN 4: VK_OEM_2 EXTENSIONS
-    else if (virtualKeyCode == VK_OEM_2)
+}
+
+void main_window::mark_startup(startup_phase phase)
+{
+    if (m_startupProfiler != nullptr)
     {
-        input.ki.wVk = VK_OEM_2;
-        if (buttonName == L"pushButton_questionMark")
-        {
-            toggleShift = true;
-        }
+        m_startupProfiler->mark(phase);
     }
-    // CHAIN 5: VK_OEM_3 EXTENSIONS
-    else if (virtualKeyCode == VK_OEM_3)
+}
+
+// Appends the startup report to startup.log in the app's local data directory, one report per start.
+void main_window::log_startup()
+{
+    if (m_startupProfiler == nullptr)
     {
-        input.ki.wVk = VK_OEM_3;
-        if (buttonName == L"pushButton_tilde")
-        {
-            toggleShift = true;
-        }
+        return;
     }
-    // CHAIN 6: VK_OEM_4 EXTENSIONS
-    else if (virtualKeyCode == VK_OEM_4)
+    QString report = QString::fromStdString(m_startupProfiler->report("xti " XTI_VERSION ", built " __DATE__ " " __TIME__));
+    m_startupProfiler = nullptr;
+    append_log("startup.log", report.toUtf8() + "\n");
+}
+
+// Appends text to a log in the app's local data directory (a WIN32 exe has no console), shows LOG ERROR if it can't.
+bool main_window::append_log(const QString& fileName, const QByteArray& text)
+{
+    QString directory = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
+    QFile logFile(directory + "/" + fileName);
+    if (!QDir().mkpath(directory) || !logFile.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text))
     {
-        input.ki.wVk = VK_OEM_4;
-        if (buttonName == L"pushButton_leftBraces")
-        {
-            toggleShift = true;
-        }
+        show_status("LOG ERROR", "cannot write " + QDir::toNativeSeparators(logFile.fileName()));
+        return false;
     }
-    // CHAIN 7: VK_OEM_5 EXTENSIONS
-    else if (virtualKeyCode == VK_OEM_5)
+    logFile.write(text);
+    return true;
+}
+
+// Called on the UI thread straight from the foreground WinEvent, so the label follows focus within a frame.
+void main_window::on_foreground_changed(void* context, const window_info* info)
+{
+    main_window* self = static_cast<main_window*>(context);
+    self->refresh_key_layout();
+    self->reset_typed_word(); // the caret is somewhere else now
+    if (info == nullptr)
     {
-        input.ki.wVk = VK_OEM_5;
-        if (buttonName == L"pushButton_verticalSlash")
-        {
-            toggleShift = true;
-        }
+        self->ui->label_activeWindow->setText(QString());
+        return;
     }
-    // CHAIN 8: VK_OEM_6 EXTENSIONS
-    else if (virtualKeyCode == VK_OEM_6)
+    QString text = QString::fromStdWString(info->title);
+    if (text.length() > 38)
     {
-        input.ki.wVk = VK_OEM_6;
-        if (buttonName == L"pushButton_rightBraces")
-        {
-            toggleShift = true;
-        }
+        text.truncate(38);
+        text.append("...");
     }
-    // CHAIN 9: VK_OEM_7 EXTENSIONS
-    else if (virtualKeyCode == VK_OEM_7)
+    self->ui->label_activeWindow->setText(text);
+}
+
+void main_window::open_or_show_app(const shortcut_config* shortcut)
+{
+    if (m_headless || shortcut == nullptr)
     {
-        input.ki.wVk = VK_OEM_7;
-        if (buttonName == L"pushButton_doubleQuote")
-        {
-            toggleShift = true;
-        }
+        return; // replayed touches must never start or move real apps, and a reload may have emptied the list
     }
-    // CHAIN 10: VK_OEM_MINUS EXTENSIONS
-    else if (virtualKeyCode == VK_OEM_MINUS)
+    if (!shortcut->snippet.empty())
     {
-        input.ki.wVk = VK_OEM_MINUS;
-        if (buttonName == L"pushButton_underscore")
-        {
-            toggleShift = true;
-        }
+        type_text(QString::fromStdWString(shortcut->snippet));
+        return;
     }
-    // CHAIN 11: VK_OEM_PLUS EXTENSIONS
-    else if (virtualKeyCode == VK_OEM_PLUS)
-    {
-        input.ki.wVk = VK_OEM_PLUS;
-        if (buttonName == L"pushButton_plus")
-        {
-            toggleShift = true;
-        }
+    std::wstring checkExeName = shortcut->checkExeName;
+    std::wstring checkTitleName = shortcut->checkTitleName;
+    bool isAbove = shortcut->above;
+    uint32_t jobKey = isAbove ? windowJobShortcutAbove : windowJobShortcutBelow;
+    app_dimensions dimensions = m_appDimensions;
+    // The window registry lookup is a hash probe and stays on the UI thread, everything that talks to
+    // other processes goes to the window executor.
+    // The window registry only holds windows of running processes, no need to check the process first.
+    HWND window = windows_subsystem::get_window(checkExeName, checkTitleName);
+    if (window != nullptr)
+    {
+        m_windowExecutor->submit(jobKey, [window, isAbove, dimensions]() { windows_subsystem::move_window(window, isAbove, dimensions); }, nullptr);
+        return;
     }
-    // CHAIN 12: VK_OEM_PERIOD EXTENSIONS
-    else if (virtualKeyCode == VK_OEM_PERIOD)
-    {
-        input.ki.wVk = VK_OEM_PERIOD;
-        if (buttonName == L"pushButton_greaterThan")
+
+    // Not found, start it. The launch tracking lives on the UI thread, so it picks up from the completion.
+    std::wstring startExePath = shortcut->startExePath;
+    std::wstring startParams = shortcut->startParams;
+    std::wstring startWorkingDir = shortcut->startWorkingDir;
+    std::shared_ptr<::HANDLE> process = std::make_shared<::HANDLE>(nullptr);
+    std::shared_ptr<bool> started = std::make_shared<bool>(false);
+    m_windowExecutor->submit(jobKey,
+        [startExePath, startParams, startWorkingDir, isAbove, dimensions, process, started]()
         {
-            toggleShift = true;
-        }
-    }
-    // CHAIN 13: VK_OEM_COMMA EXTENSIONS
-    else if (virtualKeyCode == VK_OEM_COMMA)
-    {
-        input.ki.wVk = VK_OEM_COMMA;
-        if (buttonName == L"pushButton_lessThan")
+            *started = windows_subsystem::start_process(startExePath, startParams, startWorkingDir, isAbove, dimensions, *process);
+        },
+        [checkExeName, checkTitleName, isAbove, dimensions, process, started]()
         {
-            toggleShift = true;
-        }
-    }
-    // CHAIN 14: NUMBERS SHIFT
-    else if (virtualKeyCode == VK_XTI_CUSTOM_EXCLAMATION_MARK)
-    {
-        input.ki.wVk = 0x31; // 1
-        toggleShift = true;
-    }
-    else if (virtualKeyCode == VK_XTI_CUSTOM_AT)
-    {
-        input.ki.wVk = 0x32; // 2
-        toggleShift = true;
-    }
-    else if (virtualKeyCode == VK_XTI_CUSTOM_HASH)
-    {
-        input.ki.wVk = 0x33; // 3
-        toggleShift = true;
-    }
-    else if (virtualKeyCode == VK_XTI_CUSTOM_DOLLAR)
-    {
-        input.ki.wVk = 0x34; // 4
-        toggleShift = true;
-    }
-    else if (virtualKeyCode == VK_XTI_CUSTOM_PERCENT)
-    {
-        input.ki.wVk = 0x35; // 5
-        toggleShift = true;
-    }
-    else if (virtualKeyCode == VK_XTI_CUSTOM_CIRCUMFLEX)
-    {
-        input.ki.wVk = 0x36; // 6
-        toggleShift = true;
-    }
-    else if (virtualKeyCode == VK_XTI_CUSTOM_AMPERSAND)
-    {
-        input.ki.wVk = 0x37; // 7
-        toggleShift = true;
-    }
-    else if (virtualKeyCode == VK_XTI_CUSTOM_ASTERISK)
-    {
-        input.ki.wVk = 0x38; // 8
-        toggleShift = true;
-    }
-    else if (virtualKeyCode == VK_XTI_CUSTOM_LEFT_ROUND_BRACKET)
-    {
-        input.ki.wVk = 0x39; // 9
-        toggleShift = true;
-    }
-    else if (virtualKeyCode == VK_XTI_CUSTOM_RIGHT_ROUND_BRACKET)
-    {
-        input.ki.wVk = 0x30; // 0
-        toggleShift = true;
-    }
-    // CHAIN 15: CUSTOM KEY COMBINATORS
-    else if (virtualKeyCode == VK_XTI_CUSTOM_COPY)
-    {
-        input.ki.wVk = 0x43; // C
-        toggleControl = true;
-    }
-    else if (virtualKeyCode == VK_XTI_CUSTOM_PASTE)
+            if (*started)
+            {
+                windows_subsystem::track_launch(*process, checkExeName, checkTitleName, isAbove, dimensions);
+            }
+        });
+}
+
+void main_window::on_place_window(void* context, ::HWND window, bool above, const app_dimensions& dimensions)
+{
+    main_window* self = static_cast<main_window*>(context);
+    app_dimensions placeDimensions = dimensions;
+    self->m_windowExecutor->submit(0, [window, above, placeDimensions]() { windows_subsystem::move_window(window, above, placeDimensions); }, nullptr);
+}
+
+// Only an app whose window never showed up is worth telling about, a placed one is in front of the user already.
+void main_window::on_launch_finished(void* context, const launch_result& result)
+{
+    main_window* self = static_cast<main_window*>(context);
+    if (result.placed)
     {
-        input.ki.wVk = 0x56; // V
-        toggleControl = true;
+        // Placed launches stay silent, their latency shows up in dump_latency().
+        self->m_launchLatency.record(static_cast<int64_t>(result.latencyMs) * 1000000);
+        return;
     }
-    else if (virtualKeyCode == VK_XTI_CUSTOM_FIND_FILE)
+    self->m_launchTimeouts++;
+    self->show_status("NO WINDOW", QString("%1 showed no window within %2 ms").arg(QString::fromStdWString(result.exeNameUpper)).arg(result.latencyMs));
+}
+
+void main_window::ui_on_key_press(key_id id)
+{
+    if (m_cursorIsHooked)
     {
-        input.ki.wVk = 0x4E; // N
-        toggleShift = true;
-        toggleControl = true;
+        return;
     }
-    else if (virtualKeyCode == VK_XTI_CUSTOM_FIND)
+    // Send off the key press first, visual feedback happens in post_key_press() once it's with the OS.
+    key_press_outcome outcome = key_dispatcher::press(m_keyLayout, id, m_modifierState, *m_inputSink);
+    if (!outcome.sent)
     {
-        input.ki.wVk = 0x46; // F
-        toggleControl = true;
+        error_reporter::stop(__FILE__, __LINE__, "Win32::SendInput() failure.");
     }
-    else if (virtualKeyCode == VK_XTI_CUSTOM_FIND_ALL)
+    record_keys(outcome.chord, outcome.injectStartNs, outcome.injectEndNs);
+    post_key_press(id, outcome.modChanged, outcome.modOn);
+    // CTRL+SHIFT+F12 on xti itself also saves the latency histograms, the chord has still gone out as normal.
+    if (id == key_f12 && m_modifierState.get().control && m_modifierState.get().shift)
     {
-        input.ki.wVk = 0x46; // F
-        toggleShift = true;
-        toggleControl = true;
+        dump_latency();
     }
-    else if (virtualKeyCode == VK_XTI_CUSTOM_CUT)
+}
+
+// Bookkeeping of an injected chord: its latency if it came from a touch, and the touch recorder if one is running.
+void main_window::record_keys(const key_chord& chord, int64_t injectStartNs, int64_t injectEndNs)
+{
+    // Only presses that came from a touch have checkpoints, and each touch is recorded once.
+    if (m_touchMark.hitNs != 0)
     {
-        input.ki.wVk = 0x58; // X
-        toggleControl = true;
+        m_latency.record(kind_key, m_touchMark, injectStartNs, injectEndNs);
+        m_touchMark.hitNs = 0;
     }
-    else if (virtualKeyCode == VK_XTI_CUSTOM_UNDO)
+    if (m_touchRecorder != nullptr)
     {
-        input.ki.wVk = 0x5A; // Z
-        toggleControl = true;
+        m_touchRecorder->add_keys(chord.strokes, chord.count);
     }
-    else if (virtualKeyCode == VK_XTI_CUSTOM_REDO)
+}
+
+// Windows only tells the focused window about a layout switch (WM_INPUTLANGCHANGE) and xti never has the focus.
+// A foreground change is one notification. A switch within the same window comes from a physical hotkey (e.g.
+// Alt+Shift, Win+Space), so the keyboard hook re-checks shortly after the user's own keys, see m_keyLayoutTimer.
+// The tables are only rebuilt when the foreground thread's layout handle differs.
+void main_window::refresh_key_layout()
+{
+    if (m_headless)
     {
-        input.ki.wVk = 0x59; // Y
-        toggleControl = true;
+        return; // replays always use the US defaults, so traces stay comparable
     }
-    // CHAIN 16: KEY LOCKS
-    else if (virtualKeyCode == VK_CAPITAL ||
-             virtualKeyCode == VK_SCROLL ||
-             virtualKeyCode == VK_NUMLOCK)
+    ::HKL layout = windows_subsystem::get_foreground_keyboard_layout();
+    uint64_t layoutId = reinterpret_cast<uint64_t>(layout);
+    if (layoutId == m_keyLayout.get_layout_id())
     {
-        switch (virtualKeyCode) {
-        case VK_CAPITAL:
-            modOn = !m_keyModifiers.capsLock;
-            break;
-        case VK_SCROLL:
-            modOn = !m_keyModifiers.scrollLock;
-            break;
-        case VK_NUMLOCK:
-            modOn = !m_keyModifiers.numLock;
-            break;
-        }
-        input.ki.wVk = virtualKeyCode;
-    }
-    // CHAIN 17: KEY MODIFIERS
-    else if (virtualKeyCode == VK_RCONTROL ||
-               virtualKeyCode == VK_RSHIFT ||
-               virtualKeyCode == VK_RMENU ||
-               virtualKeyCode == VK_RWIN)
-    {
-        // Modifiers stay down or up using the right-side virtual key codes.
-        // Prevents the rest of the virtual keyboard from messing with it.
-        bool currentlyDown = false;
-        switch (virtualKeyCode)
-        {
-        case VK_RCONTROL:
-            currentlyDown = m_keyModifiers.control;
-            break;
-        case VK_RSHIFT:
-            currentlyDown = m_keyModifiers.shift;
-            break;
-        case VK_RMENU:
-            currentlyDown = m_keyModifiers.alt;
-            break;
-        case VK_RWIN:
-            currentlyDown = m_keyModifiers.windows;
-            break;
-        }
-        if (currentlyDown)
-        {
-            input.ki.dwFlags = KEYEVENTF_KEYUP;
-            if (virtualKeyCode == VK_RCONTROL || virtualKeyCode == VK_RMENU)
-            {
-                // https://learn.microsoft.com/en-us/windows/win32/inputdev/about-keyboard-input go to Extended-key flag
-                // Without this the keys get stuck in down mode by the OS.
-                input.ki.dwFlags |= KEYEVENTF_EXTENDEDKEY;
-            }
-        }
-        input.ki.wVk = virtualKeyCode;
-        r = ::SendInput(1, &input, sizeof(input));
-        if (r == 0)
-        {
-            error_reporter::stop(__FILE__, __LINE__, "Win32::SendInput() failure.");
-        }
-        post_key_press(srcButton, modChanged, !currentlyDown);
-        // since we are emulating control and other non-lock modifier keys we
-        // return early so we can leave the keys pressed down.
         return;
     }
-    else
-    {
-        error_reporter::stop(__FILE__, __LINE__, "Missing key_mapping to virtual key translation for pushButton.");
-    }
-    uint16_t toSendVKC = input.ki.wVk;
-    if (toggleControl)
-    {
-        input.ki.wVk = VK_LCONTROL;
-        r = ::SendInput(1, &input, sizeof(input));
-        if (r == 0)
-        {
-            error_reporter::stop(__FILE__, __LINE__, "Win32::SendInput() failure.");
-        }
-    }
-    if (toggleShift)
+    m_keyLayout.build(windows_layout_source(layout), layoutId);
+}
+
+void main_window::dump_latency()
+{
+    QString text = QString::fromStdString(m_latency.dump() + m_keyRepeater.dump() + m_cursorMotion.dump());
+    if (m_handoverGapMs >= 0.0)
     {
-        input.ki.wVk = VK_LSHIFT;
-        r = ::SendInput(1, &input, sizeof(input));
-        if (r == 0)
-        {
-            error_reporter::stop(__FILE__, __LINE__, "Win32::SendInput() failure.");
-        }
+        text += QString("restart: no input for %1 ms, one frame is %2 ms\n").arg(m_handoverGapMs, 0, 'f', 1).arg(m_handoverFrameMs, 0, 'f', 1);
     }
-    input.ki.wVk = toSendVKC;
-    r = ::SendInput(1, &input, sizeof(input));
-    if (r == 0)
+    if (m_launchLatency.get_count() != 0 || m_launchTimeouts != 0)
     {
-        error_reporter::stop(__FILE__, __LINE__, "Win32::SendInput() failure.");
+        text += QString("app launch: %1 placed, %2 no window, launch to placed (ms) p50 %3 p99 %4 max %5\n").arg(m_launchLatency.get_count()).arg(m_launchTimeouts)
+            .arg(m_launchLatency.get_percentile(50.0) / 1000000).arg(m_launchLatency.get_percentile(99.0) / 1000000).arg(m_launchLatency.get_max() / 1000000);
     }
-    // https://learn.microsoft.com/en-us/windows/win32/inputdev/about-keyboard-input go to Extended-key flag
-    // Without this the keys get stuck in down mode by the OS.
-    if (toSendVKC == VK_RMENU ||
-        toSendVKC == VK_RCONTROL ||
-        toSendVKC == VK_INSERT ||
-        toSendVKC == VK_DELETE ||
-        toSendVKC == VK_HOME ||
-        toSendVKC == VK_END ||
-        toSendVKC == VK_PRIOR ||
-        toSendVKC == VK_NEXT ||
-        toSendVKC == VK_UP ||
-        toSendVKC == VK_DOWN ||
-        toSendVKC == VK_LEFT ||
-        toSendVKC == VK_RIGHT)
-    {
-        input.ki.dwFlags = KEYEVENTF_KEYUP | KEYEVENTF_EXTENDEDKEY;
-    }
-    else
+    if (!m_headless)
     {
-        input.ki.dwFlags = KEYEVENTF_KEYUP;
+        process_name_cache_stats names = windows_subsystem::get_process_name_cache_stats();
+        text += QString("exe names: %1 hits, %2 misses, %3 evictions, %4 cached\n").arg(names.hits).arg(names.misses).arg(names.evictions).arg(names.size);
     }
-    r = ::SendInput(1, &input, sizeof(input));
-    if (r == 0)
+    if (m_headless)
     {
-        error_reporter::stop(__FILE__, __LINE__, "Win32::SendInput() failure.");
-    }
-    input.ki.wVk = KEYEVENTF_KEYUP;
-    if (toggleShift) {
-        input.ki.wVk = VK_LSHIFT;
-        r = ::SendInput(1, &input, sizeof(input));
-        if (r == 0)
-        {
-            error_reporter::stop(__FILE__, __LINE__, "Win32::SendInput() failure.");
-        }
+        qDebug().noquote() << text; // next to the replay report
+        return;
     }
-    if (toggleControl)
+    if (append_log("latency.log", "xti " XTI_VERSION ", " + QDateTime::currentDateTime().toString(Qt::ISODate).toUtf8() + "\n" + text.toUtf8() + "\n"))
     {
-        input.ki.wVk = VK_LCONTROL;
-        r = ::SendInput(1, &input, sizeof(input));
-        if (r == 0)
-        {
-            error_reporter::stop(__FILE__, __LINE__, "Win32::SendInput() failure.");
-        }
+        show_status("STATS SAVED", "latency.log in " + QDir::toNativeSeparators(QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation)));
     }
-    post_key_press(srcButton, modChanged, modOn);
 }
 
-void main_window::post_key_press(QPushButton* srcButton, bool modChanged, bool modOn)
+void main_window::post_key_press(key_id id, bool modChanged, bool modOn)
 {
     if (modChanged)
     {
-        m_keyModifiers = windows_subsystem::get_key_modifiers();
+        // Modifiers and locks keep their own colour and never take the pressed colour.
         update_modifier_colors();
-    }
-    if (srcButton == ui->pushButton_shift ||
-        srcButton == ui->pushButton_control ||
-        srcButton == ui->pushButton_windows ||
-        srcButton == ui->pushButton_alt ||
-        srcButton == ui->pushButton_scrollLock ||
-        srcButton == ui->pushButton_numLock ||
-        srcButton == ui->pushButton_capsLock)
-    {
-        ui->label_activeKey->setText(srcButton->text() + QString(modOn ? L" ON" : L" OFF"));
+        // Texts are built once in the constructor so a press does no string work.
+        ui->label_activeKey->setText(modOn ? m_keyTextOn[id] : m_keyTextOff[id]);
     }
     else
     {
-        ui->label_activeKey->setText(srcButton->text());
+        // Only the previously pressed key and this one change colour.
+        if (m_lastPressedKey != -1)
+        {
+            set_key_visual(static_cast<key_id>(m_lastPressedKey), visualPressed, false);
+        }
+        set_key_visual(id, visualPressed, true);
+        m_lastPressedKey = id;
+        flush_key_visuals();
+        ui->label_activeKey->setText(m_keyButtonList[id]->text());
     }
 
     // Flash the touched key cyan.
-    QPalette palette = ui->label_activeKey->palette();
-    palette.setColor(QPalette::WindowText, Qt::cyan);
-    ui->label_activeKey->setPalette(palette);
+    ui->label_activeKey->setPalette(m_paletteActiveKey);
     if (m_activeKeyColorTimer == nullptr)
     {
         m_activeKeyColorTimer = new QTimer(this);
@@ -1029,92 +852,207 @@ void main_window::post_key_press(QPushButton* srcButton, bool modChanged, bool m
         m_activeKeyColorTimer->stop();
     }
     m_activeKeyColorTimer->start(200);
+
+    // After the injection, so looking up suggestions never holds up the key on its way to the app.
+    const key_modifiers& held = m_modifierState.get();
+    track_typed_word(id, held.control || held.alt || held.windows);
 }
 
 void main_window::ui_on_key_press_fade()
 {
-    QPalette defaultPalette = QApplication::palette();
-    ui->label_activeKey->setPalette(defaultPalette);
+    ui->label_activeKey->setPalette(m_paletteDefault);
 }
 
-void main_window::update_modifier_colors()
+// Problems xti carries on from are shown where the last key is, with the reason as the tooltip.
+// Anything xti cannot carry on from goes through error_reporter instead.
+void main_window::show_status(const QString& text, const QString& detail)
 {
-    QPalette defaultPalette = QApplication::palette();
-    if (m_keyModifiers.shift)
+    ui->label_activeKey->setText(text);
+    ui->label_activeKey->setToolTip(detail);
+}
+
+void main_window::start_key_repeat(int32_t buttonIndex)
+{
+    if (buttonIndex < 0 || buttonIndex >= key_count)
     {
-        QPalette palette = ui->pushButton_shift->palette();
-        palette.setColor(QPalette::Button, Qt::darkCyan);
-        ui->pushButton_shift->setPalette(palette);
+        return; // not a key, e.g. a combo box
     }
-    else
+    if ((key_mapping::get_action(static_cast<key_id>(buttonIndex)).flags & key_action::flagRepeat) == 0)
     {
-        ui->pushButton_shift->setPalette(defaultPalette);
+        return;
     }
-    if (m_keyModifiers.control)
+    if (!m_headless)
     {
-        QPalette palette = ui->pushButton_control->palette();
-        palette.setColor(QPalette::Button, Qt::darkCyan);
-        ui->pushButton_control->setPalette(palette);
+        // Read on every hold, so changes to the Windows keyboard settings apply straight away.
+        int64_t delayNs = 0;
+        int64_t intervalNs = 0;
+        windows_subsystem::get_key_repeat_timing(delayNs, intervalNs);
+        m_keyRepeater.set_timing(delayNs, intervalNs);
     }
-    else
+    m_keyRepeater.start(buttonIndex, latency_recorder::now_ns());
+    arm_key_repeat();
+}
+
+void main_window::stop_key_repeat()
+{
+    m_keyRepeater.stop();
+    m_keyRepeatTimer->stop();
+}
+
+// The timer only wakes the UI thread, the deadlines themselves come from m_keyRepeater, so timer lateness never adds up.
+void main_window::arm_key_repeat()
+{
+    if (m_keyRepeater.get_key() == -1)
     {
-        ui->pushButton_control->setPalette(defaultPalette);
+        m_keyRepeatTimer->stop();
+        return;
     }
-    if (m_keyModifiers.alt)
+    int64_t waitNs = m_keyRepeater.get_deadline_ns() - latency_recorder::now_ns();
+    int32_t waitMs = waitNs <= 0 ? 0 : static_cast<int32_t>((waitNs + 999999) / 1000000);
+    m_keyRepeatTimer->start(waitMs);
+}
+
+void main_window::ui_on_key_repeat()
+{
+    if (m_keyRepeater.poll(latency_recorder::now_ns()))
     {
-        QPalette palette = ui->pushButton_alt->palette();
-        palette.setColor(QPalette::Button, Qt::darkCyan);
-        ui->pushButton_alt->setPalette(palette);
+        ui_on_key_press(static_cast<key_id>(m_keyRepeater.get_key()));
     }
-    else
+    arm_key_repeat();
+}
+
+// Called on the UI thread by the keyboard hook for every key event, xti's own included.
+// Once everything xti sent has arrived the modifiers it left down in the OS are known, and any that should be up
+// (e.g. a lost ALT key-up) get released straight away, on both sides.
+void main_window::on_hooked_key_event(void* context, uint16_t virtualKeyCode, bool keyUp, bool injectedByXti, bool xtiSettled)
+{
+    static_assert(modifier_state::maxCorrections <= key_chord::maxStrokes, "Corrections are sent as one chord.");
+    main_window* window = static_cast<main_window*>(context);
+    if (window->m_inputReleased)
     {
-        ui->pushButton_alt->setPalette(defaultPalette);
+        // Mid handover both instances' hooks see the same xti tag, so the one not owning input can't tell whose
+        // strokes these are. The new instance adopts the old one's state instead, the old one is on its way out.
+        return;
     }
-    if (m_keyModifiers.windows)
+    bool changed = window->m_modifierState.apply_hooked_key_event(virtualKeyCode, keyUp, injectedByXti);
+    if (keyUp && !injectedByXti)
     {
-        QPalette palette = ui->pushButton_windows->palette();
-        palette.setColor(QPalette::Button, Qt::darkCyan);
-        ui->pushButton_windows->setPalette(palette);
+        // Possibly the end of a layout switch hotkey, the foreground thread has switched once the timer fires.
+        window->m_keyLayoutTimer->start();
     }
-    else
+    key_chord corrections = {};
+    if (xtiSettled)
     {
-        ui->pushButton_windows->setPalette(defaultPalette);
+        uint64_t divergences = window->m_modifierState.divergence_count();
+        corrections.count = window->m_modifierState.reconcile(corrections.strokes);
+        changed |= window->m_modifierState.divergence_count() != divergences;
     }
-    if (m_keyModifiers.capsLock)
+    if (changed)
     {
-        QPalette palette = ui->pushButton_capsLock->palette();
-        palette.setColor(QPalette::Button, Qt::darkCyan);
-        ui->pushButton_capsLock->setPalette(palette);
+        // Inject and repaint outside of the hook, the OS only gives it a short time to return.
+        QMetaObject::invokeMethod(window, [window, corrections]() { window->send_modifier_corrections(corrections); }, Qt::QueuedConnection);
     }
-    else
+}
+
+void main_window::send_modifier_corrections(const key_chord& corrections)
+{
+    if (corrections.count > 0)
     {
-        ui->pushButton_capsLock->setPalette(defaultPalette);
+        uint32_t sent = m_inputSink->send_keys(corrections.strokes, corrections.count);
+        if (sent != corrections.count)
+        {
+            error_reporter::stop(__FILE__, __LINE__, "Win32::SendInput() failure.");
+        }
+        m_modifierState.apply_strokes(corrections.strokes, corrections.count);
     }
-    if (m_keyModifiers.numLock)
+    update_modifier_colors();
+}
+
+void main_window::update_modifier_colors()
+{
+    const key_modifiers& modifiers = m_modifierState.get();
+    set_key_visual(key_shift, visualModifier, modifiers.shift);
+    set_key_visual(key_control, visualModifier, modifiers.control);
+    set_key_visual(key_alt, visualModifier, modifiers.alt);
+    set_key_visual(key_windows, visualModifier, modifiers.windows);
+    set_key_visual(key_capsLock, visualModifier, modifiers.capsLock);
+    set_key_visual(key_numLock, visualModifier, modifiers.numLock);
+    set_key_visual(key_scrollLock, visualModifier, modifiers.scrollLock);
+    flush_key_visuals();
+}
+
+const QPalette& main_window::get_key_palette(uint8_t visuals) const
+{
+    if ((visuals & visualMouse) != 0)
     {
-        QPalette palette = ui->pushButton_numLock->palette();
-        palette.setColor(QPalette::Button, Qt::darkCyan);
-        ui->pushButton_numLock->setPalette(palette);
+        return m_paletteMouse;
     }
-    else
+    if ((visuals & visualModifier) != 0)
     {
-        ui->pushButton_numLock->setPalette(defaultPalette);
+        return m_paletteModifier;
     }
-    if (m_keyModifiers.scrollLock)
+    if ((visuals & visualPressed) != 0)
     {
-        QPalette palette = ui->pushButton_scrollLock->palette();
-        palette.setColor(QPalette::Button, Qt::darkCyan);
-        ui->pushButton_scrollLock->setPalette(palette);
+        return m_palettePressed;
     }
-    else
+    return m_paletteDefault;
+}
+
+// Only marks the key dirty when the palette it ends up showing actually changes.
+void main_window::set_key_visual(key_id id, uint8_t layer, bool on)
+{
+    uint8_t before = m_keyVisuals[id];
+    uint8_t after = on ? static_cast<uint8_t>(before | layer) : static_cast<uint8_t>(before & ~layer);
+    m_keyVisuals[id] = after;
+    if (&get_key_palette(before) != &get_key_palette(after))
     {
-        ui->pushButton_scrollLock->setPalette(defaultPalette);
+        m_keyVisualsDirty.set(id);
     }
 }
 
-bool main_window::event(QEvent* event)
+void main_window::set_keys_visual(const std::vector<key_id>& ids, uint8_t layer, bool on)
 {
-    bool foundMouseLeftId = false;
+    for (size_t i = 0; i < ids.size(); i++)
+    {
+        set_key_visual(ids[i], layer, on);
+    }
+}
+
+void main_window::flush_key_visuals()
+{
+    if (m_keyVisualsDirty.none())
+    {
+        return;
+    }
+    for (size_t i = 0; i < key_count; i++)
+    {
+        if (m_keyVisualsDirty.test(i))
+        {
+            m_keyButtonList[i]->setPalette(get_key_palette(m_keyVisuals[i]));
+        }
+    }
+    m_keyVisualsDirty.reset();
+}
+
+std::vector<key_id> main_window::to_key_ids(const std::vector<QPushButton*>& buttons) const
+{
+    std::vector<key_id> ids;
+    ids.reserve(buttons.size());
+    for (size_t i = 0; i < buttons.size(); i++)
+    {
+        std::vector<QPushButton*>::const_iterator found = std::find(m_keyButtonList.begin(), m_keyButtonList.end(), buttons[i]);
+        if (found == m_keyButtonList.end())
+        {
+            error_reporter::stop(__FILE__, __LINE__, "Touchpad button is not a keyboard key.");
+        }
+        ids.push_back(static_cast<key_id>(found - m_keyButtonList.begin()));
+    }
+    return ids;
+}
+
+bool main_window::event(QEvent* event)
+{
+    bool foundMouseLeftId = false;
     bool foundMouseRightId = false;
 
     // only hooking into QEvents stream for touch handling
@@ -1122,7 +1060,26 @@ bool main_window::event(QEvent* event)
         event->type() == QEvent::TouchUpdate ||
         event->type() == QEvent::TouchEnd)
     {
+        if (m_inputReleased)
+        {
+            return true; // mid handover, the state these touches would change belongs to the other instance
+        }
         QTouchEvent* touchEvent = dynamic_cast<QTouchEvent*>(event);
+        m_touchMark.entryNs = latency_recorder::now_ns();
+        m_touchMark.hitNs = 0;
+        // Touch timestamps are message times (GetTickCount() based, in ms), so the queue stage has ms resolution.
+        // Anything older than a second is a different clock or a stalled UI thread, neither tells us about the queue.
+        uint32_t touchAgeMs = static_cast<uint32_t>(::GetTickCount()) - static_cast<uint32_t>(touchEvent->timestamp());
+        m_touchMark.touchNs = touchAgeMs < 1000 ? m_touchMark.entryNs - static_cast<int64_t>(touchAgeMs) * 1000000 : 0;
+
+        if (m_hitIndexDirty)
+        {
+            rebuild_hit_index();
+        }
+        if (m_touchRecorder != nullptr)
+        {
+            record_touch(touchEvent);
+        }
 
         // STEP 1: HANDLING PUSHING BUTTONS VIA TOUCH ONLY
         for (QList<QEventPoint>::const_iterator touch = touchEvent->points().begin();
@@ -1130,32 +1087,38 @@ bool main_window::event(QEvent* event)
         {
             if (touch->id() == 0)
             {
+                int32_t touchX = static_cast<int32_t>(std::floor(touch->position().x()));
+                int32_t touchY = static_cast<int32_t>(std::floor(touch->position().y()));
                 if (event->type() == QEvent::TouchBegin)
                 {
-                    for (size_t i = 0; i < m_allButtonsList.size(); i++)
+                    m_downButtonIndex = m_hitIndex.hit_test(touchX, touchY, snapTouchesToNearestKey);
+                    if (!m_cursorIsHooked)
                     {
-                        QWidget* button = m_allButtonsList[i];
-                        if (button->pos().x() <= touch->position().x() &&
-                            button->pos().y() <= touch->position().y() &&
-                            button->pos().x() + button->size().width() > touch->position().x() &&
-                            button->pos().y() + button->size().height() > touch->position().y())
-                        {
-                            m_downButton = button;
-                        }
+                        start_key_repeat(m_downButtonIndex);
                     }
                 }
-                if (event->type() == QEvent::TouchEnd && !m_cursorIsHooked && m_downButton != nullptr)
+                if (event->type() == QEvent::TouchUpdate && m_keyRepeater.get_key() != -1 &&
+                    m_hitIndex.hit_test(touchX, touchY, snapTouchesToNearestKey) != m_downButtonIndex)
                 {
-                    if (m_downButton->pos().x() <= touch->position().x() &&
-                        m_downButton->pos().y() <= touch->position().y() &&
-                        m_downButton->pos().x() + m_downButton->size().width() > touch->position().x() &&
-                        m_downButton->pos().y() + m_downButton->size().height() > touch->position().y())
+                    stop_key_repeat(); // slid off the key
+                }
+                // A key that has repeated has already been pressed by the repeats, letting go adds nothing.
+                bool repeated = m_keyRepeater.has_repeated();
+                if (event->type() == QEvent::TouchEnd)
+                {
+                    stop_key_repeat();
+                }
+                if (event->type() == QEvent::TouchEnd && !m_cursorIsHooked && m_downButtonIndex != -1 && !repeated)
+                {
+                    if (m_hitIndex.hit_test(touchX, touchY, snapTouchesToNearestKey) == m_downButtonIndex)
                     {
-                        if (QPushButton* button = qobject_cast<QPushButton*>(m_downButton))
+                        m_touchMark.hitNs = latency_recorder::now_ns();
+                        QWidget* downButton = m_allButtonsList[m_downButtonIndex];
+                        if (QPushButton* button = qobject_cast<QPushButton*>(downButton))
                         {
                             button->click();
                         }
-                        else if (QComboBox* comboBox = qobject_cast<QComboBox*>(m_downButton))
+                        else if (QComboBox* comboBox = qobject_cast<QComboBox*>(downButton))
                         {
                             comboBox->showPopup();
                         }
@@ -1165,7 +1128,7 @@ bool main_window::event(QEvent* event)
         }
         if (event->type() == QEvent::TouchEnd)
         {
-            m_downButton = nullptr;
+            m_downButtonIndex = -1;
         }
 
         // STEP 2: HANDLING MOUSE MOVEMENTS VIA TOUCHPAD ONLY
@@ -1177,21 +1140,13 @@ bool main_window::event(QEvent* event)
             {
                 if (event->type() == QEvent::TouchBegin)
                 {
-                    QPushButton* topLeftKey = m_keyButtonLeftList[0];
-                    QPushButton* bottomRightKey = m_keyButtonLeftList[m_keyButtonLeftList.size() - 1];
-                    if (topLeftKey->pos().x() <= touch->position().x() &&
-                        topLeftKey->pos().y() <= touch->position().y() &&
-                        bottomRightKey->pos().x() + bottomRightKey->size().width() > touch->position().x() &&
-                        bottomRightKey->pos().y() + bottomRightKey->size().height() > touch->position().y())
+                    if (m_touchpadZone.contains(static_cast<int32_t>(std::floor(touch->position().x())),
+                                                static_cast<int32_t>(std::floor(touch->position().y()))))
                     {
-                        ::POINT startPos;
-                        int32_t r = ::GetCursorPos(&startPos);
-                        if (r == 0)
-                        {
-                            error_reporter::stop(__FILE__, __LINE__, "Win32::GetCursorPos() failure.");
-                        }
-                        m_cursorStartPosition.setX(startPos.x);
-                        m_cursorStartPosition.setY(startPos.y);
+                        // Same as the press position and time on TouchBegin, and also set on replayed touches.
+                        m_cursorLastTouch = touch->globalPosition();
+                        m_cursorMotion.reset();
+                        m_cursorBallistics.reset(touch->timestamp());
                         m_cursorIsMoving = true;
                         // There needs to be some delay before we actually start moving the cursor
                         // otherwise normal touch key presses can move the cursor slightly.
@@ -1202,18 +1157,17 @@ bool main_window::event(QEvent* event)
                 {
                     if (m_cursorIsHooked)
                     {
-                        QPointF diff = touch->globalPosition() - touch->globalPressPosition();
-                        int32_t newX = m_cursorStartPosition.x() + static_cast<int>(diff.x() * m_cursorSpeed);
-                        int32_t newY = m_cursorStartPosition.y() + static_cast<int>(diff.y() * m_cursorSpeed);
-                        int32_t r = ::SetCursorPos(newX, newY);
-                        if (r == 0)
-                        {
-                            error_reporter::stop(__FILE__, __LINE__, "Win32::SetCursorPos() failure.");
-                        }
-                        r = ::SetWindowPos(reinterpret_cast<HWND>(m_cursor->winId()), HWND_TOPMOST, newX - 22, newY - 24, 0, 0, SWP_NOSIZE);
-                        if (r == 0)
+                        // Only collect the motion here, it gets injected once per display refresh by ui_on_cursor_motion_flush().
+                        // The first sample after hooking also carries everything moved during the hook delay.
+                        QPointF diff = touch->globalPosition() - m_cursorLastTouch;
+                        m_cursorLastTouch = touch->globalPosition();
+                        int32_t dx = 0;
+                        int32_t dy = 0;
+                        m_cursorBallistics.add_sample(diff.x(), diff.y(), touch->timestamp(), dx, dy);
+                        m_cursorMotion.add_sample(dx, dy);
+                        if (m_moveMark.entryNs == 0)
                         {
-                            error_reporter::stop(__FILE__, __LINE__, "Win32::SetWindowPos() failure.");
+                            m_moveMark = { m_touchMark.touchNs, m_touchMark.entryNs, latency_recorder::now_ns() };
                         }
                     }
                 }
@@ -1229,34 +1183,16 @@ bool main_window::event(QEvent* event)
                 if (event->type() == QEvent::TouchBegin ||
                     event->type() == QEvent::TouchUpdate)
                 {
+                    int32_t touchX = static_cast<int32_t>(std::floor(touch->position().x()));
+                    int32_t touchY = static_cast<int32_t>(std::floor(touch->position().y()));
                     // left
-                    QPushButton* topLeftKey = m_keyButtonRightTopList[0];
-                    QPushButton* bottomRightKey = m_keyButtonRightTopList[m_keyButtonRightTopList.size() - 1];
-                    if (topLeftKey->pos().x() <= touch->position().x() &&
-                        topLeftKey->pos().y() <= touch->position().y() &&
-                        bottomRightKey->pos().x() + bottomRightKey->size().width() > touch->position().x() &&
-                        bottomRightKey->pos().y() + bottomRightKey->size().height() > touch->position().y())
+                    if (m_leftClickZone.contains(touchX, touchY))
                     {
                         if (m_leftMouseDownId == -1)
                         {
                             m_leftMouseDownId = touch->id();
-                            for (size_t i = 0; i < m_keyButtonRightTopList.size(); i++)
-                            {
-                                QPushButton* button = m_keyButtonRightTopList[i];
-                                QPalette palette = button->palette();
-                                palette.setColor(QPalette::Button, Qt::red);
-                                button->setPalette(palette);
-                            }
-                            std::thread([](){
-                                ::INPUT input = {};
-                                input.type = INPUT_MOUSE;
-                                input.mi.dwFlags = MOUSEEVENTF_LEFTDOWN;
-                                uint32_t r = ::SendInput(1, &input, sizeof(INPUT));
-                                if (r == 0)
-                                {
-                                    error_reporter::stop(__FILE__, __LINE__, "Win32::SendInput() failure.");
-                                }
-                            }).detach();
+                            send_mouse_button(mouse_stroke::flagLeftDown);
+                            set_keys_visual(m_keyRightTopIds, visualMouse, true);
                         }
                         if (m_leftMouseDownId == touch->id())
                         {
@@ -1265,33 +1201,13 @@ bool main_window::event(QEvent* event)
                     }
 
                     // right
-                    topLeftKey = m_keyButtonRightBottomList[0];
-                    bottomRightKey = m_keyButtonRightBottomList[m_keyButtonRightBottomList.size() - 1];
-                    if (topLeftKey->pos().x() <= touch->position().x() &&
-                        topLeftKey->pos().y() <= touch->position().y() &&
-                        bottomRightKey->pos().x() + bottomRightKey->size().width() > touch->position().x() &&
-                        bottomRightKey->pos().y() + bottomRightKey->size().height() > touch->position().y())
+                    if (m_rightClickZone.contains(touchX, touchY))
                     {
                         if (m_rightMouseDownId == -1)
                         {
                             m_rightMouseDownId = touch->id();
-                            for (size_t i = 0; i < m_keyButtonRightBottomList.size(); i++)
-                            {
-                                QPushButton* button = m_keyButtonRightBottomList[i];
-                                QPalette palette = button->palette();
-                                palette.setColor(QPalette::Button, Qt::red);
-                                button->setPalette(palette);
-                            }
-                            std::thread([](){
-                                ::INPUT input = {};
-                                input.type = INPUT_MOUSE;
-                                input.mi.dwFlags = MOUSEEVENTF_RIGHTDOWN;
-                                uint32_t r = ::SendInput(1, &input, sizeof(INPUT));
-                                if (r == 0)
-                                {
-                                    error_reporter::stop(__FILE__, __LINE__, "Win32::SendInput() failure.");
-                                }
-                            }).detach();
+                            send_mouse_button(mouse_stroke::flagRightDown);
+                            set_keys_visual(m_keyRightBottomIds, visualMouse, true);
                         }
                         if (m_rightMouseDownId == touch->id())
                         {
@@ -1306,56 +1222,27 @@ bool main_window::event(QEvent* event)
         if (foundMouseLeftId == false && m_leftMouseDownId != -1)
         {
             m_leftMouseDownId = -1;
-            QPalette defaultPalette = QApplication::palette();
-            for (size_t i = 0; i < m_keyButtonRightTopList.size(); i++)
-            {
-                QPushButton* button = m_keyButtonRightTopList[i];
-                button->setPalette(defaultPalette);
-            }
-            std::thread([](){
-                ::INPUT input = {};
-                input.type = INPUT_MOUSE;
-                input.mi.dwFlags = MOUSEEVENTF_LEFTUP;
-                uint32_t r = ::SendInput(1, &input, sizeof(INPUT));
-                if (r == 0)
-                {
-                    error_reporter::stop(__FILE__, __LINE__, "Win32::SendInput() failure.");
-                }
-            }).detach();
+            send_mouse_button(mouse_stroke::flagLeftUp);
+            set_keys_visual(m_keyRightTopIds, visualMouse, false);
         }
         if (foundMouseRightId == false && m_rightMouseDownId != -1)
         {
             m_rightMouseDownId = -1;
-            QPalette defaultPalette = QApplication::palette();
-            for (size_t i = 0; i < m_keyButtonRightBottomList.size(); i++)
-            {
-                QPushButton* button = m_keyButtonRightBottomList[i];
-                button->setPalette(defaultPalette);
-            }
-            std::thread([](){
-                ::INPUT input = {};
-                input.type = INPUT_MOUSE;
-                input.mi.dwFlags = MOUSEEVENTF_RIGHTUP;
-                uint32_t r = ::SendInput(1, &input, sizeof(INPUT));
-                if (r == 0)
-                {
-                    error_reporter::stop(__FILE__, __LINE__, "Win32::SendInput() failure.");
-                }
-            }).detach();
+            send_mouse_button(mouse_stroke::flagRightUp);
+            set_keys_visual(m_keyRightBottomIds, visualMouse, false);
         }
 
-        // STEP 4: Cleanup mouse movement if necessary
+        // STEP 3: Cleanup mouse movement if necessary
         if (event->type() == QEvent::TouchEnd)
         {
             if (m_cursorIsHooked)
             {
-                QPalette defaultPalette = QApplication::palette();
-                for (size_t i = 0; i < m_keyButtonLeftList.size(); i++)
-                {
-                    QPushButton* button = m_keyButtonLeftList[i];
-                    button->setPalette(defaultPalette);
-                }
-                update_modifier_colors();
+                // Send whatever motion is still pending before letting go.
+                ui_on_cursor_motion_flush();
+                m_cursorFlushTimer->stop();
+                m_moveMark = {};
+                // Modifier colours sit on their own layer, so they come back on their own.
+                set_keys_visual(m_keyLeftIds, visualMouse, false);
                 m_cursorIsHooked = false;
             }
             if (m_cursorIsMoving)
@@ -1364,6 +1251,14 @@ bool main_window::event(QEvent* event)
                 m_cursorIsMoving = false;
             }
         }
+
+        // STEP 4: Repaint the keys that changed, all input has already gone out by now.
+        flush_key_visuals();
+    }
+    if (event->type() == QEvent::Resize ||
+        event->type() == QEvent::LayoutRequest)
+    {
+        m_hitIndexDirty = true;
     }
     if (event->type() == QEvent::TouchBegin)
     {
@@ -1373,47 +1268,403 @@ bool main_window::event(QEvent* event)
     return QMainWindow::event(event);
 }
 
-void main_window::ui_on_cursor_move_ready()
+void main_window::rebuild_hit_index()
 {
-    for (size_t i = 0; i < m_keyButtonLeftList.size(); i++)
+    // Buttons are matched in m_allButtonsList order, hit_index returns an index into it.
+    std::vector<hit_rect> rects;
+    rects.reserve(m_allButtonsList.size());
+    for (size_t i = 0; i < m_allButtonsList.size(); i++)
     {
-        QPushButton* button = m_keyButtonLeftList[i];
-        QPalette palette = button->palette();
-        palette.setColor(QPalette::Button, Qt::red);
-        button->setPalette(palette);
+        QRect geometry = m_allButtonsList[i]->geometry();
+        rects.push_back({ geometry.left(), geometry.top(), geometry.left() + geometry.width(), geometry.top() + geometry.height() });
     }
+    m_hitIndex.rebuild(rects.data(), static_cast<uint32_t>(rects.size()));
+
+    // Touchpad and click zones span from the first (top left) to the last (bottom right) key of each list.
+    m_touchpadZone = zone_from_keys(m_keyButtonLeftList);
+    m_leftClickZone = zone_from_keys(m_keyButtonRightTopList);
+    m_rightClickZone = zone_from_keys(m_keyButtonRightBottomList);
+    m_hitIndexDirty = false;
+}
+
+void main_window::record_touch(const QTouchEvent* touchEvent)
+{
+    touch_trace_frame frame = {};
+    frame.type = touch_trace_frame::typeUpdate;
+    if (touchEvent->type() == QEvent::TouchBegin)
+    {
+        frame.type = touch_trace_frame::typeBegin;
+    }
+    else if (touchEvent->type() == QEvent::TouchEnd)
+    {
+        frame.type = touch_trace_frame::typeEnd;
+    }
+    frame.timestampMs = touchEvent->timestamp();
+    for (const QEventPoint& touch : touchEvent->points())
+    {
+        frame.points.push_back({ touch.id(), static_cast<uint8_t>(touch.state()),
+            static_cast<int32_t>(std::lround(touch.position().x() * touch_trace_point::subPixels)),
+            static_cast<int32_t>(std::lround(touch.position().y() * touch_trace_point::subPixels)) });
+    }
+    m_touchRecorder->add_frame(frame);
+}
+
+hit_rect main_window::zone_from_keys(const std::vector<QPushButton*>& keys)
+{
+    QRect topLeft = keys.front()->geometry();
+    QRect bottomRight = keys.back()->geometry();
+    return { topLeft.left(), topLeft.top(), bottomRight.left() + bottomRight.width(), bottomRight.top() + bottomRight.height() };
+}
+
+void main_window::send_mouse_button(uint16_t flags)
+{
+    reset_typed_word(); // a click usually moves the caret
+    // Called right after the click zone was resolved for the current touch.
+    latency_mark mark = m_touchMark;
+    mark.hitNs = latency_recorder::now_ns();
+    post_mouse({ flags, 0, 0, 0 }, kind_click, mark);
+}
+
+void main_window::post_mouse(const mouse_stroke& stroke, latency_kind kind, const latency_mark& mark)
+{
+    // The worker never reports errors off the UI thread, failures from earlier batches surface here instead.
+    if (m_inputWorker->has_failed())
+    {
+        error_reporter::stop(__FILE__, __LINE__, "Win32::SendInput() failure.");
+    }
+    if (!m_inputWorker->post_mouse(stroke, kind, mark))
+    {
+        error_reporter::stop(__FILE__, __LINE__, "input_worker stalled.");
+    }
+}
+
+void main_window::ui_on_cursor_move_ready()
+{
+    stop_key_repeat(); // the touch is moving the cursor, not holding a key
+    set_keys_visual(m_keyLeftIds, visualMouse, true);
+    flush_key_visuals();
     m_cursorIsHooked = true;
-    m_cursorSpeed = windows_subsystem::get_mouse_speed();
+    // No base gain from the Windows pointer speed: relative moves are scaled by it in the OS already, so the
+    // curve alone supplies the touchpad's gain. 'Enhance pointer precision' has to be off, see README.
+    // One flush per frame of the screen xti is on, more moves than that can never be seen.
+    qreal refreshRate = screen()->refreshRate();
+    if (refreshRate < 1.0)
+    {
+        refreshRate = 60.0;
+    }
+    m_cursorFlushTimer->start(std::max(1, static_cast<int32_t>(std::lround(1000.0 / refreshRate))));
+}
+
+void main_window::ui_on_cursor_motion_flush()
+{
+    int32_t dx = 0;
+    int32_t dy = 0;
+    if (!m_cursorMotion.take_move(dx, dy))
+    {
+        return;
+    }
+    // Moves go through the same worker queue as the clicks, so a click can never overtake the move before it.
+    // The move carries the checkpoints of the oldest sample in it, so the dispatch stage includes the coalescing wait.
+    post_mouse({ mouse_stroke::flagMove, dx, dy, 0 }, kind_move, m_moveMark);
+    m_moveMark = {};
+    if (m_cursor == nullptr)
+    {
+        return; // headless
+    }
+
+    // The move is still in flight, so place the overlay where it is going to land.
+    ::POINT position;
+    int32_t r = ::GetCursorPos(&position);
+    if (r == 0)
+    {
+        error_reporter::stop(__FILE__, __LINE__, "Win32::GetCursorPos() failure.");
+    }
+    r = ::SetWindowPos(reinterpret_cast<HWND>(m_cursor->winId()), HWND_TOPMOST, position.x + dx - 22, position.y + dy - 24, 0, 0, SWP_NOSIZE);
+    if (r == 0)
+    {
+        error_reporter::stop(__FILE__, __LINE__, "Win32::SetWindowPos() failure.");
+    }
+}
+
+const shortcut_config* main_window::get_shortcut(bool above, int32_t index) const
+{
+    const std::vector<shortcut_config>& shortcuts = m_config.get_shortcuts(above);
+    if (index < 0 || static_cast<size_t>(index) >= shortcuts.size())
+    {
+        return nullptr;
+    }
+    return &shortcuts[index];
+}
+
+void main_window::ui_on_config_changed()
+{
+    m_configSettleTimer->start(100);
+}
+
+// Parses the config on the window executor, then applies the differences on the UI thread in one go.
+// Typing never waits on it, the UI thread only ever does the diff and the combo box edits.
+void main_window::reload_config()
+{
+    // A replaced file drops out of the watcher, and while it is briefly missing only its directory can tell us it is back.
+    QString path = app_config_loader::get_path();
+    QString directory = QFileInfo(path).absolutePath();
+    bool exists = QFileInfo::exists(path);
+    if (exists && !m_configWatcher->files().contains(path))
+    {
+        m_configWatcher->addPath(path);
+    }
+    if (exists && m_configWatcher->directories().contains(directory))
+    {
+        m_configWatcher->removePath(directory);
+    }
+    if (!exists)
+    {
+        if (!m_configWatcher->directories().contains(directory))
+        {
+            m_configWatcher->addPath(directory);
+        }
+        return;
+    }
+
+    std::shared_ptr<app_config> config = std::make_shared<app_config>();
+    std::shared_ptr<QString> error = std::make_shared<QString>();
+    std::shared_ptr<bool> valid = std::make_shared<bool>(false);
+    m_windowExecutor->submit(windowJobConfigReload,
+        [path, config, error, valid]() { *valid = app_config_loader::load(path, *config, *error); },
+        [this, config, error, valid]()
+        {
+            if (!*valid)
+            {
+                // The loaded config stays in place.
+                show_status("CONFIG ERROR", *error);
+                return;
+            }
+            apply_config(*config);
+        });
+}
+
+void main_window::apply_config(const app_config& config)
+{
+    for (bool above : { true, false })
+    {
+        QComboBox* comboBox = above ? ui->comboBox_shortcutsAbove : ui->comboBox_shortcutsBelow;
+        const std::vector<shortcut_config>& after = config.get_shortcuts(above);
+        std::vector<shortcut_edit> edits = app_config::diff(m_config.get_shortcuts(above), after);
+        // Selections shifted by the edits must not count as the user picking an app.
+        QSignalBlocker blocker(comboBox);
+        for (size_t i = 0; i < edits.size(); i++)
+        {
+            if (edits[i].op == shortcut_edit::opRemove)
+            {
+                comboBox->removeItem(static_cast<int32_t>(edits[i].index));
+            }
+            else if (edits[i].op == shortcut_edit::opInsert)
+            {
+                comboBox->insertItem(static_cast<int32_t>(edits[i].index), QString::fromStdWString(after[edits[i].index].displayName));
+            }
+            // opUpdate keeps its name and place, only the entry in m_config changes.
+        }
+    }
+    m_config = config;
 }
 
 void main_window::ui_on_shortcuts_above_changed(int32_t index)
 {
-    open_or_show_app(ui->comboBox_shortcutsAbove->itemData(index));
+    open_or_show_app(get_shortcut(true, index));
 }
 
 void main_window::ui_on_shortcuts_above_reopen()
 {
-    open_or_show_app(ui->comboBox_shortcutsAbove->currentData());
+    open_or_show_app(get_shortcut(true, ui->comboBox_shortcutsAbove->currentIndex()));
 }
 
 void main_window::ui_on_shortcuts_below_changed(int32_t index)
 {
-    open_or_show_app(ui->comboBox_shortcutsBelow->itemData(index));
+    open_or_show_app(get_shortcut(false, index));
 }
 
 void main_window::ui_on_shortcuts_below_reopen()
 {
-    open_or_show_app(ui->comboBox_shortcutsBelow->currentData());
+    open_or_show_app(get_shortcut(false, ui->comboBox_shortcutsBelow->currentIndex()));
 }
 
 void main_window::ui_on_move_active_above()
 {
-    windows_subsystem::move_active_window(true, m_appDimensions);
+    if (m_headless)
+    {
+        return;
+    }
+    app_dimensions dimensions = m_appDimensions;
+    m_windowExecutor->submit(windowJobMoveActive, [dimensions]() { windows_subsystem::move_active_window(true, dimensions); }, nullptr);
 }
 
 void main_window::ui_on_move_active_below()
 {
-    windows_subsystem::move_active_window(false, m_appDimensions);
+    if (m_headless)
+    {
+        return;
+    }
+    app_dimensions dimensions = m_appDimensions;
+    m_windowExecutor->submit(windowJobMoveActive, [dimensions]() { windows_subsystem::move_active_window(false, dimensions); }, nullptr);
+}
+
+void main_window::type_text(const QString& text)
+{
+    if (m_textInjector == nullptr || text.isEmpty())
+    {
+        return;
+    }
+    // The text goes to whichever app has the focus, xti never takes it. The report comes back from the typing
+    // thread, the injector is deleted (and joined) before this window so the queued call cannot outlive it.
+    m_textInjector->type(text.toStdU16String(), m_config.get_typing(),
+        [this](const text_injection_report& report)
+        {
+            QMetaObject::invokeMethod(this, [this, report]() { on_typing_done(report); }, Qt::QueuedConnection);
+        });
+    ui->label_activeKey->setText("TYPING");
+}
+
+void main_window::on_typing_done(const text_injection_report& report)
+{
+    if (m_textInjector->is_typing())
+    {
+        return; // a newer text superseded this one and reports on its own
+    }
+    QString detail = QString("%1 chars in %2 batches, %3 ms").arg(report.characters).arg(report.batches).arg(report.elapsedNs / 1000000);
+    if (report.failed)
+    {
+        show_status("TYPING FAILED", "SendInput rejected the input after " + detail);
+        return;
+    }
+    if (!report.complete)
+    {
+        show_status("CANCELLED", detail);
+        return;
+    }
+    show_status(QString("%1 C/S").arg(qRound64(report.get_chars_per_second())), detail);
+}
+
+void main_window::ui_on_type_clipboard()
+{
+    if (m_textInjector != nullptr && m_textInjector->is_typing())
+    {
+        m_textInjector->cancel(); // a second press stops a long clipboard part way
+        return;
+    }
+    type_text(QGuiApplication::clipboard()->text());
+}
+
+void main_window::load_dictionary()
+{
+    QString path = QCoreApplication::applicationDirPath() + "/words.xtd";
+    m_dictionaryFile = new QFile(path, this);
+    if (!m_dictionaryFile->open(QIODevice::ReadOnly))
+    {
+        return; // optional, the strip stays empty
+    }
+    // Mapped rather than read, pages of the dictionary are only loaded once a prefix reaches them.
+    qint64 size = m_dictionaryFile->size();
+    const uchar* data = m_dictionaryFile->map(0, size);
+    std::string error;
+    if (data == nullptr || !m_dictionary.open(data, static_cast<size_t>(size), error))
+    {
+        m_dictionary = word_dictionary();
+        show_status("DICTIONARY ERROR", QDir::toNativeSeparators(path) + ": " + (data == nullptr ? QString("cannot be mapped") : QString::fromStdString(error)));
+    }
+}
+
+// Follows the word being typed from the keys pressed on xti, called once the key has been injected. Letters, digits
+// and _ extend it, backspace shortens it, shift and the locks leave it alone, and anything else (space, punctuation,
+// arrows, shortcuts) ends it. A word longer than any in the dictionary is still followed, it just has no suggestions.
+void main_window::track_typed_word(key_id id, bool shortcut)
+{
+    if (m_dictionary.get_word_count() == 0)
+    {
+        return;
+    }
+    const key_action& action = key_mapping::get_action(id);
+    if ((action.flags & (key_action::flagModifier | key_action::flagLock)) != 0)
+    {
+        return;
+    }
+    char16_t character = key_mapping::get_character(id);
+    bool letter = (character >= u'a' && character <= u'z') || (character >= u'A' && character <= u'Z');
+    bool digit = character >= u'0' && character <= u'9';
+    if (id == key_backspace && !shortcut)
+    {
+        if (m_typedWord.empty())
+        {
+            return;
+        }
+        // One character, a chosen completion may have left non-ASCII ones in the word.
+        while (m_typedWord.size() > 1 && (static_cast<uint8_t>(m_typedWord.back()) & 0xC0) == 0x80)
+        {
+            m_typedWord.pop_back();
+        }
+        m_typedWord.pop_back();
+    }
+    else if (!shortcut && (letter || digit || character == u'_'))
+    {
+        char typed = static_cast<char>(character);
+        if (letter)
+        {
+            // Caps lock flips the case shift would give, as it does on a physical keyboard.
+            bool shift = (action.flags & key_action::flagShift) != 0 || m_modifierState.get().shift;
+            bool upper = shift != m_modifierState.get().capsLock;
+            typed = static_cast<char>(upper ? std::toupper(typed) : std::tolower(typed));
+        }
+        m_typedWord.push_back(typed);
+    }
+    else if (!m_typedWord.empty())
+    {
+        m_typedWord.clear();
+    }
+    else
+    {
+        return;
+    }
+    update_suggestions();
+}
+
+void main_window::reset_typed_word()
+{
+    if (!m_typedWord.empty())
+    {
+        m_typedWord.clear();
+        update_suggestions();
+    }
+}
+
+void main_window::update_suggestions()
+{
+    m_dictionary.complete(m_typedWord, suggestionCount, m_completions);
+    for (uint32_t i = 0; i < suggestionCount; i++)
+    {
+        m_suggestionButtons[i]->setText(i < m_completions.size() ? QString::fromStdString(m_completions[i].word) : QString());
+    }
+}
+
+// Types the rest of the chosen word in one batch with the key presses, so they cannot overtake each other.
+void main_window::ui_on_suggestion(uint32_t index)
+{
+    if (index >= m_completions.size())
+    {
+        return;
+    }
+    std::u16string rest = QString::fromStdString(m_completions[index].word.substr(m_typedWord.size())).toStdU16String();
+    std::vector<key_stroke> strokes;
+    text_injector::append_strokes(rest, 0, rest.size(), strokes);
+    uint32_t count = static_cast<uint32_t>(strokes.size());
+    if (m_inputSink->send_keys(strokes.data(), count) != count)
+    {
+        error_reporter::stop(__FILE__, __LINE__, "Win32::SendInput() failure.");
+    }
+    if (m_touchRecorder != nullptr)
+    {
+        m_touchRecorder->add_keys(strokes.data(), count);
+    }
+    m_typedWord = m_completions[index].word;
+    update_suggestions();
 }
 
 void main_window::ui_on_panic()
@@ -1423,11 +1674,245 @@ void main_window::ui_on_panic()
 
 void main_window::ui_on_restart()
 {
-    // restarting at same location should be OK.
-    // nothing conflicts with system running two at once for short period.
+    if (m_headless || m_handoverServer != nullptr)
+    {
+        return; // already restarting
+    }
+    // The new instance starts warm behind this one and takes over through a local socket, see handle_handover().
+    // It only asks for the state once its window is up and its hooks are in, so there is always a keyboard
+    // and held modifiers are never forgotten.
     // this won't work when debugging.
-    qApp->quit();
-    QString program = qApp->arguments()[0];
-    QStringList arguments = qApp->arguments().mid(1);
-    QProcess::startDetached(program, arguments);
+    QString serverName = QString("xti-handover-%1").arg(QCoreApplication::applicationPid());
+    QLocalServer::removeServer(serverName);
+    m_handoverServer = new QLocalServer(this);
+    connect(m_handoverServer, &QLocalServer::newConnection, this, &main_window::ui_on_handover_connection);
+    if (!m_handoverServer->listen(serverName))
+    {
+        abort_handover("cannot listen: " + m_handoverServer->errorString());
+        return;
+    }
+    // Arguments of an earlier handover are not passed on, the rest (e.g. --record) are.
+    QStringList arguments;
+    QStringList ownArguments = qApp->arguments().mid(1);
+    for (qsizetype i = 0; i < ownArguments.size(); i++)
+    {
+        if (ownArguments[i] == "--handover")
+        {
+            i += 2;
+            continue;
+        }
+        arguments.push_back(ownArguments[i]);
+    }
+    arguments << "--handover" << serverName << QString::number(static_cast<qulonglong>(winId()));
+    if (!QProcess::startDetached(qApp->arguments()[0], arguments, QString(), &m_handoverProcessId))
+    {
+        abort_handover("cannot start the new instance");
+        return;
+    }
+    m_handoverTimeout->start(handoverTimeoutMs);
+}
+
+void main_window::start_handover_client()
+{
+    m_handoverSocket = new QLocalSocket(this);
+    connect(m_handoverSocket, &QLocalSocket::readyRead, this, &main_window::ui_on_handover_read);
+    connect(m_handoverSocket, &QLocalSocket::connected, this, [this]()
+    {
+        handover_message ready = {};
+        ready.type = handover_message::typeReady;
+        send_handover(ready);
+    });
+    // The modifier state read from the OS at startup stays in use if the old instance cannot be reached.
+    connect(m_handoverSocket, &QLocalSocket::errorOccurred, this, [this]() { abort_handover("cannot reach the old instance"); });
+    connect(m_handoverSocket, &QLocalSocket::disconnected, this, [this]() { abort_handover("the old instance went away"); });
+    m_handoverTimeout->start(handoverTimeoutMs);
+    m_handoverSocket->connectToServer(m_handoverServerName);
+}
+
+void main_window::ui_on_handover_connection()
+{
+    QLocalSocket* socket = m_handoverServer->nextPendingConnection();
+    if (socket == nullptr || m_handoverSocket != nullptr)
+    {
+        delete socket; // only the instance that was started gets to take over
+        return;
+    }
+    m_handoverSocket = socket;
+    connect(m_handoverSocket, &QLocalSocket::readyRead, this, &main_window::ui_on_handover_read);
+    connect(m_handoverSocket, &QLocalSocket::disconnected, this, [this]() { abort_handover("the new instance went away"); });
+}
+
+void main_window::ui_on_handover_read()
+{
+    QByteArray data = m_handoverSocket->readAll();
+    m_handoverBuffer.insert(m_handoverBuffer.end(), data.begin(), data.end());
+    while (m_handoverSocket != nullptr)
+    {
+        handover_message message;
+        bool error = false;
+        size_t used = handover_codec::decode(m_handoverBuffer.data(), m_handoverBuffer.size(), message, error);
+        if (error)
+        {
+            abort_handover("unreadable message, is the other instance a different version?");
+            return;
+        }
+        if (used == 0)
+        {
+            return;
+        }
+        m_handoverBuffer.erase(m_handoverBuffer.begin(), m_handoverBuffer.begin() + static_cast<std::ptrdiff_t>(used));
+        handle_handover(message);
+    }
+}
+
+void main_window::handle_handover(const handover_message& message)
+{
+    if (message.type == handover_message::typeReady && m_handoverServer != nullptr)
+    {
+        // Old instance: from here until the new one confirms, touches land on this window and are dropped.
+        release_input();
+        handover_message reply = {};
+        reply.type = handover_message::typeState;
+        reply.state.modifiers = m_modifierState.get();
+        reply.state.shortcutAbove = ui->comboBox_shortcutsAbove->currentText().toStdWString();
+        reply.state.shortcutBelow = ui->comboBox_shortcutsBelow->currentText().toStdWString();
+        reply.state.releasedNs = m_inputReleasedNs;
+        send_handover(reply);
+    }
+    else if (message.type == handover_message::typeState && m_handoverServer == nullptr)
+    {
+        // New instance: xti's own held modifiers are what the old instance says, not what the OS reported at startup.
+        m_modifierState.adopt(message.state.modifiers);
+        for (bool above : { true, false })
+        {
+            QComboBox* comboBox = above ? ui->comboBox_shortcutsAbove : ui->comboBox_shortcutsBelow;
+            const std::wstring& selected = above ? message.state.shortcutAbove : message.state.shortcutBelow;
+            int32_t index = comboBox->findText(QString::fromStdWString(selected));
+            if (index != -1)
+            {
+                QSignalBlocker blocker(comboBox);
+                comboBox->setCurrentIndex(index);
+            }
+        }
+        update_modifier_colors();
+        m_inputReleased = false;
+        refresh_key_layout(); // a layout switch while warming up went unseen
+        handover_message reply = {};
+        reply.type = handover_message::typeTakenOver;
+        send_handover(reply);
+        close_handover();
+    }
+    else if (message.type == handover_message::typeTakenOver && m_handoverServer != nullptr)
+    {
+        // Old instance: the new window is right underneath, hiding this one hands it the touches.
+        hide();
+        // Logged right under the new instance's startup report, and with the latency dump on the way out.
+        m_handoverGapMs = static_cast<double>(latency_recorder::now_ns() - m_inputReleasedNs) / 1000000.0;
+        qreal refreshRate = screen()->refreshRate();
+        m_handoverFrameMs = 1000.0 / (refreshRate < 1.0 ? 60.0 : refreshRate);
+        append_log("startup.log", QString("restart: no input for %1 ms, one frame is %2 ms\n\n").arg(m_handoverGapMs, 0, 'f', 1).arg(m_handoverFrameMs, 0, 'f', 1).toUtf8());
+        m_handoverProcessId = 0; // it owns input now
+        close_handover();
+        qApp->quit();
+    }
+    else
+    {
+        abort_handover("unexpected message");
+    }
+}
+
+void main_window::send_handover(const handover_message& message)
+{
+    std::vector<uint8_t> bytes;
+    handover_codec::encode(message, bytes);
+    m_handoverSocket->write(reinterpret_cast<const char*>(bytes.data()), static_cast<qint64>(bytes.size()));
+    m_handoverSocket->flush();
+}
+
+// Lets go of everything this instance holds that cannot be handed over, i.e. touchpad buttons and motion.
+// Held modifiers and locks stay down, the new instance takes them over.
+void main_window::release_input()
+{
+    m_inputReleased = true;
+    m_inputReleasedNs = latency_recorder::now_ns();
+    stop_key_repeat();
+    if (m_textInjector != nullptr)
+    {
+        m_textInjector->cancel(); // the new instance must not type over the rest of a clipboard
+    }
+    if (m_leftMouseDownId != -1)
+    {
+        m_leftMouseDownId = -1;
+        send_mouse_button(mouse_stroke::flagLeftUp);
+        set_keys_visual(m_keyRightTopIds, visualMouse, false);
+    }
+    if (m_rightMouseDownId != -1)
+    {
+        m_rightMouseDownId = -1;
+        send_mouse_button(mouse_stroke::flagRightUp);
+        set_keys_visual(m_keyRightBottomIds, visualMouse, false);
+    }
+    if (m_cursorIsHooked)
+    {
+        ui_on_cursor_motion_flush();
+        m_cursorFlushTimer->stop();
+        m_moveMark = {};
+        set_keys_visual(m_keyLeftIds, visualMouse, false);
+        m_cursorIsHooked = false;
+    }
+    m_cursorMoveTimerDelay->stop();
+    m_cursorIsMoving = false;
+    m_downButtonIndex = -1;
+    flush_key_visuals();
+}
+
+void main_window::close_handover()
+{
+    m_handoverTimeout->stop();
+    m_handoverBuffer.clear();
+    if (m_handoverSocket != nullptr)
+    {
+        // Whatever was written still goes out, the socket deletes itself once it has.
+        disconnect(m_handoverSocket, nullptr, this, nullptr);
+        connect(m_handoverSocket, &QLocalSocket::disconnected, m_handoverSocket, &QObject::deleteLater);
+        m_handoverSocket->disconnectFromServer();
+        m_handoverSocket = nullptr;
+    }
+    if (m_handoverServer != nullptr)
+    {
+        m_handoverServer->close();
+        m_handoverServer->deleteLater();
+        m_handoverServer = nullptr;
+    }
+}
+
+// Either side: gives up on the handover so that exactly one instance is left owning input.
+// The old instance ends the new one (if it got as far as starting it) and takes input back. The new instance leaves
+// while the old one is still there, and only carries on, with the modifier state read from the OS again,
+// when the old one has gone.
+void main_window::abort_handover(const QString& reason)
+{
+    bool oldInstance = m_handoverServer != nullptr;
+    close_handover();
+    if (oldInstance)
+    {
+        if (m_handoverProcessId != 0)
+        {
+            windows_subsystem::terminate_process(m_handoverProcessId);
+            m_handoverProcessId = 0;
+        }
+        m_inputReleased = false;
+        show_status("RESTART FAILED", reason);
+        return;
+    }
+    if (windows_subsystem::is_window(reinterpret_cast<HWND>(m_handoverPreviousWindow)))
+    {
+        qApp->quit();
+        return;
+    }
+    // Key events were ignored while waiting, start over from what the OS holds now.
+    m_modifierState.adopt(windows_subsystem::get_key_modifiers());
+    update_modifier_colors();
+    m_inputReleased = false;
+    show_status("RESTARTED", reason);
 }
@@ -18,22 +18,46 @@
 
 // 1. Qt framework headers
 #include <QMainWindow>
-#include <QJsonDocument>
 #include <QPoint>
+#include <QPointF>
+#include <QPalette>
+#include <QString>
+#include <QByteArray>
 // 2. System/OS headers
 // 3. C++ standard library headers
 #include <vector>
 #include <cstdint>
+#include <bitset>
 // 4. Project classes
+#include "app_config.h"
 #include "app_dimensions.h"
 #include "touchpad_cursor.h"
-#include "key_modifiers.h"
+#include "modifier_state.h"
+#include "key_mapping.h"
+#include "key_layout.h"
+#include "hit_index.h"
+#include "cursor_motion.h"
+#include "pointer_ballistics.h"
+#include "app_launcher.h"
+#include "window_executor.h"
+#include "latency_recorder.h"
+#include "touch_trace.h"
+#include "restart_handover.h"
+#include "startup_profiler.h"
+#include "key_repeater.h"
+#include "word_dictionary.h"
 // 5. Forward decl
 class QWidget;
 class QPushButton;
-class QVariant;
+class QFile;
+class QFileSystemWatcher;
+class QLocalServer;
+class QLocalSocket;
 class QEvent;
 class QTimer;
+class QTouchEvent;
+class input_sink;
+class input_worker;
 namespace Ui {
 class main_window;
 }
@@ -43,55 +67,150 @@ class main_window : public QMainWindow
     Q_OBJECT
 
 public:
-    main_window(QWidget* parent);
+    // sink may be nullptr for the Win32 sink, the window takes ownership either way.
+    // headless skips everything that touches the desktop (window styles, hooks, window tracking, the cursor
+    // overlay, asking the OS for modifier state), for running on the offscreen platform.
+    // profiler may be nullptr, otherwise it is marked through startup and its report logged once startup is done.
+    main_window(QWidget* parent, input_sink* sink, bool headless, startup_profiler* profiler);
     virtual ~main_window();
 
+    // public set_touch_recorder(): Records every touch event and the keys it injected into recorder, nullptr to stop.
+    void set_touch_recorder(touch_trace_writer* recorder);
+
+    // public set_handover(): Starts this window as the replacement of a running instance, see ui_on_restart().
+    // Must be called before the event loop starts.
+    void set_handover(const QString& serverName, uint64_t previousWindow);
+
 private:
-    std::vector<QPushButton*> m_keyButtonList;
+    std::vector<QPushButton*> m_keyButtonList; // indexed by key_id
+    std::vector<QString> m_keyTextOn; // indexed by key_id
+    std::vector<QString> m_keyTextOff; // indexed by key_id
     std::vector<QPushButton*> m_keyButtonLeftList;
     std::vector<QPushButton*> m_keyButtonRightTopList;
     std::vector<QPushButton*> m_keyButtonRightBottomList;
     std::vector<QWidget*> m_allButtonsList;
-    QWidget* m_downButton = nullptr;
+    int32_t m_downButtonIndex = -1; // index into m_allButtonsList
 
-    QJsonDocument m_appConfig;
+    app_config m_config;
+    QFileSystemWatcher* m_configWatcher = nullptr;
+    QTimer* m_configSettleTimer = nullptr; // restarted by every change, the reload runs once it expires
 
     app_dimensions m_appDimensions;
-    key_modifiers m_keyModifiers;
+    modifier_state m_modifierState;
 
     QTimer* m_activeKeyColorTimer = nullptr;
+    QPalette m_paletteDefault;
+    QPalette m_palettePressed;
+    QPalette m_paletteModifier;
+    QPalette m_paletteMouse;
+    QPalette m_paletteActiveKey;
+
+    // Key colours are layered, the highest set layer wins (mouse > modifier > pressed > default).
+    // Layers are changed freely and only keys whose resulting palette changed are repainted by flush_key_visuals().
+    static constexpr uint8_t visualPressed = 0x01;
+    static constexpr uint8_t visualModifier = 0x02;
+    static constexpr uint8_t visualMouse = 0x04;
+    std::vector<uint8_t> m_keyVisuals; // indexed by key_id
+    std::bitset<key_count> m_keyVisualsDirty;
+    int32_t m_lastPressedKey = -1; // key_id currently showing visualPressed
+    std::vector<key_id> m_keyLeftIds;
+    std::vector<key_id> m_keyRightTopIds;
+    std::vector<key_id> m_keyRightBottomIds;
+    key_layout m_keyLayout; // translated for the foreground window's keyboard layout, see refresh_key_layout()
+    QTimer* m_keyLayoutTimer = nullptr; // single shot, restarted by every key the user releases on a physical keyboard
+    key_repeater m_keyRepeater; // key held by touch 0, key ids are m_allButtonsList indexes below key_count
+    QTimer* m_keyRepeatTimer = nullptr; // single shot, re-armed for each of m_keyRepeater's deadlines
+
+    input_sink* m_inputSink = nullptr;
+    input_worker* m_inputWorker = nullptr;
+    input_sink* m_textSink = nullptr; // owned by m_textInjector's thread, nullptr when headless
+    text_injector* m_textInjector = nullptr;
+    latency_recorder m_latency;
+    latency_mark m_touchMark = {}; // checkpoints of the touch event being handled right now
+    latency_mark m_moveMark = {}; // checkpoints of the oldest touchpad sample not yet injected
+    bool m_headless = false;
+    touch_trace_writer* m_touchRecorder = nullptr;
+    window_executor* m_windowExecutor = nullptr;
 
     Ui::main_window* ui;
-    void open_or_show_app(const QVariant& shortcutConfig);
+    // Supersede keys for m_windowExecutor, a newer request drops an older queued one with the same key.
+    static constexpr uint32_t windowJobShortcutAbove = 1;
+    static constexpr uint32_t windowJobShortcutBelow = 2;
+    static constexpr uint32_t windowJobMoveActive = 3;
+    static constexpr uint32_t windowJobConfigReload = 4;
+    latency_histogram m_launchLatency; // launch to placed, for launches whose window turned up
+    uint64_t m_launchTimeouts = 0; // launches that showed no window
+    void open_or_show_app(const shortcut_config* shortcut);
+    static void on_launch_finished(void* context, const launch_result& result);
+    static void on_foreground_changed(void* context, const window_info* info);
+    static void on_place_window(void* context, ::HWND window, bool above, const app_dimensions& dimensions);
 
     // SECTION: Virtual keyboard functions.
 private slots:
     void ui_on_post_ctor();
-    void ui_on_state_refresher_loop();
-    void ui_on_key_press();
+    void ui_on_deferred_init();
 private:
-    void post_key_press(QPushButton* srcButton, bool modChanged, bool modOn);
+    startup_profiler* m_startupProfiler = nullptr; // only used until ui_on_deferred_init() is done
+    void mark_startup(startup_phase phase);
+    void log_startup();
+    bool append_log(const QString& fileName, const QByteArray& text);
+    void ui_on_key_press(key_id id);
+    void post_key_press(key_id id, bool modChanged, bool modOn);
+    void record_keys(const key_chord& chord, int64_t injectStartNs, int64_t injectEndNs);
+    void refresh_key_layout();
+    void dump_latency();
+    void show_status(const QString& text, const QString& detail);
+    void start_key_repeat(int32_t buttonIndex);
+    void stop_key_repeat();
+    void arm_key_repeat();
 private slots:
     void ui_on_key_press_fade();
+    void ui_on_key_repeat();
 private:
     void update_modifier_colors();
+    void send_modifier_corrections(const key_chord& corrections);
+    const QPalette& get_key_palette(uint8_t visuals) const;
+    void set_key_visual(key_id id, uint8_t layer, bool on);
+    void set_keys_visual(const std::vector<key_id>& ids, uint8_t layer, bool on);
+    void flush_key_visuals();
+    std::vector<key_id> to_key_ids(const std::vector<QPushButton*>& buttons) const;
+    static void on_hooked_key_event(void* context, uint16_t virtualKeyCode, bool keyUp, bool injectedByXti, bool xtiSettled);
 
     // SECTION: Virtual touchpad functions.
 protected:
     bool m_cursorIsMoving = false;
     bool m_cursorIsHooked = false;
-    QPoint m_cursorStartPosition;
-    int32_t m_cursorSpeed = 1;
+    QPointF m_cursorLastTouch;
     QTimer* m_cursorMoveTimerDelay = nullptr;
+    QTimer* m_cursorFlushTimer = nullptr; // paced to the display refresh rate while the cursor is hooked
+    cursor_motion m_cursorMotion;
+    pointer_ballistics m_cursorBallistics;
     touchpad_cursor* m_cursor = nullptr;
     int32_t m_leftMouseDownId = -1;
     int32_t m_rightMouseDownId = -1;
+    hit_index m_hitIndex;
+    bool m_hitIndexDirty = true;
+    hit_rect m_touchpadZone = {};
+    hit_rect m_leftClickZone = {};
+    hit_rect m_rightClickZone = {};
     virtual bool event(QEvent* ev) override;
+private:
+    void rebuild_hit_index();
+    void record_touch(const QTouchEvent* touchEvent);
+    static hit_rect zone_from_keys(const std::vector<QPushButton*>& keys);
+    void send_mouse_button(uint16_t flags);
+    void post_mouse(const mouse_stroke& stroke, latency_kind kind, const latency_mark& mark);
 private slots:
     void ui_on_cursor_move_ready();
+    void ui_on_cursor_motion_flush();
 
     // SECTION: Opening apps, and other utility functions.
+private:
+    const shortcut_config* get_shortcut(bool above, int32_t index) const;
+    void reload_config();
+    void apply_config(const app_config& config);
 private slots:
+    void ui_on_config_changed();
     void ui_on_shortcuts_above_changed(int32_t index);
     void ui_on_shortcuts_above_reopen();
     void ui_on_shortcuts_below_changed(int32_t index);
@@ -100,5 +219,50 @@ private slots:
     void ui_on_move_active_below();
     void ui_on_panic();
     void ui_on_restart();
+
+    // SECTION: Typing snippets and the clipboard.
+private:
+    void type_text(const QString& text);
+    void on_typing_done(const text_injection_report& report);
+private slots:
+    void ui_on_type_clipboard();
+
+    // SECTION: Word completion, the suggestion strip offers the most frequent words starting with m_typedWord.
+private:
+    static constexpr uint32_t suggestionCount = 3;
+    QFile* m_dictionaryFile = nullptr; // mapped for as long as the window lives
+    word_dictionary m_dictionary; // empty unless words.xtd was found next to the exe
+    std::string m_typedWord; // UTF-8, what has been typed of the current word so far
+    std::vector<word_completion> m_completions;
+    std::vector<QPushButton*> m_suggestionButtons;
+    void load_dictionary();
+    void track_typed_word(key_id id, bool shortcut);
+    void reset_typed_word();
+    void update_suggestions();
+    void ui_on_suggestion(uint32_t index);
+
+    // SECTION: Restart handover, the old instance serves m_handoverServer and the new one connects to it.
+private:
+    static constexpr int32_t handoverTimeoutMs = 10000;
+    QLocalServer* m_handoverServer = nullptr; // old instance only
+    QLocalSocket* m_handoverSocket = nullptr;
+    QString m_handoverServerName; // new instance only, empty unless started by a restart
+    uint64_t m_handoverPreviousWindow = 0; // new instance only, HWND of the instance being replaced
+    std::vector<uint8_t> m_handoverBuffer; // received bytes not yet decoded
+    QTimer* m_handoverTimeout = nullptr;
+    bool m_inputReleased = false; // touches are dropped while the handover owns input
+    int64_t m_inputReleasedNs = 0; // old instance only
+    int64_t m_handoverProcessId = 0; // old instance only, the new instance once it has been started
+    double m_handoverGapMs = -1.0; // old instance only, time with no instance handling input, -1 until measured
+    double m_handoverFrameMs = 0.0;
+    void start_handover_client();
+    void handle_handover(const handover_message& message);
+    void send_handover(const handover_message& message);
+    void release_input();
+    void close_handover();
+    void abort_handover(const QString& reason);
+private slots:
+    void ui_on_handover_connection();
+    void ui_on_handover_read();
 };
 #endif // MAIN_WINDOW_H
@@ -0,0 +1,213 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "modifier_state.h"
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+// 4. Project classes
+#include "virtual_keys.h"
+
+// --- apply_key_event(): Updates the state from a single key event.
+// ----- virtualKeyCode: The key that went down or up.
+// ----- keyUp: True if released, false if pressed.
+// ------- returns: true if a modifier or lock changed.
+// --------------------------------------------------------------------------------------------/
+/* public */ bool modifier_state::apply_key_event(uint16_t virtualKeyCode, bool keyUp)
+{
+    key_modifiers before = m_state;
+    switch (virtualKeyCode)
+    {
+    // Only the right-side modifiers are tracked, those are the ones xti holds down between presses.
+    // The left-side ones are only ever pressed and released within a single chord.
+    case VK_RCONTROL:
+        m_state.control = !keyUp;
+        break;
+    case VK_RSHIFT:
+        m_state.shift = !keyUp;
+        break;
+    case VK_RMENU:
+        m_state.alt = !keyUp;
+        break;
+    case VK_RWIN:
+        m_state.windows = !keyUp;
+        break;
+    // Locks flip on the down stroke.
+    case VK_CAPITAL:
+        m_state.capsLock = keyUp ? m_state.capsLock : !m_state.capsLock;
+        break;
+    case VK_NUMLOCK:
+        m_state.numLock = keyUp ? m_state.numLock : !m_state.numLock;
+        break;
+    case VK_SCROLL:
+        m_state.scrollLock = keyUp ? m_state.scrollLock : !m_state.scrollLock;
+        break;
+    default:
+        return false;
+    }
+    return before.control != m_state.control ||
+           before.shift != m_state.shift ||
+           before.alt != m_state.alt ||
+           before.windows != m_state.windows ||
+           before.capsLock != m_state.capsLock ||
+           before.numLock != m_state.numLock ||
+           before.scrollLock != m_state.scrollLock;
+}
+
+// --- apply_strokes(): Updates the state from strokes that were injected.
+// ----- strokes: The strokes, in injection order.
+// ----- count: Number of entries in strokes that were actually injected.
+// ------- returns: true if a modifier or lock changed.
+// --------------------------------------------------------------------------------------------/
+/* public */ bool modifier_state::apply_strokes(const key_stroke* strokes, uint32_t count)
+{
+    bool changed = false;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if ((strokes[i].flags & key_stroke::flagUnicode) != 0)
+        {
+            continue; // a typed character, e.g. U+0010 must not read as VK_SHIFT
+        }
+        changed |= apply_key_event(strokes[i].virtualKeyCode, (strokes[i].flags & key_stroke::flagKeyUp) != 0);
+    }
+    return changed;
+}
+
+// --- apply_hooked_key_event(): Updates the state from a key event seen by the keyboard hook, xti's own included.
+// xti's own strokes were applied to the state when they were sent, here they only record what reached the OS.
+// ----- virtualKeyCode: The key that went down or up.
+// ----- keyUp: True if released, false if pressed.
+// ----- injectedByXti: True if xti injected the event itself.
+// ------- returns: true if a modifier or lock changed.
+// --------------------------------------------------------------------------------------------/
+/* public */ bool modifier_state::apply_hooked_key_event(uint16_t virtualKeyCode, bool keyUp, bool injectedByXti)
+{
+    uint8_t bit = modifier_bit(virtualKeyCode);
+    if (keyUp)
+    {
+        // The OS keeps one state per key, a key-up from anyone releases it.
+        m_injectedDown = static_cast<uint8_t>(m_injectedDown & ~bit);
+        m_otherDown = static_cast<uint8_t>(m_otherDown & ~bit);
+    }
+    else if (injectedByXti)
+    {
+        m_injectedDown = static_cast<uint8_t>(m_injectedDown | bit);
+    }
+    else
+    {
+        m_otherDown = static_cast<uint8_t>(m_otherDown | bit);
+    }
+    if (injectedByXti)
+    {
+        return false;
+    }
+    return apply_key_event(virtualKeyCode, keyUp);
+}
+
+// --- reconcile(): Works out the key-ups needed to release modifiers xti left down in the OS.
+// Only call it once every stroke xti sent has been seen by the keyboard hook, until then the OS is behind the state.
+// Left-side modifiers are only ever held within a single chord so any still down are stuck, right-side ones are
+// stuck when xti no longer holds them. A modifier xti holds that the OS has released is dropped from the state.
+// ----- corrections: Receives the corrective strokes, must have room for maxCorrections entries.
+// ------- returns: The number of corrective strokes written. Inject them, then pass them to apply_strokes().
+// --------------------------------------------------------------------------------------------/
+/* public */ uint32_t modifier_state::reconcile(key_stroke* corrections)
+{
+    struct held
+    {
+        uint16_t virtualKeyCode;
+        bool* ours; // nullptr for the left side, xti never holds those between presses
+    };
+    const held modifiers[maxCorrections] = {
+        { VK_LCONTROL, nullptr },
+        { VK_LSHIFT, nullptr },
+        { VK_LMENU, nullptr },
+        { VK_LWIN, nullptr },
+        { VK_RCONTROL, &m_state.control },
+        { VK_RSHIFT, &m_state.shift },
+        { VK_RMENU, &m_state.alt },
+        { VK_RWIN, &m_state.windows },
+    };
+    uint32_t count = 0;
+    for (const held& modifier : modifiers)
+    {
+        uint8_t bit = modifier_bit(modifier.virtualKeyCode);
+        bool wanted = modifier.ours != nullptr && *modifier.ours;
+        bool down = (m_injectedDown & bit) != 0;
+        if (down && !wanted)
+        {
+            // xti pressed it and never managed to release it: send the missing key-up.
+            m_divergenceCount++;
+            uint16_t flags = key_stroke::flagKeyUp;
+            if (key_chord_builder::is_extended_key(modifier.virtualKeyCode))
+            {
+                flags |= key_stroke::flagExtended;
+            }
+            corrections[count++] = { modifier.virtualKeyCode, flags, 0 };
+        }
+        else if (wanted && !down && (m_otherDown & bit) == 0)
+        {
+            // Released behind xti's back, or the press never reached the OS. Nothing to send.
+            m_divergenceCount++;
+            *modifier.ours = false;
+        }
+    }
+    return count;
+}
+
+// --- adopt(): Replaces the state outright, e.g. at startup.
+// ----- state: The new state. Its held modifiers are taken to be right-side ones xti pressed, e.g. by the instance
+// -----        being replaced, so reconcile() keeps them.
+// --------------------------------------------------------------------------------------------/
+/* public */ void modifier_state::adopt(const key_modifiers& state)
+{
+    m_state = state;
+    m_injectedDown = 0;
+    const bool held[] = { state.control, state.shift, state.alt, state.windows };
+    const uint16_t keys[] = { VK_RCONTROL, VK_RSHIFT, VK_RMENU, VK_RWIN };
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        if (held[i])
+        {
+            m_injectedDown = static_cast<uint8_t>(m_injectedDown | modifier_bit(keys[i]));
+        }
+    }
+}
+
+/* private */ uint8_t modifier_state::modifier_bit(uint16_t virtualKeyCode)
+{
+    switch (virtualKeyCode)
+    {
+    case VK_LCONTROL:
+        return 0x01;
+    case VK_LSHIFT:
+        return 0x02;
+    case VK_LMENU:
+        return 0x04;
+    case VK_LWIN:
+        return 0x08;
+    case VK_RCONTROL:
+        return 0x10;
+    case VK_RSHIFT:
+        return 0x20;
+    case VK_RMENU:
+        return 0x40;
+    case VK_RWIN:
+        return 0x80;
+    default:
+        return 0;
+    }
+}
@@ -0,0 +1,72 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef MODIFIER_STATE_H
+#define MODIFIER_STATE_H
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <cstdint>
+// 4. Project classes
+#include "key_modifiers.h"
+#include "key_chord.h"
+// 5. Forward decl
+
+// xti's own view of which modifiers are held and which locks are on.
+// Updated as events happen (strokes xti injects, key events seen by the keyboard hook) instead of polling the OS.
+// The hook also reports xti's own strokes, so which modifiers xti left down in the OS is known on both sides and
+// reconcile() can release any that should be up (e.g. an ALT whose key-up got lost) without asking the OS.
+class modifier_state
+{
+public:
+    static constexpr uint32_t maxCorrections = 8; // control, shift, alt and windows, left and right
+
+    const key_modifiers& get() const { return m_state; }
+
+    // public apply_key_event(): Updates the state from a single key event.
+    // see cpp file for more info.
+    bool apply_key_event(uint16_t virtualKeyCode, bool keyUp);
+
+    // public apply_strokes(): Updates the state from strokes that were injected.
+    // see cpp file for more info.
+    bool apply_strokes(const key_stroke* strokes, uint32_t count);
+
+    // public apply_hooked_key_event(): Updates the state from a key event seen by the keyboard hook, xti's own included.
+    // see cpp file for more info.
+    bool apply_hooked_key_event(uint16_t virtualKeyCode, bool keyUp, bool injectedByXti);
+
+    // public reconcile(): Works out the key-ups needed to release modifiers xti left down in the OS.
+    // see cpp file for more info.
+    uint32_t reconcile(key_stroke* corrections);
+
+    // public adopt(): Replaces the state outright, e.g. at startup. Held modifiers are taken to be xti's.
+    // see cpp file for more info.
+    void adopt(const key_modifiers& state);
+
+    // Number of times the OS and xti have disagreed, see reconcile().
+    uint64_t divergence_count() const { return m_divergenceCount; }
+
+private:
+    key_modifiers m_state = {};
+    uint8_t m_injectedDown = 0; // modifier_bit() of every modifier down in the OS because xti pressed it
+    uint8_t m_otherDown = 0; // same for modifiers pressed by anything else, e.g. a physical keyboard
+    uint64_t m_divergenceCount = 0;
+
+    // private modifier_bit(): Gets the bit of a left or right modifier in m_injectedDown and m_otherDown, 0 for other keys.
+    static uint8_t modifier_bit(uint16_t virtualKeyCode);
+};
+
+#endif // MODIFIER_STATE_H
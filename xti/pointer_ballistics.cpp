@@ -0,0 +1,85 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "pointer_ballistics.h"
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <cmath>
+// 4. Project classes
+
+// --- reset(): Starts a new stroke, forgetting velocity and remainders.
+// ----- timestampMs: Timestamp of the touch that started the stroke, the first sample's velocity is measured from it.
+// --------------------------------------------------------------------------------------------/
+/* public */ void pointer_ballistics::reset(uint64_t timestampMs)
+{
+    m_lastTimestampMs = timestampMs;
+    m_velocity = 0.0;
+    m_remainderX = 0.0;
+    m_remainderY = 0.0;
+}
+
+// --- add_sample(): Converts one touch sample into whole cursor pixels.
+// ----- dx: Horizontal finger motion since the previous sample, in touch pixels.
+// ----- dy: Vertical finger motion since the previous sample, in touch pixels.
+// ----- timestampMs: Timestamp of the sample, from the same clock as the one given to reset().
+// ----- outDx: Receives the horizontal cursor motion in whole pixels.
+// ----- outDy: Receives the vertical cursor motion in whole pixels.
+// --------------------------------------------------------------------------------------------/
+/* public */ void pointer_ballistics::add_sample(double dx, double dy, uint64_t timestampMs, int32_t& outDx, int32_t& outDy)
+{
+    // Samples with the same (or an out of order) timestamp keep the previous velocity,
+    // digitizers often deliver several samples per millisecond tick.
+    if (timestampMs > m_lastTimestampMs)
+    {
+        double elapsedMs = static_cast<double>(timestampMs - m_lastTimestampMs);
+        double speed = std::sqrt(dx * dx + dy * dy) / elapsedMs;
+        // Light smoothing so one noisy sample cannot make the cursor jump.
+        m_velocity = m_velocity == 0.0 ? speed : (m_velocity + speed) * 0.5;
+        m_lastTimestampMs = timestampMs;
+    }
+    double gain = get_gain(m_curve, m_velocity) * m_baseGain;
+    double moveX = dx * gain + m_remainderX;
+    double moveY = dy * gain + m_remainderY;
+    // Truncate towards zero so the remainder keeps the sign of the motion it came from.
+    double wholeX = std::trunc(moveX);
+    double wholeY = std::trunc(moveY);
+    m_remainderX = moveX - wholeX;
+    m_remainderY = moveY - wholeY;
+    outDx = static_cast<int32_t>(wholeX);
+    outDy = static_cast<int32_t>(wholeY);
+}
+
+// --- get_gain(): Gets the gain the curve gives at a speed.
+// ----- curve: The transfer curve.
+// ----- speed: Finger speed in touch pixels per millisecond.
+// ------- returns: The gain, between curve.minGain and curve.maxGain.
+// --------------------------------------------------------------------------------------------/
+/* public */ double pointer_ballistics::get_gain(const ballistics_curve& curve, double speed)
+{
+    if (speed <= curve.lowSpeed)
+    {
+        return curve.minGain;
+    }
+    if (speed >= curve.highSpeed)
+    {
+        return curve.maxGain;
+    }
+    // Smoothstep between the two ends, so the gain has no sudden kinks the finger can feel.
+    double t = (speed - curve.lowSpeed) / (curve.highSpeed - curve.lowSpeed);
+    t = t * t * (3.0 - 2.0 * t);
+    return curve.minGain + (curve.maxGain - curve.minGain) * t;
+}
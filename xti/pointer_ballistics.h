@@ -0,0 +1,74 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef POINTER_BALLISTICS_H
+#define POINTER_BALLISTICS_H
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <cstdint>
+// 4. Project classes
+// 5. Forward decl
+
+// Transfer curve from finger speed to cursor gain. Speeds are in touch pixels per millisecond.
+// Below lowSpeed the gain is minGain (precise pointing), above highSpeed it is maxGain (crossing the screen),
+// in between it eases from one to the other.
+struct ballistics_curve
+{
+    double minGain = 3.0;
+    double maxGain = 14.0;
+    double lowSpeed = 0.05;
+    double highSpeed = 1.0;
+};
+
+// Turns touchpad finger motion into cursor motion.
+// Velocity comes from the touch timestamps rather than from how often samples arrive, and the fractional
+// pixels left over from each sample are carried into the next one so slow motion is never lost.
+// Has no OS or Qt dependencies, everything it needs is passed in.
+class pointer_ballistics
+{
+public:
+    // public set_curve(): Replaces the transfer curve, takes effect from the next sample.
+    void set_curve(const ballistics_curve& curve) { m_curve = curve; }
+
+    // public set_base_gain(): Scales the whole curve (1.0 is neutral). Not for the OS pointer speed, the OS already
+    // applies that to the relative moves this produces.
+    void set_base_gain(double baseGain) { m_baseGain = baseGain; }
+
+    // public reset(): Starts a new stroke, forgetting velocity and remainders.
+    // see cpp file for more info.
+    void reset(uint64_t timestampMs);
+
+    // public add_sample(): Converts one touch sample into whole cursor pixels.
+    // see cpp file for more info.
+    void add_sample(double dx, double dy, uint64_t timestampMs, int32_t& outDx, int32_t& outDy);
+
+    // public get_gain(): Gets the gain the curve gives at a speed, without the base gain.
+    // see cpp file for more info.
+    static double get_gain(const ballistics_curve& curve, double speed);
+
+    double get_velocity() const { return m_velocity; }
+
+private:
+    ballistics_curve m_curve;
+    double m_baseGain = 1.0;
+    uint64_t m_lastTimestampMs = 0;
+    double m_velocity = 0.0; // smoothed, touch pixels per millisecond
+    double m_remainderX = 0.0;
+    double m_remainderY = 0.0;
+};
+
+#endif // POINTER_BALLISTICS_H
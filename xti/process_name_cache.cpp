@@ -0,0 +1,171 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "process_name_cache.h"
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <algorithm>
+#include <cctype>
+// 4. Project classes
+#include "error_reporter.h"
+
+/* public */ process_name_cache::~process_name_cache()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    while (!m_entries.empty())
+    {
+        evict(m_entries.begin());
+    }
+}
+
+// --- get_exe_name(): Gets the UPPERCASE exe name (without directory) of a process.
+// ----- processId: Native numerical identifier the kernel has assigned to the process.
+// ------- returns: the UPPERCASE exe name, or empty string if the process could not be opened (gone, or off limits).
+// --------------------------------------------------------------------------------------------/
+/* public */ std::wstring process_name_cache::get_exe_name(uint32_t processId)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    drain_exited();
+    std::unordered_map<uint32_t, std::unique_ptr<entry>>::iterator found = m_entries.find(processId);
+    if (found != m_entries.end())
+    {
+        if (!found->second->exited.load(std::memory_order_acquire))
+        {
+            m_hits++;
+            return found->second->exeNameUpper;
+        }
+        // The process is gone, anything now using this PID is a different process.
+        evict(found);
+    }
+    m_misses++;
+
+    // Limited information is enough for the image name and is granted for far more processes than
+    // PROCESS_QUERY_INFORMATION | PROCESS_VM_READ, without reading the other process's memory.
+    ::HANDLE process = ::OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION | SYNCHRONIZE, false, processId);
+    if (process == nullptr)
+    {
+        uint32_t errCode = ::GetLastError();
+        if (errCode == ERROR_ACCESS_DENIED || errCode == ERROR_INVALID_PARAMETER)
+        {
+            // system processes are off bounds and exited processes no longer exist, just skip them.
+            return L"";
+        }
+        error_reporter::stop(__FILE__, __LINE__, "Win32::OpenProcess() failure.");
+    }
+    wchar_t imagePath[MAX_PATH];
+    uint32_t imagePathLength = MAX_PATH;
+    int32_t r = ::QueryFullProcessImageNameW(process, 0, imagePath, reinterpret_cast<::DWORD*>(&imagePathLength));
+    if (r == 0)
+    {
+        r = ::CloseHandle(process);
+        if (r == 0)
+        {
+            error_reporter::stop(__FILE__, __LINE__, "Win32::CloseHandle() failure.");
+        }
+        // Happens for processes that are part way through exiting.
+        return L"";
+    }
+    std::wstring exeNameUpper(imagePath, imagePathLength);
+    size_t lastSlash = exeNameUpper.find_last_of(L'\\');
+    if (lastSlash != std::wstring::npos)
+    {
+        exeNameUpper.erase(0, lastSlash + 1);
+    }
+    std::transform(exeNameUpper.begin(), exeNameUpper.end(), exeNameUpper.begin(), ::toupper);
+
+    std::unique_ptr<entry> added = std::make_unique<entry>();
+    added->owner = this;
+    added->processId = processId;
+    added->exeNameUpper = exeNameUpper;
+    added->process = process;
+    r = ::RegisterWaitForSingleObject(&added->exitWait, process, on_process_exit, added.get(), INFINITE,
+                                      WT_EXECUTEONLYONCE | WT_EXECUTEINWAITTHREAD);
+    if (r == 0)
+    {
+        error_reporter::stop(__FILE__, __LINE__, "Win32::RegisterWaitForSingleObject() failure.");
+    }
+    m_entries.emplace(processId, std::move(added));
+    return exeNameUpper;
+}
+
+/* public */ void process_name_cache::evict_exited()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    drain_exited();
+}
+
+/* public */ process_name_cache_stats process_name_cache::get_stats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    process_name_cache_stats stats;
+    stats.hits = m_hits;
+    stats.misses = m_misses;
+    stats.evictions = m_evictions;
+    stats.size = static_cast<uint32_t>(m_entries.size());
+    return stats;
+}
+
+// Must be called with m_mutex held.
+/* private */ void process_name_cache::evict(std::unordered_map<uint32_t, std::unique_ptr<entry>>::iterator found)
+{
+    // INVALID_HANDLE_VALUE waits for a callback that is already running, so the entry is never used after it's freed.
+    int32_t r = ::UnregisterWaitEx(found->second->exitWait, INVALID_HANDLE_VALUE);
+    if (r == 0)
+    {
+        error_reporter::stop(__FILE__, __LINE__, "Win32::UnregisterWaitEx() failure.");
+    }
+    r = ::CloseHandle(found->second->process);
+    if (r == 0)
+    {
+        error_reporter::stop(__FILE__, __LINE__, "Win32::CloseHandle() failure.");
+    }
+    m_entries.erase(found);
+    m_evictions++;
+}
+
+// Must be called with m_mutex held. The queue is taken first and m_exitedMutex let go of before evicting, since
+// evict() waits for exit callbacks still running and those take m_exitedMutex.
+/* private */ void process_name_cache::drain_exited()
+{
+    std::vector<uint32_t> exitedIds;
+    {
+        std::lock_guard<std::mutex> exitedLock(m_exitedMutex);
+        if (m_exitedIds.empty())
+        {
+            return;
+        }
+        exitedIds.swap(m_exitedIds);
+    }
+    for (uint32_t processId : exitedIds)
+    {
+        std::unordered_map<uint32_t, std::unique_ptr<entry>>::iterator found = m_entries.find(processId);
+        // The PID may already have been looked up again and belong to a new, running process.
+        if (found != m_entries.end() && found->second->exited.load(std::memory_order_acquire))
+        {
+            evict(found);
+        }
+    }
+}
+
+// Runs on a thread pool wait thread, must stay tiny.
+/* private */ void __stdcall process_name_cache::on_process_exit(void* context, [[maybe_unused]] ::BOOLEAN timedOut)
+{
+    entry* exited = static_cast<entry*>(context);
+    exited->exited.store(true, std::memory_order_release);
+    std::lock_guard<std::mutex> lock(exited->owner->m_exitedMutex);
+    exited->owner->m_exitedIds.push_back(exited->processId);
+}
@@ -0,0 +1,87 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef PROCESS_NAME_CACHE_H
+#define PROCESS_NAME_CACHE_H
+
+// 1. Qt framework headers
+// 2. System/OS headers
+#include <Windows.h>
+// 3. C++ standard library headers
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+// 4. Project classes
+// 5. Forward decl
+
+struct process_name_cache_stats
+{
+    uint64_t hits;
+    uint64_t misses; // lookups that had to open the process
+    uint64_t evictions; // entries dropped because their process exited or was removed
+    uint32_t size;
+};
+
+// Remembers the UPPERCASE exe name of each process it has been asked about.
+// Every entry holds a handle to its process, which stops Windows from reusing the PID while it is cached,
+// and a thread pool wait that queues the entry for eviction the moment the process exits. The queue is drained
+// (handle and wait released) on the next lookup or evict_exited() call. A hit costs no kernel calls at all.
+// Safe to use from several threads.
+class process_name_cache
+{
+public:
+    process_name_cache() = default;
+    ~process_name_cache();
+    process_name_cache(const process_name_cache&) = delete;
+    process_name_cache& operator=(const process_name_cache&) = delete;
+
+    // public get_exe_name(): Gets the UPPERCASE exe name (without directory) of a process.
+    // see cpp file for more info.
+    std::wstring get_exe_name(uint32_t processId);
+
+    // public evict_exited(): Drops the processes that have exited since the last lookup, e.g. when a window is destroyed.
+    void evict_exited();
+
+    process_name_cache_stats get_stats() const;
+
+private:
+    struct entry
+    {
+        process_name_cache* owner = nullptr;
+        uint32_t processId = 0;
+        std::wstring exeNameUpper;
+        ::HANDLE process = nullptr;
+        ::HANDLE exitWait = nullptr;
+        std::atomic<bool> exited { false };
+    };
+
+    std::unordered_map<uint32_t, std::unique_ptr<entry>> m_entries;
+    mutable std::mutex m_mutex;
+    uint64_t m_hits = 0;
+    uint64_t m_misses = 0;
+    uint64_t m_evictions = 0;
+    std::mutex m_exitedMutex; // only ever held on its own, the exit callback must not wait for m_mutex
+    std::vector<uint32_t> m_exitedIds; // guarded by m_exitedMutex
+
+    void evict(std::unordered_map<uint32_t, std::unique_ptr<entry>>::iterator found);
+    void drain_exited();
+    static void __stdcall on_process_exit(void* context, ::BOOLEAN timedOut);
+};
+
+#endif // PROCESS_NAME_CACHE_H
@@ -0,0 +1,104 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "process_registry.h"
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+// 4. Project classes
+
+// --- apply_snapshot(): Brings the registry in line with a snapshot of every running process.
+// Only the differences do any work beyond one hash lookup per process.
+// ----- snapshot: Every process running right now, names UPPERCASE.
+// ----- removedOut: Receives the PIDs of processes that are gone (or whose PID now belongs to another exe). Can be nullptr.
+// --------------------------------------------------------------------------------------------/
+/* public */ void process_registry::apply_snapshot(const std::vector<process_entry>& snapshot, std::vector<uint32_t>* removedOut)
+{
+    m_generation++;
+    for (size_t i = 0; i < snapshot.size(); i++)
+    {
+        const process_entry& entry = snapshot[i];
+        std::unordered_map<uint32_t, tracked_process>::iterator found = m_processes.find(entry.processId);
+        if (found != m_processes.end())
+        {
+            if (found->second.exeNameUpper == entry.exeNameUpper)
+            {
+                found->second.generation = m_generation;
+                continue;
+            }
+            // The PID has been reused by a different exe since the last snapshot.
+            remove_running(found->second.exeNameUpper);
+            m_removed++;
+            if (removedOut != nullptr)
+            {
+                removedOut->push_back(entry.processId);
+            }
+            found->second.exeNameUpper = entry.exeNameUpper;
+            found->second.generation = m_generation;
+        }
+        else
+        {
+            m_processes.emplace(entry.processId, tracked_process { entry.exeNameUpper, m_generation });
+        }
+        add_running(entry.exeNameUpper);
+        m_added++;
+    }
+    // Anything not seen in this snapshot has exited.
+    for (std::unordered_map<uint32_t, tracked_process>::iterator it = m_processes.begin(); it != m_processes.end();)
+    {
+        if (it->second.generation == m_generation)
+        {
+            ++it;
+            continue;
+        }
+        remove_running(it->second.exeNameUpper);
+        m_removed++;
+        if (removedOut != nullptr)
+        {
+            removedOut->push_back(it->first);
+        }
+        it = m_processes.erase(it);
+    }
+}
+
+/* public */ process_registry_stats process_registry::get_stats() const
+{
+    process_registry_stats stats;
+    stats.size = static_cast<uint32_t>(m_processes.size());
+    stats.snapshots = m_generation;
+    stats.added = m_added;
+    stats.removed = m_removed;
+    return stats;
+}
+
+/* private */ void process_registry::add_running(const std::wstring& exeNameUpper)
+{
+    m_runningByExe[exeNameUpper]++;
+}
+
+/* private */ void process_registry::remove_running(const std::wstring& exeNameUpper)
+{
+    std::unordered_map<std::wstring, uint32_t>::iterator found = m_runningByExe.find(exeNameUpper);
+    if (found == m_runningByExe.end())
+    {
+        return;
+    }
+    found->second--;
+    if (found->second == 0)
+    {
+        m_runningByExe.erase(found);
+    }
+}
@@ -0,0 +1,75 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef PROCESS_REGISTRY_H
+#define PROCESS_REGISTRY_H
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+// 4. Project classes
+// 5. Forward decl
+
+struct process_entry
+{
+    uint32_t processId;
+    std::wstring exeNameUpper;
+};
+
+struct process_registry_stats
+{
+    uint32_t size;
+    uint64_t snapshots;
+    uint64_t added;
+    uint64_t removed;
+};
+
+// Set of running processes, kept current by diffing whole-system snapshots against what it already holds.
+// Grows with the snapshot, there is no fixed process limit, and is_running() is a hash lookup.
+// Has no OS dependencies, the snapshots are taken by the caller.
+class process_registry
+{
+public:
+    // public apply_snapshot(): Brings the registry in line with a snapshot of every running process.
+    // see cpp file for more info.
+    void apply_snapshot(const std::vector<process_entry>& snapshot, std::vector<uint32_t>* removedOut);
+
+    // public is_running(): Determines if any process with the exe name is running.
+    bool is_running(const std::wstring& exeNameUpper) const { return m_runningByExe.find(exeNameUpper) != m_runningByExe.end(); }
+
+    process_registry_stats get_stats() const;
+
+private:
+    struct tracked_process
+    {
+        std::wstring exeNameUpper;
+        uint64_t generation; // snapshot it was last seen in
+    };
+
+    std::unordered_map<uint32_t, tracked_process> m_processes;
+    std::unordered_map<std::wstring, uint32_t> m_runningByExe; // exe name -> number of processes running it
+    uint64_t m_generation = 0;
+    uint64_t m_added = 0;
+    uint64_t m_removed = 0;
+
+    void add_running(const std::wstring& exeNameUpper);
+    void remove_running(const std::wstring& exeNameUpper);
+};
+
+#endif // PROCESS_REGISTRY_H
@@ -0,0 +1,56 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "recording_input_sink.h"
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+// 4. Project classes
+
+recording_input_sink::recording_input_sink()
+    : m_keyBatches(0)
+    , m_mouseStrokes(0)
+{
+}
+
+/* public */ uint32_t recording_input_sink::send_keys(const key_stroke* strokes, uint32_t count)
+{
+    m_keys.insert(m_keys.end(), strokes, strokes + count);
+    m_keyBatches++;
+    return count;
+}
+
+/* public */ uint32_t recording_input_sink::send_mouse([[maybe_unused]] const mouse_stroke* strokes, uint32_t count)
+{
+    m_mouseStrokes.fetch_add(count, std::memory_order_relaxed);
+    return count;
+}
+
+/* public */ void recording_input_sink::take_keys(std::vector<key_stroke>& strokesOut)
+{
+    strokesOut.clear();
+    strokesOut.swap(m_keys);
+}
+
+/* public */ uint64_t recording_input_sink::get_key_batches() const
+{
+    return m_keyBatches;
+}
+
+/* public */ uint64_t recording_input_sink::get_mouse_strokes() const
+{
+    return m_mouseStrokes.load(std::memory_order_relaxed);
+}
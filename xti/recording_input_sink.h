@@ -0,0 +1,54 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef RECORDING_INPUT_SINK_H
+#define RECORDING_INPUT_SINK_H
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <atomic>
+#include <cstdint>
+#include <vector>
+// 4. Project classes
+#include "input_sink.h"
+// 5. Forward decl
+
+// Accepts everything and injects nothing. Key strokes are kept for the caller to inspect, mouse events
+// (which arrive on the input_worker thread) are only counted.
+class recording_input_sink : public input_sink
+{
+public:
+    recording_input_sink();
+
+    virtual uint32_t send_keys(const key_stroke* strokes, uint32_t count) override;
+    virtual uint32_t send_mouse(const mouse_stroke* strokes, uint32_t count) override;
+
+    // public take_keys(): Moves out the key strokes received since the last call. Same thread as send_keys() only.
+    void take_keys(std::vector<key_stroke>& strokesOut);
+
+    // public get_key_batches(): Number of send_keys() calls, i.e. chords injected.
+    uint64_t get_key_batches() const;
+
+    // public get_mouse_strokes(): Number of mouse events received, safe from any thread.
+    uint64_t get_mouse_strokes() const;
+
+private:
+    std::vector<key_stroke> m_keys;
+    uint64_t m_keyBatches;
+    std::atomic<uint64_t> m_mouseStrokes;
+};
+
+#endif // RECORDING_INPUT_SINK_H
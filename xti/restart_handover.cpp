@@ -0,0 +1,188 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "restart_handover.h"
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+// 4. Project classes
+
+static constexpr uint8_t handoverVersion = 1;
+// Frames are a few dozen bytes, anything bigger is a corrupt length.
+static constexpr uint64_t maxPayloadSize = 64 * 1024;
+
+static void write_varint(std::vector<uint8_t>& bytes, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        bytes.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    bytes.push_back(static_cast<uint8_t>(value));
+}
+
+// Returns false if the buffer ends before the varint does, or it is longer than 64 bits can hold.
+static bool read_varint(const uint8_t* data, size_t size, size_t& offset, uint64_t& valueOut)
+{
+    valueOut = 0;
+    for (uint32_t shift = 0; shift < 64; shift += 7)
+    {
+        if (offset >= size)
+        {
+            return false;
+        }
+        uint8_t byte = data[offset++];
+        valueOut |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void write_string(std::vector<uint8_t>& bytes, const std::wstring& text)
+{
+    // Code units go out as varints, so the format is the same whether wchar_t is 16 or 32 bits.
+    write_varint(bytes, text.size());
+    for (size_t i = 0; i < text.size(); i++)
+    {
+        write_varint(bytes, static_cast<uint32_t>(text[i]));
+    }
+}
+
+static bool read_string(const uint8_t* data, size_t size, size_t& offset, std::wstring& textOut)
+{
+    uint64_t length = 0;
+    if (!read_varint(data, size, offset, length) || length > size - offset)
+    {
+        return false;
+    }
+    textOut.clear();
+    textOut.reserve(static_cast<size_t>(length));
+    for (uint64_t i = 0; i < length; i++)
+    {
+        uint64_t unit = 0;
+        if (!read_varint(data, size, offset, unit))
+        {
+            return false;
+        }
+        textOut.push_back(static_cast<wchar_t>(unit));
+    }
+    return true;
+}
+
+// --- encode(): Appends one framed message.
+// Frame: version byte, varint payload length, then the payload (type byte, and the state for typeState).
+// ----- message: The message to send.
+// ----- bytes: Receives the frame at its end.
+// --------------------------------------------------------------------------------------------/
+/* public */ void handover_codec::encode(const handover_message& message, std::vector<uint8_t>& bytes)
+{
+    std::vector<uint8_t> payload;
+    payload.push_back(message.type);
+    if (message.type == handover_message::typeState)
+    {
+        const key_modifiers& modifiers = message.state.modifiers;
+        uint8_t bits = static_cast<uint8_t>((modifiers.capsLock ? 0x01 : 0) | (modifiers.numLock ? 0x02 : 0) |
+                                            (modifiers.scrollLock ? 0x04 : 0) | (modifiers.control ? 0x08 : 0) |
+                                            (modifiers.shift ? 0x10 : 0) | (modifiers.alt ? 0x20 : 0) |
+                                            (modifiers.windows ? 0x40 : 0));
+        payload.push_back(bits);
+        write_string(payload, message.state.shortcutAbove);
+        write_string(payload, message.state.shortcutBelow);
+        write_varint(payload, static_cast<uint64_t>(message.state.releasedNs));
+    }
+    bytes.push_back(handoverVersion);
+    write_varint(bytes, payload.size());
+    bytes.insert(bytes.end(), payload.begin(), payload.end());
+}
+
+// --- decode(): Reads the first message from the start of a stream buffer.
+// ----- data: Bytes received so far, starting at a frame boundary.
+// ----- size: Number of bytes in data.
+// ----- messageOut: Receives the message, only valid when a non-zero size is returned.
+// ----- errorOut: Set to true if the stream is not a handover stream of this version, nothing more can be read from it.
+// ------- returns: Number of bytes the message took, drop that many from the buffer. 0 if the frame is not complete yet.
+// --------------------------------------------------------------------------------------------/
+/* public */ size_t handover_codec::decode(const uint8_t* data, size_t size, handover_message& messageOut, bool& errorOut)
+{
+    errorOut = false;
+    if (size == 0)
+    {
+        return 0;
+    }
+    if (data[0] != handoverVersion)
+    {
+        errorOut = true;
+        return 0;
+    }
+    size_t offset = 1;
+    uint64_t payloadSize = 0;
+    if (!read_varint(data, size, offset, payloadSize))
+    {
+        // A varint can only be cut short by the end of what has arrived so far.
+        errorOut = offset - 1 >= 10;
+        return 0;
+    }
+    if (payloadSize == 0 || payloadSize > maxPayloadSize)
+    {
+        errorOut = true;
+        return 0;
+    }
+    if (payloadSize > size - offset)
+    {
+        return 0;
+    }
+
+    const uint8_t* payload = data + offset;
+    size_t payloadEnd = static_cast<size_t>(payloadSize);
+    size_t position = 0;
+    messageOut = {};
+    messageOut.type = payload[position++];
+    if (messageOut.type == handover_message::typeState)
+    {
+        if (position >= payloadEnd)
+        {
+            errorOut = true;
+            return 0;
+        }
+        uint8_t bits = payload[position++];
+        key_modifiers& modifiers = messageOut.state.modifiers;
+        modifiers.capsLock = (bits & 0x01) != 0;
+        modifiers.numLock = (bits & 0x02) != 0;
+        modifiers.scrollLock = (bits & 0x04) != 0;
+        modifiers.control = (bits & 0x08) != 0;
+        modifiers.shift = (bits & 0x10) != 0;
+        modifiers.alt = (bits & 0x20) != 0;
+        modifiers.windows = (bits & 0x40) != 0;
+        uint64_t releasedNs = 0;
+        if (!read_string(payload, payloadEnd, position, messageOut.state.shortcutAbove) ||
+            !read_string(payload, payloadEnd, position, messageOut.state.shortcutBelow) ||
+            !read_varint(payload, payloadEnd, position, releasedNs))
+        {
+            errorOut = true;
+            return 0;
+        }
+        messageOut.state.releasedNs = static_cast<int64_t>(releasedNs);
+    }
+    else if (messageOut.type != handover_message::typeReady && messageOut.type != handover_message::typeTakenOver)
+    {
+        errorOut = true;
+        return 0;
+    }
+    return offset + payloadEnd;
+}
@@ -0,0 +1,64 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef RESTART_HANDOVER_H
+#define RESTART_HANDOVER_H
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+// 4. Project classes
+#include "key_modifiers.h"
+// 5. Forward decl
+
+// Everything a restarted xti takes over from the instance it replaces.
+struct handover_state
+{
+    key_modifiers modifiers; // as xti holds them, including modifiers it left down
+    std::wstring shortcutAbove; // display name selected in each combo box, empty for none
+    std::wstring shortcutBelow;
+    int64_t releasedNs; // latency_recorder::now_ns() when the old instance stopped handling input
+};
+
+// One message between the old (server) and new (client) instance during a restart, in the order they are sent.
+struct handover_message
+{
+    static constexpr uint8_t typeReady = 1; // new -> old: window up and hooks installed, send the state
+    static constexpr uint8_t typeState = 2; // old -> new: carries state, the old instance has stopped handling input
+    static constexpr uint8_t typeTakenOver = 3; // new -> old: state applied, the old instance can go
+
+    uint8_t type;
+    handover_state state; // only with typeState
+};
+
+// Frames handover messages for a byte stream. Each frame starts with the format version, so an instance
+// restarting into a newer build sees a mismatch as an error instead of misreading the state.
+class handover_codec // static members only
+{
+public:
+    // public encode(): Appends one framed message.
+    // see cpp file for more info.
+    static void encode(const handover_message& message, std::vector<uint8_t>& bytes);
+
+    // public decode(): Reads the first message from the start of a stream buffer.
+    // see cpp file for more info.
+    static size_t decode(const uint8_t* data, size_t size, handover_message& messageOut, bool& errorOut);
+};
+
+#endif // RESTART_HANDOVER_H
@@ -0,0 +1,98 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "simulated_window_source.h"
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <algorithm>
+// 4. Project classes
+
+/* public */ void simulated_window_source::start(window_event_sink* sink)
+{
+    m_sink = sink;
+    for (size_t i = 0; i < m_existing.size(); i++)
+    {
+        m_sink->on_window_created(m_existing[i]);
+    }
+    m_existing.clear();
+}
+
+/* public */ void simulated_window_source::stop()
+{
+    m_sink = nullptr;
+}
+
+/* public */ void simulated_window_source::create(const window_info& info)
+{
+    if (m_sink == nullptr)
+    {
+        m_existing.push_back(info);
+        return;
+    }
+    m_sink->on_window_created(info);
+}
+
+/* public */ void simulated_window_source::destroy(window_id id)
+{
+    if (m_sink == nullptr)
+    {
+        m_existing.erase(std::remove_if(m_existing.begin(), m_existing.end(),
+                                        [id](const window_info& info) { return info.id == id; }), m_existing.end());
+        return;
+    }
+    m_sink->on_window_destroyed(id);
+}
+
+/* public */ void simulated_window_source::rename(window_id id, const std::wstring& title)
+{
+    if (m_sink == nullptr)
+    {
+        for (size_t i = 0; i < m_existing.size(); i++)
+        {
+            if (m_existing[i].id == id)
+            {
+                m_existing[i].title = title;
+            }
+        }
+        return;
+    }
+    m_sink->on_window_renamed(id, title);
+}
+
+/* public */ void simulated_window_source::set_visible(window_id id, bool visible)
+{
+    if (m_sink == nullptr)
+    {
+        for (size_t i = 0; i < m_existing.size(); i++)
+        {
+            if (m_existing[i].id == id)
+            {
+                m_existing[i].visible = visible;
+            }
+        }
+        return;
+    }
+    m_sink->on_window_visibility(id, visible);
+}
+
+/* public */ void simulated_window_source::set_foreground(window_id id)
+{
+    if (m_sink != nullptr)
+    {
+        m_sink->on_foreground_changed(id);
+    }
+}
@@ -0,0 +1,48 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef SIMULATED_WINDOW_SOURCE_H
+#define SIMULATED_WINDOW_SOURCE_H
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <cstdint>
+#include <string>
+#include <vector>
+// 4. Project classes
+#include "window_registry.h"
+// 5. Forward decl
+
+// window_event_source driven by hand, for exercising and benchmarking a window_registry without a desktop.
+// Windows created before start() are reported as already existing when it's called.
+class simulated_window_source : public window_event_source
+{
+public:
+    virtual void start(window_event_sink* sink) override;
+    virtual void stop() override;
+
+    void create(const window_info& info);
+    void destroy(window_id id);
+    void rename(window_id id, const std::wstring& title);
+    void set_visible(window_id id, bool visible);
+    void set_foreground(window_id id);
+
+private:
+    window_event_sink* m_sink = nullptr;
+    std::vector<window_info> m_existing; // only used until start()
+};
+
+#endif // SIMULATED_WINDOW_SOURCE_H
@@ -0,0 +1,90 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+// 4. Project classes
+// 5. Forward decl
+
+// Bounded lock-free queue for exactly one producer thread and one consumer thread.
+// Capacity must be a power of two. Items come out in the order they went in.
+template <typename T, uint32_t Capacity>
+class spsc_ring
+{
+    static_assert(Capacity != 0 && (Capacity & (Capacity - 1)) == 0, "spsc_ring capacity must be a power of two.");
+
+public:
+    // Producer only. Returns false without blocking if the ring is full.
+    bool try_push(const T& item)
+    {
+        uint32_t head = m_head.load(std::memory_order_relaxed);
+        uint32_t tail = m_tail.load(std::memory_order_acquire);
+        if (head - tail == Capacity)
+        {
+            return false;
+        }
+        m_items[head & (Capacity - 1)] = item;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only. Moves up to maxCount items into out, oldest first. Returns the number moved.
+    uint32_t pop_batch(T* out, uint32_t maxCount)
+    {
+        uint32_t tail = m_tail.load(std::memory_order_relaxed);
+        uint32_t head = m_head.load(std::memory_order_acquire);
+        uint32_t count = head - tail;
+        if (count > maxCount)
+        {
+            count = maxCount;
+        }
+        for (uint32_t i = 0; i < count; i++)
+        {
+            out[i] = m_items[(tail + i) & (Capacity - 1)];
+        }
+        m_tail.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    // Either thread. Only a snapshot, the other side may change it straight after.
+    uint32_t size() const
+    {
+        return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+private:
+    // Producer and consumer indexes are padded apart so they do not share a cache line.
+    // Explicit padding rather than alignas, which MSVC warns about (C4324) when it pads the class.
+    static constexpr size_t cacheLineSize = 64;
+    std::atomic<uint32_t> m_head { 0 };
+    char m_headPadding[cacheLineSize - sizeof(std::atomic<uint32_t>)];
+    std::atomic<uint32_t> m_tail { 0 };
+    char m_tailPadding[cacheLineSize - sizeof(std::atomic<uint32_t>)];
+    T m_items[Capacity];
+};
+
+#endif // SPSC_RING_H
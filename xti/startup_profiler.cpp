@@ -0,0 +1,80 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "startup_profiler.h"
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <chrono>
+#include <cstdio>
+// 4. Project classes
+
+static int64_t steady_now_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static double to_ms(int64_t ns)
+{
+    return static_cast<double>(ns) / 1000000.0;
+}
+
+startup_profiler::startup_profiler()
+    : m_startNs(steady_now_ns())
+    , m_endNs()
+{
+}
+
+/* public */ void startup_profiler::mark(startup_phase phase)
+{
+    m_endNs[phase] = steady_now_ns();
+}
+
+/* public */ int64_t startup_profiler::get_elapsed_ns(startup_phase phase) const
+{
+    return m_endNs[phase] == 0 ? 0 : m_endNs[phase] - m_startNs;
+}
+
+// --- report(): Formats the phases as a text table, one line per phase in startup_phase order, times in ms.
+// A phase takes from the end of the previous marked phase to its own end. Phases not marked show as "-".
+// ----- build: Identifies the build in the heading, so saved reports can be told apart.
+// ------- returns: The table, ending in a newline.
+// --------------------------------------------------------------------------------------------/
+/* public */ std::string startup_profiler::report(const std::string& build) const
+{
+    static constexpr const char* phaseNames[phase_count] = { "qt-init", "ui-setup", "config", "key-lists", "signals",
+        "timers", "window-style", "shown", "orientate", "keyboard-hook", "shortcuts", "window-registry", "cursor-overlay" };
+    std::string text = "startup (ms) " + build + "\nphase                  took         at\n";
+    char line[128];
+    int64_t previousNs = m_startNs;
+    for (uint32_t phase = 0; phase < phase_count; phase++)
+    {
+        if (m_endNs[phase] == 0)
+        {
+            std::snprintf(line, sizeof(line), "%-16s %10s %10s\n", phaseNames[phase], "-", "-");
+        }
+        else
+        {
+            std::snprintf(line, sizeof(line), "%-16s %10.2f %10.2f\n", phaseNames[phase], to_ms(m_endNs[phase] - previousNs),
+                to_ms(m_endNs[phase] - m_startNs));
+            previousNs = m_endNs[phase];
+        }
+        text.append(line);
+    }
+    std::snprintf(line, sizeof(line), "first key usable at %.2f ms\n", to_ms(get_elapsed_ns(firstKeyPhase)));
+    text.append(line);
+    return text;
+}
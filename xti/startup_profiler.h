@@ -0,0 +1,72 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef STARTUP_PROFILER_H
+#define STARTUP_PROFILER_H
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <cstdint>
+#include <string>
+// 4. Project classes
+// 5. Forward decl
+
+// Startup in the order it happens. Each phase ends when it is marked. Reports always list every phase in
+// this order, so reports from different builds line up even when a build skips or moves work.
+enum startup_phase : uint8_t
+{
+    phase_qtInit, // process start -> QApplication constructed
+    phase_uiSetup, // main_window widgets created from the .ui file
+    phase_config, // ~/xti.json loaded and validated
+    phase_keyLists, // key button lists and label texts
+    phase_signals, // buttons connected
+    phase_timers, // timers, palettes and the config watcher
+    phase_windowStyle, // window styles and the mouse hook
+    phase_shown, // window shown and the event loop reached post_ctor
+    phase_orientate, // window moved into place
+    phase_keyboardHook, // modifier state read and keyboard hook installed, the keyboard is usable from here
+    phase_shortcuts, // deferred: shortcut combo boxes populated
+    phase_windowRegistry, // deferred: window tracking and process lookups
+    phase_cursorOverlay, // deferred: touchpad cursor overlay created
+    phase_count
+};
+
+// Times the startup phases on the steady clock, from construction on.
+// Used from the UI thread only.
+class startup_profiler
+{
+public:
+    // The last phase that has to finish before a key can be pressed.
+    static constexpr startup_phase firstKeyPhase = phase_keyboardHook;
+
+    startup_profiler();
+
+    // public mark(): Ends a phase now. Marking a phase again moves its end.
+    void mark(startup_phase phase);
+
+    // public get_elapsed_ns(): Gets the time from construction to the end of a phase, 0 if it was not marked.
+    int64_t get_elapsed_ns(startup_phase phase) const;
+
+    // public report(): Formats the phases as a text table.
+    // see cpp file for more info.
+    std::string report(const std::string& build) const;
+
+private:
+    int64_t m_startNs;
+    int64_t m_endNs[phase_count]; // 0 for phases not marked
+};
+
+#endif // STARTUP_PROFILER_H
@@ -0,0 +1,120 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <initializer_list>
+#include <vector>
+// 4. Project classes
+#include "app_config.h"
+#include "xti_test.h"
+
+static shortcut_config make_shortcut(const wchar_t* displayName, bool above)
+{
+    shortcut_config shortcut = {};
+    shortcut.displayName = displayName;
+    shortcut.above = above;
+    return shortcut;
+}
+
+static std::vector<shortcut_config> make_list(std::initializer_list<const wchar_t*> names)
+{
+    std::vector<shortcut_config> list;
+    for (const wchar_t* name : names)
+    {
+        list.push_back(make_shortcut(name, true));
+    }
+    return list;
+}
+
+XTI_TEST(app_config_add_shortcut_normalizes)
+{
+    app_config config;
+    shortcut_config shortcut = make_shortcut(L"Notepad", false);
+    shortcut.startExePath = L"C:/Windows/notepad.exe";
+    shortcut.startWorkingDir = L"C:/Users";
+    shortcut.startParams = L"a/b";
+    config.add_shortcut(shortcut);
+    XTI_CHECK(config.get_shortcuts(true).empty());
+    const std::vector<shortcut_config>& below = config.get_shortcuts(false);
+    XTI_CHECK(below.size() == 1);
+    XTI_CHECK(below[0].displayName == L"NOTEPAD");
+    XTI_CHECK(below[0].startExePath == L"C:\\Windows\\notepad.exe");
+    XTI_CHECK(below[0].startWorkingDir == L"C:\\Users");
+    XTI_CHECK(below[0].startParams == L"a/b"); // parameters are passed as they are
+}
+
+XTI_TEST(app_config_snippets_are_kept_as_is)
+{
+    app_config config;
+    shortcut_config shortcut = make_shortcut(L"sig", true);
+    shortcut.snippet = L"Kind regards,\n/J";
+    config.add_shortcut(shortcut);
+    XTI_CHECK(config.get_shortcuts(true)[0].snippet == L"Kind regards,\n/J");
+}
+
+XTI_TEST(app_config_diff_unchanged_is_empty)
+{
+    std::vector<shortcut_config> list = make_list({ L"A", L"B", L"C" });
+    XTI_CHECK(app_config::diff(list, list).empty());
+}
+
+XTI_TEST(app_config_diff_orders_removes_inserts_updates)
+{
+    std::vector<shortcut_config> before = make_list({ L"A", L"B", L"C", L"D" });
+    std::vector<shortcut_config> after = make_list({ L"A", L"X", L"C", L"Y" });
+    after[2].startExePath = L"C:\\c.exe";
+    std::vector<shortcut_edit> edits = app_config::diff(before, after);
+    XTI_CHECK(edits.size() == 5);
+    if (edits.size() == 5)
+    {
+        // Removes descending, inserts ascending, then updates, so applying them in order keeps indexes valid.
+        XTI_CHECK(edits[0].op == shortcut_edit::opRemove && edits[0].index == 3);
+        XTI_CHECK(edits[1].op == shortcut_edit::opRemove && edits[1].index == 1);
+        XTI_CHECK(edits[2].op == shortcut_edit::opInsert && edits[2].index == 1);
+        XTI_CHECK(edits[3].op == shortcut_edit::opInsert && edits[3].index == 3);
+        XTI_CHECK(edits[4].op == shortcut_edit::opUpdate && edits[4].index == 2);
+    }
+}
+
+XTI_TEST(app_config_diff_applied_gives_the_new_list)
+{
+    // Applying the edits to the old names, as main_window does to a combo box, must give the new names.
+    std::vector<shortcut_config> before = make_list({ L"MAIL", L"WEB", L"TERM", L"CHAT", L"MUSIC" });
+    std::vector<shortcut_config> after = make_list({ L"TERM", L"WEB", L"NEW", L"MAIL", L"MUSIC" });
+    std::vector<std::wstring> names;
+    for (const shortcut_config& shortcut : before)
+    {
+        names.push_back(shortcut.displayName);
+    }
+    for (const shortcut_edit& edit : app_config::diff(before, after))
+    {
+        if (edit.op == shortcut_edit::opRemove)
+        {
+            names.erase(names.begin() + edit.index);
+        }
+        else if (edit.op == shortcut_edit::opInsert)
+        {
+            names.insert(names.begin() + edit.index, after[edit.index].displayName);
+        }
+    }
+    bool same = names.size() == after.size();
+    for (size_t i = 0; same && i < names.size(); i++)
+    {
+        same = names[i] == after[i].displayName;
+    }
+    XTI_CHECK(same);
+}
@@ -0,0 +1,84 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <string>
+// 4. Project classes
+#include "cursor_motion.h"
+#include "xti_test.h"
+
+XTI_TEST(cursor_motion_sums_samples_into_one_move)
+{
+    cursor_motion motion;
+    motion.reset();
+    motion.add_sample(0.6, -0.6);
+    motion.add_sample(0.6, -0.6);
+    motion.add_sample(0.6, -0.6);
+    int32_t dx = 0;
+    int32_t dy = 0;
+    XTI_CHECK(motion.take_move(dx, dy));
+    XTI_CHECK(dx == 1 && dy == -1);
+    cursor_motion_stats stats = motion.get_stats();
+    XTI_CHECK(stats.strokes == 1 && stats.samplesIn == 3 && stats.movesOut == 1);
+}
+
+XTI_TEST(cursor_motion_carries_fractions_to_the_next_move)
+{
+    // 0.8 is left over from the first move, the next 0.3 makes it a whole pixel.
+    cursor_motion motion;
+    motion.add_sample(1.8, 0.0);
+    int32_t dx = 0;
+    int32_t dy = 0;
+    XTI_CHECK(motion.take_move(dx, dy));
+    XTI_CHECK(dx == 1 && dy == 0);
+    motion.add_sample(0.3, 0.0);
+    XTI_CHECK(motion.take_move(dx, dy));
+    XTI_CHECK(dx == 1);
+}
+
+XTI_TEST(cursor_motion_nothing_to_move_below_a_pixel)
+{
+    cursor_motion motion;
+    motion.add_sample(0.4, -0.4);
+    int32_t dx = 7;
+    int32_t dy = 7;
+    XTI_CHECK(!motion.take_move(dx, dy));
+    XTI_CHECK(motion.get_stats().movesOut == 0);
+}
+
+XTI_TEST(cursor_motion_reset_drops_pending_motion)
+{
+    cursor_motion motion;
+    motion.add_sample(0.9, 0.9);
+    motion.reset();
+    motion.add_sample(0.2, 0.2);
+    int32_t dx = 0;
+    int32_t dy = 0;
+    XTI_CHECK(!motion.take_move(dx, dy));
+}
+
+XTI_TEST(cursor_motion_dump_reports_the_stats)
+{
+    cursor_motion motion;
+    motion.reset();
+    motion.add_sample(2.0, 0.0);
+    motion.add_sample(2.0, 0.0);
+    int32_t dx = 0;
+    int32_t dy = 0;
+    motion.take_move(dx, dy);
+    XTI_CHECK(motion.dump() == "touchpad motion: 1 strokes, 2 samples in, 1 moves out, 2.0 samples per move\n");
+}
@@ -0,0 +1,118 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+// 4. Project classes
+#include "hit_index.h"
+#include "xti_test.h"
+
+// Two keys with a 10 px gap, and a wide key below spanning several grid cells.
+static const hit_rect keys[] = {
+    { 0, 0, 40, 40 },
+    { 50, 0, 90, 40 },
+    { 0, 50, 200, 120 },
+};
+
+XTI_TEST(hit_index_empty)
+{
+    hit_index index;
+    index.rebuild(nullptr, 0);
+    XTI_CHECK(index.size() == 0);
+    XTI_CHECK(index.hit_test(0, 0, true) == -1);
+    XTI_CHECK(!index.contains(0, 0, 0));
+}
+
+XTI_TEST(hit_index_direct_hits)
+{
+    hit_index index;
+    index.rebuild(keys, 3);
+    XTI_CHECK(index.size() == 3);
+    XTI_CHECK(index.hit_test(0, 0, false) == 0);
+    XTI_CHECK(index.hit_test(39, 39, false) == 0);
+    XTI_CHECK(index.hit_test(50, 10, false) == 1);
+    // Right and bottom are exclusive.
+    XTI_CHECK(index.hit_test(40, 10, false) == -1);
+    XTI_CHECK(index.hit_test(10, 40, false) == -1);
+}
+
+XTI_TEST(hit_index_rect_spanning_cells)
+{
+    // The wide key covers 7 columns and 3 rows of 32 px cells, every corner and the middle must find it.
+    hit_index index;
+    index.rebuild(keys, 3);
+    XTI_CHECK(index.hit_test(0, 50, false) == 2);
+    XTI_CHECK(index.hit_test(199, 50, false) == 2);
+    XTI_CHECK(index.hit_test(0, 119, false) == 2);
+    XTI_CHECK(index.hit_test(199, 119, false) == 2);
+    XTI_CHECK(index.hit_test(100, 85, false) == 2);
+    XTI_CHECK(index.contains(2, 150, 100));
+    XTI_CHECK(!index.contains(2, 150, 120));
+}
+
+XTI_TEST(hit_index_snaps_to_nearest_centre)
+{
+    hit_index index;
+    index.rebuild(keys, 3);
+    // In the gap between the top keys, closer to the centre of the left one, then of the right one.
+    XTI_CHECK(index.hit_test(44, 20, false) == -1);
+    XTI_CHECK(index.hit_test(44, 20, true) == 0);
+    XTI_CHECK(index.hit_test(46, 20, true) == 1);
+    // Between the rows, the wide key's centre is far away but the small key's is near.
+    XTI_CHECK(index.hit_test(20, 45, true) == 0);
+    // Further out than the snap radius from every key.
+    XTI_CHECK(index.hit_test(140, 20, true) == -1);
+}
+
+XTI_TEST(hit_index_points_outside_the_grid)
+{
+    hit_index index;
+    index.rebuild(keys, 3);
+    XTI_CHECK(index.hit_test(-5, 10, false) == -1);
+    XTI_CHECK(index.hit_test(-5, 10, true) == 0);
+    XTI_CHECK(index.hit_test(205, 100, true) == 2);
+    XTI_CHECK(index.hit_test(100, 135, true) == -1);
+    XTI_CHECK(index.hit_test(-1000, -1000, true) == -1);
+    XTI_CHECK(index.hit_test(100000, 100000, true) == -1);
+    XTI_CHECK(!index.contains(-1, 10, 10));
+    XTI_CHECK(!index.contains(3, 10, 10));
+}
+
+XTI_TEST(hit_index_collapsed_rects_are_never_hit)
+{
+    // A hidden widget reports an empty geometry, it must neither be hit nor snapped to.
+    const hit_rect rects[] = {
+        { 0, 0, 40, 40 },
+        { 60, 0, 60, 40 },
+        { 60, 10, 100, 10 },
+    };
+    hit_index index;
+    index.rebuild(rects, 3);
+    XTI_CHECK(index.hit_test(60, 20, true) == -1);
+    XTI_CHECK(index.hit_test(70, 10, true) == -1);
+    XTI_CHECK(index.hit_test(45, 20, true) == 0);
+}
+
+XTI_TEST(hit_index_rebuild_replaces)
+{
+    hit_index index;
+    index.rebuild(keys, 3);
+    const hit_rect moved[] = { { 300, 300, 340, 340 } };
+    index.rebuild(moved, 1);
+    XTI_CHECK(index.size() == 1);
+    XTI_CHECK(index.hit_test(10, 10, true) == -1);
+    XTI_CHECK(index.hit_test(310, 310, false) == 0);
+}
@@ -0,0 +1,139 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <chrono>
+#include <thread>
+#include <vector>
+// 4. Project classes
+#include "input_worker.h"
+#include "recording_input_sink.h"
+#include "xti_test.h"
+
+// Keeps every mouse event in the order the worker injected it, optionally slowly to force back-pressure.
+class ordered_mouse_sink : public input_sink
+{
+public:
+    explicit ordered_mouse_sink(uint32_t batchDelayUs) : m_batchDelayUs(batchDelayUs) {}
+
+    virtual uint32_t send_keys([[maybe_unused]] const key_stroke* strokes, uint32_t count) override { return count; }
+
+    virtual uint32_t send_mouse(const mouse_stroke* strokes, uint32_t count) override
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(m_batchDelayUs));
+        m_strokes.insert(m_strokes.end(), strokes, strokes + count);
+        return count;
+    }
+
+    // Only read after the worker has been destroyed, which joins its thread.
+    const std::vector<mouse_stroke>& get_strokes() const { return m_strokes; }
+
+private:
+    uint32_t m_batchDelayUs;
+    std::vector<mouse_stroke> m_strokes;
+};
+
+class failing_sink : public input_sink
+{
+public:
+    virtual uint32_t send_keys([[maybe_unused]] const key_stroke* strokes, [[maybe_unused]] uint32_t count) override { return 0; }
+    virtual uint32_t send_mouse([[maybe_unused]] const mouse_stroke* strokes, [[maybe_unused]] uint32_t count) override { return 0; }
+};
+
+static const latency_mark noMark = { 0, 0, 0 };
+
+// Waits for the worker to inject what was posted, the test fails rather than hangs if it never does.
+static bool wait_for_drain(const input_worker& worker, uint64_t events)
+{
+    for (uint32_t i = 0; i < 5000; i++)
+    {
+        if (worker.get_stats().drainedEvents >= events)
+        {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+}
+
+XTI_TEST(input_worker_injects_everything_posted)
+{
+    static constexpr uint32_t posts = 10000;
+    recording_input_sink sink;
+    input_worker worker(&sink, nullptr);
+    bool allQueued = true;
+    for (uint32_t i = 0; i < posts; i++)
+    {
+        allQueued &= worker.post_mouse({ mouse_stroke::flagMove, 1, 0, 0 }, kind_move, noMark);
+    }
+    XTI_CHECK(allQueued);
+    XTI_CHECK(wait_for_drain(worker, posts));
+    XTI_CHECK(sink.get_mouse_strokes() == posts);
+    XTI_CHECK(!worker.has_failed());
+}
+
+XTI_TEST(input_worker_keeps_post_order_under_back_pressure)
+{
+    // A sink far slower than the poster fills the 256 event queue many times over, posts must wait, not fail.
+    static constexpr uint32_t posts = 2000;
+    ordered_mouse_sink sink(200);
+    bool allQueued = true;
+    input_worker_stats stats;
+    {
+        input_worker worker(&sink, nullptr);
+        for (uint32_t i = 0; i < posts; i++)
+        {
+            allQueued &= worker.post_mouse({ mouse_stroke::flagMove, static_cast<int32_t>(i), 0, 0 }, kind_move, noMark);
+        }
+        XTI_CHECK(wait_for_drain(worker, posts));
+        stats = worker.get_stats();
+    }
+    XTI_CHECK(allQueued);
+    XTI_CHECK(stats.backPressureWaits > 0);
+    XTI_CHECK(stats.drainedBatches < posts);
+    const std::vector<mouse_stroke>& strokes = sink.get_strokes();
+    XTI_CHECK(strokes.size() == posts);
+    bool inOrder = true;
+    for (uint32_t i = 0; i < strokes.size(); i++)
+    {
+        inOrder &= strokes[i].dx == static_cast<int32_t>(i);
+    }
+    XTI_CHECK(inOrder);
+}
+
+XTI_TEST(input_worker_wakes_after_sleeping)
+{
+    // Posts spaced out so the worker goes back to sleep on an empty queue between every one of them.
+    recording_input_sink sink;
+    input_worker worker(&sink, nullptr);
+    for (uint32_t i = 0; i < 20; i++)
+    {
+        XTI_CHECK(worker.post_mouse({ mouse_stroke::flagLeftDown, 0, 0, 0 }, kind_click, noMark));
+        XTI_CHECK(wait_for_drain(worker, i + 1));
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    XTI_CHECK(sink.get_mouse_strokes() == 20);
+}
+
+XTI_TEST(input_worker_reports_sink_failure)
+{
+    failing_sink sink;
+    input_worker worker(&sink, nullptr);
+    XTI_CHECK(worker.post_mouse({ mouse_stroke::flagLeftDown, 0, 0, 0 }, kind_click, noMark));
+    XTI_CHECK(wait_for_drain(worker, 1));
+    XTI_CHECK(worker.has_failed());
+}
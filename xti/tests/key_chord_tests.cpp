@@ -0,0 +1,106 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+// 4. Project classes
+#include "key_chord.h"
+#include "xti_test.h"
+
+static bool is_stroke(const key_stroke& stroke, uint16_t virtualKeyCode, uint16_t flags, uint16_t scanCode)
+{
+    return stroke.virtualKeyCode == virtualKeyCode && stroke.flags == flags && stroke.scanCode == scanCode;
+}
+
+XTI_TEST(key_chord_press_without_modifiers)
+{
+    key_chord chord = key_chord_builder::build_press('A', 0x1E, false, false, false, false);
+    XTI_CHECK(chord.count == 2);
+    XTI_CHECK(is_stroke(chord.strokes[0], 'A', 0, 0x1E));
+    XTI_CHECK(is_stroke(chord.strokes[1], 'A', key_stroke::flagKeyUp, 0x1E));
+}
+
+XTI_TEST(key_chord_press_wraps_modifiers_in_order)
+{
+    // Modifiers go down control, alt, shift and come up in reverse so the chord nests.
+    key_chord chord = key_chord_builder::build_press('A', 0x1E, true, true, true, false);
+    XTI_CHECK(chord.count == key_chord::maxStrokes);
+    XTI_CHECK(is_stroke(chord.strokes[0], VK_LCONTROL, 0, key_chord_builder::scanLeftControl));
+    XTI_CHECK(is_stroke(chord.strokes[1], VK_LMENU, 0, key_chord_builder::scanLeftAlt));
+    XTI_CHECK(is_stroke(chord.strokes[2], VK_LSHIFT, 0, key_chord_builder::scanLeftShift));
+    XTI_CHECK(is_stroke(chord.strokes[3], 'A', 0, 0x1E));
+    XTI_CHECK(is_stroke(chord.strokes[4], 'A', key_stroke::flagKeyUp, 0x1E));
+    XTI_CHECK(is_stroke(chord.strokes[5], VK_LSHIFT, key_stroke::flagKeyUp, key_chord_builder::scanLeftShift));
+    XTI_CHECK(is_stroke(chord.strokes[6], VK_LMENU, key_stroke::flagKeyUp, key_chord_builder::scanLeftAlt));
+    XTI_CHECK(is_stroke(chord.strokes[7], VK_LCONTROL, key_stroke::flagKeyUp, key_chord_builder::scanLeftControl));
+}
+
+XTI_TEST(key_chord_press_shift_only)
+{
+    key_chord chord = key_chord_builder::build_press('1', 0x02, true, false, false, false);
+    XTI_CHECK(chord.count == 4);
+    XTI_CHECK(is_stroke(chord.strokes[0], VK_LSHIFT, 0, key_chord_builder::scanLeftShift));
+    XTI_CHECK(is_stroke(chord.strokes[1], '1', 0, 0x02));
+    XTI_CHECK(is_stroke(chord.strokes[2], '1', key_stroke::flagKeyUp, 0x02));
+    XTI_CHECK(is_stroke(chord.strokes[3], VK_LSHIFT, key_stroke::flagKeyUp, key_chord_builder::scanLeftShift));
+}
+
+XTI_TEST(key_chord_press_extended_flags_key_strokes_only)
+{
+    // The extended flag goes on both the down and the up of the key, never on the wrapped modifiers.
+    key_chord chord = key_chord_builder::build_press(VK_LEFT, 0x4B, false, true, false, true);
+    XTI_CHECK(chord.count == 4);
+    XTI_CHECK(is_stroke(chord.strokes[0], VK_LCONTROL, 0, key_chord_builder::scanLeftControl));
+    XTI_CHECK(is_stroke(chord.strokes[1], VK_LEFT, key_stroke::flagExtended, 0x4B));
+    XTI_CHECK(is_stroke(chord.strokes[2], VK_LEFT, key_stroke::flagExtended | key_stroke::flagKeyUp, 0x4B));
+    XTI_CHECK(is_stroke(chord.strokes[3], VK_LCONTROL, key_stroke::flagKeyUp, key_chord_builder::scanLeftControl));
+}
+
+XTI_TEST(key_chord_toggle_is_one_stroke)
+{
+    key_chord down = key_chord_builder::build_toggle(VK_RSHIFT, 0x36, false, false);
+    XTI_CHECK(down.count == 1);
+    XTI_CHECK(is_stroke(down.strokes[0], VK_RSHIFT, 0, 0x36));
+
+    key_chord up = key_chord_builder::build_toggle(VK_RCONTROL, 0x1D, true, true);
+    XTI_CHECK(up.count == 1);
+    XTI_CHECK(is_stroke(up.strokes[0], VK_RCONTROL, key_stroke::flagKeyUp | key_stroke::flagExtended, 0x1D));
+}
+
+XTI_TEST(key_chord_unicode_carries_the_unit)
+{
+    key_chord chord = key_chord_builder::build_unicode(u'\u00E9');
+    XTI_CHECK(chord.count == 2);
+    XTI_CHECK(is_stroke(chord.strokes[0], 0x00E9, key_stroke::flagUnicode, 0));
+    XTI_CHECK(is_stroke(chord.strokes[1], 0x00E9, key_stroke::flagUnicode | key_stroke::flagKeyUp, 0));
+
+    // Each half of a surrogate pair is its own chord.
+    key_chord high = key_chord_builder::build_unicode(static_cast<char16_t>(0xD83D));
+    XTI_CHECK(high.count == 2);
+    XTI_CHECK(high.strokes[0].virtualKeyCode == 0xD83D);
+}
+
+XTI_TEST(key_chord_extended_keys)
+{
+    XTI_CHECK(key_chord_builder::is_extended_key(VK_RCONTROL));
+    XTI_CHECK(key_chord_builder::is_extended_key(VK_RMENU));
+    XTI_CHECK(key_chord_builder::is_extended_key(VK_LEFT));
+    XTI_CHECK(key_chord_builder::is_extended_key(VK_DELETE));
+    XTI_CHECK(!key_chord_builder::is_extended_key(VK_LCONTROL));
+    XTI_CHECK(!key_chord_builder::is_extended_key(VK_RSHIFT));
+    XTI_CHECK(!key_chord_builder::is_extended_key('A'));
+    XTI_CHECK(!key_chord_builder::is_extended_key(VK_BACK));
+}
@@ -0,0 +1,155 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+// 4. Project classes
+#include "key_layout.h"
+#include "virtual_keys.h"
+#include "xti_test.h"
+
+// A German-like layout: Y and Z swapped, @ is AltGr+Q, lower case letters and digits only, nothing else.
+class german_layout_source : public key_layout_source
+{
+public:
+    virtual bool find_character(char16_t character, uint16_t& virtualKeyCodeOut, uint8_t& modifiersOut) const override
+    {
+        modifiersOut = 0;
+        if (character == u'@')
+        {
+            virtualKeyCodeOut = 'Q';
+            modifiersOut = key_action::flagControl | key_action::flagAlt;
+            return true;
+        }
+        if (character == u'y' || character == u'z')
+        {
+            virtualKeyCodeOut = character == u'y' ? 'Z' : 'Y';
+            return true;
+        }
+        if ((character >= u'a' && character <= u'z') || (character >= u'0' && character <= u'9'))
+        {
+            virtualKeyCodeOut = static_cast<uint16_t>(character >= u'a' ? character - 0x20 : character);
+            return true;
+        }
+        return false;
+    }
+
+    virtual uint16_t get_scan_code(uint16_t virtualKeyCode) const override
+    {
+        switch (virtualKeyCode)
+        {
+        case 'Q':
+            return 0x10;
+        case 'Y':
+            return 0x2C;
+        case 'Z':
+            return 0x15;
+        case VK_UP:
+            return 0xE048;
+        case VK_PAUSE:
+            return 0xE11D;
+        default:
+            return 0x01;
+        }
+    }
+};
+
+XTI_TEST(key_layout_starts_as_us_defaults)
+{
+    key_layout layout;
+    XTI_CHECK(layout.get_layout_id() == 0);
+    XTI_CHECK(layout.get_unicode_count() == 0);
+    for (uint32_t i = 0; i < key_count; i++)
+    {
+        key_id id = static_cast<key_id>(i);
+        XTI_CHECK(layout.get_action(id, false).virtualKeyCode == key_mapping::get_action(id).virtualKeyCode);
+        XTI_CHECK(layout.get_action(id, true).scanCode == 0);
+    }
+}
+
+XTI_TEST(key_layout_types_by_character)
+{
+    key_layout layout;
+    layout.build(german_layout_source(), 0x4070407);
+    XTI_CHECK(layout.get_layout_id() == 0x4070407);
+    // The y button types y, which is where Z is on this layout.
+    const key_action& y = layout.get_action(key_y, false);
+    XTI_CHECK(y.virtualKeyCode == 'Z');
+    XTI_CHECK(y.scanCode == 0x15);
+    // @ becomes AltGr+Q instead of Shift+2.
+    const key_action& at = layout.get_action(key_at, false);
+    XTI_CHECK(at.virtualKeyCode == 'Q');
+    XTI_CHECK((at.flags & key_action::flagShift) == 0);
+    XTI_CHECK((at.flags & (key_action::flagControl | key_action::flagAlt)) == (key_action::flagControl | key_action::flagAlt));
+    XTI_CHECK(at.scanCode == 0x10);
+}
+
+XTI_TEST(key_layout_shortcuts_keep_the_virtual_key)
+{
+    // Ctrl+Z stays Ctrl+Z wherever the Z key is.
+    key_layout layout;
+    layout.build(german_layout_source(), 1);
+    const key_action& z = layout.get_action(key_z, true);
+    XTI_CHECK(z.virtualKeyCode == 'Z');
+    XTI_CHECK(z.scanCode == 0x15);
+    XTI_CHECK(layout.get_action(key_at, true).virtualKeyCode == key_mapping::get_action(key_at).virtualKeyCode);
+}
+
+XTI_TEST(key_layout_falls_back_to_unicode)
+{
+    // Punctuation is missing from this layout, each such key is typed as its character.
+    key_layout layout;
+    layout.build(german_layout_source(), 1);
+    XTI_CHECK(layout.get_unicode_count() > 0);
+    uint32_t unicodeKeys = 0;
+    for (uint32_t i = 0; i < key_count; i++)
+    {
+        key_id id = static_cast<key_id>(i);
+        const key_action& action = layout.get_action(id, false);
+        if ((action.flags & key_action::flagUnicode) != 0)
+        {
+            XTI_CHECK(action.virtualKeyCode == key_mapping::get_character(id));
+            XTI_CHECK(action.scanCode == 0);
+            XTI_CHECK((action.flags & (key_action::flagShift | key_action::flagControl | key_action::flagAlt)) == 0);
+            unicodeKeys++;
+        }
+        XTI_CHECK((layout.get_action(id, true).flags & key_action::flagUnicode) == 0);
+    }
+    XTI_CHECK(unicodeKeys == layout.get_unicode_count());
+}
+
+XTI_TEST(key_layout_scan_code_prefixes)
+{
+    // E0 marks an extended key, the E1 prefix of Pause (the Break key) cannot be injected and leaves scan code 0.
+    key_layout layout;
+    layout.build(german_layout_source(), 1);
+    const key_action& up = layout.get_action(key_up, false);
+    XTI_CHECK(up.scanCode == 0x48);
+    XTI_CHECK((up.flags & key_action::flagExtended) != 0);
+    XTI_CHECK(layout.get_action(key_break, false).scanCode == 0);
+    XTI_CHECK(layout.get_action(key_space, false).scanCode == 0x01);
+}
+
+XTI_TEST(key_layout_rebuild_replaces_tables)
+{
+    // Building again for another layout leaves nothing of the previous one behind.
+    key_layout layout;
+    layout.build(german_layout_source(), 1);
+    uint32_t unicodeCount = layout.get_unicode_count();
+    layout.build(german_layout_source(), 2);
+    XTI_CHECK(layout.get_layout_id() == 2);
+    XTI_CHECK(layout.get_unicode_count() == unicodeCount);
+}
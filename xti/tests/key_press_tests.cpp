@@ -0,0 +1,143 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <vector>
+// 4. Project classes
+#include "key_dispatcher.h"
+#include "key_layout.h"
+#include "key_mapping.h"
+#include "latency_recorder.h"
+#include "modifier_state.h"
+#include "recording_input_sink.h"
+#include "xti_test.h"
+
+// Every heap allocation in this binary goes through here, so a test can assert a path makes none.
+static std::atomic<bool> countAllocations(false);
+static std::atomic<uint64_t> allocationCount(0);
+
+void* operator new(std::size_t size)
+{
+    if (countAllocations.load(std::memory_order_relaxed))
+    {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    void* memory = std::malloc(size == 0 ? 1 : size);
+    if (memory == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, [[maybe_unused]] std::size_t size) noexcept
+{
+    std::free(memory);
+}
+
+// Presses every key twice through key_dispatcher as main_window::ui_on_key_press() does, so modifiers and locks end
+// up as they started, then once more with control held for the shortcut actions.
+static void press_every_key(const key_layout& layout, input_sink& sink, modifier_state& modifiers, latency_recorder& latency)
+{
+    for (uint32_t shortcut = 0; shortcut < 2; shortcut++)
+    {
+        if (shortcut != 0)
+        {
+            key_dispatcher::press(layout, key_control, modifiers, sink);
+        }
+        for (uint32_t i = 0; i < key_count; i++)
+        {
+            for (uint32_t repeat = 0; repeat < 2; repeat++)
+            {
+                key_press_outcome outcome = key_dispatcher::press(layout, static_cast<key_id>(i), modifiers, sink);
+                latency_mark mark = { outcome.injectStartNs, outcome.injectStartNs, outcome.injectStartNs };
+                latency.record(kind_key, mark, outcome.injectStartNs, outcome.injectEndNs);
+            }
+        }
+        if (shortcut != 0)
+        {
+            key_dispatcher::press(layout, key_control, modifiers, sink);
+        }
+    }
+}
+
+XTI_TEST(key_press_makes_no_allocations)
+{
+    key_layout layout;
+    recording_input_sink sink;
+    modifier_state modifiers;
+    latency_recorder latency;
+
+    // The sink stores what it receives, so let it grow once and then hand its buffer back: the first take_keys()
+    // moves the grown buffer out, the second moves it back in empty.
+    press_every_key(layout, sink, modifiers, latency);
+    std::vector<key_stroke> spare;
+    sink.take_keys(spare);
+    sink.take_keys(spare);
+    uint64_t expectedBatches = sink.get_key_batches() * 2;
+
+    allocationCount.store(0);
+    countAllocations.store(true);
+    press_every_key(layout, sink, modifiers, latency);
+    countAllocations.store(false);
+
+    XTI_CHECK(allocationCount.load() == 0);
+    XTI_CHECK(sink.get_key_batches() == expectedBatches);
+}
+
+XTI_TEST(key_press_dispatch_outcomes)
+{
+    key_layout layout;
+    recording_input_sink sink;
+    modifier_state modifiers;
+
+    // A modifier goes down and stays down, a second press lets it go.
+    key_press_outcome outcome = key_dispatcher::press(layout, key_control, modifiers, sink);
+    XTI_CHECK(outcome.sent && outcome.modChanged && outcome.modOn);
+    XTI_CHECK(outcome.chord.count == 1);
+    XTI_CHECK(modifiers.get().control);
+    // With control held a letter is the shortcut, Ctrl+Z whatever the layout.
+    outcome = key_dispatcher::press(layout, key_z, modifiers, sink);
+    XTI_CHECK(!outcome.modChanged);
+    XTI_CHECK(outcome.chord.count == 2);
+    XTI_CHECK(outcome.chord.strokes[0].virtualKeyCode == 'Z');
+    outcome = key_dispatcher::press(layout, key_control, modifiers, sink);
+    XTI_CHECK(outcome.modChanged && !outcome.modOn);
+    XTI_CHECK(!modifiers.get().control);
+
+    // Locks flip.
+    outcome = key_dispatcher::press(layout, key_capsLock, modifiers, sink);
+    XTI_CHECK(outcome.modChanged && outcome.modOn);
+    XTI_CHECK(modifiers.get().capsLock);
+    outcome = key_dispatcher::press(layout, key_capsLock, modifiers, sink);
+    XTI_CHECK(outcome.modChanged && !outcome.modOn);
+
+    // @ is Shift+2 on the US defaults.
+    outcome = key_dispatcher::press(layout, key_at, modifiers, sink);
+    XTI_CHECK(outcome.chord.count == 4);
+    XTI_CHECK(outcome.chord.strokes[1].virtualKeyCode == '2');
+    XTI_CHECK(outcome.injectEndNs >= outcome.injectStartNs);
+    XTI_CHECK(!modifiers.get().shift);
+}
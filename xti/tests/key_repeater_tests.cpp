@@ -0,0 +1,110 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+// 4. Project classes
+#include "key_mapping.h"
+#include "key_repeater.h"
+#include "xti_test.h"
+
+XTI_TEST(key_repeater_idle_never_fires)
+{
+    key_repeater repeater;
+    XTI_CHECK(repeater.get_key() == -1);
+    XTI_CHECK(!repeater.poll(1000000000000));
+    XTI_CHECK(repeater.get_stats().repeats == 0);
+}
+
+XTI_TEST(key_repeater_deadlines_follow_delay_then_interval)
+{
+    key_repeater repeater;
+    repeater.set_timing(500, 100);
+    repeater.start(7, 1000);
+    XTI_CHECK(repeater.get_key() == 7);
+    XTI_CHECK(repeater.get_deadline_ns() == 1500);
+    XTI_CHECK(!repeater.poll(1499));
+    XTI_CHECK(!repeater.has_repeated());
+    XTI_CHECK(repeater.poll(1500));
+    XTI_CHECK(repeater.has_repeated());
+    XTI_CHECK(repeater.get_deadline_ns() == 1600);
+    XTI_CHECK(!repeater.poll(1550)); // one repeat per deadline
+    XTI_CHECK(repeater.poll(1600));
+    XTI_CHECK(repeater.get_stats().repeats == 2);
+}
+
+XTI_TEST(key_repeater_late_poll_keeps_the_grid)
+{
+    // A late poll fires once and the next deadline stays on held + delay + n * interval.
+    key_repeater repeater;
+    repeater.set_timing(500, 100);
+    repeater.start(7, 0);
+    XTI_CHECK(repeater.poll(530));
+    XTI_CHECK(repeater.get_deadline_ns() == 600);
+    XTI_CHECK(repeater.get_jitter().get_max() == 30);
+}
+
+XTI_TEST(key_repeater_skips_missed_deadlines)
+{
+    // Polled three and a half intervals late: one repeat now, no burst, and the missed ones are counted.
+    key_repeater repeater;
+    repeater.set_timing(500, 100);
+    repeater.start(7, 0);
+    XTI_CHECK(repeater.poll(850));
+    XTI_CHECK(repeater.get_deadline_ns() == 900);
+    XTI_CHECK(!repeater.poll(850));
+    XTI_CHECK(repeater.get_stats().repeats == 1);
+    XTI_CHECK(repeater.get_stats().skipped == 3);
+}
+
+XTI_TEST(key_repeater_stop_and_restart)
+{
+    key_repeater repeater;
+    repeater.set_timing(500, 100);
+    repeater.start(7, 0);
+    XTI_CHECK(repeater.poll(500));
+    repeater.stop();
+    XTI_CHECK(repeater.get_key() == -1);
+    XTI_CHECK(!repeater.has_repeated());
+    XTI_CHECK(!repeater.poll(600));
+    // Timing changes only apply from the next start().
+    repeater.set_timing(200, 0);
+    repeater.start(9, 1000);
+    XTI_CHECK(repeater.get_deadline_ns() == 1200);
+    XTI_CHECK(repeater.poll(1200));
+    XTI_CHECK(repeater.get_deadline_ns() == 1201); // a zero interval is clamped to 1 ns
+    XTI_CHECK(repeater.get_stats().repeats == 2);
+}
+
+XTI_TEST(key_repeater_dump_counts)
+{
+    key_repeater repeater;
+    repeater.set_timing(500, 100);
+    repeater.start(7, 0);
+    repeater.poll(850);
+    XTI_CHECK(repeater.dump().compare(0, 35, "key repeat: 1 repeats, 3 skipped, l") == 0);
+}
+
+XTI_TEST(key_repeater_touchpad_keys_do_not_repeat)
+{
+    // Holding a finger inside the touchpad area moves the cursor, which stops any repeat, so these keys never repeat.
+    const key_id touchpadKeys[] = { key_pageUp, key_volumeUp, key_space, key_undo };
+    for (key_id id : touchpadKeys)
+    {
+        XTI_CHECK((key_mapping::get_action(id).flags & key_action::flagRepeat) == 0);
+    }
+    XTI_CHECK((key_mapping::get_action(key_backspace).flags & key_action::flagRepeat) != 0);
+}
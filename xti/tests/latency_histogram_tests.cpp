@@ -0,0 +1,103 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+// 4. Project classes
+#include "latency_histogram.h"
+#include "latency_recorder.h"
+#include "xti_test.h"
+
+XTI_TEST(latency_histogram_empty)
+{
+    latency_histogram histogram;
+    XTI_CHECK(histogram.get_count() == 0);
+    XTI_CHECK(histogram.get_max() == 0);
+    XTI_CHECK(histogram.get_percentile(50.0) == 0);
+}
+
+XTI_TEST(latency_histogram_small_values_are_exact)
+{
+    // Below 2 * subBucketCount every value has a bucket of its own.
+    latency_histogram histogram;
+    for (int64_t value = 1; value <= 50; value++)
+    {
+        histogram.record(value);
+    }
+    XTI_CHECK(histogram.get_count() == 50);
+    XTI_CHECK(histogram.get_percentile(50.0) == 25);
+    XTI_CHECK(histogram.get_percentile(100.0) == 50);
+    XTI_CHECK(histogram.get_max() == 50);
+}
+
+XTI_TEST(latency_histogram_percentile_within_bucket_error)
+{
+    // 1..100000 ns, every percentile must land at or just above the exact answer, never below it.
+    latency_histogram histogram;
+    for (int64_t value = 1; value <= 100000; value++)
+    {
+        histogram.record(value);
+    }
+    const double percentiles[] = { 1.0, 50.0, 90.0, 99.0, 99.9 };
+    for (double percentile : percentiles)
+    {
+        uint64_t exact = static_cast<uint64_t>(percentile * 1000.0);
+        uint64_t reported = histogram.get_percentile(percentile);
+        XTI_CHECK(reported >= exact);
+        XTI_CHECK(reported <= exact + exact / latency_histogram::subBucketCount + 1);
+    }
+}
+
+XTI_TEST(latency_histogram_capped_at_max)
+{
+    // One value in a wide bucket reports the exact max, not the top of its bucket.
+    latency_histogram histogram;
+    histogram.record(1000001);
+    XTI_CHECK(histogram.get_percentile(99.0) == 1000001);
+}
+
+XTI_TEST(latency_histogram_clamps_out_of_range)
+{
+    latency_histogram histogram;
+    histogram.record(-5);
+    histogram.record(static_cast<int64_t>(latency_histogram::maxValue) * 4);
+    XTI_CHECK(histogram.get_count() == 2);
+    XTI_CHECK(histogram.get_percentile(50.0) == 0);
+    XTI_CHECK(histogram.get_max() == latency_histogram::maxValue);
+}
+
+XTI_TEST(latency_recorder_records_each_stage)
+{
+    latency_recorder recorder;
+    latency_mark mark = { 1000, 3000, 6000 };
+    recorder.record(kind_key, mark, 10000, 15000);
+    XTI_CHECK(recorder.get_histogram(kind_key, stage_queue).get_max() == 2000);
+    XTI_CHECK(recorder.get_histogram(kind_key, stage_hitTest).get_max() == 3000);
+    XTI_CHECK(recorder.get_histogram(kind_key, stage_dispatch).get_max() == 4000);
+    XTI_CHECK(recorder.get_histogram(kind_key, stage_inject).get_max() == 5000);
+    XTI_CHECK(recorder.get_histogram(kind_key, stage_total).get_max() == 14000);
+    XTI_CHECK(recorder.get_histogram(kind_click, stage_total).get_count() == 0);
+}
+
+XTI_TEST(latency_recorder_skips_missing_checkpoints)
+{
+    // No touch timestamp: no queue stage, and the total starts at event() instead.
+    latency_recorder recorder;
+    latency_mark mark = { 0, 3000, 6000 };
+    recorder.record(kind_move, mark, 10000, 15000);
+    XTI_CHECK(recorder.get_histogram(kind_move, stage_queue).get_count() == 0);
+    XTI_CHECK(recorder.get_histogram(kind_move, stage_total).get_max() == 12000);
+}
@@ -0,0 +1,158 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+// 4. Project classes
+#include "modifier_state.h"
+#include "xti_test.h"
+
+// Feeds injected strokes through the state as the app does: applied when sent, then seen again by the hook.
+static void inject(modifier_state& state, const key_chord& chord)
+{
+    state.apply_strokes(chord.strokes, chord.count);
+    for (uint32_t i = 0; i < chord.count; i++)
+    {
+        state.apply_hooked_key_event(chord.strokes[i].virtualKeyCode, (chord.strokes[i].flags & key_stroke::flagKeyUp) != 0, true);
+    }
+}
+
+XTI_TEST(modifier_state_tracks_right_side_toggles)
+{
+    modifier_state state;
+    XTI_CHECK(state.apply_key_event(VK_RSHIFT, false));
+    XTI_CHECK(state.get().shift);
+    XTI_CHECK(!state.apply_key_event(VK_RSHIFT, false));
+    XTI_CHECK(state.apply_key_event(VK_RSHIFT, true));
+    XTI_CHECK(!state.get().shift);
+    // Left-side modifiers are only ever held within a chord.
+    XTI_CHECK(!state.apply_key_event(VK_LCONTROL, false));
+    XTI_CHECK(!state.get().control);
+}
+
+XTI_TEST(modifier_state_locks_flip_on_key_down)
+{
+    modifier_state state;
+    XTI_CHECK(state.apply_key_event(VK_CAPITAL, false));
+    XTI_CHECK(!state.apply_key_event(VK_CAPITAL, true));
+    XTI_CHECK(state.get().capsLock);
+    XTI_CHECK(state.apply_key_event(VK_CAPITAL, false));
+    XTI_CHECK(!state.get().capsLock);
+}
+
+XTI_TEST(modifier_state_ignores_unicode_strokes)
+{
+    // U+0010 typed as unicode must not read as VK_SHIFT.
+    modifier_state state;
+    key_chord chord = key_chord_builder::build_unicode(static_cast<char16_t>(VK_SHIFT));
+    XTI_CHECK(!state.apply_strokes(chord.strokes, chord.count));
+}
+
+XTI_TEST(modifier_state_reconcile_clean_press_needs_nothing)
+{
+    modifier_state state;
+    inject(state, key_chord_builder::build_press('A', 0x1E, true, true, true, false));
+    key_stroke corrections[modifier_state::maxCorrections];
+    XTI_CHECK(state.reconcile(corrections) == 0);
+    XTI_CHECK(state.divergence_count() == 0);
+}
+
+XTI_TEST(modifier_state_reconcile_releases_stuck_left_modifiers)
+{
+    // The chord's LSHIFT and LMENU key-ups never reached the OS.
+    modifier_state state;
+    key_chord chord = key_chord_builder::build_press('A', 0x1E, true, false, true, false);
+    state.apply_strokes(chord.strokes, chord.count);
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        state.apply_hooked_key_event(chord.strokes[i].virtualKeyCode, (chord.strokes[i].flags & key_stroke::flagKeyUp) != 0, true);
+    }
+    key_stroke corrections[modifier_state::maxCorrections];
+    uint32_t count = state.reconcile(corrections);
+    XTI_CHECK(count == 2);
+    XTI_CHECK(corrections[0].virtualKeyCode == VK_LSHIFT && corrections[0].flags == key_stroke::flagKeyUp);
+    XTI_CHECK(corrections[1].virtualKeyCode == VK_LMENU && corrections[1].flags == key_stroke::flagKeyUp);
+    XTI_CHECK(state.divergence_count() == 2);
+
+    // Once the corrections have arrived nothing is stuck any more.
+    key_chord sent = {};
+    for (uint32_t i = 0; i < count; i++)
+    {
+        sent.strokes[sent.count++] = corrections[i];
+    }
+    inject(state, sent);
+    XTI_CHECK(state.reconcile(corrections) == 0);
+}
+
+XTI_TEST(modifier_state_reconcile_releases_right_modifier_xti_let_go)
+{
+    // xti toggled RCONTROL down then up, but only the down reached the OS.
+    modifier_state state;
+    inject(state, key_chord_builder::build_toggle(VK_RCONTROL, 0x1D, false, true));
+    key_chord up = key_chord_builder::build_toggle(VK_RCONTROL, 0x1D, true, true);
+    state.apply_strokes(up.strokes, up.count);
+    key_stroke corrections[modifier_state::maxCorrections];
+    XTI_CHECK(state.reconcile(corrections) == 1);
+    XTI_CHECK(corrections[0].virtualKeyCode == VK_RCONTROL);
+    XTI_CHECK(corrections[0].flags == (key_stroke::flagKeyUp | key_stroke::flagExtended));
+}
+
+XTI_TEST(modifier_state_reconcile_keeps_held_right_modifier)
+{
+    modifier_state state;
+    inject(state, key_chord_builder::build_toggle(VK_RSHIFT, 0x36, false, false));
+    inject(state, key_chord_builder::build_press('A', 0x1E, false, false, false, false));
+    key_stroke corrections[modifier_state::maxCorrections];
+    XTI_CHECK(state.reconcile(corrections) == 0);
+    XTI_CHECK(state.get().shift);
+}
+
+XTI_TEST(modifier_state_reconcile_drops_modifier_released_elsewhere)
+{
+    // xti holds RSHIFT, then a physical keyboard presses and releases it, which releases it in the OS too.
+    modifier_state state;
+    inject(state, key_chord_builder::build_toggle(VK_RSHIFT, 0x36, false, false));
+    state.apply_hooked_key_event(VK_RSHIFT, false, false);
+    state.apply_hooked_key_event(VK_RSHIFT, true, false);
+    XTI_CHECK(!state.get().shift);
+    key_stroke corrections[modifier_state::maxCorrections];
+    XTI_CHECK(state.reconcile(corrections) == 0);
+    XTI_CHECK(!state.get().shift);
+}
+
+XTI_TEST(modifier_state_reconcile_leaves_physical_keys_alone)
+{
+    // A physical LSHIFT held down is not xti's to release.
+    modifier_state state;
+    XTI_CHECK(!state.apply_hooked_key_event(VK_LSHIFT, false, false));
+    key_stroke corrections[modifier_state::maxCorrections];
+    XTI_CHECK(state.reconcile(corrections) == 0);
+    XTI_CHECK(state.divergence_count() == 0);
+}
+
+XTI_TEST(modifier_state_adopt_keeps_handed_over_modifiers)
+{
+    // Held modifiers handed over by the previous instance were pressed by xti, reconcile() must not drop them.
+    modifier_state state;
+    key_modifiers adopted = {};
+    adopted.alt = true;
+    adopted.numLock = true;
+    state.adopt(adopted);
+    key_stroke corrections[modifier_state::maxCorrections];
+    XTI_CHECK(state.reconcile(corrections) == 0);
+    XTI_CHECK(state.get().alt);
+    XTI_CHECK(state.get().numLock);
+}
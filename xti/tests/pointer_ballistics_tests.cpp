@@ -0,0 +1,120 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <cmath>
+// 4. Project classes
+#include "pointer_ballistics.h"
+#include "xti_test.h"
+
+XTI_TEST(pointer_ballistics_gain_curve_ends)
+{
+    ballistics_curve curve;
+    XTI_CHECK(pointer_ballistics::get_gain(curve, 0.0) == curve.minGain);
+    XTI_CHECK(pointer_ballistics::get_gain(curve, curve.lowSpeed) == curve.minGain);
+    XTI_CHECK(pointer_ballistics::get_gain(curve, curve.highSpeed) == curve.maxGain);
+    XTI_CHECK(pointer_ballistics::get_gain(curve, 100.0) == curve.maxGain);
+    // Smoothstep is symmetric, half way in speed is half way in gain.
+    double middle = pointer_ballistics::get_gain(curve, (curve.lowSpeed + curve.highSpeed) / 2.0);
+    XTI_CHECK(std::fabs(middle - (curve.minGain + curve.maxGain) / 2.0) < 1e-9);
+}
+
+XTI_TEST(pointer_ballistics_gain_never_decreases)
+{
+    ballistics_curve curve;
+    double previous = 0.0;
+    bool increasing = true;
+    for (uint32_t i = 0; i <= 200; i++)
+    {
+        double gain = pointer_ballistics::get_gain(curve, i * 0.01);
+        increasing &= gain >= previous;
+        previous = gain;
+    }
+    XTI_CHECK(increasing);
+}
+
+XTI_TEST(pointer_ballistics_velocity_from_timestamps)
+{
+    // 10 touch pixels over 5 ms, however often the samples arrive.
+    pointer_ballistics ballistics;
+    ballistics.reset(1000);
+    int32_t dx = 0;
+    int32_t dy = 0;
+    ballistics.add_sample(6.0, 8.0, 1005, dx, dy);
+    XTI_CHECK(std::fabs(ballistics.get_velocity() - 2.0) < 1e-9);
+    // A second sample in the same millisecond keeps the velocity.
+    ballistics.add_sample(6.0, 8.0, 1005, dx, dy);
+    XTI_CHECK(std::fabs(ballistics.get_velocity() - 2.0) < 1e-9);
+    // Later samples are smoothed with the previous velocity.
+    ballistics.add_sample(0.0, 0.0, 1010, dx, dy);
+    XTI_CHECK(std::fabs(ballistics.get_velocity() - 1.0) < 1e-9);
+}
+
+XTI_TEST(pointer_ballistics_slow_motion_is_not_lost)
+{
+    // At minGain 2 a quarter of a touch pixel is half a cursor pixel, ten of them must add up to 5 pixels.
+    ballistics_curve curve;
+    curve.minGain = 2.0;
+    pointer_ballistics ballistics;
+    ballistics.set_curve(curve);
+    ballistics.reset(0);
+    int32_t totalX = 0;
+    int32_t totalY = 0;
+    for (uint64_t i = 1; i <= 10; i++)
+    {
+        int32_t dx = 0;
+        int32_t dy = 0;
+        ballistics.add_sample(0.25, -0.25, i * 10, dx, dy);
+        totalX += dx;
+        totalY += dy;
+    }
+    XTI_CHECK(totalX == 5);
+    XTI_CHECK(totalY == -5);
+}
+
+XTI_TEST(pointer_ballistics_base_gain_scales_the_curve)
+{
+    ballistics_curve curve;
+    curve.minGain = 2.0;
+    curve.maxGain = 2.0;
+    pointer_ballistics ballistics;
+    ballistics.set_curve(curve);
+    ballistics.set_base_gain(1.5);
+    ballistics.reset(0);
+    int32_t dx = 0;
+    int32_t dy = 0;
+    ballistics.add_sample(10.0, -4.0, 1, dx, dy);
+    XTI_CHECK(dx == 30 && dy == -12);
+}
+
+XTI_TEST(pointer_ballistics_reset_forgets_remainders)
+{
+    ballistics_curve curve;
+    curve.minGain = 1.0;
+    curve.maxGain = 1.0;
+    pointer_ballistics ballistics;
+    ballistics.set_curve(curve);
+    ballistics.reset(0);
+    int32_t dx = 0;
+    int32_t dy = 0;
+    ballistics.add_sample(0.75, 0.0, 1, dx, dy);
+    XTI_CHECK(dx == 0);
+    ballistics.reset(10);
+    XTI_CHECK(ballistics.get_velocity() == 0.0);
+    ballistics.add_sample(0.5, 0.0, 11, dx, dy);
+    XTI_CHECK(dx == 0);
+}
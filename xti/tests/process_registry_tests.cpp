@@ -0,0 +1,120 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <algorithm>
+#include <vector>
+// 4. Project classes
+#include "process_registry.h"
+#include "xti_test.h"
+
+XTI_TEST(process_registry_start_and_exit)
+{
+    process_registry registry;
+    std::vector<uint32_t> removed;
+    registry.apply_snapshot({ { 4, L"SYSTEM" }, { 100, L"NOTEPAD.EXE" }, { 101, L"NOTEPAD.EXE" } }, &removed);
+    XTI_CHECK(removed.empty());
+    XTI_CHECK(registry.is_running(L"NOTEPAD.EXE"));
+    XTI_CHECK(!registry.is_running(L"CALC.EXE"));
+    XTI_CHECK(registry.get_stats().size == 3);
+    XTI_CHECK(registry.get_stats().added == 3);
+
+    // One of two notepads exits, notepad is still running.
+    registry.apply_snapshot({ { 4, L"SYSTEM" }, { 101, L"NOTEPAD.EXE" } }, &removed);
+    XTI_CHECK(removed.size() == 1 && removed[0] == 100);
+    XTI_CHECK(registry.is_running(L"NOTEPAD.EXE"));
+
+    removed.clear();
+    registry.apply_snapshot({ { 4, L"SYSTEM" } }, &removed);
+    XTI_CHECK(removed.size() == 1 && removed[0] == 101);
+    XTI_CHECK(!registry.is_running(L"NOTEPAD.EXE"));
+    XTI_CHECK(registry.is_running(L"SYSTEM"));
+
+    process_registry_stats stats = registry.get_stats();
+    XTI_CHECK(stats.size == 1);
+    XTI_CHECK(stats.snapshots == 3);
+    XTI_CHECK(stats.added == 3);
+    XTI_CHECK(stats.removed == 2);
+}
+
+XTI_TEST(process_registry_unchanged_snapshot)
+{
+    process_registry registry;
+    std::vector<uint32_t> removed;
+    registry.apply_snapshot({ { 100, L"NOTEPAD.EXE" } }, &removed);
+    registry.apply_snapshot({ { 100, L"NOTEPAD.EXE" } }, &removed);
+    XTI_CHECK(removed.empty());
+    XTI_CHECK(registry.get_stats().added == 1);
+    XTI_CHECK(registry.get_stats().removed == 0);
+    // removedOut is optional.
+    registry.apply_snapshot({}, nullptr);
+    XTI_CHECK(!registry.is_running(L"NOTEPAD.EXE"));
+    XTI_CHECK(registry.get_stats().size == 0);
+}
+
+XTI_TEST(process_registry_pid_reuse)
+{
+    // Between two snapshots notepad exits and its PID goes to calc: the old process is reported gone
+    // and the PID now counts for the new exe.
+    process_registry registry;
+    std::vector<uint32_t> removed;
+    registry.apply_snapshot({ { 100, L"NOTEPAD.EXE" }, { 200, L"NOTEPAD.EXE" } }, &removed);
+    registry.apply_snapshot({ { 100, L"CALC.EXE" }, { 200, L"NOTEPAD.EXE" } }, &removed);
+    XTI_CHECK(removed.size() == 1 && removed[0] == 100);
+    XTI_CHECK(registry.is_running(L"CALC.EXE"));
+    XTI_CHECK(registry.is_running(L"NOTEPAD.EXE"));
+    XTI_CHECK(registry.get_stats().size == 2);
+    XTI_CHECK(registry.get_stats().added == 3);
+    XTI_CHECK(registry.get_stats().removed == 1);
+
+    // The reused PID is tracked under calc from now on, its exit takes calc (not notepad) off the running list.
+    removed.clear();
+    registry.apply_snapshot({ { 200, L"NOTEPAD.EXE" } }, &removed);
+    XTI_CHECK(removed.size() == 1 && removed[0] == 100);
+    XTI_CHECK(!registry.is_running(L"CALC.EXE"));
+    XTI_CHECK(registry.is_running(L"NOTEPAD.EXE"));
+
+    // Reused by the last process of an exe, that exe stops running.
+    removed.clear();
+    registry.apply_snapshot({ { 200, L"CALC.EXE" } }, &removed);
+    XTI_CHECK(removed.size() == 1 && removed[0] == 200);
+    XTI_CHECK(!registry.is_running(L"NOTEPAD.EXE"));
+    XTI_CHECK(registry.is_running(L"CALC.EXE"));
+    XTI_CHECK(registry.get_stats().size == 1);
+}
+
+XTI_TEST(process_registry_many_processes)
+{
+    // No fixed limit, and only the differences change anything.
+    process_registry registry;
+    std::vector<process_entry> snapshot;
+    for (uint32_t i = 0; i < 5000; i++)
+    {
+        snapshot.push_back({ i * 4 + 8, i % 2 == 0 ? L"SVCHOST.EXE" : L"CONHOST.EXE" });
+    }
+    std::vector<uint32_t> removed;
+    registry.apply_snapshot(snapshot, &removed);
+    XTI_CHECK(registry.get_stats().size == 5000);
+    snapshot.erase(snapshot.begin(), snapshot.begin() + 10);
+    registry.apply_snapshot(snapshot, &removed);
+    XTI_CHECK(removed.size() == 10);
+    std::sort(removed.begin(), removed.end());
+    XTI_CHECK(removed.front() == 8 && removed.back() == 9 * 4 + 8);
+    XTI_CHECK(registry.get_stats().size == 4990);
+    XTI_CHECK(registry.get_stats().added == 5000);
+    XTI_CHECK(registry.is_running(L"SVCHOST.EXE") && registry.is_running(L"CONHOST.EXE"));
+}
@@ -0,0 +1,126 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <cstdint>
+#include <vector>
+// 4. Project classes
+#include "restart_handover.h"
+#include "xti_test.h"
+
+static handover_message make_state()
+{
+    handover_message message = {};
+    message.type = handover_message::typeState;
+    message.state.modifiers.capsLock = true;
+    message.state.modifiers.shift = true;
+    message.state.modifiers.windows = true;
+    message.state.shortcutAbove = L"Copy";
+    message.state.shortcutBelow = L"Caf\u00E9";
+    message.state.releasedNs = 123456789012345;
+    return message;
+}
+
+XTI_TEST(restart_handover_state_round_trip)
+{
+    std::vector<uint8_t> bytes;
+    handover_codec::encode(make_state(), bytes);
+    handover_message decoded = {};
+    bool error = true;
+    XTI_CHECK(handover_codec::decode(bytes.data(), bytes.size(), decoded, error) == bytes.size());
+    XTI_CHECK(!error);
+    XTI_CHECK(decoded.type == handover_message::typeState);
+    XTI_CHECK(decoded.state.modifiers.capsLock);
+    XTI_CHECK(!decoded.state.modifiers.numLock);
+    XTI_CHECK(!decoded.state.modifiers.control);
+    XTI_CHECK(decoded.state.modifiers.shift);
+    XTI_CHECK(decoded.state.modifiers.windows);
+    XTI_CHECK(decoded.state.shortcutAbove == L"Copy");
+    XTI_CHECK(decoded.state.shortcutBelow == L"Caf\u00E9");
+    XTI_CHECK(decoded.state.releasedNs == 123456789012345);
+}
+
+XTI_TEST(restart_handover_partial_frame_waits)
+{
+    // Every prefix of a frame is "not yet", never an error.
+    std::vector<uint8_t> bytes;
+    handover_codec::encode(make_state(), bytes);
+    for (size_t size = 0; size < bytes.size(); size++)
+    {
+        handover_message decoded = {};
+        bool error = true;
+        XTI_CHECK(handover_codec::decode(bytes.data(), size, decoded, error) == 0);
+        XTI_CHECK(!error);
+    }
+}
+
+XTI_TEST(restart_handover_back_to_back_frames)
+{
+    handover_message ready = {};
+    ready.type = handover_message::typeReady;
+    handover_message takenOver = {};
+    takenOver.type = handover_message::typeTakenOver;
+    std::vector<uint8_t> bytes;
+    handover_codec::encode(ready, bytes);
+    size_t firstSize = bytes.size();
+    handover_codec::encode(takenOver, bytes);
+
+    handover_message decoded = {};
+    bool error = true;
+    XTI_CHECK(handover_codec::decode(bytes.data(), bytes.size(), decoded, error) == firstSize);
+    XTI_CHECK(!error);
+    XTI_CHECK(decoded.type == handover_message::typeReady);
+    XTI_CHECK(handover_codec::decode(bytes.data() + firstSize, bytes.size() - firstSize, decoded, error) == bytes.size() - firstSize);
+    XTI_CHECK(!error);
+    XTI_CHECK(decoded.type == handover_message::typeTakenOver);
+}
+
+XTI_TEST(restart_handover_rejects_other_version)
+{
+    std::vector<uint8_t> bytes;
+    handover_codec::encode(make_state(), bytes);
+    bytes[0] = static_cast<uint8_t>(bytes[0] + 1);
+    handover_message decoded = {};
+    bool error = false;
+    XTI_CHECK(handover_codec::decode(bytes.data(), bytes.size(), decoded, error) == 0);
+    XTI_CHECK(error);
+}
+
+XTI_TEST(restart_handover_rejects_unknown_type)
+{
+    handover_message message = {};
+    message.type = 9;
+    std::vector<uint8_t> bytes;
+    handover_codec::encode(message, bytes);
+    handover_message decoded = {};
+    bool error = false;
+    XTI_CHECK(handover_codec::decode(bytes.data(), bytes.size(), decoded, error) == 0);
+    XTI_CHECK(error);
+}
+
+XTI_TEST(restart_handover_rejects_truncated_state)
+{
+    // A complete frame whose payload stops inside the state is corrupt, not incomplete.
+    std::vector<uint8_t> bytes;
+    handover_codec::encode(make_state(), bytes);
+    bytes.pop_back();
+    bytes[1] = static_cast<uint8_t>(bytes[1] - 1);
+    handover_message decoded = {};
+    bool error = false;
+    XTI_CHECK(handover_codec::decode(bytes.data(), bytes.size(), decoded, error) == 0);
+    XTI_CHECK(error);
+}
@@ -0,0 +1,73 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <string>
+// 4. Project classes
+#include "startup_profiler.h"
+#include "xti_test.h"
+
+XTI_TEST(startup_profiler_unmarked_phase_is_zero)
+{
+    startup_profiler profiler;
+    for (uint32_t phase = 0; phase < phase_count; phase++)
+    {
+        XTI_CHECK(profiler.get_elapsed_ns(static_cast<startup_phase>(phase)) == 0);
+    }
+}
+
+XTI_TEST(startup_profiler_marks_are_ordered)
+{
+    startup_profiler profiler;
+    profiler.mark(phase_qtInit);
+    profiler.mark(phase_config);
+    profiler.mark(phase_keyboardHook);
+    XTI_CHECK(profiler.get_elapsed_ns(phase_qtInit) > 0);
+    XTI_CHECK(profiler.get_elapsed_ns(phase_config) >= profiler.get_elapsed_ns(phase_qtInit));
+    XTI_CHECK(profiler.get_elapsed_ns(phase_keyboardHook) >= profiler.get_elapsed_ns(phase_config));
+    XTI_CHECK(profiler.get_elapsed_ns(phase_uiSetup) == 0);
+}
+
+XTI_TEST(startup_profiler_mark_again_moves_end)
+{
+    startup_profiler profiler;
+    profiler.mark(phase_shown);
+    int64_t first = profiler.get_elapsed_ns(phase_shown);
+    profiler.mark(phase_shown);
+    XTI_CHECK(profiler.get_elapsed_ns(phase_shown) >= first);
+}
+
+XTI_TEST(startup_profiler_report_lists_every_phase_in_order)
+{
+    // Unmarked phases still get their line, so reports of different builds line up.
+    startup_profiler profiler;
+    profiler.mark(phase_config);
+    std::string report = profiler.report("build 7");
+    XTI_CHECK(report.compare(0, 21, "startup (ms) build 7\n") == 0);
+    const char* names[] = { "qt-init", "ui-setup", "config", "key-lists", "signals", "timers", "window-style", "shown",
+        "orientate", "keyboard-hook", "shortcuts", "window-registry", "cursor-overlay", "first key usable at" };
+    size_t position = 0;
+    for (const char* name : names)
+    {
+        size_t found = report.find(std::string("\n") + name, position);
+        XTI_CHECK(found != std::string::npos);
+        position = found + 1;
+    }
+    XTI_CHECK(report.find("\nqt-init                   -          -\n") != std::string::npos);
+    XTI_CHECK(report.find("\nconfig                    -") == std::string::npos);
+    XTI_CHECK(report.back() == '\n');
+}
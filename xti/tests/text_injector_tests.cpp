@@ -0,0 +1,184 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <chrono>
+#include <future>
+#include <string>
+#include <vector>
+// 4. Project classes
+#include "recording_input_sink.h"
+#include "text_injector.h"
+#include "virtual_keys.h"
+#include "xti_test.h"
+
+// Records every batch and rejects all of them from rejectFrom on, like SendInput blocked by UIPI.
+class batch_input_sink : public input_sink
+{
+public:
+    explicit batch_input_sink(uint64_t rejectFrom)
+        : m_rejectFrom(rejectFrom)
+    {
+    }
+
+    virtual uint32_t send_keys(const key_stroke* strokes, uint32_t count) override
+    {
+        if (batchSizes.size() >= m_rejectFrom)
+        {
+            return 0;
+        }
+        batchSizes.push_back(count);
+        keys.insert(keys.end(), strokes, strokes + count);
+        return count;
+    }
+
+    virtual uint32_t send_mouse(const mouse_stroke*, uint32_t count) override
+    {
+        return count;
+    }
+
+    std::vector<uint32_t> batchSizes;
+    std::vector<key_stroke> keys;
+
+private:
+    uint64_t m_rejectFrom;
+};
+
+static bool is_stroke(const key_stroke& stroke, uint16_t virtualKeyCode, uint16_t flags)
+{
+    return stroke.virtualKeyCode == virtualKeyCode && stroke.flags == flags;
+}
+
+XTI_TEST(text_injector_strokes_for_text_and_line_breaks)
+{
+    // CRLF is one Enter, tab is Tab, the rest is unicode down and up.
+    std::u16string text = u"a\r\nb\tc";
+    std::vector<key_stroke> strokes;
+    XTI_CHECK(text_injector::append_strokes(text, 0, text.size(), strokes) == 5);
+    XTI_CHECK(strokes.size() == 10);
+    XTI_CHECK(is_stroke(strokes[0], u'a', key_stroke::flagUnicode));
+    XTI_CHECK(is_stroke(strokes[1], u'a', key_stroke::flagUnicode | key_stroke::flagKeyUp));
+    XTI_CHECK(is_stroke(strokes[2], VK_RETURN, 0));
+    XTI_CHECK(is_stroke(strokes[3], VK_RETURN, key_stroke::flagKeyUp));
+    XTI_CHECK(is_stroke(strokes[6], VK_TAB, 0));
+    XTI_CHECK(is_stroke(strokes[9], u'c', key_stroke::flagUnicode | key_stroke::flagKeyUp));
+}
+
+XTI_TEST(text_injector_strokes_for_lone_cr_and_lf)
+{
+    std::u16string text = u"\r\r\n\n";
+    std::vector<key_stroke> strokes;
+    XTI_CHECK(text_injector::append_strokes(text, 0, text.size(), strokes) == 3);
+    XTI_CHECK(strokes.size() == 6);
+}
+
+XTI_TEST(text_injector_strokes_for_surrogate_pair)
+{
+    // U+1F600 is one character but two units, each typed as its own unicode stroke pair.
+    std::u16string text = u"\U0001F600";
+    std::vector<key_stroke> strokes;
+    XTI_CHECK(text_injector::append_strokes(text, 0, text.size(), strokes) == 1);
+    XTI_CHECK(strokes.size() == 4);
+    XTI_CHECK(is_stroke(strokes[0], 0xD83D, key_stroke::flagUnicode));
+    XTI_CHECK(is_stroke(strokes[2], 0xDE00, key_stroke::flagUnicode));
+}
+
+XTI_TEST(text_injector_strokes_append)
+{
+    std::vector<key_stroke> strokes(3);
+    XTI_CHECK(text_injector::append_strokes(u"xyz", 1, 2, strokes) == 1);
+    XTI_CHECK(strokes.size() == 5);
+    XTI_CHECK(is_stroke(strokes[3], u'y', key_stroke::flagUnicode));
+}
+
+XTI_TEST(text_injector_batches_by_characters)
+{
+    batch_input_sink sink(UINT64_MAX);
+    text_injector injector(&sink);
+    text_injection_settings settings;
+    settings.charsPerBatch = 1000;
+    settings.batchPauseNs = 0;
+    text_injection_report report = injector.inject(std::u16string(2500, u'x'), settings);
+    XTI_CHECK(report.complete);
+    XTI_CHECK(!report.failed);
+    XTI_CHECK(report.characters == 2500);
+    XTI_CHECK(report.batches == 3);
+    XTI_CHECK(sink.batchSizes.size() == 3);
+    XTI_CHECK(sink.batchSizes[0] == 2000);
+    XTI_CHECK(sink.batchSizes[2] == 1000);
+}
+
+XTI_TEST(text_injector_batch_never_splits_pairs)
+{
+    // Three characters per batch: "ab" + CRLF, then a surrogate pair and "c" + "d".
+    batch_input_sink sink(UINT64_MAX);
+    text_injector injector(&sink);
+    text_injection_settings settings;
+    settings.charsPerBatch = 3;
+    settings.batchPauseNs = 0;
+    text_injection_report report = injector.inject(u"ab\r\n\U0001F600cd", settings);
+    XTI_CHECK(report.complete);
+    XTI_CHECK(report.characters == 6);
+    XTI_CHECK(sink.batchSizes.size() == 2);
+    XTI_CHECK(sink.batchSizes[0] == 6);
+    XTI_CHECK(sink.batchSizes[1] == 8);
+}
+
+XTI_TEST(text_injector_zero_batch_size_sends_everything)
+{
+    batch_input_sink sink(UINT64_MAX);
+    text_injector injector(&sink);
+    text_injection_settings settings;
+    settings.charsPerBatch = 0;
+    text_injection_report report = injector.inject(std::u16string(5000, u'x'), settings);
+    XTI_CHECK(report.complete);
+    XTI_CHECK(report.batches == 1);
+}
+
+XTI_TEST(text_injector_stops_when_rejected)
+{
+    batch_input_sink sink(1);
+    text_injector injector(&sink);
+    text_injection_settings settings;
+    settings.charsPerBatch = 10;
+    settings.batchPauseNs = 0;
+    text_injection_report report = injector.inject(std::u16string(35, u'x'), settings);
+    XTI_CHECK(!report.complete);
+    XTI_CHECK(report.failed);
+    XTI_CHECK(report.characters == 10);
+    XTI_CHECK(report.batches == 1);
+}
+
+XTI_TEST(text_injector_cancel_stops_after_batch_in_flight)
+{
+    // The pause is long enough that only cancel() can end it, the first batch always goes out.
+    recording_input_sink sink;
+    text_injector injector(&sink);
+    text_injection_settings settings;
+    settings.charsPerBatch = 10;
+    settings.batchPauseNs = 60000000000;
+    std::promise<text_injection_report> done;
+    std::future<text_injection_report> result = done.get_future();
+    injector.type(std::u16string(35, u'x'), settings, [&done](const text_injection_report& report) { done.set_value(report); });
+    injector.cancel();
+    XTI_CHECK(result.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+    text_injection_report report = result.get();
+    XTI_CHECK(!report.complete);
+    XTI_CHECK(!report.failed);
+    XTI_CHECK(report.characters == 10);
+    XTI_CHECK(!injector.is_typing());
+}
@@ -0,0 +1,95 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <fstream>
+#include <iterator>
+#include <vector>
+// 4. Project classes
+#include "touch_trace.h"
+#include "xti_test.h"
+
+XTI_TEST(touch_trace_round_trip)
+{
+    touch_trace_writer writer;
+    touch_trace_frame begin = { touch_trace_frame::typeBegin, 5000, { { 0, 0x01, 320, -48 }, { 1, 0x01, 16000, 800 } }, {} };
+    touch_trace_frame update = { touch_trace_frame::typeUpdate, 5008, { { 0, 0x02, 336, -40 }, { 1, 0x04, 16000, 800 } }, {} };
+    touch_trace_frame end = { touch_trace_frame::typeEnd, 5020, { { 0, 0x08, 336, -40 } }, {} };
+    writer.add_keys(nullptr, 0); // before the first frame, ignored
+    writer.add_frame(begin);
+    writer.add_frame(update);
+    writer.add_frame(end);
+    key_stroke strokes[2] = { { 'A', 0, 0x1E }, { 'A', key_stroke::flagKeyUp, 0x1E } };
+    writer.add_keys(strokes, 2);
+    const std::vector<uint8_t>& bytes = writer.finish();
+    XTI_CHECK(writer.get_frame_count() == 3);
+
+    touch_trace_reader reader(bytes.data(), bytes.size());
+    touch_trace_frame frame;
+    XTI_CHECK(reader.next(frame));
+    XTI_CHECK(frame.type == touch_trace_frame::typeBegin && frame.timestampMs == 5000);
+    XTI_CHECK(frame.points.size() == 2 && frame.points[1].x == 16000 && frame.points[0].y == -48);
+    XTI_CHECK(reader.next(frame));
+    XTI_CHECK(frame.timestampMs == 5008 && frame.points[0].x == 336 && frame.points[0].state == 0x02);
+    XTI_CHECK(reader.next(frame));
+    XTI_CHECK(frame.type == touch_trace_frame::typeEnd && frame.keys.size() == 2);
+    XTI_CHECK(frame.keys[1].virtualKeyCode == 'A' && frame.keys[1].flags == key_stroke::flagKeyUp);
+    XTI_CHECK(!reader.next(frame));
+    XTI_CHECK(!reader.has_error());
+}
+
+XTI_TEST(touch_trace_truncated_is_an_error)
+{
+    touch_trace_writer writer;
+    writer.add_frame({ touch_trace_frame::typeBegin, 100, { { 0, 0x01, 1000, 1000 } }, {} });
+    std::vector<uint8_t> bytes = writer.finish();
+    bytes.pop_back();
+    touch_trace_reader reader(bytes.data(), bytes.size());
+    touch_trace_frame frame;
+    XTI_CHECK(!reader.next(frame));
+    XTI_CHECK(reader.has_error());
+}
+
+XTI_TEST(touch_trace_checked_in_replay_is_readable)
+{
+    // The trace ctest replays through the app on Windows: a tap on each of ESC, F1 to F6, then F1 again.
+    std::ifstream file(XTI_TEST_DATA_DIR "/top_row_taps.xtt", std::ios::binary);
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    XTI_CHECK(!bytes.empty());
+    static constexpr uint16_t expected[] = { VK_ESCAPE, VK_F1, VK_F2, VK_F3, VK_F4, VK_F5, VK_F6, VK_F1 };
+    touch_trace_reader reader(bytes.data(), bytes.size());
+    touch_trace_frame frame;
+    uint32_t taps = 0;
+    while (reader.next(frame))
+    {
+        if (frame.type != touch_trace_frame::typeEnd)
+        {
+            XTI_CHECK(frame.keys.empty());
+            continue;
+        }
+        XTI_CHECK(taps < 8);
+        XTI_CHECK(frame.keys.size() == 2);
+        if (taps < 8 && frame.keys.size() == 2)
+        {
+            XTI_CHECK(frame.keys[0].virtualKeyCode == expected[taps] && frame.keys[0].flags == 0);
+            XTI_CHECK(frame.keys[1].virtualKeyCode == expected[taps] && frame.keys[1].flags == key_stroke::flagKeyUp);
+        }
+        taps++;
+    }
+    XTI_CHECK(!reader.has_error());
+    XTI_CHECK(taps == 8);
+}
@@ -0,0 +1,212 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <chrono>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+// 4. Project classes
+#include "window_executor.h"
+#include "xti_test.h"
+
+// Stands in for the UI thread: keeps what the executor posts until the test runs it.
+class posted_queue
+{
+public:
+    window_executor::post_function get_post()
+    {
+        return [this](std::function<void()> posted)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_posted.push_back(std::move(posted));
+        };
+    }
+
+    std::vector<std::function<void()>> take()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::vector<std::function<void()>> posted;
+        posted.swap(m_posted);
+        return posted;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::vector<std::function<void()>> m_posted;
+};
+
+// Work that records its name, from the executor thread. Only read once the executor has finished with it.
+static std::function<void()> log_work(std::vector<std::string>* log, const char* name)
+{
+    return [log, name]() { log->push_back(name); };
+}
+
+// Waits for a request to have finished, the test fails rather than hangs if it never does.
+static bool wait_for(std::future<void>& done)
+{
+    return done.wait_for(std::chrono::seconds(5)) == std::future_status::ready;
+}
+
+// Requests count as completed just after their work returns, so stats can trail a request's own signal.
+static bool wait_for_completed(const window_executor& executor, uint64_t completed)
+{
+    for (uint32_t i = 0; i < 5000; i++)
+    {
+        if (executor.get_stats().completed >= completed)
+        {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+}
+
+XTI_TEST(window_executor_runs_in_order)
+{
+    posted_queue ui;
+    window_executor executor(ui.get_post(), nullptr, nullptr);
+    std::vector<std::string> log;
+    std::vector<std::string> completions;
+    std::promise<void> done;
+    std::future<void> doneFuture = done.get_future();
+    executor.submit(0, log_work(&log, "a"), [&completions]() { completions.push_back("a"); });
+    executor.submit(0, log_work(&log, "b"), nullptr);
+    executor.submit(0, log_work(&log, "c"), [&completions]() { completions.push_back("c"); });
+    executor.submit(0, [&done]() { done.set_value(); }, nullptr);
+    XTI_CHECK(wait_for(doneFuture));
+    XTI_CHECK((log == std::vector<std::string> { "a", "b", "c" }));
+    XTI_CHECK(wait_for_completed(executor, 4));
+
+    // Completions come back through the post function, in order, and only run where it runs them.
+    std::vector<std::function<void()>> posted = ui.take();
+    XTI_CHECK(posted.size() == 2);
+    XTI_CHECK(completions.empty());
+    for (size_t i = 0; i < posted.size(); i++)
+    {
+        posted[i]();
+    }
+    XTI_CHECK((completions == std::vector<std::string> { "a", "c" }));
+
+    window_executor_stats stats = executor.get_stats();
+    XTI_CHECK(stats.submitted == 4);
+    XTI_CHECK(stats.completed == 4);
+    XTI_CHECK(stats.superseded == 0);
+    XTI_CHECK(stats.queueDepth == 0);
+}
+
+XTI_TEST(window_executor_supersedes_queued_requests)
+{
+    posted_queue ui;
+    window_executor executor(ui.get_post(), nullptr, nullptr);
+    std::vector<std::string> log;
+    std::promise<void> started;
+    std::future<void> startedFuture = started.get_future();
+    std::promise<void> release;
+    std::shared_future<void> releaseFuture = release.get_future().share();
+    std::promise<void> done;
+    std::future<void> doneFuture = done.get_future();
+
+    // Hold the executor in a request with key 1, so everything below queues up behind it.
+    executor.submit(1, [&log, &started, releaseFuture]()
+        {
+            log.push_back("running");
+            started.set_value();
+            releaseFuture.wait();
+        }, nullptr);
+    XTI_CHECK(wait_for(startedFuture));
+
+    executor.submit(1, log_work(&log, "above 1"), nullptr);
+    executor.submit(2, log_work(&log, "below 1"), nullptr);
+    executor.submit(1, log_work(&log, "above 2"), nullptr);
+    executor.submit(0, log_work(&log, "move 1"), nullptr);
+    executor.submit(0, log_work(&log, "move 2"), nullptr);
+    executor.submit(2, log_work(&log, "below 2"), nullptr);
+    // A newer request drops the queued one with its key, key 0 never supersedes, and the one already running
+    // is never dropped.
+    window_executor_stats stats = executor.get_stats();
+    XTI_CHECK(stats.superseded == 2);
+    XTI_CHECK(stats.queueDepth == 4);
+
+    executor.submit(0, [&done]() { done.set_value(); }, nullptr);
+    release.set_value();
+    XTI_CHECK(wait_for(doneFuture));
+    XTI_CHECK((log == std::vector<std::string> { "running", "above 2", "move 1", "move 2", "below 2" }));
+    XTI_CHECK(wait_for_completed(executor, 6));
+    stats = executor.get_stats();
+    XTI_CHECK(stats.submitted == 8);
+    XTI_CHECK(stats.completed == 6);
+    XTI_CHECK(stats.superseded == 2);
+}
+
+XTI_TEST(window_executor_reports_exceptions)
+{
+    posted_queue ui;
+    window_executor executor(ui.get_post(), nullptr, nullptr);
+    bool completed = false;
+    std::promise<void> done;
+    std::future<void> doneFuture = done.get_future();
+    executor.submit(0, []() { throw std::runtime_error("window gone"); }, [&completed]() { completed = true; });
+    executor.submit(0, [&done]() { done.set_value(); }, nullptr);
+    XTI_CHECK(wait_for(doneFuture));
+    XTI_CHECK(wait_for_completed(executor, 1));
+
+    // The exception is rethrown where the post function runs it, the failed request's completion never runs,
+    // and the executor carries on with the next request.
+    std::vector<std::function<void()>> posted = ui.take();
+    XTI_CHECK(posted.size() == 1);
+    bool rethrown = false;
+    try
+    {
+        posted[0]();
+    }
+    catch (const std::runtime_error& error)
+    {
+        rethrown = std::string(error.what()) == "window gone";
+    }
+    XTI_CHECK(rethrown);
+    XTI_CHECK(!completed);
+    XTI_CHECK(executor.get_stats().completed == 1);
+}
+
+XTI_TEST(window_executor_thread_start_and_stop)
+{
+    posted_queue ui;
+    std::thread::id startThread;
+    std::thread::id stopThread;
+    std::thread::id workThread;
+    {
+        window_executor executor(ui.get_post(), [&startThread]() { startThread = std::this_thread::get_id(); },
+                                 [&stopThread]() { stopThread = std::this_thread::get_id(); });
+        std::promise<void> done;
+        std::future<void> doneFuture = done.get_future();
+        executor.submit(0, [&workThread, &done]()
+            {
+                workThread = std::this_thread::get_id();
+                done.set_value();
+            }, nullptr);
+        XTI_CHECK(wait_for(doneFuture));
+    }
+    // Both ran on the executor thread, which is not this one, and the stop hook ran before the destructor returned.
+    XTI_CHECK(workThread != std::this_thread::get_id());
+    XTI_CHECK(startThread == workThread);
+    XTI_CHECK(stopThread == workThread);
+}
@@ -0,0 +1,245 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <string>
+#include <vector>
+// 4. Project classes
+#include "simulated_window_source.h"
+#include "window_registry.h"
+#include "xti_test.h"
+
+static window_info make_window(window_id id, const std::wstring& exeNameUpper, const std::wstring& title)
+{
+    window_info info;
+    info.id = id;
+    info.processId = static_cast<uint32_t>(id * 10);
+    info.exeNameUpper = exeNameUpper;
+    info.title = title;
+    info.visible = true;
+    return info;
+}
+
+// Records every foreground listener call, with the title it saw (empty for an unknown window).
+struct foreground_calls
+{
+    std::vector<window_id> ids;
+    std::vector<std::wstring> titles;
+};
+
+static void on_foreground(void* context, const window_info* info)
+{
+    foreground_calls* calls = static_cast<foreground_calls*>(context);
+    calls->ids.push_back(info == nullptr ? 0 : info->id);
+    calls->titles.push_back(info == nullptr ? std::wstring() : info->title);
+}
+
+XTI_TEST(window_registry_existing_windows_on_start)
+{
+    // Windows created before start() are reported when it is called, with any changes made in the meantime.
+    window_registry registry;
+    simulated_window_source source;
+    source.create(make_window(1, L"NOTEPAD.EXE", L"a.txt"));
+    source.create(make_window(2, L"NOTEPAD.EXE", L"b.txt"));
+    source.create(make_window(3, L"CALC.EXE", L"Calculator"));
+    source.rename(1, L"c.txt");
+    source.set_visible(2, false);
+    source.destroy(3);
+    XTI_CHECK(registry.size() == 0);
+
+    source.start(&registry);
+    XTI_CHECK(registry.size() == 2);
+    XTI_CHECK(registry.get(1) != nullptr && registry.get(1)->title == L"c.txt");
+    XTI_CHECK(registry.get(2) != nullptr && !registry.get(2)->visible);
+    XTI_CHECK(registry.get(3) == nullptr);
+    XTI_CHECK(registry.find(L"NOTEPAD.EXE", L"") == 1);
+}
+
+XTI_TEST(window_registry_create_and_destroy)
+{
+    window_registry registry;
+    simulated_window_source source;
+    source.start(&registry);
+    source.create(make_window(1, L"NOTEPAD.EXE", L"a.txt"));
+    XTI_CHECK(registry.size() == 1);
+    XTI_CHECK(registry.get(1) != nullptr && registry.get(1)->processId == 10);
+    XTI_CHECK(registry.find(L"NOTEPAD.EXE", L"") == 1);
+
+    source.destroy(1);
+    XTI_CHECK(registry.size() == 0);
+    XTI_CHECK(registry.get(1) == nullptr);
+    XTI_CHECK(registry.find(L"NOTEPAD.EXE", L"") == 0);
+    // Unknown ids are ignored.
+    source.destroy(1);
+    XTI_CHECK(registry.size() == 0);
+}
+
+XTI_TEST(window_registry_reused_id)
+{
+    // A created event for a known id replaces the window, and moves it to its new exe.
+    window_registry registry;
+    simulated_window_source source;
+    source.start(&registry);
+    source.create(make_window(1, L"NOTEPAD.EXE", L"a.txt"));
+    source.create(make_window(1, L"CALC.EXE", L"Calculator"));
+    XTI_CHECK(registry.size() == 1);
+    XTI_CHECK(registry.find(L"NOTEPAD.EXE", L"") == 0);
+    XTI_CHECK(registry.find(L"CALC.EXE", L"") == 1);
+}
+
+XTI_TEST(window_registry_find_by_title)
+{
+    window_registry registry;
+    simulated_window_source source;
+    source.start(&registry);
+    source.create(make_window(1, L"NOTEPAD.EXE", L"notes.txt - Notepad"));
+    source.create(make_window(2, L"NOTEPAD.EXE", L"todo.txt - Notepad"));
+    source.create(make_window(3, L"CALC.EXE", L"Calculator"));
+
+    // No title: the oldest window of the exe.
+    XTI_CHECK(registry.find(L"NOTEPAD.EXE", L"") == 1);
+    XTI_CHECK(registry.find(L"NOTEPAD.EXE", L"todo") == 2);
+    XTI_CHECK(registry.find(L"NOTEPAD.EXE", L"Notepad") == 1);
+    // The title must contain the text, case sensitively, and the exe must match exactly.
+    XTI_CHECK(registry.find(L"NOTEPAD.EXE", L"TODO") == 0);
+    XTI_CHECK(registry.find(L"NOTEPAD.EXE", L"Calculator") == 0);
+    XTI_CHECK(registry.find(L"notepad.exe", L"") == 0);
+    XTI_CHECK(registry.find(L"WORD.EXE", L"") == 0);
+}
+
+XTI_TEST(window_registry_rename)
+{
+    window_registry registry;
+    simulated_window_source source;
+    source.start(&registry);
+    source.create(make_window(1, L"NOTEPAD.EXE", L"a.txt"));
+    source.rename(1, L"b.txt");
+    XTI_CHECK(registry.get(1)->title == L"b.txt");
+    XTI_CHECK(registry.find(L"NOTEPAD.EXE", L"a.txt") == 0);
+    XTI_CHECK(registry.find(L"NOTEPAD.EXE", L"b.txt") == 1);
+
+    // Untitled windows are never matches, even with no title asked for.
+    source.rename(1, L"");
+    XTI_CHECK(registry.find(L"NOTEPAD.EXE", L"") == 0);
+    // Renaming an unknown window doesn't add it.
+    source.rename(2, L"c.txt");
+    XTI_CHECK(registry.size() == 1);
+}
+
+XTI_TEST(window_registry_hide_and_show)
+{
+    window_registry registry;
+    simulated_window_source source;
+    source.start(&registry);
+    source.create(make_window(1, L"NOTEPAD.EXE", L"a.txt"));
+    source.create(make_window(2, L"NOTEPAD.EXE", L"b.txt"));
+
+    // Hiding the oldest window makes the next one the match, showing it again restores it.
+    source.set_visible(1, false);
+    XTI_CHECK(!registry.get(1)->visible);
+    XTI_CHECK(registry.find(L"NOTEPAD.EXE", L"") == 2);
+    XTI_CHECK(registry.find(L"NOTEPAD.EXE", L"a.txt") == 0);
+    source.set_visible(1, true);
+    XTI_CHECK(registry.find(L"NOTEPAD.EXE", L"") == 1);
+
+    source.set_visible(1, false);
+    source.set_visible(2, false);
+    XTI_CHECK(registry.find(L"NOTEPAD.EXE", L"") == 0);
+    XTI_CHECK(registry.size() == 2);
+}
+
+XTI_TEST(window_registry_find_many)
+{
+    window_registry registry;
+    simulated_window_source source;
+    source.start(&registry);
+    source.create(make_window(1, L"NOTEPAD.EXE", L"a.txt"));
+    source.create(make_window(2, L"NOTEPAD.EXE", L"b.txt"));
+    source.create(make_window(3, L"CALC.EXE", L"Calculator"));
+
+    const window_query queries[] = {
+        { L"NOTEPAD.EXE", L"" },
+        { L"NOTEPAD.EXE", L"b.txt" },
+        { L"CALC.EXE", L"" },
+        { L"WORD.EXE", L"" },
+        { L"CALC.EXE", L"a.txt" },
+    };
+    window_id found[5] = { 99, 99, 99, 99, 99 };
+    registry.find_many(queries, 5, found);
+    XTI_CHECK(found[0] == 1);
+    XTI_CHECK(found[1] == 2);
+    XTI_CHECK(found[2] == 3);
+    XTI_CHECK(found[3] == 0);
+    XTI_CHECK(found[4] == 0);
+
+    // Each answer matches the single lookup, also after changes.
+    source.destroy(1);
+    registry.find_many(queries, 5, found);
+    for (uint32_t i = 0; i < 5; i++)
+    {
+        XTI_CHECK(found[i] == registry.find(queries[i].exeNameUpper, queries[i].titleContains));
+    }
+    XTI_CHECK(found[0] == 2);
+}
+
+XTI_TEST(window_registry_foreground_listener)
+{
+    window_registry registry;
+    simulated_window_source source;
+    foreground_calls calls;
+    registry.set_foreground_listener(on_foreground, &calls);
+    source.start(&registry);
+    source.create(make_window(1, L"NOTEPAD.EXE", L"a.txt"));
+    source.create(make_window(2, L"CALC.EXE", L"Calculator"));
+    XTI_CHECK(registry.get_foreground() == nullptr);
+
+    source.set_foreground(1);
+    XTI_CHECK(calls.ids.size() == 1 && calls.ids[0] == 1 && calls.titles[0] == L"a.txt");
+    XTI_CHECK(registry.get_foreground() != nullptr && registry.get_foreground()->id == 1);
+
+    // The same window again is not a change.
+    source.set_foreground(1);
+    XTI_CHECK(calls.ids.size() == 1);
+
+    // Renaming the foreground window is reported, renaming another window or keeping the title isn't.
+    source.rename(1, L"b.txt");
+    XTI_CHECK(calls.ids.size() == 2 && calls.ids[1] == 1 && calls.titles[1] == L"b.txt");
+    source.rename(1, L"b.txt");
+    source.rename(2, L"Calculator - Scientific");
+    XTI_CHECK(calls.ids.size() == 2);
+
+    source.set_foreground(2);
+    XTI_CHECK(calls.ids.size() == 3 && calls.ids[2] == 2);
+
+    // A window the registry doesn't know (e.g. xti's own) is reported as nullptr.
+    source.set_foreground(42);
+    XTI_CHECK(calls.ids.size() == 4 && calls.ids[3] == 0);
+    XTI_CHECK(registry.get_foreground() == nullptr);
+
+    // Destroying the foreground window leaves no foreground window.
+    source.set_foreground(1);
+    source.destroy(1);
+    XTI_CHECK(registry.get_foreground() == nullptr);
+
+    // After stop() the source no longer reaches the registry.
+    source.stop();
+    source.set_foreground(2);
+    source.create(make_window(3, L"WORD.EXE", L"Document1"));
+    XTI_CHECK(calls.ids.size() == 5);
+    XTI_CHECK(registry.size() == 1);
+    XTI_CHECK(registry.get_foreground() == nullptr);
+}
@@ -0,0 +1,161 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <string>
+#include <vector>
+// 4. Project classes
+#include "word_dictionary.h"
+#include "xti_test.h"
+
+// Builds and opens a dictionary, bytes must outlive it.
+static bool open_dictionary(const word_dictionary_builder& builder, std::vector<uint8_t>& bytes, word_dictionary& dictionary)
+{
+    bytes = builder.build();
+    std::string error;
+    return dictionary.open(bytes.data(), bytes.size(), error);
+}
+
+static std::vector<std::string> complete(const word_dictionary& dictionary, const std::string& prefix, uint32_t k)
+{
+    std::vector<word_completion> completions;
+    dictionary.complete(prefix, k, completions);
+    std::vector<std::string> words;
+    for (const word_completion& completion : completions)
+    {
+        words.push_back(completion.word);
+    }
+    return words;
+}
+
+XTI_TEST(word_dictionary_most_frequent_first)
+{
+    word_dictionary_builder builder;
+    builder.add("there", 50);
+    builder.add("the", 1000);
+    builder.add("then", 100);
+    builder.add("this", 400);
+    builder.add("other", 900);
+    std::vector<uint8_t> bytes;
+    word_dictionary dictionary;
+    XTI_CHECK(open_dictionary(builder, bytes, dictionary));
+    XTI_CHECK(dictionary.get_word_count() == 5);
+    XTI_CHECK((complete(dictionary, "th", 3) == std::vector<std::string>{ "the", "this", "then" }));
+    // The prefix itself is never a completion.
+    XTI_CHECK((complete(dictionary, "the", 3) == std::vector<std::string>{ "then", "there" }));
+    XTI_CHECK(complete(dictionary, "x", 3).empty());
+    XTI_CHECK(complete(dictionary, "", 3).empty());
+    XTI_CHECK(complete(dictionary, "th", 0).empty());
+}
+
+XTI_TEST(word_dictionary_ignores_case)
+{
+    // Whatever the corpus had, completions start with the prefix exactly as typed.
+    word_dictionary_builder builder;
+    builder.add("Windows", 100);
+    builder.add("window", 50);
+    builder.add("the", 1000);
+    builder.add("The", 300);
+    std::vector<uint8_t> bytes;
+    word_dictionary dictionary;
+    XTI_CHECK(open_dictionary(builder, bytes, dictionary));
+    XTI_CHECK((complete(dictionary, "win", 3) == std::vector<std::string>{ "windows", "window" }));
+    XTI_CHECK((complete(dictionary, "Win", 3) == std::vector<std::string>{ "Windows", "Window" }));
+    // "the" and "The" are one completion, scored as the more frequent one.
+    std::vector<word_completion> completions;
+    dictionary.complete("Th", 3, completions);
+    XTI_CHECK(completions.size() == 1);
+    XTI_CHECK(completions[0].word == "The");
+}
+
+XTI_TEST(word_dictionary_capitals_carry_over)
+{
+    // Two or more capitals type the rest in capitals too, a single one only capitalises.
+    word_dictionary_builder builder;
+    builder.add("keyboard", 10);
+    std::vector<uint8_t> bytes;
+    word_dictionary dictionary;
+    XTI_CHECK(open_dictionary(builder, bytes, dictionary));
+    XTI_CHECK((complete(dictionary, "KEY", 1) == std::vector<std::string>{ "KEYBOARD" }));
+    XTI_CHECK((complete(dictionary, "K", 1) == std::vector<std::string>{ "Keyboard" }));
+    XTI_CHECK((complete(dictionary, "kEy", 1) == std::vector<std::string>{ "kEyboard" }));
+}
+
+XTI_TEST(word_dictionary_range_across_blocks)
+{
+    // Enough words for several blocks, with the prefix range in the middle of them.
+    word_dictionary_builder builder;
+    for (char first = 'a'; first <= 'z'; first++)
+    {
+        for (char second = 'a'; second <= 'z'; second++)
+        {
+            builder.add(std::string(1, first) + second + "x", 1);
+        }
+    }
+    builder.add("mqx", 64);
+    builder.add("Mzx", 8);
+    std::vector<uint8_t> bytes;
+    word_dictionary dictionary;
+    XTI_CHECK(open_dictionary(builder, bytes, dictionary));
+    std::vector<std::string> words = complete(dictionary, "m", 30);
+    XTI_CHECK(words.size() == 26);
+    XTI_CHECK(words[0] == "mqx");
+    XTI_CHECK(words[1] == "mzx");
+    for (const std::string& word : words)
+    {
+        XTI_CHECK(word[0] == 'm');
+    }
+}
+
+XTI_TEST(word_dictionary_long_prefix_has_no_completion)
+{
+    word_dictionary_builder builder;
+    std::string longest(word_dictionary_builder::maxWordBytes, 'a');
+    builder.add(longest, 5);
+    builder.add(longest + "a", 5); // over the limit, ignored
+    std::vector<uint8_t> bytes;
+    word_dictionary dictionary;
+    XTI_CHECK(open_dictionary(builder, bytes, dictionary));
+    XTI_CHECK(dictionary.get_word_count() == 1);
+    XTI_CHECK(complete(dictionary, longest.substr(1), 3).size() == 1);
+    XTI_CHECK(complete(dictionary, longest, 3).empty());
+    XTI_CHECK(complete(dictionary, longest + "aaaa", 3).empty());
+}
+
+XTI_TEST(word_dictionary_add_text_splits_words)
+{
+    word_dictionary_builder builder;
+    const char text[] = "m_keyLayout = 0x10; a b key_layout";
+    builder.add_text(text, sizeof(text) - 1);
+    XTI_CHECK(builder.get_word_count() == 2);
+}
+
+XTI_TEST(word_dictionary_rejects_damaged_files)
+{
+    word_dictionary_builder builder;
+    builder.add("word", 1);
+    std::vector<uint8_t> bytes = builder.build();
+    word_dictionary dictionary;
+    std::string error;
+    XTI_CHECK(!dictionary.open(bytes.data(), bytes.size() - 1, error));
+    XTI_CHECK(!error.empty());
+    bytes[3]++;
+    error.clear();
+    XTI_CHECK(!dictionary.open(bytes.data(), bytes.size(), error));
+    XTI_CHECK(!error.empty());
+    XTI_CHECK(dictionary.get_word_count() == 0);
+}
@@ -0,0 +1,84 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "xti_test.h"
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <cstdio>
+#include <cstring>
+#include <vector>
+// 4. Project classes
+
+struct registered_test
+{
+    const char* name;
+    xti_test::test_function function;
+};
+
+// Function local, so registering from other translation units never runs before it exists.
+static std::vector<registered_test>& get_tests()
+{
+    static std::vector<registered_test> tests;
+    return tests;
+}
+
+static uint32_t currentFailures = 0;
+
+/* public */ bool xti_test::add(const char* name, test_function function)
+{
+    get_tests().push_back({ name, function });
+    return true;
+}
+
+/* public */ void xti_test::check(bool passed, const char* expression, const char* file, int32_t line)
+{
+    if (!passed)
+    {
+        std::printf("  %s:%d: check failed: %s\n", file, line, expression);
+        currentFailures++;
+    }
+}
+
+// --- run(): Runs every test whose name starts with prefix and returns the exit code.
+// ----- prefix: Only tests whose name starts with it run, nullptr runs all of them.
+// ------- returns: 0 if at least one test ran and none failed, 1 otherwise.
+// --------------------------------------------------------------------------------------------/
+/* public */ int32_t xti_test::run(const char* prefix)
+{
+    uint32_t ran = 0;
+    uint32_t failed = 0;
+    for (const registered_test& test : get_tests())
+    {
+        if (prefix != nullptr && std::strncmp(test.name, prefix, std::strlen(prefix)) != 0)
+        {
+            continue;
+        }
+        currentFailures = 0;
+        test.function();
+        std::printf("%-64s %s\n", test.name, currentFailures == 0 ? "ok" : "FAILED");
+        ran++;
+        failed += currentFailures == 0 ? 0 : 1;
+    }
+    std::printf("%u tests, %u failed\n", ran, failed);
+    // A prefix that matches nothing is a typo in the test registration, not a pass.
+    return ran > 0 && failed == 0 ? 0 : 1;
+}
+
+int main(int argc, char* argv[])
+{
+    return xti_test::run(argc > 1 ? argv[1] : nullptr);
+}
@@ -0,0 +1,51 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef XTI_TEST_H
+#define XTI_TEST_H
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <cstdint>
+// 4. Project classes
+// 5. Forward decl
+
+// Minimal test runner for xti_core, so the tests build wherever the library does without a test framework.
+// Tests register themselves with XTI_TEST and are run by name prefix: `xti_tests [prefix]`.
+class xti_test // static members only
+{
+public:
+    typedef void (*test_function)();
+
+    // public add(): Registers a test, called through XTI_TEST before main() runs.
+    static bool add(const char* name, test_function function);
+
+    // public check(): Records a failed check of the test running right now, the test carries on.
+    static void check(bool passed, const char* expression, const char* file, int32_t line);
+
+    // public run(): Runs every test whose name starts with prefix (nullptr for all) and returns the exit code.
+    // see cpp file for more info.
+    static int32_t run(const char* prefix);
+};
+
+#define XTI_TEST(name)                                                         \
+    static void name();                                                        \
+    [[maybe_unused]] static const bool name##Registered = xti_test::add(#name, &name); \
+    static void name()
+
+#define XTI_CHECK(expression) xti_test::check((expression), #expression, __FILE__, __LINE__)
+
+#endif // XTI_TEST_H
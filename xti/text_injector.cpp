@@ -0,0 +1,196 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "text_injector.h"
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <chrono>
+#include <utility>
+// 4. Project classes
+#include "key_chord.h"
+#include "latency_recorder.h"
+
+/* public */ double text_injection_report::get_chars_per_second() const
+{
+    if (elapsedNs <= 0)
+    {
+        return 0.0;
+    }
+    return static_cast<double>(characters) * 1e9 / static_cast<double>(elapsedNs);
+}
+
+static bool is_high_surrogate(char16_t unit)
+{
+    return unit >= 0xD800 && unit <= 0xDBFF;
+}
+
+text_injector::text_injector(input_sink* sink)
+    : m_sink(sink)
+    , m_typing(false)
+{
+}
+
+text_injector::~text_injector()
+{
+    cancel();
+    join();
+}
+
+// --- type(): Starts typing text in the background, cancelling whatever was still being typed.
+// Waits for the previous text's batch in flight to finish first, so the two never interleave.
+// ----- text: The text to type, UTF-16 as Windows and Qt hand it out.
+// ----- settings: How to batch and throttle it.
+// ----- done: Called on the typing thread once typing has finished, been cancelled or failed. May be empty.
+// --------------------------------------------------------------------------------------------/
+/* public */ void text_injector::type(std::u16string text, const text_injection_settings& settings, done_callback done)
+{
+    cancel();
+    join();
+    {
+        std::lock_guard<std::mutex> lock(m_cancelMutex);
+        m_cancelled = false;
+    }
+    m_typing.store(true, std::memory_order_release);
+    m_thread = std::thread([this, text = std::move(text), settings, done = std::move(done)]()
+    {
+        text_injection_report report = inject(text, settings);
+        m_typing.store(false, std::memory_order_release);
+        if (done)
+        {
+            done(report);
+        }
+    });
+}
+
+/* public */ void text_injector::cancel()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_cancelMutex);
+        m_cancelled = true;
+    }
+    m_cancelWake.notify_one();
+}
+
+/* private */ void text_injector::join()
+{
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+}
+
+// --- inject(): Types text on the calling thread, stopping early if cancel() is called meanwhile.
+// Each batch is one send_keys() call, so nothing the user types can land in the middle of a batch.
+// The pause between batches is for the receiver, not the OS: a Win32 app gets a posted WM_KEYDOWN, WM_CHAR and
+// WM_KEYUP per character and its queue holds at most 10000 posted messages, anything past that is dropped.
+// ----- text: The text to type.
+// ----- settings: How to batch and throttle it.
+// ------- returns: What was typed and how fast.
+// --------------------------------------------------------------------------------------------/
+/* public */ text_injection_report text_injector::inject(const std::u16string& text, const text_injection_settings& settings)
+{
+    text_injection_report report = {};
+    int64_t startNs = latency_recorder::now_ns();
+    size_t begin = 0;
+    while (begin < text.size())
+    {
+        size_t end = find_batch_end(text, begin, settings.charsPerBatch);
+        m_strokes.clear();
+        uint64_t characters = append_strokes(text, begin, end, m_strokes);
+        uint32_t count = static_cast<uint32_t>(m_strokes.size());
+        if (m_sink->send_keys(m_strokes.data(), count) < count)
+        {
+            report.failed = true;
+            break;
+        }
+        report.characters += characters;
+        report.batches++;
+        begin = end;
+        std::unique_lock<std::mutex> lock(m_cancelMutex);
+        if (begin < text.size() && settings.batchPauseNs > 0)
+        {
+            m_cancelWake.wait_for(lock, std::chrono::nanoseconds(settings.batchPauseNs), [this]() { return m_cancelled; });
+        }
+        if (m_cancelled)
+        {
+            break;
+        }
+    }
+    report.elapsedNs = latency_recorder::now_ns() - startNs;
+    report.complete = begin >= text.size() && !report.failed;
+    return report;
+}
+
+// --- find_batch_end(): Finds where a batch of at most charsPerBatch characters starting at begin ends.
+// Never splits a surrogate pair or a CRLF, either half on its own would type the wrong thing.
+// ----- text: The text being typed.
+// ----- begin: Where the batch starts.
+// ----- charsPerBatch: Most characters in the batch, 0 for no limit.
+// ------- returns: One past the last UTF-16 unit of the batch.
+// --------------------------------------------------------------------------------------------/
+/* private */ size_t text_injector::find_batch_end(const std::u16string& text, size_t begin, uint32_t charsPerBatch)
+{
+    if (charsPerBatch == 0)
+    {
+        return text.size();
+    }
+    size_t end = begin;
+    for (uint32_t i = 0; i < charsPerBatch && end < text.size(); i++)
+    {
+        bool twoUnits = end + 1 < text.size() &&
+                        (is_high_surrogate(text[end]) || (text[end] == u'\r' && text[end + 1] == u'\n'));
+        end += twoUnits ? 2 : 1;
+    }
+    return end;
+}
+
+// --- append_strokes(): Converts text[begin, end) to key strokes.
+// Line breaks (CRLF, LF or a lone CR) become a press of Enter and tabs a press of Tab, since many apps ignore
+// those as unicode characters. Everything else is a unicode down and up per UTF-16 unit, a surrogate pair being
+// two of those back to back as SendInput expects.
+// ----- text: The text being typed.
+// ----- begin: First UTF-16 unit to convert.
+// ----- end: One past the last UTF-16 unit to convert.
+// ----- strokesOut: Receives the strokes, appended to what is already there.
+// ------- returns: The number of characters converted.
+// --------------------------------------------------------------------------------------------/
+/* public */ uint64_t text_injector::append_strokes(const std::u16string& text, size_t begin, size_t end, std::vector<key_stroke>& strokesOut)
+{
+    uint64_t characters = 0;
+    for (size_t i = begin; i < end; i++)
+    {
+        char16_t unit = text[i];
+        if (unit == u'\r' || unit == u'\n' || unit == u'\t')
+        {
+            if (unit == u'\r' && i + 1 < end && text[i + 1] == u'\n')
+            {
+                i++;
+            }
+            key_chord chord = key_chord_builder::build_press(unit == u'\t' ? VK_TAB : VK_RETURN, 0, false, false, false, false);
+            strokesOut.insert(strokesOut.end(), chord.strokes, chord.strokes + chord.count);
+            characters++;
+            continue;
+        }
+        key_chord chord = key_chord_builder::build_unicode(unit);
+        strokesOut.insert(strokesOut.end(), chord.strokes, chord.strokes + chord.count);
+        if (!is_high_surrogate(unit))
+        {
+            characters++; // a pair is counted at its low half
+        }
+    }
+    return characters;
+}
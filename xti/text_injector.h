@@ -0,0 +1,99 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef TEXT_INJECTOR_H
+#define TEXT_INJECTOR_H
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+// 4. Project classes
+#include "input_sink.h"
+// 5. Forward decl
+
+// How a long text is split up for slow receivers. The defaults suit most apps, see text_injector::inject().
+struct text_injection_settings
+{
+    uint32_t charsPerBatch = 1000; // 0 sends the whole text as one batch
+    int64_t batchPauseNs = 10000000; // 10 ms
+};
+
+struct text_injection_report
+{
+    uint64_t characters; // code points typed, a line break (CRLF or LF) is one
+    uint64_t batches;
+    int64_t elapsedNs; // pauses between batches included
+    bool complete; // false if cancelled or the sink rejected a batch
+    bool failed; // the sink rejected a batch
+
+    // public get_chars_per_second(): Gets the achieved rate, 0 if nothing was typed.
+    double get_chars_per_second() const;
+};
+
+// Types arbitrary text as unicode key strokes (key_stroke::flagUnicode), a batch of characters per send_keys()
+// call. type() runs on a thread of its own so a megabyte of clipboard never blocks the caller, one text at a time.
+class text_injector
+{
+public:
+    using done_callback = std::function<void(const text_injection_report&)>;
+
+    // sink is not owned and is only ever called from the typing thread, it must not be shared with another thread.
+    explicit text_injector(input_sink* sink);
+    ~text_injector();
+    text_injector(const text_injector&) = delete;
+    text_injector& operator=(const text_injector&) = delete;
+
+    // public type(): Starts typing text in the background, cancelling whatever was still being typed.
+    // see cpp file for more info.
+    void type(std::u16string text, const text_injection_settings& settings, done_callback done);
+
+    // public cancel(): Stops typing after the batch in flight, does nothing if idle.
+    void cancel();
+
+    // public is_typing(): Determines if a text is being typed right now.
+    bool is_typing() const { return m_typing.load(std::memory_order_acquire); }
+
+    // public inject(): Types text on the calling thread, stopping early if cancel() is called meanwhile.
+    // see cpp file for more info.
+    text_injection_report inject(const std::u16string& text, const text_injection_settings& settings);
+
+    // public append_strokes(): Converts text[begin, end) to key strokes.
+    // see cpp file for more info.
+    static uint64_t append_strokes(const std::u16string& text, size_t begin, size_t end, std::vector<key_stroke>& strokesOut);
+
+private:
+    // private find_batch_end(): Finds where a batch of at most charsPerBatch characters starting at begin ends.
+    // see cpp file for more info.
+    static size_t find_batch_end(const std::u16string& text, size_t begin, uint32_t charsPerBatch);
+    void join();
+
+    input_sink* m_sink;
+    std::vector<key_stroke> m_strokes; // reused between batches, typing thread only
+    std::thread m_thread;
+    std::atomic<bool> m_typing;
+    std::mutex m_cancelMutex;
+    std::condition_variable m_cancelWake;
+    bool m_cancelled = false; // guarded by m_cancelMutex
+};
+
+#endif // TEXT_INJECTOR_H
@@ -0,0 +1,181 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "touch_replay.h"
+
+// 1. Qt framework headers
+#include <QApplication>
+#include <QDebug>
+#include <QEvent>
+#include <QEventPoint>
+#include <QFile>
+#include <QIODevice>
+#include <QList>
+#include <QPointF>
+#include <QPointingDevice>
+#include <QTimer>
+#include <QTouchEvent>
+// 2. System/OS headers
+#include <Windows.h>
+// 3. C++ standard library headers
+#include <utility>
+// 4. Project classes
+#include "error_reporter.h"
+#include "latency_recorder.h"
+#include "main_window.h"
+#include "recording_input_sink.h"
+
+// --- run(): Replays a trace file through a headless main_window.
+// QT_QPA_PLATFORM must already be set to offscreen, main.cpp does that before creating the QApplication.
+// ----- tracePath: File written by --record.
+// ----- fast: True to send every frame as soon as the previous one was handled, false to keep the recorded timing.
+//             Fast mode is for key throughput, the touchpad needs real time because of its 150 ms hook delay.
+// ------- returns: 0 if every frame produced the recorded key strokes, 1 otherwise.
+// --------------------------------------------------------------------------------------------/
+/* public */ int32_t touch_replay::run(const QString& tracePath, bool fast)
+{
+    QFile traceFile(tracePath);
+    if (!traceFile.open(QIODevice::ReadOnly))
+    {
+        error_reporter::stop(__FILE__, __LINE__, "Cannot open the --replay trace file.");
+    }
+    QByteArray data = traceFile.readAll();
+    traceFile.close();
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data.constData());
+    std::vector<uint8_t> trace(bytes, bytes + data.size());
+
+    // The window owns the sink.
+    recording_input_sink* sink = new recording_input_sink();
+    main_window window(nullptr, sink, true, nullptr);
+    window.show();
+    touch_replay* replay = new touch_replay(&window, sink, std::move(trace), fast);
+    // Started from the event loop, an empty trace would otherwise exit() before exec() and hang.
+    QTimer::singleShot(0, replay, [replay]() { replay->schedule_next(); });
+    int32_t r = QApplication::exec();
+    delete replay;
+    return r;
+}
+
+touch_replay::touch_replay(main_window* window, recording_input_sink* sink, std::vector<uint8_t> trace, bool fast)
+    : m_window(window)
+    , m_sink(sink)
+    , m_trace(std::move(trace))
+    , m_reader(m_trace.data(), m_trace.size())
+    , m_fast(fast)
+{
+    m_device = new QPointingDevice("xti replay", 1, QInputDevice::DeviceType::TouchScreen, QPointingDevice::PointerType::Finger,
+        QInputDevice::Capability::Position, 10, 0, QString(), QPointingDeviceUniqueId(), this);
+    // Timestamps are moved to now, so main_window's queue stage sees the recorded spacing rather than the recording's age.
+    m_baseTimestampMs = ::GetTickCount();
+    m_clock.start();
+}
+
+touch_replay::~touch_replay()
+{
+}
+
+/* private */ void touch_replay::schedule_next()
+{
+    m_hasFrame = m_reader.next(m_frame);
+    if (!m_hasFrame)
+    {
+        finish();
+        return;
+    }
+    if (m_frames == 0)
+    {
+        m_firstTimestampMs = m_frame.timestampMs;
+    }
+    int64_t delayMs = 0;
+    if (!m_fast)
+    {
+        delayMs = static_cast<int64_t>(m_frame.timestampMs - m_firstTimestampMs) - m_clock.elapsed();
+    }
+    // Always via the event loop, so timers and queued calls main_window relies on get to run in between.
+    QTimer::singleShot(delayMs > 0 ? static_cast<int32_t>(delayMs) : 0, Qt::PreciseTimer, this, &touch_replay::ui_on_next_frame);
+}
+
+/* private */ void touch_replay::ui_on_next_frame()
+{
+    send_frame();
+    schedule_next();
+}
+
+/* private */ void touch_replay::send_frame()
+{
+    QList<QEventPoint> points;
+    points.reserve(static_cast<qsizetype>(m_frame.points.size()));
+    for (const touch_trace_point& point : m_frame.points)
+    {
+        QPointF position(static_cast<double>(point.x) / touch_trace_point::subPixels, static_cast<double>(point.y) / touch_trace_point::subPixels);
+        points.append(QEventPoint(point.id, static_cast<QEventPoint::State>(point.state), position, m_window->mapToGlobal(position)));
+    }
+    QEvent::Type type = QEvent::TouchUpdate;
+    if (m_frame.type == touch_trace_frame::typeBegin)
+    {
+        type = QEvent::TouchBegin;
+        m_touches++;
+    }
+    else if (m_frame.type == touch_trace_frame::typeEnd)
+    {
+        type = QEvent::TouchEnd;
+    }
+    QTouchEvent event(type, m_device, Qt::NoModifier, points);
+    event.setTimestamp(m_frame.timestampMs - m_firstTimestampMs + m_baseTimestampMs);
+
+    int64_t startNs = latency_recorder::now_ns();
+    QApplication::sendEvent(m_window, &event);
+    m_handlerTime.record(latency_recorder::now_ns() - startNs);
+    m_frames++;
+
+    // Key presses are injected synchronously from event(), so everything this frame caused is in the sink now.
+    m_sink->take_keys(m_keys);
+    bool same = m_keys.size() == m_frame.keys.size();
+    for (size_t i = 0; same && i < m_keys.size(); i++)
+    {
+        same = m_keys[i].virtualKeyCode == m_frame.keys[i].virtualKeyCode && m_keys[i].flags == m_frame.keys[i].flags;
+    }
+    if (!same)
+    {
+        if (m_keys.empty())
+        {
+            m_dropped++;
+        }
+        else
+        {
+            m_misrouted++;
+        }
+    }
+}
+
+/* private */ void touch_replay::finish()
+{
+    double seconds = static_cast<double>(m_clock.nsecsElapsed()) / 1e9;
+    uint64_t keys = m_sink->get_key_batches();
+    qDebug() << "replay:" << (m_fast ? "fast" : "real time") << m_frames << "frames," << m_touches << "touches in" << seconds << "s";
+    qDebug() << "replay:" << keys << "keys," << static_cast<double>(keys) / seconds << "keys/s,"
+             << m_sink->get_mouse_strokes() << "mouse events";
+    qDebug() << "replay:" << m_dropped << "dropped," << m_misrouted << "misrouted frames";
+    qDebug() << "replay: event() us p50" << static_cast<double>(m_handlerTime.get_percentile(50.0)) / 1000.0
+             << "p99" << static_cast<double>(m_handlerTime.get_percentile(99.0)) / 1000.0
+             << "p99.9" << static_cast<double>(m_handlerTime.get_percentile(99.9)) / 1000.0
+             << "max" << static_cast<double>(m_handlerTime.get_max()) / 1000.0;
+    if (m_reader.has_error())
+    {
+        qDebug() << "replay: trace is truncated or corrupt, stopped after" << m_frames << "frames";
+    }
+    bool passed = m_dropped == 0 && m_misrouted == 0 && !m_reader.has_error();
+    QApplication::exit(passed ? 0 : 1);
+}
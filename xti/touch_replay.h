@@ -0,0 +1,76 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef TOUCH_REPLAY_H
+#define TOUCH_REPLAY_H
+
+// 1. Qt framework headers
+#include <QObject>
+#include <QElapsedTimer>
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <cstdint>
+#include <vector>
+// 4. Project classes
+#include "touch_trace.h"
+#include "latency_histogram.h"
+// 5. Forward decl
+class QPointingDevice;
+class main_window;
+class recording_input_sink;
+
+// Feeds a recorded touch trace through a headless main_window on the offscreen platform and reports
+// sustained keys/sec, dropped or misrouted touches and the time main_window::event() took per frame.
+// A frame counts as dropped if it produced no key strokes where the recording did, and as misrouted
+// if it produced different ones.
+class touch_replay : public QObject
+{
+    Q_OBJECT
+
+public:
+    // public run(): Replays the trace file and returns the process exit code, 0 if every frame matched.
+    // see cpp file for more info.
+    static int32_t run(const QString& tracePath, bool fast);
+
+private:
+    touch_replay(main_window* window, recording_input_sink* sink, std::vector<uint8_t> trace, bool fast);
+    virtual ~touch_replay();
+
+    main_window* m_window;
+    recording_input_sink* m_sink;
+    std::vector<uint8_t> m_trace;
+    touch_trace_reader m_reader;
+    bool m_fast;
+    QPointingDevice* m_device;
+    QElapsedTimer m_clock;
+    uint64_t m_firstTimestampMs = 0;
+    uint64_t m_baseTimestampMs = 0;
+    touch_trace_frame m_frame;
+    bool m_hasFrame = false;
+    std::vector<key_stroke> m_keys;
+    latency_histogram m_handlerTime;
+    uint64_t m_frames = 0;
+    uint64_t m_touches = 0;
+    uint64_t m_dropped = 0;
+    uint64_t m_misrouted = 0;
+
+    void schedule_next();
+    void send_frame();
+    void finish();
+private slots:
+    void ui_on_next_frame();
+};
+
+#endif // TOUCH_REPLAY_H
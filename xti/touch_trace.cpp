@@ -0,0 +1,243 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "touch_trace.h"
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+// 4. Project classes
+
+static constexpr uint8_t traceMagic[] = { 'X', 'T', 'T', 1 }; // the last byte is the format version
+
+static void write_varint(std::vector<uint8_t>& bytes, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        bytes.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    bytes.push_back(static_cast<uint8_t>(value));
+}
+
+static uint64_t to_zigzag(int64_t value)
+{
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+static int64_t from_zigzag(uint64_t value)
+{
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+// Finds the last position of a touch id, adding it at (0, 0) the first time it is seen.
+static touch_trace_point& find_last_position(std::vector<touch_trace_point>& positions, int32_t id)
+{
+    for (touch_trace_point& point : positions)
+    {
+        if (point.id == id)
+        {
+            return point;
+        }
+    }
+    positions.push_back({ id, 0, 0, 0 });
+    return positions.back();
+}
+
+touch_trace_writer::touch_trace_writer()
+    : m_pending()
+    , m_hasPending(false)
+    , m_lastTimestampMs(0)
+    , m_frameCount(0)
+{
+    m_bytes.assign(traceMagic, traceMagic + sizeof(traceMagic));
+}
+
+/* public */ void touch_trace_writer::add_frame(const touch_trace_frame& frame)
+{
+    if (m_hasPending)
+    {
+        encode_pending();
+    }
+    m_pending = frame;
+    m_hasPending = true;
+    m_frameCount++;
+}
+
+/* public */ void touch_trace_writer::add_keys(const key_stroke* strokes, uint32_t count)
+{
+    if (m_hasPending)
+    {
+        m_pending.keys.insert(m_pending.keys.end(), strokes, strokes + count);
+    }
+}
+
+// --- finish(): Encodes the last frame and returns the whole trace.
+// More frames may still be added afterwards, the next finish() then returns those as well.
+// ------- returns: The encoded trace, ready to be written to a file as is.
+// --------------------------------------------------------------------------------------------/
+/* public */ const std::vector<uint8_t>& touch_trace_writer::finish()
+{
+    if (m_hasPending)
+    {
+        encode_pending();
+        m_hasPending = false;
+    }
+    return m_bytes;
+}
+
+/* public */ uint64_t touch_trace_writer::get_frame_count() const
+{
+    return m_frameCount;
+}
+
+/* private */ void touch_trace_writer::encode_pending()
+{
+    m_bytes.push_back(m_pending.type);
+    // Qt timestamps only go forward, but a bad one must not break the encoding.
+    write_varint(m_bytes, to_zigzag(static_cast<int64_t>(m_pending.timestampMs - m_lastTimestampMs)));
+    m_lastTimestampMs = m_pending.timestampMs;
+    write_varint(m_bytes, m_pending.points.size());
+    for (const touch_trace_point& point : m_pending.points)
+    {
+        touch_trace_point& last = find_last_position(m_lastPositions, point.id);
+        write_varint(m_bytes, to_zigzag(point.id));
+        m_bytes.push_back(point.state);
+        write_varint(m_bytes, to_zigzag(static_cast<int64_t>(point.x) - last.x));
+        write_varint(m_bytes, to_zigzag(static_cast<int64_t>(point.y) - last.y));
+        last.x = point.x;
+        last.y = point.y;
+    }
+    write_varint(m_bytes, m_pending.keys.size());
+    for (const key_stroke& stroke : m_pending.keys)
+    {
+        write_varint(m_bytes, stroke.virtualKeyCode);
+        write_varint(m_bytes, stroke.flags);
+    }
+    m_pending.points.clear();
+    m_pending.keys.clear();
+}
+
+touch_trace_reader::touch_trace_reader(const uint8_t* data, size_t size)
+    : m_data(data)
+    , m_size(size)
+    , m_offset(sizeof(traceMagic))
+    , m_error(false)
+    , m_lastTimestampMs(0)
+{
+    if (size < sizeof(traceMagic))
+    {
+        m_error = true;
+        return;
+    }
+    for (size_t i = 0; i < sizeof(traceMagic); i++)
+    {
+        if (data[i] != traceMagic[i])
+        {
+            m_error = true;
+        }
+    }
+}
+
+// --- next(): Decodes the next frame.
+// ----- frame: Receives the frame, its vectors are reused.
+// ------- returns: false at the end of the trace or on an error, see has_error().
+// --------------------------------------------------------------------------------------------/
+/* public */ bool touch_trace_reader::next(touch_trace_frame& frame)
+{
+    if (m_error || m_offset == m_size)
+    {
+        return false;
+    }
+    frame.points.clear();
+    frame.keys.clear();
+    uint64_t delta = 0;
+    uint64_t count = 0;
+    if (!read_byte(frame.type) || !read_varint(delta) || !read_varint(count))
+    {
+        return false;
+    }
+    m_lastTimestampMs += static_cast<uint64_t>(from_zigzag(delta));
+    frame.timestampMs = m_lastTimestampMs;
+    for (uint64_t i = 0; i < count; i++)
+    {
+        uint64_t id = 0;
+        uint64_t dx = 0;
+        uint64_t dy = 0;
+        touch_trace_point point = {};
+        if (!read_varint(id) || !read_byte(point.state) || !read_varint(dx) || !read_varint(dy))
+        {
+            return false;
+        }
+        point.id = static_cast<int32_t>(from_zigzag(id));
+        touch_trace_point& last = find_last_position(m_lastPositions, point.id);
+        point.x = static_cast<int32_t>(last.x + from_zigzag(dx));
+        point.y = static_cast<int32_t>(last.y + from_zigzag(dy));
+        last.x = point.x;
+        last.y = point.y;
+        frame.points.push_back(point);
+    }
+    if (!read_varint(count))
+    {
+        return false;
+    }
+    for (uint64_t i = 0; i < count; i++)
+    {
+        uint64_t virtualKeyCode = 0;
+        uint64_t flags = 0;
+        if (!read_varint(virtualKeyCode) || !read_varint(flags))
+        {
+            return false;
+        }
+        frame.keys.push_back({ static_cast<uint16_t>(virtualKeyCode), static_cast<uint16_t>(flags), 0 }); // scan codes are not traced
+    }
+    return true;
+}
+
+/* public */ bool touch_trace_reader::has_error() const
+{
+    return m_error;
+}
+
+/* private */ bool touch_trace_reader::read_varint(uint64_t& value)
+{
+    value = 0;
+    for (uint32_t shift = 0; shift < 64; shift += 7)
+    {
+        uint8_t byte = 0;
+        if (!read_byte(byte))
+        {
+            return false;
+        }
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            return true;
+        }
+    }
+    m_error = true;
+    return false;
+}
+
+/* private */ bool touch_trace_reader::read_byte(uint8_t& value)
+{
+    if (m_offset >= m_size)
+    {
+        m_error = true;
+        return false;
+    }
+    value = m_data[m_offset++];
+    return true;
+}
@@ -0,0 +1,111 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef TOUCH_TRACE_H
+#define TOUCH_TRACE_H
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+// 4. Project classes
+#include "key_chord.h"
+// 5. Forward decl
+
+// One touch point as main_window::event() saw it, positions are window relative.
+struct touch_trace_point
+{
+    static constexpr int32_t subPixels = 16; // x and y are in 1/16 px
+
+    int32_t id;
+    uint8_t state; // QEventPoint::State
+    int32_t x;
+    int32_t y;
+};
+
+// One touch event plus the key strokes xti injected while handling it, which replay checks itself against.
+struct touch_trace_frame
+{
+    static constexpr uint8_t typeBegin = 0;
+    static constexpr uint8_t typeUpdate = 1;
+    static constexpr uint8_t typeEnd = 2;
+
+    uint8_t type;
+    uint64_t timestampMs; // QInputEvent::timestamp()
+    std::vector<touch_trace_point> points;
+    std::vector<key_stroke> keys;
+};
+
+// Encodes frames into the compact trace format: a 4 byte header, then per frame the type, the timestamp
+// delta, and every point as its id, state and position delta from the last position of the same id,
+// all as (zigzag) varints. A finger moving a few pixels per event costs 5-6 bytes per point.
+class touch_trace_writer
+{
+public:
+    touch_trace_writer();
+
+    // public add_frame(): Starts a new frame, the previous one is encoded.
+    void add_frame(const touch_trace_frame& frame);
+
+    // public add_keys(): Attaches injected strokes to the frame being handled, ignored before the first frame.
+    void add_keys(const key_stroke* strokes, uint32_t count);
+
+    // public finish(): Encodes the last frame and returns the whole trace.
+    // see cpp file for more info.
+    const std::vector<uint8_t>& finish();
+
+    // public get_frame_count(): Number of frames added so far.
+    uint64_t get_frame_count() const;
+
+private:
+    std::vector<uint8_t> m_bytes;
+    touch_trace_frame m_pending;
+    bool m_hasPending;
+    uint64_t m_lastTimestampMs;
+    uint64_t m_frameCount;
+    std::vector<touch_trace_point> m_lastPositions; // one entry per touch id seen so far
+
+    void encode_pending();
+};
+
+// Decodes a trace written by touch_trace_writer, one frame at a time.
+class touch_trace_reader
+{
+public:
+    // The data must outlive the reader.
+    touch_trace_reader(const uint8_t* data, size_t size);
+
+    // public next(): Decodes the next frame.
+    // see cpp file for more info.
+    bool next(touch_trace_frame& frame);
+
+    // public has_error(): True if next() stopped on a bad header or truncated frame rather than the end of the trace.
+    bool has_error() const;
+
+private:
+    const uint8_t* m_data;
+    size_t m_size;
+    size_t m_offset;
+    bool m_error;
+    uint64_t m_lastTimestampMs;
+    std::vector<touch_trace_point> m_lastPositions;
+
+    bool read_varint(uint64_t& value);
+    bool read_byte(uint8_t& value);
+};
+
+#endif // TOUCH_TRACE_H
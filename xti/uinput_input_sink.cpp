@@ -0,0 +1,409 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "uinput_input_sink.h"
+
+// 1. Qt framework headers
+// 2. System/OS headers
+#include <dirent.h>
+#include <fcntl.h>
+#include <linux/uinput.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+// 3. C++ standard library headers
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+// 4. Project classes
+
+static constexpr const char* uinputPath = "/dev/uinput";
+// One notch of the high-resolution wheel, the same unit as WHEEL_DELTA on Windows.
+static constexpr int32_t wheelNotch = 120;
+
+static void append_event(std::vector<::input_event>& events, size_t& count, uint16_t type, uint16_t code, int32_t value)
+{
+    if (events.size() <= count)
+    {
+        events.resize(events.size() * 2 + 8);
+    }
+    ::input_event& event = events[count++];
+    event = {};
+    // The kernel stamps the time itself, whatever is written here is ignored.
+    event.type = type;
+    event.code = code;
+    event.value = value;
+}
+
+static void throw_errno(const char* message)
+{
+    throw std::system_error(errno, std::generic_category(), message);
+}
+
+// --- uinput_input_sink(): Creates the virtual keyboard and pointer.
+// The caller needs write access to /dev/uinput (root, or the uinput/input group on most distributions).
+// The evdev nodes exist as soon as this returns, but udev may still be applying permissions to them.
+// --------------------------------------------------------------------------------------------/
+/* public */ uinput_input_sink::uinput_input_sink()
+    : m_keyboardFd(-1)
+    , m_pointerFd(-1)
+    , m_wheelRemainder(0)
+{
+    m_keyboardFd = create_device("xti virtual keyboard", false);
+    try
+    {
+        m_pointerFd = create_device("xti virtual pointer", true);
+    }
+    catch (...)
+    {
+        ::ioctl(m_keyboardFd, UI_DEV_DESTROY);
+        ::close(m_keyboardFd);
+        throw;
+    }
+}
+
+// --- ~uinput_input_sink(): Destroys both virtual devices.
+// The kernel releases any key or button still held down when a device goes away, so nothing is left stuck.
+// --------------------------------------------------------------------------------------------/
+/* public */ uinput_input_sink::~uinput_input_sink()
+{
+    for (int32_t fd : { m_keyboardFd, m_pointerFd })
+    {
+        ::ioctl(fd, UI_DEV_DESTROY);
+        ::close(fd);
+    }
+}
+
+// --- send_keys(): Injects the strokes in order with a single write().
+// Each stroke is its own SYN_REPORT frame, like a physical keyboard reports it, so consumers never see a
+// key pressed and released within one frame.
+// ----- strokes: The key strokes to inject.
+// ----- count: Number of entries in strokes.
+// ------- returns: count if the kernel accepted the batch, otherwise 0. Keys with no evdev code fail the batch, as do
+// unicode strokes since evdev has no way to type a character rather than a key.
+// --------------------------------------------------------------------------------------------/
+/* public */ uint32_t uinput_input_sink::send_keys(const key_stroke* strokes, uint32_t count)
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+    size_t eventCount = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint16_t code = (strokes[i].flags & key_stroke::flagUnicode) != 0 ? KEY_RESERVED : to_evdev_code(strokes[i].virtualKeyCode);
+        if (code == KEY_RESERVED)
+        {
+            return 0;
+        }
+        int32_t value = (strokes[i].flags & key_stroke::flagKeyUp) != 0 ? 0 : 1;
+        append_event(m_keyEvents, eventCount, EV_KEY, code, value);
+        append_event(m_keyEvents, eventCount, EV_SYN, SYN_REPORT, 0);
+    }
+    return write_events(m_keyboardFd, m_keyEvents, eventCount) ? count : 0;
+}
+
+// --- send_mouse(): Injects the mouse events in order with a single write().
+// Wheel turns go out on both REL_WHEEL_HI_RES and, once whole notches add up, the legacy REL_WHEEL
+// as the kernel documentation asks of high-resolution devices.
+// ----- strokes: The mouse events to inject.
+// ----- count: Number of entries in strokes.
+// ------- returns: count if the kernel accepted the batch, otherwise 0.
+// --------------------------------------------------------------------------------------------/
+/* public */ uint32_t uinput_input_sink::send_mouse(const mouse_stroke* strokes, uint32_t count)
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+    size_t eventCount = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const mouse_stroke& stroke = strokes[i];
+        size_t frameStart = eventCount;
+        if ((stroke.flags & mouse_stroke::flagMove) != 0)
+        {
+            // The input core drops zero relative values, there is no point sending them.
+            if (stroke.dx != 0)
+            {
+                append_event(m_mouseEvents, eventCount, EV_REL, REL_X, stroke.dx);
+            }
+            if (stroke.dy != 0)
+            {
+                append_event(m_mouseEvents, eventCount, EV_REL, REL_Y, stroke.dy);
+            }
+        }
+        if ((stroke.flags & mouse_stroke::flagWheel) != 0 && stroke.wheel != 0)
+        {
+            append_event(m_mouseEvents, eventCount, EV_REL, REL_WHEEL_HI_RES, stroke.wheel);
+            m_wheelRemainder += stroke.wheel;
+            int32_t notches = m_wheelRemainder / wheelNotch;
+            if (notches != 0)
+            {
+                m_wheelRemainder -= notches * wheelNotch;
+                append_event(m_mouseEvents, eventCount, EV_REL, REL_WHEEL, notches);
+            }
+        }
+        if ((stroke.flags & mouse_stroke::flagLeftDown) != 0)
+        {
+            append_event(m_mouseEvents, eventCount, EV_KEY, BTN_LEFT, 1);
+        }
+        if ((stroke.flags & mouse_stroke::flagLeftUp) != 0)
+        {
+            append_event(m_mouseEvents, eventCount, EV_KEY, BTN_LEFT, 0);
+        }
+        if ((stroke.flags & mouse_stroke::flagRightDown) != 0)
+        {
+            append_event(m_mouseEvents, eventCount, EV_KEY, BTN_RIGHT, 1);
+        }
+        if ((stroke.flags & mouse_stroke::flagRightUp) != 0)
+        {
+            append_event(m_mouseEvents, eventCount, EV_KEY, BTN_RIGHT, 0);
+        }
+        if (eventCount != frameStart)
+        {
+            append_event(m_mouseEvents, eventCount, EV_SYN, SYN_REPORT, 0);
+        }
+    }
+    if (eventCount == 0)
+    {
+        return count;
+    }
+    return write_events(m_pointerFd, m_mouseEvents, eventCount) ? count : 0;
+}
+
+// --- get_keyboard_node(): Finds the evdev node the kernel created for the virtual keyboard.
+// ------- returns: The /dev/input/eventN path, or an empty string if the kernel does not support UI_GET_SYSNAME.
+// --------------------------------------------------------------------------------------------/
+/* public */ std::string uinput_input_sink::get_keyboard_node() const
+{
+    return get_event_node(m_keyboardFd);
+}
+
+/* public */ std::string uinput_input_sink::get_pointer_node() const
+{
+    return get_event_node(m_pointerFd);
+}
+
+// --- to_evdev_code(): Maps a virtual key code to the evdev code of the key at the same position on a US keyboard.
+// Layout translation is left to the compositor, exactly like a physical keyboard.
+// ----- virtualKeyCode: Any key xti can send, see key_mapping.
+// ------- returns: The KEY_* code, or KEY_RESERVED (0) if the key has no evdev equivalent.
+// --------------------------------------------------------------------------------------------/
+/* public */ uint16_t uinput_input_sink::to_evdev_code(uint16_t virtualKeyCode)
+{
+    switch (virtualKeyCode)
+    {
+    case VK_BACK: return KEY_BACKSPACE;
+    case VK_TAB: return KEY_TAB;
+    case VK_RETURN: return KEY_ENTER;
+    case VK_SHIFT: return KEY_LEFTSHIFT;
+    case VK_CONTROL: return KEY_LEFTCTRL;
+    case VK_MENU: return KEY_LEFTALT;
+    case VK_PAUSE: return KEY_PAUSE;
+    case VK_CAPITAL: return KEY_CAPSLOCK;
+    case VK_ESCAPE: return KEY_ESC;
+    case VK_SPACE: return KEY_SPACE;
+    case VK_PRIOR: return KEY_PAGEUP;
+    case VK_NEXT: return KEY_PAGEDOWN;
+    case VK_END: return KEY_END;
+    case VK_HOME: return KEY_HOME;
+    case VK_LEFT: return KEY_LEFT;
+    case VK_UP: return KEY_UP;
+    case VK_RIGHT: return KEY_RIGHT;
+    case VK_DOWN: return KEY_DOWN;
+    case VK_SNAPSHOT: return KEY_SYSRQ;
+    case VK_INSERT: return KEY_INSERT;
+    case VK_DELETE: return KEY_DELETE;
+    case '0': return KEY_0;
+    case '1': return KEY_1;
+    case '2': return KEY_2;
+    case '3': return KEY_3;
+    case '4': return KEY_4;
+    case '5': return KEY_5;
+    case '6': return KEY_6;
+    case '7': return KEY_7;
+    case '8': return KEY_8;
+    case '9': return KEY_9;
+    case 'A': return KEY_A;
+    case 'B': return KEY_B;
+    case 'C': return KEY_C;
+    case 'D': return KEY_D;
+    case 'E': return KEY_E;
+    case 'F': return KEY_F;
+    case 'G': return KEY_G;
+    case 'H': return KEY_H;
+    case 'I': return KEY_I;
+    case 'J': return KEY_J;
+    case 'K': return KEY_K;
+    case 'L': return KEY_L;
+    case 'M': return KEY_M;
+    case 'N': return KEY_N;
+    case 'O': return KEY_O;
+    case 'P': return KEY_P;
+    case 'Q': return KEY_Q;
+    case 'R': return KEY_R;
+    case 'S': return KEY_S;
+    case 'T': return KEY_T;
+    case 'U': return KEY_U;
+    case 'V': return KEY_V;
+    case 'W': return KEY_W;
+    case 'X': return KEY_X;
+    case 'Y': return KEY_Y;
+    case 'Z': return KEY_Z;
+    case VK_LWIN: return KEY_LEFTMETA;
+    case VK_RWIN: return KEY_RIGHTMETA;
+    case VK_APPS: return KEY_COMPOSE;
+    case VK_F1: return KEY_F1;
+    case VK_F2: return KEY_F2;
+    case VK_F3: return KEY_F3;
+    case VK_F4: return KEY_F4;
+    case VK_F5: return KEY_F5;
+    case VK_F6: return KEY_F6;
+    case VK_F7: return KEY_F7;
+    case VK_F8: return KEY_F8;
+    case VK_F9: return KEY_F9;
+    case VK_F10: return KEY_F10;
+    case VK_F11: return KEY_F11;
+    case VK_F12: return KEY_F12;
+    case VK_NUMLOCK: return KEY_NUMLOCK;
+    case VK_SCROLL: return KEY_SCROLLLOCK;
+    case VK_LSHIFT: return KEY_LEFTSHIFT;
+    case VK_RSHIFT: return KEY_RIGHTSHIFT;
+    case VK_LCONTROL: return KEY_LEFTCTRL;
+    case VK_RCONTROL: return KEY_RIGHTCTRL;
+    case VK_LMENU: return KEY_LEFTALT;
+    case VK_RMENU: return KEY_RIGHTALT;
+    case VK_VOLUME_MUTE: return KEY_MUTE;
+    case VK_VOLUME_DOWN: return KEY_VOLUMEDOWN;
+    case VK_VOLUME_UP: return KEY_VOLUMEUP;
+    case VK_MEDIA_NEXT_TRACK: return KEY_NEXTSONG;
+    case VK_MEDIA_PREV_TRACK: return KEY_PREVIOUSSONG;
+    case VK_MEDIA_PLAY_PAUSE: return KEY_PLAYPAUSE;
+    case VK_OEM_1: return KEY_SEMICOLON;
+    case VK_OEM_PLUS: return KEY_EQUAL;
+    case VK_OEM_COMMA: return KEY_COMMA;
+    case VK_OEM_MINUS: return KEY_MINUS;
+    case VK_OEM_PERIOD: return KEY_DOT;
+    case VK_OEM_2: return KEY_SLASH;
+    case VK_OEM_3: return KEY_GRAVE;
+    case VK_OEM_4: return KEY_LEFTBRACE;
+    case VK_OEM_5: return KEY_BACKSLASH;
+    case VK_OEM_6: return KEY_RIGHTBRACE;
+    case VK_OEM_7: return KEY_APOSTROPHE;
+    default: return KEY_RESERVED;
+    }
+}
+
+// --- create_device(): Opens /dev/uinput and registers one virtual device on it.
+// ----- name: Device name shown by libinput and /proc/bus/input/devices.
+// ----- pointer: True for the relative pointer, false for the keyboard.
+// ------- returns: The uinput file descriptor, which owns the device until it is closed.
+// --------------------------------------------------------------------------------------------/
+/* private */ int32_t uinput_input_sink::create_device(const char* name, bool pointer)
+{
+    int32_t fd = ::open(uinputPath, O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0)
+    {
+        throw_errno("uinput: open(/dev/uinput) failure.");
+    }
+    bool ok = true;
+    if (pointer)
+    {
+        ok = ok && ::ioctl(fd, UI_SET_EVBIT, EV_KEY) == 0;
+        ok = ok && ::ioctl(fd, UI_SET_KEYBIT, BTN_LEFT) == 0;
+        ok = ok && ::ioctl(fd, UI_SET_KEYBIT, BTN_RIGHT) == 0;
+        ok = ok && ::ioctl(fd, UI_SET_EVBIT, EV_REL) == 0;
+        for (int32_t axis : { REL_X, REL_Y, REL_WHEEL, REL_WHEEL_HI_RES })
+        {
+            ok = ok && ::ioctl(fd, UI_SET_RELBIT, axis) == 0;
+        }
+    }
+    else
+    {
+        // No EV_REP: auto repeat is driven by xti itself, the kernel must not add its own.
+        ok = ok && ::ioctl(fd, UI_SET_EVBIT, EV_KEY) == 0;
+        for (uint16_t vk = 1; vk <= 0xFF && ok; vk++)
+        {
+            uint16_t code = to_evdev_code(vk);
+            if (code != KEY_RESERVED)
+            {
+                ok = ::ioctl(fd, UI_SET_KEYBIT, code) == 0;
+            }
+        }
+    }
+    ::uinput_setup setup = {};
+    setup.id.bustype = BUS_VIRTUAL;
+    setup.id.vendor = 0x5854; // "XT"
+    setup.id.product = pointer ? 2 : 1;
+    std::strncpy(setup.name, name, UINPUT_MAX_NAME_SIZE - 1);
+    ok = ok && ::ioctl(fd, UI_DEV_SETUP, &setup) == 0;
+    ok = ok && ::ioctl(fd, UI_DEV_CREATE) == 0;
+    if (!ok)
+    {
+        int32_t error = errno;
+        ::close(fd);
+        errno = error;
+        throw_errno("uinput: ioctl(UI_DEV_CREATE) failure.");
+    }
+    return fd;
+}
+
+// --- get_event_node(): Resolves the evdev node of a created device through sysfs.
+// ----- fd: A uinput file descriptor returned by create_device().
+// ------- returns: The /dev/input/eventN path, or an empty string if it cannot be found.
+// --------------------------------------------------------------------------------------------/
+/* private */ std::string uinput_input_sink::get_event_node(int32_t fd)
+{
+    char sysName[64] = {};
+    if (::ioctl(fd, UI_GET_SYSNAME(sizeof(sysName)), sysName) < 0)
+    {
+        return {};
+    }
+    std::string sysDir = std::string("/sys/devices/virtual/input/") + sysName;
+    ::DIR* dir = ::opendir(sysDir.c_str());
+    if (dir == nullptr)
+    {
+        return {};
+    }
+    std::string node;
+    while (::dirent* entry = ::readdir(dir))
+    {
+        if (std::strncmp(entry->d_name, "event", 5) == 0)
+        {
+            node = std::string("/dev/input/") + entry->d_name;
+            break;
+        }
+    }
+    ::closedir(dir);
+    return node;
+}
+
+// --- write_events(): Hands a prepared batch to the kernel.
+// uinput consumes whole input_event records, so the only partial outcome is an error part way through.
+// ----- fd: The device to write to.
+// ----- events: The batch buffer.
+// ----- count: Number of valid events at the start of the buffer.
+// ------- returns: True if every event was accepted.
+// --------------------------------------------------------------------------------------------/
+/* private */ bool uinput_input_sink::write_events(int32_t fd, const std::vector<::input_event>& events, size_t count)
+{
+    size_t bytes = count * sizeof(::input_event);
+    ssize_t written;
+    do
+    {
+        written = ::write(fd, events.data(), bytes);
+    } while (written < 0 && errno == EINTR);
+    return written == static_cast<ssize_t>(bytes);
+}
@@ -0,0 +1,73 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef UINPUT_INPUT_SINK_H
+#define UINPUT_INPUT_SINK_H
+
+// 1. Qt framework headers
+// 2. System/OS headers
+#include <linux/input.h>
+// 3. C++ standard library headers
+#include <cstdint>
+#include <string>
+#include <vector>
+// 4. Project classes
+#include "input_sink.h"
+// 5. Forward decl
+
+// Injects input on Linux through two uinput virtual devices: a keyboard, and a relative pointer with a
+// high-resolution wheel. Every batch becomes one input_event array, each stroke terminated by its own
+// SYN_REPORT, handed to the kernel with a single write(). That is the uinput equivalent of one ::SendInput call.
+// send_keys() and send_mouse() may be called from two different threads at once, each uses its own device and buffer.
+class uinput_input_sink : public input_sink
+{
+public:
+    // public uinput_input_sink(): Creates both virtual devices, throws std::system_error if /dev/uinput is unusable.
+    // see cpp file for more info.
+    uinput_input_sink();
+    virtual ~uinput_input_sink() override;
+
+    uinput_input_sink(const uinput_input_sink&) = delete;
+    uinput_input_sink& operator=(const uinput_input_sink&) = delete;
+
+    virtual uint32_t send_keys(const key_stroke* strokes, uint32_t count) override;
+    virtual uint32_t send_mouse(const mouse_stroke* strokes, uint32_t count) override;
+
+    // public get_keyboard_node(): Path of the evdev node the kernel created for the virtual keyboard, e.g. /dev/input/event7.
+    // see cpp file for more info.
+    std::string get_keyboard_node() const;
+
+    // public get_pointer_node(): Same as get_keyboard_node() but for the virtual pointer.
+    std::string get_pointer_node() const;
+
+    // public to_evdev_code(): Maps a virtual key code to its evdev KEY_* code.
+    // see cpp file for more info.
+    static uint16_t to_evdev_code(uint16_t virtualKeyCode);
+
+private:
+    static int32_t create_device(const char* name, bool pointer);
+    static std::string get_event_node(int32_t fd);
+    static bool write_events(int32_t fd, const std::vector<::input_event>& events, size_t count);
+
+    int32_t m_keyboardFd;
+    int32_t m_pointerFd;
+    // The legacy REL_WHEEL axis only moves in whole notches, partial turns are carried over here.
+    int32_t m_wheelRemainder;
+    // Reused between calls so a key press does not allocate once the buffer has grown to fit a chord.
+    std::vector<::input_event> m_keyEvents;
+    std::vector<::input_event> m_mouseEvents;
+};
+
+#endif // UINPUT_INPUT_SINK_H
@@ -0,0 +1,290 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// Loopback benchmark for uinput_input_sink: injects through the virtual devices, reads the same events back
+// from their evdev nodes and reports throughput and latency. The nodes are grabbed so nothing reaches the
+// desktop session. Needs write access to /dev/uinput and read access to /dev/input/event*.
+// usage: xti_uinput_bench [iterations]
+
+// 1. Qt framework headers
+// 2. System/OS headers
+#include <fcntl.h>
+#include <linux/input.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+// 3. C++ standard library headers
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <string>
+#include <vector>
+// 4. Project classes
+#include "key_chord.h"
+#include "uinput_input_sink.h"
+
+static int64_t now_ns()
+{
+    ::timespec ts;
+    ::clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+static int64_t event_ns(const ::input_event& event)
+{
+    return static_cast<int64_t>(event.input_event_sec) * 1000000000 + static_cast<int64_t>(event.input_event_usec) * 1000;
+}
+
+// Opens and grabs an evdev node. udev may still be fixing permissions right after the device is created,
+// so failures are retried for up to two seconds.
+static int32_t open_node(const std::string& node)
+{
+    for (int32_t attempt = 0; attempt < 200; attempt++)
+    {
+        int32_t fd = ::open(node.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd >= 0)
+        {
+            int32_t clock = CLOCK_MONOTONIC;
+            if (::ioctl(fd, EVIOCSCLOCKID, &clock) != 0 || ::ioctl(fd, EVIOCGRAB, 1) != 0)
+            {
+                ::close(fd);
+                return -1;
+            }
+            return fd;
+        }
+        ::usleep(10000);
+    }
+    return -1;
+}
+
+struct frame_result
+{
+    bool ok;
+    int64_t lastKernelNs; // kernel timestamp of the final SYN_REPORT
+    uint32_t mismatches;  // events read back that were not the expected ones
+};
+
+// Reads until frameCount SYN_REPORT frames arrived, checking EV_KEY/EV_REL events against the expected list.
+static frame_result read_frames(int32_t fd, uint32_t frameCount, const std::vector<::input_event>& expected)
+{
+    frame_result result = { false, 0, 0 };
+    ::input_event buffer[64];
+    uint32_t frames = 0;
+    size_t next = 0;
+    while (frames < frameCount)
+    {
+        ::pollfd pfd = { fd, POLLIN, 0 };
+        if (::poll(&pfd, 1, 1000) <= 0)
+        {
+            return result;
+        }
+        ssize_t bytes = ::read(fd, buffer, sizeof(buffer));
+        if (bytes <= 0)
+        {
+            return result;
+        }
+        size_t count = static_cast<size_t>(bytes) / sizeof(::input_event);
+        for (size_t i = 0; i < count; i++)
+        {
+            const ::input_event& event = buffer[i];
+            if (event.type == EV_SYN && event.code == SYN_DROPPED)
+            {
+                return result;
+            }
+            if (event.type == EV_SYN && event.code == SYN_REPORT)
+            {
+                frames++;
+                result.lastKernelNs = event_ns(event);
+                continue;
+            }
+            if (event.type != EV_KEY && event.type != EV_REL)
+            {
+                continue;
+            }
+            if (next >= expected.size() || expected[next].type != event.type || expected[next].code != event.code
+                || expected[next].value != event.value)
+            {
+                result.mismatches++;
+            }
+            next++;
+        }
+    }
+    result.ok = true;
+    return result;
+}
+
+static void append_expected(std::vector<::input_event>& expected, uint16_t type, uint16_t code, int32_t value)
+{
+    ::input_event event = {};
+    event.type = type;
+    event.code = code;
+    event.value = value;
+    expected.push_back(event);
+}
+
+static int64_t percentile(std::vector<int64_t>& samples, double fraction)
+{
+    if (samples.empty())
+    {
+        return 0;
+    }
+    size_t index = static_cast<size_t>(fraction * static_cast<double>(samples.size() - 1));
+    std::nth_element(samples.begin(), samples.begin() + static_cast<std::ptrdiff_t>(index), samples.end());
+    return samples[index];
+}
+
+static void report(const char* name, uint32_t batches, uint32_t events, int64_t elapsedNs, std::vector<int64_t>& writeToKernel,
+    std::vector<int64_t>& writeToRead, uint32_t mismatches)
+{
+    double seconds = static_cast<double>(elapsedNs) / 1e9;
+    std::printf("%s: %u batches, %.0f batches/s, %.0f events/s, %u mismatched events\n", name, batches,
+        static_cast<double>(batches) / seconds, static_cast<double>(events) / seconds, mismatches);
+    std::printf("  write->kernel stamp us: p50 %.1f  p99 %.1f  p99.9 %.1f  max %.1f\n",
+        percentile(writeToKernel, 0.5) / 1e3, percentile(writeToKernel, 0.99) / 1e3, percentile(writeToKernel, 0.999) / 1e3,
+        percentile(writeToKernel, 1.0) / 1e3);
+    std::printf("  write->read returned us: p50 %.1f  p99 %.1f  p99.9 %.1f  max %.1f\n",
+        percentile(writeToRead, 0.5) / 1e3, percentile(writeToRead, 0.99) / 1e3, percentile(writeToRead, 0.999) / 1e3,
+        percentile(writeToRead, 1.0) / 1e3);
+}
+
+// One chord at a time, waiting for it to come back before the next, cycling through keys with and without shift.
+static bool bench_keys(uinput_input_sink& sink, int32_t fd, uint32_t iterations)
+{
+    static constexpr uint16_t keys[] = { 'A', 'S', 'D', 'F', VK_SPACE, VK_OEM_PERIOD, VK_LEFT, VK_RETURN };
+    std::vector<int64_t> writeToKernel;
+    std::vector<int64_t> writeToRead;
+    writeToKernel.reserve(iterations);
+    writeToRead.reserve(iterations);
+    std::vector<::input_event> expected;
+    uint32_t events = 0;
+    uint32_t mismatches = 0;
+    int64_t start = now_ns();
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        uint16_t vk = keys[i % (sizeof(keys) / sizeof(keys[0]))];
+        key_chord chord = key_chord_builder::build_press(vk, 0, (i & 8) != 0, false, false, key_chord_builder::is_extended_key(vk));
+        expected.clear();
+        for (uint32_t s = 0; s < chord.count; s++)
+        {
+            bool keyUp = (chord.strokes[s].flags & key_stroke::flagKeyUp) != 0;
+            append_expected(expected, EV_KEY, uinput_input_sink::to_evdev_code(chord.strokes[s].virtualKeyCode), keyUp ? 0 : 1);
+        }
+        int64_t sent = now_ns();
+        if (sink.send_keys(chord.strokes, chord.count) != chord.count)
+        {
+            std::fprintf(stderr, "keys: write() failed at iteration %u\n", i);
+            return false;
+        }
+        frame_result result = read_frames(fd, chord.count, expected);
+        int64_t received = now_ns();
+        if (!result.ok)
+        {
+            std::fprintf(stderr, "keys: events lost at iteration %u\n", i);
+            return false;
+        }
+        writeToKernel.push_back(result.lastKernelNs - sent);
+        writeToRead.push_back(received - sent);
+        events += chord.count;
+        mismatches += result.mismatches;
+    }
+    report("keys", iterations, events, now_ns() - start, writeToKernel, writeToRead, mismatches);
+    return mismatches == 0;
+}
+
+// Batches of relative moves and wheel turns, the shape the touchpad flush produces once per frame.
+static bool bench_pointer(uinput_input_sink& sink, int32_t fd, uint32_t iterations)
+{
+    static constexpr uint32_t strokesPerBatch = 4;
+    std::vector<int64_t> writeToKernel;
+    std::vector<int64_t> writeToRead;
+    writeToKernel.reserve(iterations);
+    writeToRead.reserve(iterations);
+    std::vector<::input_event> expected;
+    uint32_t events = 0;
+    uint32_t mismatches = 0;
+    int64_t start = now_ns();
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        // Alternate direction so the pointer does not drift, full notches keep REL_WHEEL in step.
+        int32_t direction = (i & 1) != 0 ? -1 : 1;
+        mouse_stroke strokes[strokesPerBatch] = {
+            { mouse_stroke::flagMove, 3 * direction, -2 * direction, 0 },
+            { mouse_stroke::flagMove, direction, 0, 0 },
+            { mouse_stroke::flagWheel, 0, 0, 120 * direction },
+            { mouse_stroke::flagMove | mouse_stroke::flagWheel, -4 * direction, 2 * direction, -120 * direction },
+        };
+        expected.clear();
+        append_expected(expected, EV_REL, REL_X, 3 * direction);
+        append_expected(expected, EV_REL, REL_Y, -2 * direction);
+        append_expected(expected, EV_REL, REL_X, direction);
+        append_expected(expected, EV_REL, REL_WHEEL_HI_RES, 120 * direction);
+        append_expected(expected, EV_REL, REL_WHEEL, direction);
+        append_expected(expected, EV_REL, REL_X, -4 * direction);
+        append_expected(expected, EV_REL, REL_Y, 2 * direction);
+        append_expected(expected, EV_REL, REL_WHEEL_HI_RES, -120 * direction);
+        append_expected(expected, EV_REL, REL_WHEEL, -direction);
+        int64_t sent = now_ns();
+        if (sink.send_mouse(strokes, strokesPerBatch) != strokesPerBatch)
+        {
+            std::fprintf(stderr, "pointer: write() failed at iteration %u\n", i);
+            return false;
+        }
+        frame_result result = read_frames(fd, strokesPerBatch, expected);
+        int64_t received = now_ns();
+        if (!result.ok)
+        {
+            std::fprintf(stderr, "pointer: events lost at iteration %u\n", i);
+            return false;
+        }
+        writeToKernel.push_back(result.lastKernelNs - sent);
+        writeToRead.push_back(received - sent);
+        events += static_cast<uint32_t>(expected.size());
+        mismatches += result.mismatches;
+    }
+    report("pointer", iterations, events, now_ns() - start, writeToKernel, writeToRead, mismatches);
+    return mismatches == 0;
+}
+
+int main(int argc, char* argv[])
+{
+    uint32_t iterations = argc > 1 ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 5000;
+    try
+    {
+        uinput_input_sink sink;
+        std::string keyboardNode = sink.get_keyboard_node();
+        std::string pointerNode = sink.get_pointer_node();
+        int32_t keyboardFd = open_node(keyboardNode);
+        int32_t pointerFd = open_node(pointerNode);
+        if (keyboardFd < 0 || pointerFd < 0)
+        {
+            std::fprintf(stderr, "cannot open and grab %s / %s\n", keyboardNode.c_str(), pointerNode.c_str());
+            return 1;
+        }
+        std::printf("keyboard %s, pointer %s, %u iterations\n", keyboardNode.c_str(), pointerNode.c_str(), iterations);
+        bool ok = bench_keys(sink, keyboardFd, iterations);
+        ok = bench_pointer(sink, pointerFd, iterations) && ok;
+        ::close(keyboardFd);
+        ::close(pointerFd);
+        return ok ? 0 : 1;
+    }
+    catch (const std::exception& e)
+    {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+}
@@ -0,0 +1,133 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "window_executor.h"
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <exception>
+#include <utility>
+// 4. Project classes
+
+// ----- postToUi: Used to run completions and rethrow request exceptions on the UI thread.
+// ----- threadStart: Runs on the executor thread before any request (e.g. COM initialization), can be empty.
+// ----- threadStop: Runs on the executor thread after the last request, can be empty.
+window_executor::window_executor(post_function postToUi, std::function<void()> threadStart, std::function<void()> threadStop)
+    : m_postToUi(std::move(postToUi)),
+      m_threadStart(std::move(threadStart)),
+      m_threadStop(std::move(threadStop))
+{
+    m_thread = std::thread(&window_executor::run, this);
+}
+
+// Requests that haven't started are dropped, the one running (if any) is finished first.
+window_executor::~window_executor()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+        m_queue.clear();
+    }
+    m_wake.notify_one();
+    m_thread.join();
+}
+
+// --- submit(): Queues a request.
+// ----- supersedeKey: Requests for the same thing share a key, a new one drops any queued (not yet started) request
+//                     with the same key, e.g. rapid changes of one combo box. 0 never supersedes.
+// ----- work: Runs on the executor thread.
+// ----- completion: Runs on the UI thread after work returned. Can be empty.
+// --------------------------------------------------------------------------------------------/
+/* public */ void window_executor::submit(uint32_t supersedeKey, std::function<void()> work, std::function<void()> completion)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (supersedeKey != 0)
+        {
+            for (std::deque<request>::iterator it = m_queue.begin(); it != m_queue.end();)
+            {
+                if (it->supersedeKey == supersedeKey)
+                {
+                    it = m_queue.erase(it);
+                    m_superseded++;
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+        }
+        m_queue.push_back({ supersedeKey, std::move(work), std::move(completion) });
+        m_submitted++;
+    }
+    m_wake.notify_one();
+}
+
+/* public */ window_executor_stats window_executor::get_stats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    window_executor_stats stats;
+    stats.submitted = m_submitted;
+    stats.completed = m_completed;
+    stats.superseded = m_superseded;
+    stats.queueDepth = static_cast<uint32_t>(m_queue.size());
+    return stats;
+}
+
+/* private */ void window_executor::run()
+{
+    if (m_threadStart)
+    {
+        m_threadStart();
+    }
+    while (true)
+    {
+        request next;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this]() { return m_stopping || !m_queue.empty(); });
+            if (m_stopping)
+            {
+                break;
+            }
+            next = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+        try
+        {
+            next.work();
+        }
+        catch (...)
+        {
+            // Errors are reported where every other error is, on the UI thread.
+            std::exception_ptr error = std::current_exception();
+            m_postToUi([error]() { std::rethrow_exception(error); });
+            continue;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_completed++;
+        }
+        if (next.completion)
+        {
+            m_postToUi(std::move(next.completion));
+        }
+    }
+    if (m_threadStop)
+    {
+        m_threadStop();
+    }
+}
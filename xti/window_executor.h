@@ -0,0 +1,82 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef WINDOW_EXECUTOR_H
+#define WINDOW_EXECUTOR_H
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+// 4. Project classes
+// 5. Forward decl
+
+struct window_executor_stats
+{
+    uint64_t submitted;
+    uint64_t completed;
+    uint64_t superseded; // dropped before they started because a newer request with the same key came in
+    uint32_t queueDepth;
+};
+
+// Runs window management (launching, moving, DWM queries...) on its own thread, one request at a time in order,
+// so slow or hung windows can never stall touch and typing on the UI thread.
+// Completions, and any exception thrown by a request, are handed back through the post function given at construction.
+class window_executor
+{
+public:
+    // Hands a function to the UI thread to run there, e.g. with a queued QMetaObject::invokeMethod.
+    typedef std::function<void(std::function<void()>)> post_function;
+
+    window_executor(post_function postToUi, std::function<void()> threadStart, std::function<void()> threadStop);
+    ~window_executor();
+    window_executor(const window_executor&) = delete;
+    window_executor& operator=(const window_executor&) = delete;
+
+    // public submit(): Queues a request.
+    // see cpp file for more info.
+    void submit(uint32_t supersedeKey, std::function<void()> work, std::function<void()> completion);
+
+    window_executor_stats get_stats() const;
+
+private:
+    struct request
+    {
+        uint32_t supersedeKey;
+        std::function<void()> work;
+        std::function<void()> completion;
+    };
+
+    post_function m_postToUi;
+    std::function<void()> m_threadStart;
+    std::function<void()> m_threadStop;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::deque<request> m_queue; // guarded by m_mutex
+    bool m_stopping = false; // guarded by m_mutex
+    uint64_t m_submitted = 0; // guarded by m_mutex
+    uint64_t m_completed = 0; // guarded by m_mutex
+    uint64_t m_superseded = 0; // guarded by m_mutex
+    std::thread m_thread;
+
+    void run();
+};
+
+#endif // WINDOW_EXECUTOR_H
@@ -0,0 +1,186 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "window_registry.h"
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <algorithm>
+// 4. Project classes
+
+// --- on_window_created(): Adds a window, or replaces it if the id is already known (ids can be reused).
+// ----- info: The window. exeNameUpper must already be UPPERCASE.
+// --------------------------------------------------------------------------------------------/
+/* public */ void window_registry::on_window_created(const window_info& info)
+{
+    std::unordered_map<window_id, window_info>::iterator found = m_windows.find(info.id);
+    if (found != m_windows.end())
+    {
+        unindex(found->second);
+        found->second = info;
+    }
+    else
+    {
+        m_windows.emplace(info.id, info);
+    }
+    m_windowsByExe[info.exeNameUpper].push_back(info.id);
+    if (m_observer != nullptr)
+    {
+        m_observer->on_window_created(info);
+    }
+}
+
+/* public */ void window_registry::on_window_destroyed(window_id id)
+{
+    std::unordered_map<window_id, window_info>::iterator found = m_windows.find(id);
+    if (found == m_windows.end())
+    {
+        return;
+    }
+    unindex(found->second);
+    m_windows.erase(found);
+    if (m_observer != nullptr)
+    {
+        m_observer->on_window_destroyed(id);
+    }
+}
+
+/* public */ void window_registry::on_window_renamed(window_id id, const std::wstring& title)
+{
+    std::unordered_map<window_id, window_info>::iterator found = m_windows.find(id);
+    if (found != m_windows.end())
+    {
+        // Unchanged titles (apps often re-set the same one) cost nothing further.
+        if (found->second.title == title)
+        {
+            return;
+        }
+        found->second.title = title;
+        if (id == m_foreground && m_foregroundListener != nullptr)
+        {
+            m_foregroundListener(m_foregroundListenerContext, &found->second);
+        }
+        if (m_observer != nullptr)
+        {
+            m_observer->on_window_renamed(id, title);
+        }
+    }
+}
+
+/* public */ void window_registry::on_window_visibility(window_id id, bool visible)
+{
+    std::unordered_map<window_id, window_info>::iterator found = m_windows.find(id);
+    if (found != m_windows.end())
+    {
+        found->second.visible = visible;
+        if (m_observer != nullptr)
+        {
+            m_observer->on_window_visibility(id, visible);
+        }
+    }
+}
+
+/* public */ void window_registry::on_foreground_changed(window_id id)
+{
+    if (id == m_foreground)
+    {
+        return;
+    }
+    m_foreground = id;
+    if (m_foregroundListener != nullptr)
+    {
+        m_foregroundListener(m_foregroundListenerContext, get(id));
+    }
+    if (m_observer != nullptr)
+    {
+        m_observer->on_foreground_changed(id);
+    }
+}
+
+// --- find(): Finds a visible, titled window of an exe.
+// ----- exeNameUpper: exe name (with extension), UPPERCASE.
+// ----- titleContains: Text that the window title must contain, empty means any title (only match exe name).
+// ------- returns: the oldest matching window, or 0 if there is none.
+// --------------------------------------------------------------------------------------------/
+/* public */ window_id window_registry::find(const std::wstring& exeNameUpper, const std::wstring& titleContains) const
+{
+    std::unordered_map<std::wstring, std::vector<window_id>>::const_iterator exeWindows = m_windowsByExe.find(exeNameUpper);
+    if (exeWindows == m_windowsByExe.end())
+    {
+        return 0;
+    }
+    for (size_t i = 0; i < exeWindows->second.size(); i++)
+    {
+        const window_info& info = m_windows.find(exeWindows->second[i])->second;
+        // Same rules as the old desktop enumeration: hidden and untitled windows are never matches.
+        if (!info.visible || info.title.empty())
+        {
+            continue;
+        }
+        if (titleContains.empty() || info.title.find(titleContains) != std::wstring::npos)
+        {
+            return info.id;
+        }
+    }
+    return 0;
+}
+
+// --- find_many(): Same as find() for several queries at once.
+// ----- queries: The lookups to do.
+// ----- count: Number of entries in queries.
+// ----- out: Receives one window (or 0) per query, must have room for count entries.
+// --------------------------------------------------------------------------------------------/
+/* public */ void window_registry::find_many(const window_query* queries, uint32_t count, window_id* out) const
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        out[i] = find(queries[i].exeNameUpper, queries[i].titleContains);
+    }
+}
+
+/* public */ const window_info* window_registry::get(window_id id) const
+{
+    std::unordered_map<window_id, window_info>::const_iterator found = m_windows.find(id);
+    return found == m_windows.end() ? nullptr : &found->second;
+}
+
+/* public */ void window_registry::clear()
+{
+    m_windows.clear();
+    m_windowsByExe.clear();
+    m_foreground = 0;
+}
+
+/* public */ void window_registry::set_foreground_listener(foreground_listener listener, void* context)
+{
+    m_foregroundListener = listener;
+    m_foregroundListenerContext = context;
+}
+
+/* private */ void window_registry::unindex(const window_info& info)
+{
+    std::unordered_map<std::wstring, std::vector<window_id>>::iterator exeWindows = m_windowsByExe.find(info.exeNameUpper);
+    if (exeWindows == m_windowsByExe.end())
+    {
+        return;
+    }
+    std::vector<window_id>& ids = exeWindows->second;
+    ids.erase(std::find(ids.begin(), ids.end(), info.id));
+    if (ids.empty())
+    {
+        m_windowsByExe.erase(exeWindows);
+    }
+}
@@ -0,0 +1,119 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef WINDOW_REGISTRY_H
+#define WINDOW_REGISTRY_H
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+// 4. Project classes
+// 5. Forward decl
+
+// Opaque top-level window identifier, an HWND on Windows.
+typedef uintptr_t window_id;
+
+struct window_info
+{
+    window_id id;
+    uint32_t processId;
+    std::wstring exeNameUpper;
+    std::wstring title;
+    bool visible;
+};
+
+// Receives top-level window changes from a window_event_source.
+class window_event_sink
+{
+public:
+    virtual ~window_event_sink() = default;
+    virtual void on_window_created(const window_info& info) = 0;
+    virtual void on_window_destroyed(window_id id) = 0;
+    virtual void on_window_renamed(window_id id, const std::wstring& title) = 0;
+    virtual void on_window_visibility(window_id id, bool visible) = 0;
+    virtual void on_foreground_changed(window_id id) = 0;
+};
+
+// Produces top-level window changes. start() first reports every window that already exists, then live changes
+// until stop(). The Win32 implementation is windows_window_source, simulated_window_source drives it by hand.
+class window_event_source
+{
+public:
+    virtual ~window_event_source() = default;
+    virtual void start(window_event_sink* sink) = 0;
+    virtual void stop() = 0;
+};
+
+// A window lookup, as done by a shortcut.
+struct window_query
+{
+    std::wstring exeNameUpper;
+    std::wstring titleContains; // empty means any title
+};
+
+// Live set of top-level windows, indexed by exe name, kept current by a window_event_source.
+// Looking a window up is a hash probe plus a walk over that exe's windows, no OS calls.
+// Not thread safe, events and lookups must come from the same thread.
+class window_registry : public window_event_sink
+{
+public:
+    virtual void on_window_created(const window_info& info) override;
+    virtual void on_window_destroyed(window_id id) override;
+    virtual void on_window_renamed(window_id id, const std::wstring& title) override;
+    virtual void on_window_visibility(window_id id, bool visible) override;
+    virtual void on_foreground_changed(window_id id) override;
+
+    // public find(): Finds a visible, titled window of an exe.
+    // see cpp file for more info.
+    window_id find(const std::wstring& exeNameUpper, const std::wstring& titleContains) const;
+
+    // public find_many(): Same as find() for several queries at once.
+    // see cpp file for more info.
+    void find_many(const window_query* queries, uint32_t count, window_id* out) const;
+
+    // public get(): Gets a window's details, nullptr if it isn't known.
+    const window_info* get(window_id id) const;
+
+    uint32_t size() const { return static_cast<uint32_t>(m_windows.size()); }
+
+    void clear();
+
+    // public set_observer(): Forwards every event to observer once the registry has applied it, nullptr to stop.
+    void set_observer(window_event_sink* observer) { m_observer = observer; }
+
+    // public set_foreground_listener(): Called when the foreground window changes, or the foreground window's title
+    // changes. info is nullptr when the foreground window isn't one the registry knows about (e.g. xti's own).
+    typedef void (*foreground_listener)(void* context, const window_info* info);
+    void set_foreground_listener(foreground_listener listener, void* context);
+
+    // public get_foreground(): Gets the foreground window, nullptr if the registry doesn't know it.
+    const window_info* get_foreground() const { return get(m_foreground); }
+
+private:
+    window_event_sink* m_observer = nullptr;
+    foreground_listener m_foregroundListener = nullptr;
+    void* m_foregroundListenerContext = nullptr;
+    window_id m_foreground = 0;
+    std::unordered_map<window_id, window_info> m_windows;
+    std::unordered_map<std::wstring, std::vector<window_id>> m_windowsByExe; // in creation order
+
+    void unindex(const window_info& info);
+};
+
+#endif // WINDOW_REGISTRY_H
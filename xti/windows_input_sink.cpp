@@ -0,0 +1,122 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "windows_input_sink.h"
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+// 4. Project classes
+
+/* private */ std::atomic<uint32_t> windows_input_sink::batchCount { 0 };
+
+// --- send_keys(): Injects the strokes in order as a single batch.
+// The last stroke is stamped with the batch number, so the keyboard hook can tell when everything sent has arrived.
+// ----- strokes: The key strokes to inject.
+// ----- count: Number of entries in strokes.
+// ------- returns: The number of strokes the OS accepted. Less than count if it was blocked part way (e.g. by UIPI).
+// --------------------------------------------------------------------------------------------/
+/* public */ uint32_t windows_input_sink::send_keys(const key_stroke* strokes, uint32_t count)
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+    if (m_keyInputs.size() < count)
+    {
+        m_keyInputs.resize(count);
+    }
+    ::ULONG_PTR batch = batch_number(batchCount.fetch_add(1) + 1);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        ::INPUT& input = m_keyInputs[i];
+        input = {};
+        input.type = INPUT_KEYBOARD;
+        input.ki.dwExtraInfo = i + 1 == count ? extraInfoTag | batch : extraInfoTag;
+        if ((strokes[i].flags & key_stroke::flagUnicode) != 0)
+        {
+            // Arrives as VK_PACKET, the unit is handed to the app as WM_CHAR whatever the keyboard layout.
+            input.ki.wScan = strokes[i].virtualKeyCode;
+            input.ki.dwFlags |= KEYEVENTF_UNICODE;
+        }
+        else
+        {
+            // Windows messages carry the virtual key, raw input (games) and remote desktop clients read the scan code.
+            input.ki.wVk = strokes[i].virtualKeyCode;
+            input.ki.wScan = strokes[i].scanCode;
+        }
+        if ((strokes[i].flags & key_stroke::flagKeyUp) != 0)
+        {
+            input.ki.dwFlags |= KEYEVENTF_KEYUP;
+        }
+        if ((strokes[i].flags & key_stroke::flagExtended) != 0)
+        {
+            input.ki.dwFlags |= KEYEVENTF_EXTENDEDKEY;
+        }
+    }
+    return ::SendInput(count, m_keyInputs.data(), sizeof(::INPUT));
+}
+
+// --- send_mouse(): Injects the mouse events in order as a single batch.
+// ----- strokes: The mouse events to inject.
+// ----- count: Number of entries in strokes.
+// ------- returns: The number of events the OS accepted.
+// --------------------------------------------------------------------------------------------/
+/* public */ uint32_t windows_input_sink::send_mouse(const mouse_stroke* strokes, uint32_t count)
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+    if (m_mouseInputs.size() < count)
+    {
+        m_mouseInputs.resize(count);
+    }
+    for (uint32_t i = 0; i < count; i++)
+    {
+        ::INPUT& input = m_mouseInputs[i];
+        input = {};
+        input.type = INPUT_MOUSE;
+        uint16_t flags = strokes[i].flags;
+        if ((flags & mouse_stroke::flagLeftDown) != 0)
+        {
+            input.mi.dwFlags |= MOUSEEVENTF_LEFTDOWN;
+        }
+        if ((flags & mouse_stroke::flagLeftUp) != 0)
+        {
+            input.mi.dwFlags |= MOUSEEVENTF_LEFTUP;
+        }
+        if ((flags & mouse_stroke::flagRightDown) != 0)
+        {
+            input.mi.dwFlags |= MOUSEEVENTF_RIGHTDOWN;
+        }
+        if ((flags & mouse_stroke::flagRightUp) != 0)
+        {
+            input.mi.dwFlags |= MOUSEEVENTF_RIGHTUP;
+        }
+        if ((flags & mouse_stroke::flagMove) != 0)
+        {
+            input.mi.dwFlags |= MOUSEEVENTF_MOVE;
+            input.mi.dx = strokes[i].dx;
+            input.mi.dy = strokes[i].dy;
+        }
+        if ((flags & mouse_stroke::flagWheel) != 0)
+        {
+            input.mi.dwFlags |= MOUSEEVENTF_WHEEL;
+            input.mi.mouseData = static_cast<::DWORD>(strokes[i].wheel);
+        }
+    }
+    return ::SendInput(count, m_mouseInputs.data(), sizeof(::INPUT));
+}
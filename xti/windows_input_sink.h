@@ -0,0 +1,63 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef WINDOWS_INPUT_SINK_H
+#define WINDOWS_INPUT_SINK_H
+
+// 1. Qt framework headers
+// 2. System/OS headers
+#include <Windows.h>
+// 3. C++ standard library headers
+#include <atomic>
+#include <cstdint>
+#include <vector>
+// 4. Project classes
+#include "input_sink.h"
+// 5. Forward decl
+
+// Injects input into the OS with one ::SendInput call per batch.
+// send_keys() and send_mouse() may be called from two different threads at once (UI thread and input_worker),
+// each uses its own buffer.
+class windows_input_sink : public input_sink
+{
+public:
+    // Stamped into dwExtraInfo of every injected key so the keyboard hook can tell xti's own strokes apart.
+    // The low 16 bits carry the batch number on the last stroke of each send_keys() batch, 0 on the others.
+    static constexpr ::ULONG_PTR extraInfoTag = 0x58540000; // "XT"
+    static constexpr ::ULONG_PTR extraInfoTagMask = 0xFFFF0000;
+
+    virtual uint32_t send_keys(const key_stroke* strokes, uint32_t count) override;
+    virtual uint32_t send_mouse(const mouse_stroke* strokes, uint32_t count) override;
+
+    // public is_injected(): True if a key event seen by the keyboard hook was injected by xti.
+    static bool is_injected(::ULONG_PTR extraInfo) { return (extraInfo & extraInfoTagMask) == extraInfoTag; }
+
+    // public ends_last_batch(): True if the key event is the last stroke of the latest batch, i.e. every stroke xti has
+    // sent so far has reached the keyboard hook. Only meaningful when is_injected() is true.
+    static bool ends_last_batch(::ULONG_PTR extraInfo) { return (extraInfo & 0xFFFF) == batch_number(batchCount.load()); }
+
+private:
+    // Batches sent by every instance, the UI thread's sink and the text_injector's share the numbering.
+    static std::atomic<uint32_t> batchCount;
+
+    // Numbers wrap within 1..0xFFFF, 0 marks a stroke that does not end a batch.
+    static ::ULONG_PTR batch_number(uint32_t count) { return (count % 0xFFFF) + 1; }
+
+    // Reused between calls so a key press does not allocate once the buffer has grown to fit a chord.
+    std::vector<::INPUT> m_keyInputs;
+    std::vector<::INPUT> m_mouseInputs;
+};
+
+#endif // WINDOWS_INPUT_SINK_H
@@ -0,0 +1,92 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "windows_layout_source.h"
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+// 4. Project classes
+
+windows_layout_source::windows_layout_source(::HKL layout)
+    : m_layout(layout)
+{
+}
+
+// --- find_character(): Finds the key and the modifiers that type a character on this layout.
+// https://learn.microsoft.com/en-us/windows/win32/api/winuser/nf-winuser-vkkeyscanexw
+// Control or alt on their own make a shortcut rather than a character, only both together (AltGr) are accepted.
+// The key is then typed into a scratch keyboard state to rule out dead keys, which would swallow the character.
+// ----- character: The character to find.
+// ----- virtualKeyCodeOut: Receives the key.
+// ----- modifiersOut: Receives key_action::flagShift, flagControl and flagAlt as needed.
+// ------- returns: False if the layout has no key that types the character as is.
+// --------------------------------------------------------------------------------------------/
+/* public */ bool windows_layout_source::find_character(char16_t character, uint16_t& virtualKeyCodeOut, uint8_t& modifiersOut) const
+{
+    ::SHORT result = ::VkKeyScanExW(static_cast<::WCHAR>(character), m_layout);
+    if (result == -1)
+    {
+        return false;
+    }
+    uint16_t virtualKeyCode = LOBYTE(result);
+    uint8_t state = HIBYTE(result); // 1 shift, 2 control, 4 alt, higher bits are Hankaku and reserved shift states
+    bool shift = (state & 0x01) != 0;
+    bool control = (state & 0x02) != 0;
+    bool alt = (state & 0x04) != 0;
+    if ((state & ~0x07) != 0 || control != alt)
+    {
+        return false;
+    }
+
+    ::BYTE keyState[256] = {};
+    if (shift)
+    {
+        keyState[VK_SHIFT] = 0x80;
+    }
+    if (control)
+    {
+        keyState[VK_CONTROL] = 0x80;
+        keyState[VK_MENU] = 0x80;
+    }
+    ::WCHAR typed[4] = {};
+    ::UINT scanCode = ::MapVirtualKeyExW(virtualKeyCode, MAPVK_VK_TO_VSC, m_layout);
+    // Flag 0x4 leaves the kernel keyboard state (and a dead key the user has pending) untouched, Windows 10 1607 and later.
+    int32_t count = ::ToUnicodeEx(virtualKeyCode, scanCode, keyState, typed, 4, 0x4, m_layout);
+    if (count != 1 || typed[0] != static_cast<::WCHAR>(character))
+    {
+        return false; // -1 is a dead key
+    }
+    virtualKeyCodeOut = virtualKeyCode;
+    modifiersOut = 0;
+    if (shift)
+    {
+        modifiersOut |= key_action::flagShift;
+    }
+    if (control)
+    {
+        modifiersOut |= key_action::flagControl | key_action::flagAlt;
+    }
+    return true;
+}
+
+// --- get_scan_code(): Gets the scan code of a key on this layout.
+// ----- virtualKeyCode: The key.
+// ------- returns: The scan code, 0xE0 in the high byte for extended keys, 0 if the layout has none.
+// --------------------------------------------------------------------------------------------/
+/* public */ uint16_t windows_layout_source::get_scan_code(uint16_t virtualKeyCode) const
+{
+    return static_cast<uint16_t>(::MapVirtualKeyExW(virtualKeyCode, MAPVK_VK_TO_VSC_EX, m_layout));
+}
@@ -0,0 +1,41 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef WINDOWS_LAYOUT_SOURCE_H
+#define WINDOWS_LAYOUT_SOURCE_H
+
+// 1. Qt framework headers
+// 2. System/OS headers
+#include <Windows.h>
+// 3. C++ standard library headers
+#include <cstdint>
+// 4. Project classes
+#include "key_layout.h"
+// 5. Forward decl
+
+// key_layout_source for an installed keyboard layout, read through the Win32 layout functions.
+class windows_layout_source : public key_layout_source
+{
+public:
+    explicit windows_layout_source(::HKL layout);
+
+    virtual bool find_character(char16_t character, uint16_t& virtualKeyCodeOut, uint8_t& modifiersOut) const override;
+    virtual uint16_t get_scan_code(uint16_t virtualKeyCode) const override;
+
+private:
+    ::HKL m_layout;
+};
+
+#endif // WINDOWS_LAYOUT_SOURCE_H
@@ -17,15 +17,17 @@
 
 // 1. Qt framework headers
 // 2. System/OS headers
-#include <Psapi.h>
 #include <shellapi.h>
 #include <dwmapi.h>
+#include <combaseapi.h>
 // 3. C++ standard library headers
-#include <memory>
 #include <cctype>
 #include <algorithm>
+#include <vector>
 // 4. Project classes
 #include "error_reporter.h"
+#include "windows_input_sink.h"
+#include "windows_window_source.h"
 
 // --- initialize_apply_keyboard_window_style(): Tells windows to apply for keyboard native window styling.
 // ----- window: HWND of the Qt app.
@@ -93,6 +95,48 @@
     move_window(window, above, appDimensions);
 }
 
+// --- place_window_below(): Puts a window directly underneath another in the z-order, without activating it.
+// Used by a restarted xti to warm up behind the instance it replaces, so that one keeps taking touches until the handover.
+// ----- window: The window to move in the z-order.
+// ----- above: The window that should stay on top of it. Both must be top-most. Nothing happens if it no longer exists.
+// --------------------------------------------------------------------------------------/
+/* public */ void windows_subsystem::place_window_below(::HWND window, ::HWND above)
+{
+    if (::IsWindow(above) == 0)
+    {
+        return;
+    }
+    int32_t r = ::SetWindowPos(window, above, 0, 0, 0, 0, SWP_NOMOVE | SWP_NOSIZE | SWP_NOACTIVATE);
+    if (r == 0)
+    {
+        error_reporter::stop(__FILE__, __LINE__, "Win32::SetWindowPos() failure.");
+    }
+}
+
+/* public */ bool windows_subsystem::is_window(::HWND window)
+{
+    return ::IsWindow(window) != 0;
+}
+
+// --- terminate_process(): Ends a process xti started, e.g. a replacement instance whose handover failed.
+// Keys it left down stay down in the OS, they belong to the caller's modifier state from here on.
+// ----- processId: The process to end. Nothing happens if it has already exited.
+// --------------------------------------------------------------------------------------/
+/* public */ void windows_subsystem::terminate_process(int64_t processId)
+{
+    ::HANDLE process = ::OpenProcess(PROCESS_TERMINATE | SYNCHRONIZE, FALSE, static_cast<::DWORD>(processId));
+    if (process == nullptr)
+    {
+        return; // already gone
+    }
+    // Only waited for briefly, so its hooks are gone before this instance takes input back.
+    if (::TerminateProcess(process, 1) != 0)
+    {
+        ::WaitForSingleObject(process, 1000);
+    }
+    ::CloseHandle(process);
+}
+
 // --- initialize_disable_touch_input(): Prevents touch input from interfering with the virtual touchpad.
 // --------------------------------------------------------------------------------------/
 /* public */ void windows_subsystem::initialize_disable_touch_input()
@@ -131,187 +175,233 @@
     return ::CallNextHookEx(llMouseHook, code, wParam, lParam);
 }
 
-// --- start_process(): Starts a new process and positioning either above or below the xti keyboard.
-// ----- exePath: absolute file path of the executable.
-// ----- params: Additional parameter string to pass at startup.
-// ----- workingDirectory: absolute working directory to run it under.
-// ----- expectedExeName: The running executable name that this function should eventually produce.
-// ----- expectedTitleName: The running window title name that this function should eventually produce. Empty for any.
-// ----- above: True if to open above the xti keyboard, false if move below the xti keyboard.
-// ----- appDimensions: Where windows should be placed in the desktop.
-// ---------------------------------------------------------------------------------------------------------------------------------------------------------------------/
-/* public */ void windows_subsystem::start_process(const std::wstring& exePath, const std::wstring& params, const std::wstring& workingDirectory,
-                                                   const std::wstring& expectedExeName, const std::wstring& expectedTitleName, bool above, const app_dimensions& appDimensions)
+// --- initialize_keyboard_hook(): Reports every key event, flagging the ones xti injected itself.
+// ----- callback: Called on the UI thread for every key down/up. xtiSettled is true on the last stroke of the latest
+// -----           batch xti sent, at which point the OS has every stroke xti injected.
+// ----- context: Passed back to callback unchanged.
+// --------------------------------------------------------------------------------------/
+/* public */ void windows_subsystem::initialize_keyboard_hook(key_event_callback callback, void* context)
 {
-    // Intentionally don't check the return value of ShellExecuteW.
-    // User may have bad config, don't crash the app if we failed to open the process.
-    ::ShellExecuteW(nullptr, L"open", exePath.c_str(),
-                                           params.empty() ? nullptr : params.c_str(), workingDirectory.c_str(), SW_SHOWNORMAL);
-    // Wait 500 ms for any application initialization logic before attempting to re-organize windows.
-    ::Sleep(500);
-    ::HWND window;
-    // Try with title name first.
-    if (!expectedTitleName.empty())
+    ::HMODULE handle = ::GetModuleHandleW(nullptr);
+    if (handle == nullptr)
     {
-        window = get_window(expectedExeName, expectedTitleName);
-        if (window != nullptr)
-        {
-            move_window(window, above, appDimensions);
-            return;
-        }
+        error_reporter::stop(__FILE__, __LINE__, "Win32::GetModuleHandleW() failure.");
     }
-    // Try without title name.
-    window = get_window(expectedExeName, L"");
-    if (window != nullptr)
+    keyEventCallback = callback;
+    keyEventContext = context;
+    llKeyboardHook = ::SetWindowsHookExW(WH_KEYBOARD_LL, ll_keyboard_proc, handle, 0);
+    if (llKeyboardHook == nullptr)
     {
-        move_window(window, above, appDimensions);
+        error_reporter::stop(__FILE__, __LINE__, "Win32::SetWindowsHookExW() failure.");
     }
 }
-
-// --- is_process_running(): Determines if a process is running within the system.
-// ----- processName: The process name to check. Not case sensitive.
-// ------- returns: true if found, false if not
-// ---------------------------------------------------------------------------------------/
-/* public */ bool windows_subsystem::is_process_running(const std::wstring& processName)
+/* public */ void windows_subsystem::cleanup_keyboard_hook()
 {
-    uint32_t processesArray[1024];
-    uint32_t needed;
-    int32_t r = ::EnumProcesses(reinterpret_cast<::DWORD*>(processesArray), sizeof(processesArray), reinterpret_cast<::DWORD*>(&needed));
+    int32_t r = ::UnhookWindowsHookEx(llKeyboardHook);
     if (r == 0)
     {
-        error_reporter::stop(__FILE__, __LINE__, "Win32::EnumProcesses() failure.");
-    }
-    uint32_t processCount = needed / sizeof(uint32_t);
-    if (processCount == 1024)
-    {
-        error_reporter::stop(__FILE__, __LINE__, "Win32::EnumProcesses() overflow.");
+        error_reporter::stop(__FILE__, __LINE__, "Win32::UnhookWindowsHookEx() failure.");
     }
-    std::wstring processNameUpper = processName;
-    std::transform(processNameUpper.begin(), processNameUpper.end(), processNameUpper.begin(), ::toupper);
-    for (size_t i = 0; i < processCount; i++)
+    keyEventCallback = nullptr;
+}
+/* private */ ::HHOOK windows_subsystem::llKeyboardHook;
+/* private */ windows_subsystem::key_event_callback windows_subsystem::keyEventCallback;
+/* private */ void* windows_subsystem::keyEventContext;
+/* private */ int64_t windows_subsystem::ll_keyboard_proc(int32_t code, uint64_t wParam, int64_t lParam)
+{
+    if (code >= 0 && keyEventCallback != nullptr)
     {
-        if (processesArray[i] == 0)
-        {
-            continue; // skip kernel, the get_exe_name_from_process_id fails on 0.
-        }
-        std::wstring processNameUpperRunning = get_exe_name_from_process_id(processesArray[i]);
-        if (processNameUpperRunning == processNameUpper)
-        {
-            return true;
-        }
+        ::KBDLLHOOKSTRUCT* hookInfo = reinterpret_cast<::KBDLLHOOKSTRUCT*>(lParam);
+        bool injectedByXti = windows_input_sink::is_injected(hookInfo->dwExtraInfo);
+        bool xtiSettled = injectedByXti && windows_input_sink::ends_last_batch(hookInfo->dwExtraInfo);
+        // Keep this quick, the OS drops hooks that take too long.
+        keyEventCallback(keyEventContext, static_cast<uint16_t>(hookInfo->vkCode), (hookInfo->flags & LLKHF_UP) != 0,
+                         injectedByXti, xtiSettled);
     }
-    return false;
+    return ::CallNextHookEx(llKeyboardHook, code, wParam, lParam);
 }
 
-// --- get_window(): Get a window based on specific underlying exe name and title.
-// ----- runningExe: exe name (with extension). Not case sensitive.
-// ----- requiredTitleContains: Text that the window title must contain, empty means any title (only match exe name).
-// ------- returns: the found HWND, or nulptr if not found.
-// --------------------------------------------------------------------------------------------------------------------/
-/* public */ ::HWND windows_subsystem::get_window(const std::wstring& runningExe, const std::wstring& requiredTitleContains)
+// --- set_launch_callback(): Sets what gets told about every start_process() once its window is placed (or it timed out).
+// ----- callback: Called on the UI thread with the outcome and launch-to-placed latency.
+// ----- context: Passed back to callback unchanged.
+// ---------------------------------------------------------------------------------------------------------/
+/* public */ void windows_subsystem::set_launch_callback(app_launcher::launch_callback callback, void* context)
+{
+    appLauncher->set_callback(callback, context);
+}
+
+// --- set_window_placer(): Sets what moves a launched app's window once it's found, e.g. to do it off the UI thread.
+// ----- placer: Called on the UI thread with the window to move. nullptr moves it straight away with move_window().
+// ----- context: Passed back to placer unchanged.
+// ---------------------------------------------------------------------------------------------------------/
+/* public */ void windows_subsystem::set_window_placer(app_launcher::place_function placer, void* context)
+{
+    appLauncher->set_placer(placer, context);
+}
+
+// --- track_launch(): Places the window of a started process once it appears. Needs initialize_window_registry().
+// ----- process: From start_process(), owned by the launch tracking from here on. Can be nullptr.
+// ----- expectedExeName: The running executable name that the launch should eventually produce.
+// ----- expectedTitleName: The running window title name that the launch should eventually produce. Empty for any.
+// ----- above: True if to open above the xti keyboard, false if move below the xti keyboard.
+// ----- appDimensions: Where windows should be placed in the desktop.
+// ---------------------------------------------------------------------------------------------------------/
+/* public */ void windows_subsystem::track_launch(::HANDLE process, const std::wstring& expectedExeName, const std::wstring& expectedTitleName,
+                                                  bool above, const app_dimensions& appDimensions)
+{
+    std::wstring expectedExeNameUpper = expectedExeName;
+    std::transform(expectedExeNameUpper.begin(), expectedExeNameUpper.end(), expectedExeNameUpper.begin(), ::toupper);
+    appLauncher->track(process, expectedExeNameUpper, expectedTitleName, above, appDimensions);
+}
+
+// --- initialize_worker_thread(): Prepares a background thread for window management calls.
+// ShellExecuteExW needs COM on the calling thread.
+// ---------------------------------------------------------------------------------------------------------/
+/* public */ void windows_subsystem::initialize_worker_thread()
 {
-    enumWindowProcExeNameUpper = runningExe;
-    std::transform(enumWindowProcExeNameUpper.begin(), enumWindowProcExeNameUpper.end(), enumWindowProcExeNameUpper.begin(), ::toupper);
-    enumWindowProcTitleContains = requiredTitleContains;
-    enumWindowProcHwndOut = nullptr;
-    ::SetLastError(ERROR_SUCCESS);
-    // Throwing away return value here, can return 0 if the enumeration stops early. Rely on GetLastError instead as documentation suggests.
-    ::EnumDesktopWindows(nullptr, enum_window_proc, 0);
-    uint32_t errCode =  ::GetLastError();
-    if (errCode != ERROR_SUCCESS)
+    int32_t r = ::CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED | COINIT_DISABLE_OLE1DDE);
+    if (r != S_OK)
     {
-        error_reporter::stop(__FILE__, __LINE__, "Win32::EnumDesktopWindows() failure.");
+        error_reporter::stop(__FILE__, __LINE__, "Win32::CoInitializeEx() failure.");
     }
-    return enumWindowProcHwndOut;
+}
+/* public */ void windows_subsystem::cleanup_worker_thread()
+{
+    ::CoUninitialize();
 }
 
-/* private */ thread_local std::wstring windows_subsystem::enumWindowProcExeNameUpper;
-/* private */ thread_local std::wstring windows_subsystem::enumWindowProcTitleContains;
-/* private */ thread_local ::HWND windows_subsystem::enumWindowProcHwndOut;
-/* private */ int32_t __stdcall windows_subsystem::enum_window_proc(::HWND window, [[maybe_unused]] int64_t param)
+// --- start_process(): Starts a new process, placed either above or below the xti keyboard if it allows it.
+// Can be called from any thread that went through initialize_worker_thread(). Returns as soon as the process is started,
+// pass processOut to track_launch() to have its window placed once it appears.
+// ----- exePath: absolute file path of the executable.
+// ----- params: Additional parameter string to pass at startup.
+// ----- workingDirectory: absolute working directory to run it under.
+// ----- above: True if to open above the xti keyboard, false if move below the xti keyboard.
+// ----- appDimensions: Where windows should be placed in the desktop.
+// ----- processOut: Receives the started process, nullptr if the shell handed it to an already running instance.
+// ------- returns: false if nothing could be started (bad config).
+// ---------------------------------------------------------------------------------------------------------------------------------------------------------------------/
+/* public */ bool windows_subsystem::start_process(const std::wstring& exePath, const std::wstring& params, const std::wstring& workingDirectory,
+                                                   bool above, const app_dimensions& appDimensions, ::HANDLE& processOut)
 {
-    // In this function we set SetLastError after every return intentionally. See EnumDesktopWindows documentation.
-    uint32_t processId;
-    int32_t r;
-    uint32_t rDword = ::GetWindowThreadProcessId(window, reinterpret_cast<::DWORD*>(&processId));
-    if (rDword == 0)
+    ::HANDLE process = nullptr;
+
+    // Executables are started directly with their placement in the startup info, apps that create their first window
+    // with CW_USEDEFAULT open straight into position.
+    std::wstring commandLine = L"\"" + exePath + L"\"";
+    if (!params.empty())
     {
-        error_reporter::stop(__FILE__, __LINE__, "Win32::GetWindowThreadProcessId() failure.");
+        commandLine += L" " + params;
     }
-    std::wstring exeNameUpper = get_exe_name_from_process_id(processId);
-    if (enumWindowProcExeNameUpper == exeNameUpper)
+    ::STARTUPINFOW startupInfo = {};
+    startupInfo.cb = sizeof(startupInfo);
+    startupInfo.dwFlags = STARTF_USEPOSITION | STARTF_USESIZE | STARTF_USESHOWWINDOW;
+    startupInfo.wShowWindow = SW_SHOWNORMAL;
+    startupInfo.dwX = 0;
+    startupInfo.dwY = above ? 0 : appDimensions.dimensionsBelowYStart;
+    startupInfo.dwXSize = appDimensions.dimensionsAvailableScreenWidth;
+    startupInfo.dwYSize = above ? appDimensions.dimensionsAboveYEnd : appDimensions.dimensionsBelowYEnd - appDimensions.dimensionsBelowYStart;
+    ::PROCESS_INFORMATION processInfo = {};
+    int32_t r = ::CreateProcessW(nullptr, commandLine.data(), nullptr, nullptr, false, 0, nullptr,
+                                 workingDirectory.empty() ? nullptr : workingDirectory.c_str(), &startupInfo, &processInfo);
+    if (r != 0)
     {
-        // We skip windows that are not visible.
-        r = ::IsWindowVisible(window);
-        if (r == 0)
-        {
-            ::SetLastError(ERROR_SUCCESS);
-            return true;
-        }
-
-        ::SetLastError(ERROR_SUCCESS); // GetWindowTextLengthW needs SetLastError set first.
-        int32_t windowTitleLength = ::GetWindowTextLengthW(window);
-        // error response only available with GetLastError rather than return of GetWindowTextLengthW here.
-        uint32_t errCode = ::GetLastError();
-        if (errCode != ERROR_SUCCESS)
-        {
-            error_reporter::stop(__FILE__, __LINE__, "Win32::GetWindowTextLengthW() failure.");
-        }
-        std::unique_ptr<wchar_t[]> windowTitle = std::make_unique<wchar_t[]>(windowTitleLength + 1);
-        ::SetLastError(ERROR_SUCCESS);
-        r = ::GetWindowTextW(window, windowTitle.get(), windowTitleLength + 1);
+        ::CloseHandle(processInfo.hThread);
+        process = processInfo.hProcess;
+    }
+    else
+    {
+        // Not something CreateProcessW can run (documents, App Paths aliases...), let the shell work it out.
+        ::SHELLEXECUTEINFOW shellInfo = {};
+        shellInfo.cbSize = sizeof(shellInfo);
+        shellInfo.fMask = SEE_MASK_NOCLOSEPROCESS | SEE_MASK_FLAG_NO_UI;
+        shellInfo.lpVerb = L"open";
+        shellInfo.lpFile = exePath.c_str();
+        shellInfo.lpParameters = params.empty() ? nullptr : params.c_str();
+        shellInfo.lpDirectory = workingDirectory.c_str();
+        shellInfo.nShow = SW_SHOWNORMAL;
+        r = ::ShellExecuteExW(&shellInfo);
         if (r == 0)
         {
-            errCode = ::GetLastError();
-            if (errCode != ERROR_SUCCESS)
-            {
-                error_reporter::stop(__FILE__, __LINE__, "Win32::GetWindowTextW() failure.");
-            }
-            // We skip windows with no text or any other reason that prevents us
-            // from getting the title when LastError was not set. Usually its due to one of two senarios:
-            // 1. The window hasn't finished initalizing.
-            // 2. its a privileged window that really shouldn't be iterated on.
-            ::SetLastError(ERROR_SUCCESS);
-            return true;
-        }
-
-        if (enumWindowProcTitleContains.empty())
-        {
-            // No need to check windowTitle here, just return the window we found.
-            enumWindowProcHwndOut = window;
-            ::SetLastError(ERROR_SUCCESS);
-            return false;
-        }
-
-        std::wstring windowTitleStr = windowTitle.get();
-        size_t find = windowTitleStr.find(enumWindowProcTitleContains);
-        if (find != std::wstring::npos)
-        {
-            enumWindowProcHwndOut = window;
-            ::SetLastError(ERROR_SUCCESS);
+            // Intentionally not an error, user may have bad config. Don't crash the app if we failed to open the process.
             return false;
         }
+        process = shellInfo.hProcess; // nullptr if the shell reused a running instance
     }
-    ::SetLastError(ERROR_SUCCESS);
+    processOut = process;
     return true;
 }
 
+// --- initialize_window_registry(): Starts tracking top-level windows for get_window().
+// Must be called from the UI thread, window events are delivered through its message loop.
+// -------------------------------------------------------------------------------------------/
+/* public */ void windows_subsystem::initialize_window_registry()
+{
+    windowSource = new windows_window_source(&processNameCache);
+    windowSource->start(&windowRegistry);
+    appLauncher = new app_launcher(&windowRegistry);
+    windowRegistry.set_observer(appLauncher);
+}
+/* public */ void windows_subsystem::cleanup_window_registry()
+{
+    if (windowSource != nullptr)
+    {
+        windowSource->stop();
+        delete windowSource;
+        windowSource = nullptr;
+    }
+    windowRegistry.set_observer(nullptr);
+    delete appLauncher;
+    appLauncher = nullptr;
+    windowRegistry.clear();
+}
+/* private */ window_registry windows_subsystem::windowRegistry;
+/* private */ window_event_source* windows_subsystem::windowSource = nullptr;
+/* private */ app_launcher* windows_subsystem::appLauncher = nullptr;
+
+// --- get_window(): Get a window based on specific underlying exe name and title.
+// ----- runningExe: exe name (with extension). Not case sensitive.
+// ----- requiredTitleContains: Text that the window title must contain, empty means any title (only match exe name).
+// ------- returns: the found HWND, or nulptr if not found.
+// --------------------------------------------------------------------------------------------------------------------/
+/* public */ ::HWND windows_subsystem::get_window(const std::wstring& runningExe, const std::wstring& requiredTitleContains)
+{
+    std::wstring exeNameUpper = runningExe;
+    std::transform(exeNameUpper.begin(), exeNameUpper.end(), exeNameUpper.begin(), ::toupper);
+    // Lookup in the live registry, no desktop enumeration.
+    return reinterpret_cast<::HWND>(windowRegistry.find(exeNameUpper, requiredTitleContains));
+}
+
 // --- move_window(): moves a window either above, or below the xti keyboard.
 // ----- window: The window to move.
 // ----- above: True if move above the xti keyboard, false if move below the xti keyboard.
 // ----- appDimensions: Where windows should be placed in the desktop.
 /* public */ void windows_subsystem::move_window(::HWND window, bool above, const app_dimensions& dimensions)
 {
+    if (::IsWindow(window) == 0)
+    {
+        return; // closed since it was found, moves can be queued for a while.
+    }
+    // Runs on the window executor, the window can still close at any point in between: failing on a window that
+    // is gone by then is not an error.
     RECT currDimensions;
     int32_t r = ::GetWindowRect(window, &currDimensions);
     if (r == 0)
     {
+        if (::IsWindow(window) == 0)
+        {
+            return;
+        }
         error_reporter::stop(__FILE__, __LINE__, "Win32::GetWindowRect() failure.");
     }
     RECT adjDimensions;
     r = ::DwmGetWindowAttribute(window, DWMWA_EXTENDED_FRAME_BOUNDS, &adjDimensions, sizeof(RECT));
     if (r != S_OK)
     {
+        if (::IsWindow(window) == 0)
+        {
+            return;
+        }
         error_reporter::stop(__FILE__, __LINE__, "Win32::DwmGetWindowAttribute() failure.");
     }
 
@@ -328,6 +418,10 @@
     r = ::SetWindowPos(window, HWND_TOP, newX, newY, newWidth, newHeight, SWP_SHOWWINDOW);
     if (r == 0)
     {
+        if (::IsWindow(window) == 0)
+        {
+            return;
+        }
         error_reporter::stop(__FILE__, __LINE__, "Win32::SetWindowPos() failure.");
     }
 }
@@ -337,48 +431,13 @@
 // ------- returns: the UPPERCASE binary executable file name if found, or empty string if not found.
 // -------------------------------------------------------------------------------------------/
 /* private */ std::wstring windows_subsystem::get_exe_name_from_process_id(uint32_t processId) {
-    ::HANDLE processHandle = ::OpenProcess(PROCESS_QUERY_INFORMATION | PROCESS_VM_READ, false, processId);
-    if (processHandle == nullptr)
-    {
-        if (::GetLastError() == ERROR_ACCESS_DENIED)
-        {
-            // system processes are off bounds, just skip them
-            return L"";
-        }
-        error_reporter::stop(__FILE__, __LINE__, "Win32::OpenProcess() failure.");
-    }
-    ::HMODULE moduleHandle;
-    uint32_t needed;
-    int32_t r = ::EnumProcessModulesEx(processHandle, &moduleHandle, sizeof(moduleHandle), reinterpret_cast<::DWORD*>(&needed), LIST_MODULES_DEFAULT);
-    if (r == 0)
-    {
-        uint32_t errCode = ::GetLastError();
-        if (errCode == ERROR_NOACCESS || errCode == ERROR_PARTIAL_COPY)
-        {
-            // system processes are off bounds, just skip them
-            r = ::CloseHandle(processHandle);
-            if (r == 0)
-            {
-                error_reporter::stop(__FILE__, __LINE__, "Win32::CloseHandle() failure.");
-            }
-            return L"";
-        }
-        error_reporter::stop(__FILE__, __LINE__, "Win32::EnumProcessModulesEx() failure.");
-    }
-    wchar_t processName[MAX_PATH];
-    r = ::GetModuleBaseNameW(processHandle, moduleHandle, processName, sizeof(processName) / sizeof(wchar_t));
-    if (r == 0)
-    {
-        error_reporter::stop(__FILE__, __LINE__, "Win32::GetModuleBaseNameW() failure.");
-    }
-    r = ::CloseHandle(processHandle);
-    if (r == 0)
-    {
-        error_reporter::stop(__FILE__, __LINE__, "Win32::CloseHandle() failure.");
-    }
-    std::wstring out = processName;
-    std::transform(out.begin(), out.end(), out.begin(), ::toupper);
-    return out;
+    // Windows that share a process, and repeated lookups of the same process, are answered from the cache.
+    return processNameCache.get_exe_name(processId);
+}
+/* private */ process_name_cache windows_subsystem::processNameCache;
+/* public */ process_name_cache_stats windows_subsystem::get_process_name_cache_stats()
+{
+    return processNameCache.get_stats();
 }
 
 // --- show_exception_to_user(): Shows a message box with given error message.
@@ -391,6 +450,7 @@
 }
 
 // --- get_key_modifiers(): Gets the current active key modifiers on the system.
+// Only read at startup, from then on modifier_state follows the keyboard hook.
 // ------- returns: All key modifier states.
 // ---------------------------------------------------------------/
 /* public */ key_modifiers windows_subsystem::get_key_modifiers()
@@ -399,52 +459,61 @@
     modifiers.capsLock = (::GetKeyState(VK_CAPITAL) & 0x0001) != 0;
     modifiers.scrollLock = (::GetKeyState(VK_SCROLL) & 0x0001) != 0;
     modifiers.numLock = (::GetKeyState(VK_NUMLOCK) & 0x0001) != 0;
-    modifiers.control = (::GetKeyState(VK_RCONTROL) & 0x8000) != 0;
-    modifiers.shift = (::GetKeyState(VK_RSHIFT) & 0x8000) != 0;
-    modifiers.alt = (::GetKeyState(VK_RMENU) & 0x8000) != 0;
-    modifiers.windows = (::GetKeyState(VK_RWIN) & 0x8000) != 0;;
+    // Held state comes from the async (system wide) key state. xti never has keyboard focus
+    // so its own thread's key state can lag behind what the foreground window sees.
+    modifiers.control = (::GetAsyncKeyState(VK_RCONTROL) & 0x8000) != 0;
+    modifiers.shift = (::GetAsyncKeyState(VK_RSHIFT) & 0x8000) != 0;
+    modifiers.alt = (::GetAsyncKeyState(VK_RMENU) & 0x8000) != 0;
+    modifiers.windows = (::GetAsyncKeyState(VK_RWIN) & 0x8000) != 0;
     return modifiers;
 }
 
-// --- get_focus_window_name(): Gets the current window title that has focus.
-// ------- returns: Window title name text.
-/* public */ std::wstring windows_subsystem::get_focus_window_name() {
-    HWND window = ::GetForegroundWindow();
-    if (window == nullptr)
-    {
-        return L"";
-    }
-    ::SetLastError(ERROR_SUCCESS); // GetWindowTextLengthW needs SetLastError set first.
-    int32_t windowTitleLength = ::GetWindowTextLengthW(window);
-    // error response only available with GetLastError rather than return of GetWindowTextLengthW here.
-    uint32_t errCode = ::GetLastError();
-    if (errCode != ERROR_SUCCESS)
+// --- set_foreground_listener(): Gets told when the foreground window, or its title, changes.
+// Pushed from the window registry's WinEvent hooks on the UI thread, titles come from the registry so nothing is fetched.
+// ----- listener: Called with the new foreground window, nullptr info if it's unknown (e.g. one of xti's own).
+// ----- context: Passed back to listener unchanged.
+// ---------------------------------------------------------------------------------------------------------/
+/* public */ void windows_subsystem::set_foreground_listener(window_registry::foreground_listener listener, void* context)
+{
+    windowRegistry.set_foreground_listener(listener, context);
+    if (listener != nullptr)
     {
-        error_reporter::stop(__FILE__, __LINE__, "Win32::GetWindowTextLengthW() failure.");
+        listener(context, windowRegistry.get_foreground());
     }
-    std::unique_ptr<wchar_t[]> windowTitle = std::make_unique<wchar_t[]>(windowTitleLength + 1);
-    ::SetLastError(ERROR_SUCCESS);
-    int32_t r = ::GetWindowTextW(window, windowTitle.get(), windowTitleLength + 1);
+}
+
+// --- get_key_repeat_timing(): Gets the keyboard repeat delay and rate set in the Windows keyboard settings.
+// https://learn.microsoft.com/en-us/windows/win32/api/winuser/nf-winuser-systemparametersinfow go to SPI_GETKEYBOARDDELAY
+// ----- delayNsOut: Receives the time from pressing a key to its first repeat, 250 ms to 1 s.
+// ----- intervalNsOut: Receives the time between repeats, about 2.5 (slowest) to 30 (fastest) repeats a second.
+// --------------------------------------------------------------------------------------------/
+/* public */ void windows_subsystem::get_key_repeat_timing(int64_t& delayNsOut, int64_t& intervalNsOut)
+{
+    int32_t delay = 0;
+    int32_t r = ::SystemParametersInfoW(SPI_GETKEYBOARDDELAY, 0, &delay, 0);
     if (r == 0)
     {
-        errCode = ::GetLastError();
-        if (errCode != ERROR_SUCCESS)
-        {
-            error_reporter::stop(__FILE__, __LINE__, "Win32::GetWindowTextW() failure.");
-        }
-        return L"";
+        error_reporter::stop(__FILE__, __LINE__, "Win32::SystemParametersInfoW() failure.");
     }
-    return windowTitle.get();
-}
-
-// --- get_mouse_speed(): Gets the current mouse sensitivity setting. Value from 1 to 20.
-// ------- returns: Speed value.
-/* public */ int32_t windows_subsystem::get_mouse_speed() {
-    int32_t speed;
-    int32_t r = ::SystemParametersInfoW(SPI_GETMOUSESPEED, 0, &speed, 0);
+    uint32_t speed = 0;
+    r = ::SystemParametersInfoW(SPI_GETKEYBOARDSPEED, 0, &speed, 0);
     if (r == 0)
     {
         error_reporter::stop(__FILE__, __LINE__, "Win32::SystemParametersInfoW() failure.");
     }
-    return speed;
+    // Delay 0..3 is 250 ms steps, speed 0..31 is spread linearly over 2.5..30 repeats a second.
+    delayNsOut = (static_cast<int64_t>(std::min(delay, 3)) + 1) * 250000000;
+    double repeatsPerSecond = 2.5 + (30.0 - 2.5) * static_cast<double>(std::min(speed, 31u)) / 31.0;
+    intervalNsOut = static_cast<int64_t>(1000000000.0 / repeatsPerSecond);
+}
+
+// --- get_foreground_keyboard_layout(): Gets the keyboard layout of the window that receives typed keys.
+// Layouts are per thread, xti's own thread never has the focus so its layout says nothing about where keys go.
+// ------- returns: The foreground thread's layout, xti's own when there is no foreground window.
+// --------------------------------------------------------------------------------------------/
+/* public */ ::HKL windows_subsystem::get_foreground_keyboard_layout()
+{
+    ::HWND foreground = ::GetForegroundWindow();
+    ::DWORD threadId = foreground != nullptr ? ::GetWindowThreadProcessId(foreground, nullptr) : 0;
+    return ::GetKeyboardLayout(threadId);
 }
@@ -25,6 +25,9 @@
 // 4. Project classes
 #include "app_dimensions.h"
 #include "key_modifiers.h"
+#include "process_name_cache.h"
+#include "window_registry.h"
+#include "app_launcher.h"
 // 5. Forward decl
 
 class windows_subsystem // static members only
@@ -51,31 +54,71 @@ private:
     static ::HHOOK llMouseHook;
     static int64_t ll_mouse_proc(int32_t code, uint64_t wParam, int64_t lParam);
 
+public:
+    // USED AT APP STARTUP
+    // public initialize_keyboard_hook(): Reports every key event, flagging the ones xti injected itself.
+    // see cpp file for more info.
+    typedef void (*key_event_callback)(void* context, uint16_t virtualKeyCode, bool keyUp, bool injectedByXti, bool xtiSettled);
+    static void initialize_keyboard_hook(key_event_callback callback, void* context);
+    static void cleanup_keyboard_hook();
+private:
+    static ::HHOOK llKeyboardHook;
+    static key_event_callback keyEventCallback;
+    static void* keyEventContext;
+    static int64_t ll_keyboard_proc(int32_t code, uint64_t wParam, int64_t lParam);
+
     // public move_active_window(): Moves the current active foreground window above or below the xti keyboard.
     // see cpp file for more info.
 public:
     static void move_active_window(bool above, const app_dimensions& appDimensions);
 
-    // public start_process(): Starts a new process and positioning either above or below the xti keyboard.
+    // public place_window_below(): Puts a window directly underneath another in the z-order, without activating it.
     // see cpp file for more info.
 public:
-    static void start_process(const std::wstring& path, const std::wstring& params, const std::wstring& workingDirectory,
-    const std::wstring& expectedExeName, const std::wstring& expectedTitleName, bool above, const app_dimensions& appDimensions);
+    static void place_window_below(::HWND window, ::HWND above);
+
+    // public is_window(): True if the window still exists, e.g. the one of an instance being replaced.
+    static bool is_window(::HWND window);
 
-    // public is_process_running(): Determines if a process is running within the system.
+    // public terminate_process(): Ends a process xti started, e.g. a replacement instance whose handover failed.
+    // see cpp file for more info.
+    static void terminate_process(int64_t processId);
+
+    // public start_process(): Starts a new process, placed either above or below the xti keyboard if it allows it.
+    // see cpp file for more info.
+public:
+    static bool start_process(const std::wstring& path, const std::wstring& params, const std::wstring& workingDirectory,
+                              bool above, const app_dimensions& appDimensions, ::HANDLE& processOut);
+
+    // public track_launch(): Places the window of a started process once it appears. UI thread only.
     // see cpp file for more info.
 public:
-    static bool is_process_running(const std::wstring& processName);
+    static void set_launch_callback(app_launcher::launch_callback callback, void* context);
+    static void set_window_placer(app_launcher::place_function placer, void* context);
+    static void track_launch(::HANDLE process, const std::wstring& expectedExeName, const std::wstring& expectedTitleName,
+                             bool above, const app_dimensions& appDimensions);
+
+    // public initialize_worker_thread(): Prepares a background thread for window management calls (COM for the shell).
+    // see cpp file for more info.
+public:
+    static void initialize_worker_thread();
+    static void cleanup_worker_thread();
+
+    // USED AT APP STARTUP
+    // public initialize_window_registry(): Starts tracking top-level windows for get_window().
+    // see cpp file for more info.
+public:
+    static void initialize_window_registry();
+    static void cleanup_window_registry();
+private:
+    static window_registry windowRegistry;
+    static window_event_source* windowSource;
+    static app_launcher* appLauncher;
 
     // public get_window(): Get a window based on specific underlying exe name and title.
     // see cpp file for more info.
 public:
     static ::HWND get_window(const std::wstring& runningExe, const std::wstring& requiredTitleContains /* empty means no requirement*/);
-private:
-    static thread_local std::wstring enumWindowProcExeNameUpper;
-    static thread_local std::wstring enumWindowProcTitleContains;
-    static thread_local ::HWND enumWindowProcHwndOut;
-    static int32_t __stdcall enum_window_proc(::HWND window, int64_t param);
 
     // public move_window(): moves a window either above, or below the xti keyboard.
     // see cpp file for more info.
@@ -86,6 +129,10 @@ public:
     // see cpp file for more info.
 private:
     static std::wstring get_exe_name_from_process_id(uint32_t processId);
+    static process_name_cache processNameCache;
+public:
+    // public get_process_name_cache_stats(): Gets the hit/miss counters of the exe name cache.
+    static process_name_cache_stats get_process_name_cache_stats();
 
 public:
     // public show_exception_to_user(): Shows a message box with given error message.
@@ -98,13 +145,19 @@ public:
     static key_modifiers get_key_modifiers();
 
 public:
-    // public get_focus_window_name(): Gets the current window title that has focus.
+    // public set_foreground_listener(): Gets told when the foreground window, or its title, changes.
+    // see cpp file for more info.
+    static void set_foreground_listener(window_registry::foreground_listener listener, void* context);
+
+public:
+    // public get_key_repeat_timing(): Gets the keyboard repeat delay and rate set in the Windows keyboard settings.
     // see cpp file for more info.
-    static std::wstring get_focus_window_name();
+    static void get_key_repeat_timing(int64_t& delayNsOut, int64_t& intervalNsOut);
 
 public:
-    // public get_mouse_speed(): Gets the current mouse sensitivity setting. Value from 1 to 20.
-    static int32_t get_mouse_speed();
+    // public get_foreground_keyboard_layout(): Gets the keyboard layout of the window that receives typed keys.
+    // see cpp file for more info.
+    static ::HKL get_foreground_keyboard_layout();
 };
 
 #endif // WINDOWS_SUBSYSTEM_H
@@ -0,0 +1,198 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "windows_window_source.h"
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <memory>
+// 4. Project classes
+#include "error_reporter.h"
+
+/* public */ windows_window_source::windows_window_source(process_name_cache* processNames)
+    : m_processNames(processNames)
+{
+    m_ownProcessId = ::GetCurrentProcessId();
+}
+
+/* public */ windows_window_source::~windows_window_source()
+{
+    stop();
+}
+
+// --- start(): Reports every existing top-level window, then hooks window changes.
+// ----- sink: Receives the windows and changes. Must outlive stop().
+// --------------------------------------------------------------------------------------------/
+/* public */ void windows_window_source::start(window_event_sink* sink)
+{
+    m_sink = sink;
+    activeSource = this;
+    // Hooks first, so nothing created during the enumeration is missed. Duplicates are fine, the registry upserts.
+    m_lifetimeHook = ::SetWinEventHook(EVENT_OBJECT_CREATE, EVENT_OBJECT_HIDE, nullptr, win_event_proc, 0, 0,
+                                       WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
+    if (m_lifetimeHook == nullptr)
+    {
+        error_reporter::stop(__FILE__, __LINE__, "Win32::SetWinEventHook() failure.");
+    }
+    // Separate hook for name changes, a range up to it would also take the very chatty location changes.
+    m_nameHook = ::SetWinEventHook(EVENT_OBJECT_NAMECHANGE, EVENT_OBJECT_NAMECHANGE, nullptr, win_event_proc, 0, 0,
+                                   WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
+    if (m_nameHook == nullptr)
+    {
+        error_reporter::stop(__FILE__, __LINE__, "Win32::SetWinEventHook() failure.");
+    }
+    // Includes xti's own process, so the foreground moving onto one of xti's windows still gets reported.
+    m_foregroundHook = ::SetWinEventHook(EVENT_SYSTEM_FOREGROUND, EVENT_SYSTEM_FOREGROUND, nullptr, win_event_proc, 0, 0,
+                                         WINEVENT_OUTOFCONTEXT);
+    if (m_foregroundHook == nullptr)
+    {
+        error_reporter::stop(__FILE__, __LINE__, "Win32::SetWinEventHook() failure.");
+    }
+    // Throwing away return value here, can return 0 if the enumeration stops early. Rely on GetLastError instead as documentation suggests.
+    ::SetLastError(ERROR_SUCCESS);
+    ::EnumWindows(enum_windows_proc, 0);
+    uint32_t errCode = ::GetLastError();
+    if (errCode != ERROR_SUCCESS)
+    {
+        error_reporter::stop(__FILE__, __LINE__, "Win32::EnumWindows() failure.");
+    }
+    m_sink->on_foreground_changed(reinterpret_cast<window_id>(::GetForegroundWindow()));
+}
+
+/* public */ void windows_window_source::stop()
+{
+    if (m_lifetimeHook != nullptr)
+    {
+        ::UnhookWinEvent(m_lifetimeHook);
+        m_lifetimeHook = nullptr;
+    }
+    if (m_nameHook != nullptr)
+    {
+        ::UnhookWinEvent(m_nameHook);
+        m_nameHook = nullptr;
+    }
+    if (m_foregroundHook != nullptr)
+    {
+        ::UnhookWinEvent(m_foregroundHook);
+        m_foregroundHook = nullptr;
+    }
+    if (activeSource == this)
+    {
+        activeSource = nullptr;
+    }
+    m_sink = nullptr;
+}
+
+// --- get_window_title(): Gets a window's title.
+// ----- window: The window.
+// ------- returns: The title, empty if it has none or it can't be read (not initialized yet, or privileged).
+// --------------------------------------------------------------------------------------------/
+/* public */ std::wstring windows_window_source::get_window_title(::HWND window)
+{
+    ::SetLastError(ERROR_SUCCESS); // GetWindowTextLengthW needs SetLastError set first.
+    int32_t windowTitleLength = ::GetWindowTextLengthW(window);
+    if (windowTitleLength == 0)
+    {
+        // Either no title or the window is already gone, neither is an error here.
+        return L"";
+    }
+    std::unique_ptr<wchar_t[]> windowTitle = std::make_unique<wchar_t[]>(windowTitleLength + 1);
+    int32_t r = ::GetWindowTextW(window, windowTitle.get(), windowTitleLength + 1);
+    if (r == 0)
+    {
+        return L"";
+    }
+    return windowTitle.get();
+}
+
+/* private */ windows_window_source* windows_window_source::activeSource = nullptr;
+
+/* private */ bool windows_window_source::describe(::HWND window, window_info& info) const
+{
+    uint32_t processId = 0;
+    uint32_t rDword = ::GetWindowThreadProcessId(window, reinterpret_cast<::DWORD*>(&processId));
+    if (rDword == 0 || processId == m_ownProcessId)
+    {
+        // Already destroyed, or one of xti's own windows.
+        return false;
+    }
+    info.id = reinterpret_cast<window_id>(window);
+    info.processId = processId;
+    info.exeNameUpper = m_processNames->get_exe_name(processId);
+    info.title = get_window_title(window);
+    info.visible = ::IsWindowVisible(window) != 0;
+    return true;
+}
+
+/* private */ int32_t __stdcall windows_window_source::enum_windows_proc(::HWND window, [[maybe_unused]] int64_t param)
+{
+    window_info info;
+    if (activeSource != nullptr && activeSource->describe(window, info))
+    {
+        activeSource->m_sink->on_window_created(info);
+    }
+    ::SetLastError(ERROR_SUCCESS);
+    return true;
+}
+
+/* private */ void __stdcall windows_window_source::win_event_proc([[maybe_unused]] ::HWINEVENTHOOK hook, ::DWORD event, ::HWND window,
+                                                                  ::LONG objectId, ::LONG childId,
+                                                                  [[maybe_unused]] ::DWORD eventThread, [[maybe_unused]] ::DWORD eventTime)
+{
+    // Only the windows themselves, not their child objects (carets, scroll bars, list items...).
+    if (activeSource == nullptr || window == nullptr || objectId != OBJID_WINDOW || childId != CHILDID_SELF)
+    {
+        return;
+    }
+    window_id id = reinterpret_cast<window_id>(window);
+    if (event == EVENT_SYSTEM_FOREGROUND)
+    {
+        // xti's own windows aren't in the registry, it reports them as unknown.
+        activeSource->m_sink->on_foreground_changed(id);
+        return;
+    }
+    if (event == EVENT_OBJECT_DESTROY)
+    {
+        // Can't ask a destroyed window whether it was top-level, the registry ignores ids it doesn't know.
+        activeSource->m_sink->on_window_destroyed(id);
+        // Most processes exit around their last window closing, let go of the ones that have.
+        activeSource->m_processNames->evict_exited();
+        return;
+    }
+    if (::GetAncestor(window, GA_PARENT) != ::GetDesktopWindow())
+    {
+        return;
+    }
+    switch (event)
+    {
+    case EVENT_OBJECT_CREATE:
+    {
+        window_info info;
+        if (activeSource->describe(window, info))
+        {
+            activeSource->m_sink->on_window_created(info);
+        }
+        break;
+    }
+    case EVENT_OBJECT_SHOW:
+    case EVENT_OBJECT_HIDE:
+        activeSource->m_sink->on_window_visibility(id, event == EVENT_OBJECT_SHOW);
+        break;
+    case EVENT_OBJECT_NAMECHANGE:
+        activeSource->m_sink->on_window_renamed(id, get_window_title(window));
+        break;
+    }
+}
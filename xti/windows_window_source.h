@@ -0,0 +1,61 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef WINDOWS_WINDOW_SOURCE_H
+#define WINDOWS_WINDOW_SOURCE_H
+
+// 1. Qt framework headers
+// 2. System/OS headers
+#include <Windows.h>
+// 3. C++ standard library headers
+#include <cstdint>
+#include <string>
+// 4. Project classes
+#include "window_registry.h"
+#include "process_name_cache.h"
+// 5. Forward decl
+
+// window_event_source for the real desktop. Existing windows (and the current foreground window) come from one EnumWindows pass,
+// changes from out-of-context WinEvent hooks, which the OS delivers through the message loop of the thread that
+// called start(). Only one instance may be started at a time.
+class windows_window_source : public window_event_source
+{
+public:
+    explicit windows_window_source(process_name_cache* processNames);
+    virtual ~windows_window_source();
+
+    virtual void start(window_event_sink* sink) override;
+    virtual void stop() override;
+
+    // public get_window_title(): Gets a window's title, empty if it has none or it can't be read.
+    // see cpp file for more info.
+    static std::wstring get_window_title(::HWND window);
+
+private:
+    static windows_window_source* activeSource;
+    process_name_cache* m_processNames;
+    window_event_sink* m_sink = nullptr;
+    ::HWINEVENTHOOK m_lifetimeHook = nullptr;
+    ::HWINEVENTHOOK m_nameHook = nullptr;
+    ::HWINEVENTHOOK m_foregroundHook = nullptr;
+    uint32_t m_ownProcessId = 0;
+
+    bool describe(::HWND window, window_info& info) const;
+    static int32_t __stdcall enum_windows_proc(::HWND window, int64_t param);
+    static void __stdcall win_event_proc(::HWINEVENTHOOK hook, ::DWORD event, ::HWND window, ::LONG objectId, ::LONG childId,
+                                         ::DWORD eventThread, ::DWORD eventTime);
+};
+
+#endif // WINDOWS_WINDOW_SOURCE_H
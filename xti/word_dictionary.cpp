@@ -0,0 +1,526 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "word_dictionary.h"
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
+// 4. Project classes
+
+static constexpr uint8_t dictionaryMagic[] = { 'X', 'T', 'W', 2 }; // the last byte is the format version
+static constexpr size_t headerSize = sizeof(dictionaryMagic) + 4 * sizeof(uint32_t);
+
+static void write_u32(std::vector<uint8_t>& bytes, uint32_t value)
+{
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        bytes.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+static uint32_t read_u32(const uint8_t* data)
+{
+    return static_cast<uint32_t>(data[0]) | static_cast<uint32_t>(data[1]) << 8 |
+           static_cast<uint32_t>(data[2]) << 16 | static_cast<uint32_t>(data[3]) << 24;
+}
+
+static void write_varint(std::vector<uint8_t>& bytes, uint32_t value)
+{
+    while (value >= 0x80)
+    {
+        bytes.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    bytes.push_back(static_cast<uint8_t>(value));
+}
+
+static bool read_varint(const uint8_t* data, uint32_t size, uint32_t& offset, uint32_t& valueOut)
+{
+    valueOut = 0;
+    for (uint32_t shift = 0; shift < 32; shift += 7)
+    {
+        if (offset >= size)
+        {
+            return false;
+        }
+        uint8_t byte = data[offset++];
+        valueOut |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Case is folded for ASCII letters only, so a folded word has the same length and UTF-8 is left whole.
+static uint8_t fold_case(uint8_t byte)
+{
+    return byte >= 'A' && byte <= 'Z' ? static_cast<uint8_t>(byte + 0x20) : byte;
+}
+
+// Orders a word against an already folded key as if the word was folded too, <0, 0 or >0 like memcmp.
+static int32_t compare_folded(const uint8_t* word, size_t length, const std::string& key)
+{
+    size_t common = std::min(length, key.size());
+    for (size_t i = 0; i < common; i++)
+    {
+        uint8_t folded = fold_case(word[i]);
+        uint8_t keyByte = static_cast<uint8_t>(key[i]);
+        if (folded != keyByte)
+        {
+            return folded < keyByte ? -1 : 1;
+        }
+    }
+    return length < key.size() ? -1 : (length > key.size() ? 1 : 0);
+}
+
+static std::string fold_word(const std::string& word)
+{
+    std::string folded = word;
+    for (char& byte : folded)
+    {
+        byte = static_cast<char>(fold_case(static_cast<uint8_t>(byte)));
+    }
+    return folded;
+}
+
+// The order of the dictionary: case folded, then by bytes so "The" and "the" have a fixed order.
+static bool sorts_before(const std::string& a, const std::string& b)
+{
+    size_t common = std::min(a.size(), b.size());
+    for (size_t i = 0; i < common; i++)
+    {
+        uint8_t x = fold_case(static_cast<uint8_t>(a[i]));
+        uint8_t y = fold_case(static_cast<uint8_t>(b[i]));
+        if (x != y)
+        {
+            return x < y;
+        }
+    }
+    return a.size() != b.size() ? a.size() < b.size() : a < b;
+}
+
+// Uppercases the whole word if the prefix was typed in capitals (at least two letters, so a capitalised word does
+// not count), otherwise puts the prefix back as typed. Either way the word starts with exactly what was typed.
+static void apply_typed_case(const std::string& prefix, std::string& word)
+{
+    uint32_t letters = 0;
+    uint32_t upper = 0;
+    for (char byte : prefix)
+    {
+        uint8_t unit = static_cast<uint8_t>(byte);
+        letters += fold_case(unit) >= 'a' && fold_case(unit) <= 'z' ? 1 : 0;
+        upper += unit >= 'A' && unit <= 'Z' ? 1 : 0;
+    }
+    if (letters >= 2 && upper == letters)
+    {
+        for (char& byte : word)
+        {
+            if (byte >= 'a' && byte <= 'z')
+            {
+                byte = static_cast<char>(byte - 0x20);
+            }
+        }
+        return;
+    }
+    word.replace(0, prefix.size(), prefix);
+}
+
+static bool is_word_byte(uint8_t byte)
+{
+    // Any UTF-8 lead or continuation byte counts, so accented and non-Latin words stay whole.
+    return (byte >= 'a' && byte <= 'z') || (byte >= 'A' && byte <= 'Z') || (byte >= '0' && byte <= '9') ||
+           byte == '_' || byte >= 0x80;
+}
+
+/* public */ void word_dictionary_builder::add(const std::string& word, uint64_t count)
+{
+    if (word.empty() || word.size() > maxWordBytes || count == 0)
+    {
+        return;
+    }
+    m_counts[word] += count;
+}
+
+// --- add_text(): Splits text into words and adds one use of each.
+// A word is a run of ASCII letters, digits, _ and non-ASCII UTF-8, so identifiers like m_keyLayout stay whole.
+// Single characters and runs starting with a digit (numbers, hex) are not worth completing and are skipped.
+// ----- text: The text, UTF-8.
+// ----- size: Bytes in text.
+// --------------------------------------------------------------------------------------------/
+/* public */ void word_dictionary_builder::add_text(const char* text, size_t size)
+{
+    size_t start = 0;
+    while (start < size)
+    {
+        if (!is_word_byte(static_cast<uint8_t>(text[start])))
+        {
+            start++;
+            continue;
+        }
+        size_t end = start;
+        while (end < size && is_word_byte(static_cast<uint8_t>(text[end])))
+        {
+            end++;
+        }
+        if (end - start >= 2 && !(text[start] >= '0' && text[start] <= '9'))
+        {
+            add(std::string(text + start, end - start), 1);
+        }
+        start = end;
+    }
+}
+
+// --- build(): Lays out the dictionary file.
+// Words are sorted with ASCII case folded (ties in byte order), so every spelling of a prefix is one range.
+// Little endian throughout: the 4 byte magic, then word count, block count, score tree leaf count and string
+// bytes as uint32_t, then the uint32_t offset of every block into the strings, the score tree, and the strings.
+// A block's first word is stored whole (varint length, bytes), the rest as the length shared with the word
+// before, the length of the rest and its bytes. Scores are 1 + 6 * log2(count), capped at 255.
+// ------- returns: The file contents.
+// --------------------------------------------------------------------------------------------/
+/* public */ std::vector<uint8_t> word_dictionary_builder::build() const
+{
+    std::vector<std::pair<std::string, uint64_t>> words(m_counts.begin(), m_counts.end());
+    std::sort(words.begin(), words.end(), [](const std::pair<std::string, uint64_t>& a, const std::pair<std::string, uint64_t>& b)
+    {
+        return sorts_before(a.first, b.first);
+    });
+    uint32_t wordCount = static_cast<uint32_t>(words.size());
+    uint32_t blockCount = (wordCount + word_dictionary::blockWords - 1) / word_dictionary::blockWords;
+    uint32_t leafCount = 1;
+    while (leafCount < wordCount)
+    {
+        leafCount *= 2;
+    }
+
+    std::vector<uint8_t> tree(2 * static_cast<size_t>(leafCount), 0);
+    for (uint32_t i = 0; i < wordCount; i++)
+    {
+        double score = 1.0 + 6.0 * std::log2(static_cast<double>(words[i].second));
+        tree[leafCount + i] = static_cast<uint8_t>(std::min(score, 255.0));
+    }
+    for (uint32_t node = leafCount - 1; node >= 1; node--)
+    {
+        tree[node] = std::max(tree[2 * node], tree[2 * node + 1]);
+    }
+
+    std::vector<uint8_t> strings;
+    std::vector<uint32_t> blockOffsets;
+    for (uint32_t i = 0; i < wordCount; i++)
+    {
+        const std::string& word = words[i].first;
+        if (i % word_dictionary::blockWords == 0)
+        {
+            blockOffsets.push_back(static_cast<uint32_t>(strings.size()));
+            write_varint(strings, static_cast<uint32_t>(word.size()));
+            strings.insert(strings.end(), word.begin(), word.end());
+            continue;
+        }
+        const std::string& previous = words[i - 1].first;
+        size_t shared = 0;
+        while (shared < word.size() && shared < previous.size() && word[shared] == previous[shared])
+        {
+            shared++;
+        }
+        write_varint(strings, static_cast<uint32_t>(shared));
+        write_varint(strings, static_cast<uint32_t>(word.size() - shared));
+        strings.insert(strings.end(), word.begin() + shared, word.end());
+    }
+
+    std::vector<uint8_t> bytes(dictionaryMagic, dictionaryMagic + sizeof(dictionaryMagic));
+    write_u32(bytes, wordCount);
+    write_u32(bytes, blockCount);
+    write_u32(bytes, leafCount);
+    write_u32(bytes, static_cast<uint32_t>(strings.size()));
+    for (uint32_t offset : blockOffsets)
+    {
+        write_u32(bytes, offset);
+    }
+    bytes.insert(bytes.end(), tree.begin(), tree.end());
+    bytes.insert(bytes.end(), strings.begin(), strings.end());
+    return bytes;
+}
+
+word_dictionary::word_dictionary()
+    : m_data(nullptr)
+    , m_wordCount(0)
+    , m_blockCount(0)
+    , m_leafCount(0)
+    , m_blockOffsets(nullptr)
+    , m_tree(nullptr)
+    , m_strings(nullptr)
+    , m_stringsSize(0)
+{
+}
+
+// --- open(): Checks a dictionary file and starts reading from it.
+// Only the header and block offsets are checked here, the words are bounds checked as they are decoded so a
+// damaged file gives wrong completions at worst.
+// ----- data: The file contents, must stay valid (e.g. mapped) for as long as this dictionary is used.
+// ----- size: Bytes in data.
+// ----- errorOut: Receives a short reason when the file is not usable.
+// ------- returns: True if the file can be used.
+// --------------------------------------------------------------------------------------------/
+/* public */ bool word_dictionary::open(const uint8_t* data, size_t size, std::string& errorOut)
+{
+    *this = word_dictionary();
+    if (size < headerSize || std::memcmp(data, dictionaryMagic, sizeof(dictionaryMagic)) != 0)
+    {
+        errorOut = "not a dictionary file, or from another version of xti_dictc";
+        return false;
+    }
+    uint32_t wordCount = read_u32(data + 4);
+    uint32_t blockCount = read_u32(data + 8);
+    uint32_t leafCount = read_u32(data + 12);
+    uint32_t stringsSize = read_u32(data + 16);
+    uint64_t expectedSize = headerSize + 4 * static_cast<uint64_t>(blockCount) + 2 * static_cast<uint64_t>(leafCount) + stringsSize;
+    if (blockCount != (wordCount + blockWords - 1) / blockWords ||
+        leafCount == 0 || (leafCount & (leafCount - 1)) != 0 || leafCount < wordCount ||
+        expectedSize != size)
+    {
+        errorOut = "dictionary file is truncated or damaged";
+        return false;
+    }
+    m_blockOffsets = data + headerSize;
+    for (uint32_t block = 0; block < blockCount; block++)
+    {
+        if (read_u32(m_blockOffsets + 4 * static_cast<size_t>(block)) >= stringsSize)
+        {
+            errorOut = "dictionary file is truncated or damaged";
+            m_blockOffsets = nullptr;
+            return false;
+        }
+    }
+    m_data = data;
+    m_wordCount = wordCount;
+    m_blockCount = blockCount;
+    m_leafCount = leafCount;
+    m_tree = m_blockOffsets + 4 * static_cast<size_t>(blockCount);
+    m_strings = m_tree + 2 * static_cast<size_t>(leafCount);
+    m_stringsSize = stringsSize;
+    return true;
+}
+
+/* private */ uint32_t word_dictionary::get_block_offset(uint32_t block) const
+{
+    return read_u32(m_blockOffsets + 4 * static_cast<size_t>(block));
+}
+
+// --- decode(): Decodes words of a block in order, stopping at the first one visit() returns false for.
+// ----- block: The block to decode.
+// ----- visit: Called as visit(index, word) with each word's index in the whole dictionary.
+// ------- returns: False if the block is damaged.
+// --------------------------------------------------------------------------------------------/
+template <typename Visit>
+/* private */ bool word_dictionary::decode(uint32_t block, Visit visit) const
+{
+    uint32_t offset = get_block_offset(block);
+    uint32_t first = block * blockWords;
+    uint32_t last = std::min(first + blockWords, m_wordCount);
+    m_scratch.clear();
+    for (uint32_t index = first; index < last; index++)
+    {
+        uint32_t shared = 0;
+        uint32_t length = 0;
+        if ((index != first && !read_varint(m_strings, m_stringsSize, offset, shared)) ||
+            !read_varint(m_strings, m_stringsSize, offset, length) ||
+            shared > m_scratch.size() || length > m_stringsSize - offset)
+        {
+            return false;
+        }
+        m_scratch.resize(shared);
+        m_scratch.append(reinterpret_cast<const char*>(m_strings + offset), length);
+        offset += length;
+        if (!visit(index, m_scratch))
+        {
+            break;
+        }
+    }
+    return true;
+}
+
+// --- lower_bound(): Finds the first word not sorting before key, in the case folded order of build().
+// Binary search over each block's first word (stored whole, so compared in place), then a walk through one block.
+// ----- key: The word to search for, already case folded.
+// ------- returns: The word's index, m_wordCount if every word sorts before key.
+// --------------------------------------------------------------------------------------------/
+/* private */ uint32_t word_dictionary::lower_bound(const std::string& key) const
+{
+    // The last block whose first word is <= key, the answer lies in it or is the first word of the next.
+    uint32_t low = 0;
+    uint32_t high = m_blockCount;
+    while (low < high)
+    {
+        uint32_t middle = low + (high - low) / 2;
+        uint32_t offset = get_block_offset(middle);
+        uint32_t length = 0;
+        if (!read_varint(m_strings, m_stringsSize, offset, length) || length > m_stringsSize - offset)
+        {
+            return m_wordCount;
+        }
+        if (compare_folded(m_strings + offset, length, key) > 0)
+        {
+            high = middle;
+        }
+        else
+        {
+            low = middle + 1;
+        }
+    }
+    if (low == 0)
+    {
+        return 0;
+    }
+    uint32_t block = low - 1;
+    uint32_t found = std::min((block + 1) * blockWords, m_wordCount);
+    decode(block, [&key, &found](uint32_t index, const std::string& word)
+    {
+        if (compare_folded(reinterpret_cast<const uint8_t*>(word.data()), word.size(), key) >= 0)
+        {
+            found = index;
+            return false;
+        }
+        return true;
+    });
+    return found;
+}
+
+// --- complete(): Finds the most frequent words that start with prefix, ignoring ASCII case.
+// The words starting with prefix are one sorted range. The tree nodes covering that range are searched best first,
+// each pop either yields the next best word (a leaf) or opens up the two halves below it. Each word is given the
+// case of the prefix (see apply_typed_case()), so "The" and "the" in the corpus are one completion of "Th".
+// ----- prefix: What has been typed of the word so far, UTF-8. The prefix itself is never returned as a completion.
+// ----- k: Most completions wanted.
+// ----- completionsOut: Receives up to k distinct completions starting with prefix byte for byte, most frequent
+// -----                 first, ties in sorted order.
+// --------------------------------------------------------------------------------------------/
+/* public */ void word_dictionary::complete(const std::string& prefix, uint32_t k, std::vector<word_completion>& completionsOut) const
+{
+    completionsOut.clear();
+    if (m_wordCount == 0 || prefix.empty() || prefix.size() >= word_dictionary_builder::maxWordBytes || k == 0)
+    {
+        return; // no word is longer than maxWordBytes, so a prefix that long has no completion
+    }
+    std::string folded = fold_word(prefix);
+    uint32_t first = lower_bound(folded);
+    // Everything before the prefix with its last byte incremented starts with it, 0xFF bytes carry over.
+    std::string next = folded;
+    while (!next.empty() && static_cast<uint8_t>(next.back()) == 0xFF)
+    {
+        next.pop_back();
+    }
+    uint32_t end = m_wordCount;
+    if (!next.empty())
+    {
+        next.back() = static_cast<char>(static_cast<uint8_t>(next.back()) + 1);
+        end = lower_bound(next);
+    }
+    if (first >= end)
+    {
+        return;
+    }
+
+    struct candidate
+    {
+        uint8_t score;
+        uint32_t start; // first word under the node, breaks ties in sorted order
+        uint32_t node;
+    };
+    auto worse = [](const candidate& a, const candidate& b) { return a.score < b.score || (a.score == b.score && a.start > b.start); };
+    std::vector<candidate> heap;
+    auto push = [this, &heap, &worse](uint32_t node, uint32_t start)
+    {
+        if (m_tree[node] != 0)
+        {
+            heap.push_back({ m_tree[node], start, node });
+            std::push_heap(heap.begin(), heap.end(), worse);
+        }
+    };
+    // Canonical cover of [first, end), every node fully inside it.
+    uint32_t low = first + m_leafCount;
+    uint32_t high = end + m_leafCount;
+    uint32_t width = 1;
+    for (; low < high; low /= 2, high /= 2, width *= 2)
+    {
+        if ((low & 1) != 0)
+        {
+            push(low, (low * width) - m_leafCount);
+            low++;
+        }
+        if ((high & 1) != 0)
+        {
+            high--;
+            push(high, (high * width) - m_leafCount);
+        }
+    }
+
+    while (!heap.empty() && completionsOut.size() < k)
+    {
+        std::pop_heap(heap.begin(), heap.end(), worse);
+        candidate best = heap.back();
+        heap.pop_back();
+        if (best.node >= m_leafCount)
+        {
+            add_completion(prefix, best.node - m_leafCount, completionsOut);
+            continue;
+        }
+        uint32_t halfWidth = 1;
+        for (uint32_t node = best.node; node < m_leafCount / 2; node *= 2)
+        {
+            halfWidth *= 2;
+        }
+        push(2 * best.node, best.start);
+        push(2 * best.node + 1, best.start + halfWidth);
+    }
+}
+
+// --- add_completion(): Adds a word given the case of the prefix, unless it is the prefix itself or already there.
+// ----- prefix: As passed to complete().
+// ----- index: The word's index in the whole dictionary.
+// ----- completionsOut: Receives the completion at its end.
+// --------------------------------------------------------------------------------------------/
+/* private */ void word_dictionary::add_completion(const std::string& prefix, uint32_t index, std::vector<word_completion>& completionsOut) const
+{
+    word_completion completion = { std::string(), m_tree[m_leafCount + index] };
+    decode(index / blockWords, [index, &completion](uint32_t decoded, const std::string& word)
+    {
+        if (decoded == index)
+        {
+            completion.word = word;
+            return false;
+        }
+        return true;
+    });
+    if (completion.word.size() <= prefix.size())
+    {
+        return;
+    }
+    apply_typed_case(prefix, completion.word);
+    for (const word_completion& existing : completionsOut)
+    {
+        if (existing.word == completion.word)
+        {
+            return; // the same word in another case, which scored higher
+        }
+    }
+    completionsOut.push_back(std::move(completion));
+}
@@ -0,0 +1,105 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef WORD_DICTIONARY_H
+#define WORD_DICTIONARY_H
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+// 4. Project classes
+// 5. Forward decl
+
+struct word_completion
+{
+    std::string word; // UTF-8, the prefix as typed followed by the rest of the word from the corpus
+    uint8_t score; // log scaled frequency, higher is more frequent
+};
+
+// Lays out the dictionary file read by word_dictionary, from a word list with counts or from plain text.
+// Used offline by xti_dictc and by the benchmarks, never by the keyboard itself.
+class word_dictionary_builder
+{
+public:
+    static constexpr size_t maxWordBytes = 64;
+
+    // public add(): Adds count uses of a word, empty words and words over maxWordBytes are ignored.
+    void add(const std::string& word, uint64_t count);
+
+    // public add_text(): Splits text into words and adds one use of each.
+    // see cpp file for more info.
+    void add_text(const char* text, size_t size);
+
+    size_t get_word_count() const { return m_counts.size(); }
+
+    // public build(): Lays out the dictionary file.
+    // see cpp file for more info.
+    std::vector<uint8_t> build() const;
+
+private:
+    std::unordered_map<std::string, uint64_t> m_counts;
+};
+
+// Prefix completion over a dictionary file from word_dictionary_builder, read in place so the file can be memory
+// mapped and costs no parsing or heap. The file holds the words sorted with ASCII case folded and front coded in
+// blocks of blockWords, and a tree of subtree maximum scores over them, so the k best completions of any prefix
+// are found in O(log n + k log n) without looking at the words in between. Used from one thread at a time.
+class word_dictionary
+{
+public:
+    static constexpr uint32_t blockWords = 16;
+
+    word_dictionary();
+
+    // public open(): Checks a dictionary file and starts reading from it.
+    // see cpp file for more info.
+    bool open(const uint8_t* data, size_t size, std::string& errorOut);
+
+    uint32_t get_word_count() const { return m_wordCount; }
+
+    // public complete(): Finds the most frequent words that start with prefix, ignoring ASCII case.
+    // see cpp file for more info.
+    void complete(const std::string& prefix, uint32_t k, std::vector<word_completion>& completionsOut) const;
+
+private:
+    const uint8_t* m_data;
+    uint32_t m_wordCount;
+    uint32_t m_blockCount;
+    uint32_t m_leafCount; // leaves of the score tree, wordCount rounded up to a power of 2
+    const uint8_t* m_blockOffsets; // uint32_t per block, little endian
+    const uint8_t* m_tree; // 2 * m_leafCount scores, node n has children 2n and 2n + 1, leaf i is node m_leafCount + i
+    const uint8_t* m_strings;
+    uint32_t m_stringsSize;
+    mutable std::string m_scratch; // decoded word, reused between calls
+
+    uint32_t get_block_offset(uint32_t block) const;
+    uint32_t lower_bound(const std::string& key) const;
+
+    // private add_completion(): Adds a word given the case of the prefix, unless it is the prefix itself or already there.
+    // see cpp file for more info.
+    void add_completion(const std::string& prefix, uint32_t index, std::vector<word_completion>& completionsOut) const;
+
+    // private decode(): Decodes words of a block in order, stopping at the first one visit() returns false for.
+    // see cpp file for more info.
+    template <typename Visit>
+    bool decode(uint32_t block, Visit visit) const;
+};
+
+#endif // WORD_DICTIONARY_H
@@ -0,0 +1,679 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// Micro-benchmarks for the hot paths in xti_core, so per-operation cost can be compared release to release.
+// Every benchmark runs a fixed batch of operations 7 times and reports the median and fastest ns/op.
+// usage: xti_bench [filter] [corpus]   only runs benchmarks whose name contains filter, word completion is measured
+//                                     on the words of corpus (any text file) instead of a synthetic dictionary
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+// 4. Project classes
+#include "app_config.h"
+#include "cursor_motion.h"
+#include "hit_index.h"
+#include "input_worker.h"
+#include "key_chord.h"
+#include "key_layout.h"
+#include "key_mapping.h"
+#include "latency_histogram.h"
+#include "latency_recorder.h"
+#include "modifier_state.h"
+#include "pointer_ballistics.h"
+#include "process_registry.h"
+#include "recording_input_sink.h"
+#include "spsc_ring.h"
+#include "text_injector.h"
+#include "touch_trace.h"
+#include "window_executor.h"
+#include "window_registry.h"
+#include "word_dictionary.h"
+
+// Results are folded in here so the optimizer cannot drop the work being measured.
+static volatile uint64_t benchSink;
+
+static const char* benchFilter = nullptr;
+static const char* benchCorpus = nullptr;
+
+static int64_t now_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Runs body (which performs opsPerRun operations) once to warm up, then 7 timed times.
+template <typename Body>
+static void run_bench(const char* name, uint64_t opsPerRun, Body body)
+{
+    if (benchFilter != nullptr && std::strstr(name, benchFilter) == nullptr)
+    {
+        return;
+    }
+    static constexpr uint32_t runs = 7;
+    body();
+    double nsPerOp[runs];
+    for (uint32_t run = 0; run < runs; run++)
+    {
+        int64_t start = now_ns();
+        body();
+        nsPerOp[run] = static_cast<double>(now_ns() - start) / static_cast<double>(opsPerRun);
+    }
+    std::sort(nsPerOp, nsPerOp + runs);
+    std::printf("%-52s %10.1f ns/op  (min %8.1f)  %14.0f ops/s\n", name, nsPerOp[runs / 2], nsPerOp[0], 1e9 / nsPerOp[runs / 2]);
+}
+
+// Roughly the xti layout: 150 keys of 60x60 px with 4 px gaps.
+static std::vector<hit_rect> make_keyboard_rects()
+{
+    std::vector<hit_rect> rects;
+    for (int32_t row = 0; row < 10; row++)
+    {
+        for (int32_t column = 0; column < 15; column++)
+        {
+            int32_t left = column * 64;
+            int32_t top = row * 64;
+            rects.push_back({ left, top, left + 60, top + 60 });
+        }
+    }
+    return rects;
+}
+
+static void bench_keys()
+{
+    static constexpr uint64_t ops = 100000;
+    run_bench("key_mapping::get_action + build_press", ops, []() {
+        uint64_t total = 0;
+        for (uint64_t i = 0; i < ops; i++)
+        {
+            const key_action& action = key_mapping::get_action(static_cast<key_id>(i % key_count));
+            key_chord chord = key_chord_builder::build_press(action.virtualKeyCode, action.scanCode, (action.flags & key_action::flagShift) != 0,
+                (action.flags & key_action::flagControl) != 0, (action.flags & key_action::flagAlt) != 0, (action.flags & key_action::flagExtended) != 0);
+            total += chord.count + chord.strokes[0].virtualKeyCode;
+        }
+        benchSink = total;
+    });
+
+    modifier_state modifiers;
+    run_bench("modifier_state::apply_key_event", ops, [&modifiers]() {
+        static constexpr uint16_t keys[] = { VK_LSHIFT, 'A', VK_RCONTROL, VK_CAPITAL };
+        uint64_t changed = 0;
+        for (uint64_t i = 0; i < ops; i++)
+        {
+            changed += modifiers.apply_key_event(keys[i % 4], (i & 4) != 0) ? 1 : 0;
+        }
+        benchSink = changed;
+    });
+    run_bench("modifier_state::reconcile (one stuck key)", ops, [&modifiers]() {
+        key_stroke corrections[modifier_state::maxCorrections];
+        uint64_t total = 0;
+        for (uint64_t i = 0; i < ops; i++)
+        {
+            // An LMENU down xti injected whose key-up never arrived, released again by the correction.
+            modifiers.apply_hooked_key_event(VK_LMENU, false, true);
+            total += modifiers.reconcile(corrections);
+            modifiers.apply_hooked_key_event(VK_LMENU, true, true);
+        }
+        benchSink = total;
+    });
+}
+
+static void bench_geometry()
+{
+    std::vector<hit_rect> rects = make_keyboard_rects();
+    hit_index index;
+    index.rebuild(rects.data(), static_cast<uint32_t>(rects.size()));
+    std::mt19937 random(42);
+    std::uniform_int_distribution<int32_t> xs(0, 15 * 64);
+    std::uniform_int_distribution<int32_t> ys(0, 10 * 64);
+    std::vector<int32_t> points;
+    for (uint32_t i = 0; i < 4096; i++)
+    {
+        points.push_back(xs(random));
+        points.push_back(ys(random));
+    }
+    static constexpr uint64_t ops = 100000;
+    run_bench("hit_index::hit_test (150 keys, snap)", ops, [&index, &points]() {
+        int64_t total = 0;
+        for (uint64_t i = 0; i < ops; i++)
+        {
+            size_t p = (i & 4095) * 2;
+            total += index.hit_test(points[p], points[p + 1], true);
+        }
+        benchSink = static_cast<uint64_t>(total);
+    });
+    run_bench("hit_index::rebuild (150 keys)", 1000, [&index, &rects]() {
+        for (uint32_t i = 0; i < 1000; i++)
+        {
+            index.rebuild(rects.data(), static_cast<uint32_t>(rects.size()));
+        }
+        benchSink = index.size();
+    });
+}
+
+static void bench_touchpad()
+{
+    static constexpr uint64_t ops = 100000;
+    pointer_ballistics ballistics;
+    ballistics.set_base_gain(1.0);
+    run_bench("pointer_ballistics::add_sample", ops, [&ballistics]() {
+        ballistics.reset(0);
+        int64_t total = 0;
+        for (uint64_t i = 0; i < ops; i++)
+        {
+            int32_t dx = 0;
+            int32_t dy = 0;
+            ballistics.add_sample(static_cast<double>(i % 7) - 3.0, 1.5, i * 8, dx, dy);
+            total += dx + dy;
+        }
+        benchSink = static_cast<uint64_t>(total);
+    });
+    cursor_motion motion;
+    run_bench("cursor_motion::add_sample + take_move", ops, [&motion]() {
+        motion.reset();
+        int64_t total = 0;
+        for (uint64_t i = 0; i < ops; i++)
+        {
+            motion.add_sample(0.7, -0.3);
+            int32_t dx = 0;
+            int32_t dy = 0;
+            if (motion.take_move(dx, dy))
+            {
+                total += dx + dy;
+            }
+        }
+        benchSink = static_cast<uint64_t>(total);
+    });
+}
+
+static void bench_queues()
+{
+    static constexpr uint64_t ops = 100000;
+    static spsc_ring<mouse_stroke, 256> ring;
+    run_bench("spsc_ring push + pop_batch(64), one thread", ops, []() {
+        mouse_stroke out[64];
+        uint64_t total = 0;
+        for (uint64_t i = 0; i < ops; i += 64)
+        {
+            for (uint32_t j = 0; j < 64; j++)
+            {
+                ring.try_push({ mouse_stroke::flagMove, 1, static_cast<int32_t>(j), 0 });
+            }
+            total += ring.pop_batch(out, 64);
+        }
+        benchSink = total;
+    });
+
+    // The UI thread's cost of handing a mouse event to the worker, including the wake, with the worker injecting
+    // into a sink that does nothing. Latency recording is on, as in the app.
+    recording_input_sink sink;
+    latency_recorder latency;
+    input_worker worker(&sink, &latency);
+    run_bench("input_worker::post_mouse -> recording sink", ops, [&worker, &sink]() {
+        uint64_t target = sink.get_mouse_strokes() + ops;
+        latency_mark mark = { 0, latency_recorder::now_ns(), latency_recorder::now_ns() };
+        for (uint64_t i = 0; i < ops; i++)
+        {
+            while (!worker.post_mouse({ mouse_stroke::flagMove, 1, 0, 0 }, kind_move, mark))
+            {
+                std::this_thread::yield();
+            }
+        }
+        while (sink.get_mouse_strokes() < target)
+        {
+            std::this_thread::yield();
+        }
+        benchSink = sink.get_mouse_strokes();
+    });
+}
+
+static void bench_latency()
+{
+    static constexpr uint64_t ops = 1000000;
+    static latency_histogram histogram;
+    run_bench("latency_histogram::record", ops, []() {
+        for (uint64_t i = 0; i < ops; i++)
+        {
+            histogram.record(static_cast<int64_t>((i * 2654435761u) & 0xFFFFFF));
+        }
+        benchSink = histogram.get_max();
+    });
+    static latency_recorder recorder;
+    run_bench("latency_recorder::record (5 stages)", ops, []() {
+        latency_mark mark = { 1000, 2000000, 2050000 };
+        for (uint64_t i = 0; i < ops; i++)
+        {
+            int64_t start = 2100000 + static_cast<int64_t>(i & 0xFFFF);
+            recorder.record(kind_key, mark, start, start + 20000);
+        }
+        benchSink = recorder.get_histogram(kind_key, stage_total).get_max();
+    });
+    run_bench("latency_histogram::get_percentile", 1000, []() {
+        uint64_t total = 0;
+        for (uint32_t i = 0; i < 1000; i++)
+        {
+            total += histogram.get_percentile(99.9);
+        }
+        benchSink = total;
+    });
+}
+
+static void bench_trace()
+{
+    static constexpr uint64_t frames = 10000;
+    std::vector<touch_trace_frame> source;
+    for (uint64_t i = 0; i < frames; i++)
+    {
+        touch_trace_frame frame = {};
+        frame.type = touch_trace_frame::typeUpdate;
+        frame.timestampMs = 1000000 + i * 8;
+        frame.points.push_back({ 0, 2, static_cast<int32_t>(i * 37 % 4000), static_cast<int32_t>(i * 11 % 4000) });
+        if (i % 4 == 0)
+        {
+            frame.points.push_back({ 1, 4, 8000, 9000 });
+        }
+        source.push_back(frame);
+    }
+    std::vector<uint8_t> encoded;
+    run_bench("touch_trace_writer::add_frame + finish", frames, [&source, &encoded]() {
+        touch_trace_writer writer;
+        for (const touch_trace_frame& frame : source)
+        {
+            writer.add_frame(frame);
+        }
+        encoded = writer.finish();
+        benchSink = encoded.size();
+    });
+    run_bench("touch_trace_reader::next", frames, [&encoded]() {
+        touch_trace_reader reader(encoded.data(), encoded.size());
+        touch_trace_frame frame;
+        uint64_t points = 0;
+        while (reader.next(frame))
+        {
+            points += frame.points.size();
+        }
+        benchSink = points;
+    });
+}
+
+static std::wstring make_exe_name(uint32_t index)
+{
+    return L"APP" + std::to_wstring(index) + L".EXE";
+}
+
+static void bench_window_registry(uint32_t windowCount)
+{
+    // Most machines run a few dozen apps, each owning many (mostly hidden) top-level windows.
+    static constexpr uint32_t exeCount = 200;
+    window_registry registry;
+    for (uint32_t i = 0; i < windowCount; i++)
+    {
+        window_info info = { 0x10000 + i, 1000 + i % exeCount, make_exe_name(i % exeCount), L"Document " + std::to_wstring(i), i % 3 == 0 };
+        registry.on_window_created(info);
+    }
+    std::vector<std::wstring> exeNames;
+    for (uint32_t i = 0; i < exeCount; i++)
+    {
+        exeNames.push_back(make_exe_name(i));
+    }
+    static constexpr uint64_t ops = 10000;
+    std::string name = "window_registry::find (" + std::to_string(windowCount) + " windows)";
+    run_bench(name.c_str(), ops, [&registry, &exeNames]() {
+        const std::wstring title = L"Document 3";
+        uint64_t total = 0;
+        for (uint64_t i = 0; i < ops; i++)
+        {
+            total += registry.find(exeNames[i % exeCount], title);
+        }
+        benchSink = total;
+    });
+    name = "window_registry create + destroy (" + std::to_string(windowCount) + " windows)";
+    run_bench(name.c_str(), ops, [&registry, windowCount]() {
+        for (uint64_t i = 0; i < ops; i++)
+        {
+            window_id id = 0x80000000u + static_cast<window_id>(i);
+            registry.on_window_created({ id, 42, L"CHURN.EXE", L"Transient", true });
+            registry.on_window_destroyed(id);
+        }
+        benchSink = registry.size() + windowCount;
+    });
+}
+
+static void bench_process_registry()
+{
+    static constexpr uint32_t processCount = 10000;
+    std::vector<process_entry> snapshotA;
+    std::vector<process_entry> snapshotB;
+    for (uint32_t i = 0; i < processCount; i++)
+    {
+        process_entry entry = { 4 + i * 4, make_exe_name(i % 500) };
+        snapshotA.push_back(entry);
+        // 1% of the processes exit and are replaced by new ones between snapshots.
+        if (i % 100 == 0)
+        {
+            entry.processId += 1000000;
+        }
+        snapshotB.push_back(entry);
+    }
+    process_registry registry;
+    std::vector<uint32_t> removed;
+    static constexpr uint64_t ops = 100;
+    run_bench("process_registry::apply_snapshot (10k, 1% churn)", ops, [&registry, &snapshotA, &snapshotB, &removed]() {
+        uint64_t total = 0;
+        for (uint64_t i = 0; i < ops; i++)
+        {
+            registry.apply_snapshot((i & 1) != 0 ? snapshotB : snapshotA, &removed);
+            total += removed.size();
+        }
+        benchSink = total;
+    });
+    std::vector<std::wstring> exeNames;
+    for (uint32_t i = 0; i < 1000; i++)
+    {
+        exeNames.push_back(make_exe_name(i));
+    }
+    run_bench("process_registry::is_running (10k)", 100000, [&registry, &exeNames]() {
+        uint64_t running = 0;
+        for (uint64_t i = 0; i < 100000; i++)
+        {
+            running += registry.is_running(exeNames[i % 1000]) ? 1 : 0;
+        }
+        benchSink = running;
+    });
+}
+
+static void bench_window_executor()
+{
+    // Completions run straight on the executor thread here, this measures the queue hand-off itself.
+    std::atomic<uint64_t> completed { 0 };
+    window_executor executor([](std::function<void()> function) { function(); }, []() {}, []() {});
+    static constexpr uint64_t ops = 10000;
+    run_bench("window_executor::submit -> completion", ops, [&executor, &completed]() {
+        uint64_t target = completed.load() + ops;
+        for (uint64_t i = 0; i < ops; i++)
+        {
+            // Key 0 never supersedes, so every request runs.
+            executor.submit(0, []() {}, [&completed]() { completed.fetch_add(1); });
+        }
+        while (completed.load() < target)
+        {
+            std::this_thread::yield();
+        }
+        benchSink = completed.load();
+    });
+}
+
+static void bench_app_config()
+{
+    // A large config, reloaded with one shortcut edited, one added and one removed.
+    static constexpr uint32_t shortcutCount = 200;
+    std::vector<shortcut_config> before;
+    for (uint32_t i = 0; i < shortcutCount; i++)
+    {
+        before.push_back({ make_exe_name(i), L"C:\\apps\\" + make_exe_name(i), L"", L"C:\\apps", make_exe_name(i), L"", true, L"" });
+    }
+    std::vector<shortcut_config> after = before;
+    after[10].startParams = L"--new";
+    after.erase(after.begin() + 50);
+    after.push_back({ L"ADDED", L"C:\\apps\\ADDED.EXE", L"", L"C:\\apps", L"ADDED.EXE", L"", true, L"" });
+    static constexpr uint64_t ops = 100;
+    run_bench("app_config::diff (200 shortcuts, 3 changes)", ops, [&before, &after]() {
+        uint64_t total = 0;
+        for (uint64_t i = 0; i < ops; i++)
+        {
+            total += app_config::diff(before, after).size();
+        }
+        benchSink = total;
+    });
+}
+
+// Accepts and drops every stroke, so the text injection benchmark measures xti and not a growing buffer.
+class discarding_input_sink : public input_sink
+{
+public:
+    virtual uint32_t send_keys(const key_stroke* strokes, uint32_t count) override
+    {
+        benchSink = strokes[count - 1].virtualKeyCode;
+        return count;
+    }
+    virtual uint32_t send_mouse(const mouse_stroke*, uint32_t count) override { return count; }
+};
+
+static void bench_text_injector()
+{
+    // 1 MiB of UTF-16 mixing plain words, CRLF line breaks, tabs, CJK and surrogate pairs.
+    static const std::u16string pattern = u"The quick brown fox\tjumps over \u4E2D\u6587 \U0001F600 the lazy dog.\r\n";
+    std::u16string text;
+    while (text.size() < 512 * 1024)
+    {
+        text += pattern;
+    }
+    discarding_input_sink sink;
+    text_injector injector(&sink);
+    uint64_t characters = injector.inject(text, { 0, 0 }).characters;
+    for (uint32_t charsPerBatch : { 0u, 1000u, 64u })
+    {
+        char name[64];
+        std::snprintf(name, sizeof(name), "text_injector::inject (1 MiB, %u chars/batch)", charsPerBatch);
+        run_bench(name, characters, [&injector, &text, charsPerBatch]() {
+            benchSink = injector.inject(text, { charsPerBatch, 0 }).batches;
+        });
+    }
+}
+
+// The US layout as key_mapping knows it, optionally without the punctuation keys so those fall back to unicode.
+class us_layout_source : public key_layout_source
+{
+public:
+    explicit us_layout_source(bool lettersAndDigitsOnly)
+        : m_lettersAndDigitsOnly(lettersAndDigitsOnly)
+    {
+    }
+    virtual bool find_character(char16_t character, uint16_t& virtualKeyCodeOut, uint8_t& modifiersOut) const override
+    {
+        for (uint32_t i = 0; i < key_count; i++)
+        {
+            if (key_mapping::get_character(static_cast<key_id>(i)) == character)
+            {
+                const key_action& action = key_mapping::get_action(static_cast<key_id>(i));
+                bool letterOrDigit = (action.virtualKeyCode >= 0x30 && action.virtualKeyCode <= 0x39) ||
+                                     (action.virtualKeyCode >= 0x41 && action.virtualKeyCode <= 0x5A);
+                if (m_lettersAndDigitsOnly && !letterOrDigit)
+                {
+                    return false;
+                }
+                virtualKeyCodeOut = action.virtualKeyCode;
+                modifiersOut = action.flags & key_action::flagShift;
+                return true;
+            }
+        }
+        return false;
+    }
+    virtual uint16_t get_scan_code(uint16_t virtualKeyCode) const override
+    {
+        return key_chord_builder::is_extended_key(virtualKeyCode) ? 0xE000 | (virtualKeyCode & 0x7F) : virtualKeyCode & 0x7F;
+    }
+
+private:
+    bool m_lettersAndDigitsOnly;
+};
+
+static void bench_key_layout()
+{
+    us_layout_source us(false);
+    us_layout_source lettersOnly(true);
+    key_layout layout;
+    static constexpr uint64_t buildOps = 100;
+    run_bench("key_layout::build (US)", buildOps, [&layout, &us]() {
+        for (uint64_t i = 0; i < buildOps; i++)
+        {
+            layout.build(us, i + 1);
+        }
+        benchSink = layout.get_unicode_count();
+    });
+    run_bench("key_layout::build (letters only, unicode fallback)", buildOps, [&layout, &lettersOnly]() {
+        for (uint64_t i = 0; i < buildOps; i++)
+        {
+            layout.build(lettersOnly, i + 1);
+        }
+        benchSink = layout.get_unicode_count();
+    });
+
+    // Dispatch costs the same whichever layout is active, half the presses here are unicode.
+    static constexpr uint64_t ops = 100000;
+    run_bench("key_layout::get_action + build chord", ops, [&layout]() {
+        uint64_t total = 0;
+        for (uint64_t i = 0; i < ops; i++)
+        {
+            const key_action& action = layout.get_action(static_cast<key_id>(i % key_count), (i & 64) != 0);
+            key_chord chord = (action.flags & key_action::flagUnicode) != 0 ?
+                key_chord_builder::build_unicode(static_cast<char16_t>(action.virtualKeyCode)) :
+                key_chord_builder::build_press(action.virtualKeyCode, action.scanCode, (action.flags & key_action::flagShift) != 0,
+                    (action.flags & key_action::flagControl) != 0, (action.flags & key_action::flagAlt) != 0,
+                    (action.flags & key_action::flagExtended) != 0);
+            total += chord.count + chord.strokes[0].scanCode;
+        }
+        benchSink = total;
+    });
+}
+
+static void bench_word_dictionary()
+{
+    if (benchFilter != nullptr && std::strstr("word_dictionary", benchFilter) == nullptr)
+    {
+        return;
+    }
+    word_dictionary_builder builder;
+    std::vector<std::string> samples; // words to take query prefixes from
+    if (benchCorpus != nullptr)
+    {
+        std::ifstream file(benchCorpus, std::ios::binary);
+        std::vector<char> text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        builder.add_text(text.data(), text.size());
+        // Words as they come in the text, so frequent words are queried as often as they are typed.
+        auto is_letter = [&text](size_t i) { return (text[i] >= 'a' && text[i] <= 'z') || (text[i] >= 'A' && text[i] <= 'Z'); };
+        size_t step = text.size() / 10000 + 1;
+        for (size_t start = 0; start < text.size(); start += step)
+        {
+            while (start < text.size() && (!is_letter(start) || (start > 0 && is_letter(start - 1))))
+            {
+                start++;
+            }
+            size_t end = start;
+            while (end < text.size() && is_letter(end))
+            {
+                end++;
+            }
+            if (end - start >= 2)
+            {
+                samples.push_back(std::string(text.data() + start, end - start));
+            }
+            start = end;
+        }
+    }
+    else
+    {
+        // 500k made up words from a syllable alphabet, Zipf distributed counts like a natural language.
+        static const char* syllables[] = { "ka", "to", "ri", "ne", "sa", "mo", "lu", "pe", "chi", "da", "fo", "gu", "ha", "ji",
+                                           "ko", "la", "mi", "no", "pa", "qu", "re", "si", "tu", "va", "we", "xi", "yo", "ze",
+                                           "st", "th", "er", "in", "an", "on", "es", "ti" };
+        static constexpr uint32_t syllableCount = sizeof(syllables) / sizeof(syllables[0]);
+        static constexpr uint32_t wordCount = 500000;
+        std::mt19937 rng(7);
+        uint32_t rank = 0;
+        while (builder.get_word_count() < wordCount)
+        {
+            std::string word;
+            uint32_t length = 2 + rng() % 4;
+            for (uint32_t i = 0; i < length; i++)
+            {
+                word += syllables[rng() % syllableCount];
+            }
+            builder.add(word, 100000000 / (++rank));
+            if (rank % 50 == 0)
+            {
+                samples.push_back(word);
+            }
+        }
+    }
+    int64_t buildStart = now_ns();
+    std::vector<uint8_t> bytes = builder.build();
+    int64_t buildNs = now_ns() - buildStart;
+    word_dictionary dictionary;
+    std::string error;
+    if (!dictionary.open(bytes.data(), bytes.size(), error) || samples.empty())
+    {
+        std::printf("word_dictionary: %s\n", error.empty() ? "no words in corpus" : error.c_str());
+        return;
+    }
+    std::printf("word_dictionary: %u words in %zu bytes (%.1f bytes/word), built in %lld ms\n", dictionary.get_word_count(),
+                bytes.size(), static_cast<double>(bytes.size()) / dictionary.get_word_count(), static_cast<long long>(buildNs / 1000000));
+
+    // Every keystroke of a word queries the prefix typed so far, so prefixes of 1 to 4 characters.
+    std::vector<std::string> prefixes;
+    for (size_t i = 0; i < samples.size(); i++)
+    {
+        prefixes.push_back(samples[i].substr(0, 1 + i % 4));
+    }
+    static constexpr uint64_t ops = 10000;
+    run_bench("word_dictionary::complete (top 3)", ops, [&dictionary, &prefixes]() {
+        std::vector<word_completion> completions;
+        uint64_t total = 0;
+        for (uint64_t i = 0; i < ops; i++)
+        {
+            dictionary.complete(prefixes[i % prefixes.size()], 3, completions);
+            total += completions.size();
+        }
+        benchSink = total;
+    });
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc > 1)
+    {
+        benchFilter = argv[1];
+    }
+    if (argc > 2)
+    {
+        benchCorpus = argv[2];
+    }
+    bench_keys();
+    bench_key_layout();
+    bench_geometry();
+    bench_touchpad();
+    bench_queues();
+    bench_latency();
+    bench_trace();
+    bench_window_registry(1000);
+    bench_window_registry(10000);
+    bench_process_registry();
+    bench_window_executor();
+    bench_app_config();
+    bench_text_injector();
+    bench_word_dictionary();
+    return 0;
+}
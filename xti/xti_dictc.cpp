@@ -0,0 +1,114 @@
+// xti keyboard
+// Copyright © Jordan Singh
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// Offline compiler for the word completion dictionary read by word_dictionary.
+// usage: xti_dictc [--counts] <input>... <output>
+//   input files are plain text (source code, books, chat logs) whose words are counted, or with --counts
+//   lines of "word count" as found in published frequency lists.
+
+// 1. Qt framework headers
+// 2. System/OS headers
+// 3. C++ standard library headers
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+// 4. Project classes
+#include "word_dictionary.h"
+
+static bool read_file(const char* path, std::vector<char>& bytesOut)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+    bytesOut.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return !file.bad();
+}
+
+// Adds every "word count" line, lines that do not parse are skipped.
+static void add_counts(word_dictionary_builder& builder, const std::vector<char>& bytes)
+{
+    std::string text(bytes.begin(), bytes.end());
+    size_t start = 0;
+    while (start < text.size())
+    {
+        size_t end = text.find('\n', start);
+        if (end == std::string::npos)
+        {
+            end = text.size();
+        }
+        std::string line = text.substr(start, end - start);
+        size_t space = line.find_first_of(" \t");
+        if (space != std::string::npos)
+        {
+            uint64_t count = std::strtoull(line.c_str() + space + 1, nullptr, 10);
+            builder.add(line.substr(0, space), count);
+        }
+        start = end + 1;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int32_t first = 1;
+    bool counts = argc > 1 && std::strcmp(argv[1], "--counts") == 0;
+    if (counts)
+    {
+        first++;
+    }
+    if (argc - first < 2)
+    {
+        std::fprintf(stderr, "usage: xti_dictc [--counts] <input>... <output>\n");
+        return 1;
+    }
+    word_dictionary_builder builder;
+    std::vector<char> bytes;
+    for (int32_t i = first; i < argc - 1; i++)
+    {
+        if (!read_file(argv[i], bytes))
+        {
+            std::fprintf(stderr, "xti_dictc: cannot read %s\n", argv[i]);
+            return 1;
+        }
+        if (counts)
+        {
+            add_counts(builder, bytes);
+        }
+        else
+        {
+            builder.add_text(bytes.data(), bytes.size());
+        }
+    }
+
+    std::vector<uint8_t> dictionary = builder.build();
+    const char* outputPath = argv[argc - 1];
+    std::ofstream output(outputPath, std::ios::binary);
+    output.write(reinterpret_cast<const char*>(dictionary.data()), static_cast<std::streamsize>(dictionary.size()));
+    output.close();
+    if (!output)
+    {
+        std::fprintf(stderr, "xti_dictc: cannot write %s\n", outputPath);
+        return 1;
+    }
+    std::printf("%zu words, %zu bytes (%.1f bytes/word)\n", builder.get_word_count(), dictionary.size(),
+                builder.get_word_count() == 0 ? 0.0 : static_cast<double>(dictionary.size()) / static_cast<double>(builder.get_word_count()));
+    return 0;
+}